@@ -0,0 +1,28 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include "AP_WS_Admission.h"
+#include "framework/MicroServiceFuncs.h"
+
+namespace OpenWifi {
+
+	void AP_WS_Admission::Start() {
+		Settings S;
+		S.Enabled = MicroServiceConfigGetBool("openwifi.admission", false);
+		S.Min = MicroServiceConfigGetInt("openwifi.admission.min", 32);
+		S.Max = MicroServiceConfigGetInt("openwifi.admission.max", 1024);
+		S.Initial = MicroServiceConfigGetInt("openwifi.admission.initial", 256);
+		S.TargetLatency = std::chrono::milliseconds(
+			MicroServiceConfigGetInt("openwifi.admission.targetlatency", 2000));
+		S.HandshakeTimeout = std::chrono::seconds(
+			MicroServiceConfigGetInt("openwifi.admission.handshaketimeout", 10));
+		S.HoldTimeout =
+			std::chrono::seconds(MicroServiceConfigGetInt("openwifi.admission.holdtimeout", 30));
+		S.AdjustEvery =
+			std::chrono::seconds(MicroServiceConfigGetInt("openwifi.admission.adjust", 5));
+		Configure(S);
+	}
+
+} // namespace OpenWifi
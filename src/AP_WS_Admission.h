@@ -0,0 +1,233 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "Poco/JSON/Object.h"
+
+#include "framework/MetricsRegistry.h"
+
+namespace OpenWifi {
+
+	//	Limits how many devices go through connection setup (TLS handshake, websocket upgrade,
+	//	certificate and blacklist checks, connect message and its database work) at the same time.
+	//	A device is admitted when its TCP connection is accepted, before the handshake, and keeps
+	//	its slot until its connect message has been processed or the connection ends. Admission
+	//	never waits: over the limit, the connection is closed right away, so neither the accept
+	//	thread nor a handshake thread is spent on it and the device reconnects on its own backoff.
+	//	Admitted connections are handshaked in arrival order. Shed devices get no place in line,
+	//	so admission is first come first served only among the devices let in. The limit adapts
+	//	to connect latency: it backs off when latency is over target and grows while devices are
+	//	turned away and latency is fine.
+	class AP_WS_Admission {
+	  public:
+		using Clock = std::chrono::steady_clock;
+
+		struct Settings {
+			bool Enabled = false;
+			std::uint64_t Min = 32, Max = 1024, Initial = 256;
+			std::chrono::milliseconds TargetLatency{2000};
+			std::chrono::milliseconds HandshakeTimeout{10000}, HoldTimeout{30000}, AdjustEvery{5000};
+		};
+
+		void Start();
+
+		inline void Configure(const Settings &S, Clock::time_point Now = Clock::now()) {
+			std::lock_guard Lock(Mutex_);
+			Enabled_ = S.Enabled;
+			MinLimit_ = std::max((std::uint64_t)1, S.Min);
+			MaxLimit_ = std::max(MinLimit_, S.Max);
+			Limit_ = std::clamp(S.Initial, MinLimit_, MaxLimit_);
+			TargetLatency_ = S.TargetLatency;
+			HoldTimeout_ = S.HoldTimeout;
+			HandshakeTimeout_ = std::min(S.HandshakeTimeout, S.HoldTimeout);
+			AdjustEvery_ = S.AdjustEvery;
+			NextAdjust_ = Now + AdjustEvery_;
+		}
+
+		//	Never blocks. False means the device was shed.
+		inline bool Admit(std::uint64_t &Ticket, Clock::time_point Now = Clock::now()) {
+			Ticket = 0;
+			std::lock_guard Lock(Mutex_);
+			if (!Enabled_)
+				return true;
+			if (!TakeSlot(Now))
+				return false;
+			Ticket = NextTicket_++;
+			InFlight_.emplace_hint(InFlight_.end(), Ticket, Now);
+			return true;
+		}
+
+		//	At accept time, before the TLS handshake. The slot waits for Claim() under the
+		//	connection's peer address for at most the handshake timeout.
+		inline bool Admit(const std::string &Peer, Clock::time_point Now = Clock::now()) {
+			std::lock_guard Lock(Mutex_);
+			if (!Enabled_)
+				return true;
+			if (!TakeSlot(Now))
+				return false;
+			auto Ticket = NextTicket_++;
+			Handshaking_.emplace_hint(Handshaking_.end(), Ticket, Pending{Now, Peer});
+			ByPeer_[Peer] = Ticket;
+			return true;
+		}
+
+		//	Once the upgrade request arrives: the ticket admitted for Peer, 0 when there is none
+		//	or its handshake took too long.
+		inline std::uint64_t Claim(const std::string &Peer, Clock::time_point Now = Clock::now()) {
+			std::lock_guard Lock(Mutex_);
+			ExpireHeld(Now);
+			auto ByPeer = ByPeer_.find(Peer);
+			if (ByPeer == ByPeer_.end())
+				return 0;
+			auto Ticket = ByPeer->second;
+			ByPeer_.erase(ByPeer);
+			auto Hit = Handshaking_.find(Ticket);
+			if (Hit == Handshaking_.end())
+				return 0;
+			InFlight_.emplace(Ticket, Hit->second.Since);
+			Handshaking_.erase(Hit);
+			return Ticket;
+		}
+
+		//	Completed is true once the connect message was processed.
+		inline void Release(std::uint64_t Ticket, bool Completed,
+							Clock::time_point Now = Clock::now()) {
+			if (Ticket == 0)
+				return;
+			std::lock_guard Lock(Mutex_);
+			auto Hit = InFlight_.find(Ticket);
+			if (Hit == InFlight_.end())
+				return;
+			if (Completed) {
+				auto Us = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+							  Now - Hit->second)
+							  .count();
+				Latency_.Record(Us);
+				Completed_++;
+				PeriodCompleted_++;
+				PeriodLatencyUs_ += Us;
+			}
+			InFlight_.erase(Hit);
+			Adjust(Now);
+		}
+
+		[[nodiscard]] inline std::uint64_t InFlight() {
+			std::lock_guard Lock(Mutex_);
+			return Handshaking_.size() + InFlight_.size();
+		}
+
+		[[nodiscard]] inline std::uint64_t Limit() {
+			std::lock_guard Lock(Mutex_);
+			return Limit_;
+		}
+
+		inline void GetStatistics(Poco::JSON::Object &Obj) {
+			std::lock_guard Lock(Mutex_);
+			Obj.set("enabled", Enabled_);
+			Obj.set("limit", Limit_);
+			Obj.set("inFlight", Handshaking_.size() + InFlight_.size());
+			Obj.set("handshaking", Handshaking_.size());
+			Obj.set("peakInFlight", PeakInFlight_);
+			Obj.set("admitted", TotalAdmitted_);
+			Obj.set("shed", Shed_);
+			Obj.set("expired", Expired_);
+			Obj.set("handshakesExpired", HandshakesExpired_);
+			Obj.set("completed", Completed_);
+			Obj.set("grown", Grown_);
+			Obj.set("shrunk", Shrunk_);
+			Poco::JSON::Object Latency;
+			Latency_.ToJSON(Latency);
+			Obj.set("connectLatency", Latency);
+		}
+
+	  private:
+		struct Pending {
+			Clock::time_point Since;
+			std::string Peer;
+		};
+
+		bool Enabled_ = false;
+		std::uint64_t MinLimit_ = 32, MaxLimit_ = 1024, Limit_ = 256;
+		std::chrono::milliseconds TargetLatency_{2000};
+		std::chrono::milliseconds HandshakeTimeout_{10000}, HoldTimeout_{30000}, AdjustEvery_{5000};
+
+		std::mutex Mutex_;
+		//	tickets grow with time, so the oldest slots come first in both.
+		std::map<std::uint64_t, Pending> Handshaking_;
+		std::map<std::uint64_t, Clock::time_point> InFlight_;
+		std::map<std::string, std::uint64_t> ByPeer_;
+		std::uint64_t NextTicket_ = 1;
+
+		MetricHistogram Latency_;
+		std::uint64_t TotalAdmitted_ = 0, Shed_ = 0, Expired_ = 0, HandshakesExpired_ = 0,
+					  Completed_ = 0, Grown_ = 0, Shrunk_ = 0, PeakInFlight_ = 0;
+
+		//	since the last adjustment
+		Clock::time_point NextAdjust_{};
+		std::uint64_t PeriodLatencyUs_ = 0, PeriodCompleted_ = 0, PeriodShed_ = 0;
+
+		//	Called with Mutex_ held. False when over the limit.
+		inline bool TakeSlot(Clock::time_point Now) {
+			ExpireHeld(Now);
+			auto Used = (std::uint64_t)(Handshaking_.size() + InFlight_.size());
+			if (Used >= Limit_) {
+				Shed_++;
+				PeriodShed_++;
+				Adjust(Now);
+				return false;
+			}
+			PeakInFlight_ = std::max(PeakInFlight_, Used + 1);
+			TotalAdmitted_++;
+			Adjust(Now);
+			return true;
+		}
+
+		//	Called with Mutex_ held. Drops the slots of handshakes that failed or never finished
+		//	and of devices that never sent a connect.
+		inline void ExpireHeld(Clock::time_point Now) {
+			while (!Handshaking_.empty() &&
+				   Now - Handshaking_.begin()->second.Since > HandshakeTimeout_) {
+				auto ByPeer = ByPeer_.find(Handshaking_.begin()->second.Peer);
+				if (ByPeer != ByPeer_.end() && ByPeer->second == Handshaking_.begin()->first)
+					ByPeer_.erase(ByPeer);
+				Handshaking_.erase(Handshaking_.begin());
+				HandshakesExpired_++;
+			}
+			while (!InFlight_.empty() && Now - InFlight_.begin()->second > HoldTimeout_) {
+				InFlight_.erase(InFlight_.begin());
+				Expired_++;
+			}
+		}
+
+		//	Called with Mutex_ held.
+		inline void Adjust(Clock::time_point Now) {
+			if (Now < NextAdjust_)
+				return;
+			NextAdjust_ = Now + AdjustEvery_;
+			auto TargetUs = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+								TargetLatency_)
+								.count();
+			if (PeriodCompleted_ > 0 && PeriodLatencyUs_ / PeriodCompleted_ > TargetUs) {
+				auto Lower = std::max(MinLimit_, Limit_ * 3 / 4);
+				if (Lower < Limit_) {
+					Limit_ = Lower;
+					Shrunk_++;
+				}
+			} else if (PeriodShed_ > 0 && Limit_ < MaxLimit_) {
+				Limit_ = std::min(MaxLimit_, Limit_ + std::max((std::uint64_t)1, Limit_ / 8));
+				Grown_++;
+			}
+			PeriodLatencyUs_ = PeriodCompleted_ = PeriodShed_ = 0;
+		}
+	};
+
+} // namespace OpenWifi
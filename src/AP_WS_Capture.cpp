@@ -0,0 +1,263 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include "Poco/Exception.h"
+#include "Poco/JSON/Parser.h"
+#include "Poco/String.h"
+#include "Poco/zlib.h"
+
+#include "fmt/format.h"
+
+#include "AP_WS_Capture.h"
+#include "framework/ow_constants.h"
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	bool AP_WS_Capture::Open(const std::string &FileName, std::uint64_t MaxFrames) {
+		std::lock_guard G(Mutex_);
+		File_.open(FileName, std::ios::binary | std::ios::trunc);
+		if (!File_) {
+			poco_error(Logger_, fmt::format("CAPTURE: cannot create {}.", FileName));
+			return false;
+		}
+		Deflater_ = std::make_unique<Poco::DeflatingOutputStream>(
+			File_, Poco::DeflatingStreamBuf::STREAM_ZLIB, Z_BEST_SPEED);
+		Writer_ = std::make_unique<Poco::BinaryWriter>(
+			*Deflater_, Poco::BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+		Writer_->writeRaw(Magic);
+		FileName_ = FileName;
+		MaxFrames_ = MaxFrames;
+		Started_ = std::chrono::steady_clock::now();
+		Stopping_ = false;
+		WriterThread_ = std::thread([this] { WriterLoop(); });
+		Active_ = true;
+		poco_notice(Logger_, fmt::format("CAPTURE: recording device frames to {}, up to {} frames.",
+										 FileName, MaxFrames));
+		return true;
+	}
+
+	//	Frames already queued are written before the file is closed.
+	void AP_WS_Capture::Close() {
+		Active_ = false;
+		{
+			std::lock_guard G(QueueMutex_);
+			Stopping_ = true;
+		}
+		QueueReady_.notify_one();
+		if (WriterThread_.joinable())
+			WriterThread_.join();
+		std::lock_guard G(Mutex_);
+		Finish();
+	}
+
+	void AP_WS_Capture::Finish() {
+		if (!Writer_)
+			return;
+		Active_ = false;
+		try {
+			Writer_->flush();
+			Deflater_->close();
+			File_.close();
+		} catch (const Poco::Exception &E) {
+			Logger_.log(E);
+		}
+		Writer_.reset();
+		Deflater_.reset();
+		poco_notice(Logger_, fmt::format("CAPTURE: {} closed with {} frames from {} devices.",
+										 FileName_, Frames_, Devices_.size()));
+	}
+
+	//	Events carry the device serial number in params, which can differ from the certificate
+	//	CN. Compact JSON is all devices send, anything else falls back to the CN.
+	static std::string SerialInFrame(const std::string &Text) {
+		static const std::string Key = fmt::format("\"{}\":\"", uCentralProtocol::SERIAL);
+		auto Start = Text.find(Key);
+		if (Start == std::string::npos)
+			return "";
+		Start += Key.size();
+		auto End = Text.find('"', Start);
+		if (End == std::string::npos)
+			return "";
+		auto Serial = Poco::toLower(Text.substr(Start, End - Start));
+		return Utils::ValidSerialNumber(Serial) ? Serial : "";
+	}
+
+	//	Runs on the reactor threads: only a copy, the writer thread does the rest.
+	void AP_WS_Capture::Record(const std::string &SerialNumber, const char *Frame,
+							   std::size_t Size) {
+		if (!Active_)
+			return;
+		std::string Text(Frame, Size);
+		{
+			std::lock_guard G(QueueMutex_);
+			if (Stopping_)
+				return;
+			if (QueuedBytes_ + Size > MaxQueuedBytes) {
+				Dropped_++;
+				return;
+			}
+			//	taken under the lock, so offsets grow along the file.
+			auto Offset = std::chrono::duration_cast<std::chrono::microseconds>(
+							  std::chrono::steady_clock::now() - Started_)
+							  .count();
+			Queue_.push_back(Pending{(std::uint64_t)Offset, SerialNumber, std::move(Text)});
+			QueuedBytes_ += Size;
+		}
+		QueueReady_.notify_one();
+	}
+
+	void AP_WS_Capture::WriterLoop() {
+		Utils::SetThreadName("ws:capture");
+		std::deque<Pending> Batch;
+		while (true) {
+			{
+				std::unique_lock G(QueueMutex_);
+				QueueReady_.wait(G, [this] { return Stopping_ || !Queue_.empty(); });
+				if (Queue_.empty())
+					return;
+				Batch.swap(Queue_);
+				QueuedBytes_ = 0;
+			}
+			for (auto &P : Batch)
+				Write(P);
+			Batch.clear();
+		}
+	}
+
+	void AP_WS_Capture::Write(Pending &P) {
+		auto &Text = P.Text;
+		auto Serial = SerialInFrame(Text);
+		if (Serial.empty())
+			Serial = P.SerialNumber;
+
+		std::lock_guard G(Mutex_);
+		if (!Writer_)
+			return;
+		try {
+			auto Device = Devices_.emplace(Serial, (std::uint32_t)Devices_.size()).first->second;
+			auto Alias = Pseudonym(Device);
+			if (Text.find(uCentralProtocol::COMPRESS_64) != std::string::npos)
+				AnonymiseCompressed(Text, Serial, Alias);
+			Anonymise(Text, Serial, Alias);
+			if (P.SerialNumber != Serial)
+				Anonymise(Text, P.SerialNumber, Alias);
+
+			Writer_->write7BitEncoded((Poco::UInt64)P.Offset);
+			Writer_->write7BitEncoded((Poco::UInt32)Device);
+			Writer_->write7BitEncoded((Poco::UInt32)Text.size());
+			Writer_->writeRaw(Text);
+			Frames_++;
+			Bytes_ += Text.size();
+		} catch (const Poco::Exception &E) {
+			//	a frame that cannot be anonymised is left out.
+			Failed_++;
+			poco_debug(Logger_, fmt::format("CAPTURE: frame skipped: {}", E.displayText()));
+		} catch (const std::exception &E) {
+			Failed_++;
+			poco_debug(Logger_, fmt::format("CAPTURE: frame skipped: {}", E.what()));
+		}
+
+		if (MaxFrames_ && Frames_ >= MaxFrames_)
+			Finish();
+	}
+
+	void AP_WS_Capture::GetStatistics(Poco::JSON::Object &Obj) {
+		std::lock_guard G(Mutex_);
+		Obj.set("file", FileName_);
+		Obj.set("active", Writer_ != nullptr);
+		Obj.set("frames", Frames_);
+		Obj.set("bytes", Bytes_);
+		Obj.set("devices", Devices_.size());
+		Obj.set("skipped", Failed_);
+		Obj.set("dropped", Dropped_.load());
+		std::lock_guard Q(QueueMutex_);
+		Obj.set("queuedBytes", QueuedBytes_);
+	}
+
+	std::string AP_WS_Capture::Pseudonym(std::uint32_t Device) {
+		return fmt::format("02{:010x}", Device);
+	}
+
+	void AP_WS_Capture::Anonymise(std::string &Text, const std::string &SerialNumber,
+								  const std::string &Pseudonym) {
+		if (SerialNumber.empty())
+			return;
+		auto MAC = Utils::SerialToMAC(SerialNumber);
+		auto AliasMAC = Utils::SerialToMAC(Pseudonym);
+		Poco::replaceInPlace(Text, SerialNumber, Pseudonym);
+		Poco::replaceInPlace(Text, Poco::toUpper(SerialNumber), Poco::toUpper(Pseudonym));
+		Poco::replaceInPlace(Text, MAC, AliasMAC);
+		Poco::replaceInPlace(Text, Poco::toUpper(MAC), Poco::toUpper(AliasMAC));
+	}
+
+	//	The payload is expanded, anonymised and compressed again, so the replay still pays for
+	//	the decompression.
+	void AP_WS_Capture::AnonymiseCompressed(std::string &Text, const std::string &SerialNumber,
+											const std::string &Pseudonym) {
+		Poco::JSON::Parser Parser;
+		auto Doc = Parser.parse(Text).extract<Poco::JSON::Object::Ptr>();
+		if (!Doc->isObject(uCentralProtocol::PARAMS))
+			return;
+		auto Params = Doc->getObject(uCentralProtocol::PARAMS);
+		if (!Params->has(uCentralProtocol::COMPRESS_64))
+			return;
+
+		std::uint64_t CompressedSize =
+			Params->has("compress_sz") ? (std::uint64_t)Params->get("compress_sz") : 0;
+		std::string Expanded;
+		if (!Utils::ExtractBase64CompressedData(
+				Params->get(uCentralProtocol::COMPRESS_64).toString(), Expanded, CompressedSize))
+			throw Poco::DataFormatException("compressed payload cannot be expanded");
+		Anonymise(Expanded, SerialNumber, Pseudonym);
+
+		uLongf Size = compressBound(Expanded.size());
+		std::vector<Bytef> Compressed(Size);
+		if (compress(Compressed.data(), &Size, (const Bytef *)Expanded.data(), Expanded.size()) !=
+			Z_OK)
+			throw Poco::DataFormatException("compressed payload cannot be rebuilt");
+		Params->set(uCentralProtocol::COMPRESS_64, Utils::base64encode(Compressed.data(), Size));
+		Params->set("compress_sz", Expanded.size());
+
+		std::ostringstream OS;
+		Doc->stringify(OS);
+		Text = OS.str();
+	}
+
+	AP_WS_CaptureReader::AP_WS_CaptureReader(const std::string &FileName)
+		: File_(FileName, std::ios::binary) {
+		if (!File_)
+			throw Poco::FileNotFoundException(FileName);
+		Inflater_ = std::make_unique<Poco::InflatingInputStream>(
+			File_, Poco::InflatingStreamBuf::STREAM_ZLIB);
+		Reader_ = std::make_unique<Poco::BinaryReader>(
+			*Inflater_, Poco::BinaryReader::LITTLE_ENDIAN_BYTE_ORDER);
+		std::string Magic;
+		Reader_->readRaw(std::strlen(AP_WS_Capture::Magic), Magic);
+		if (Magic != AP_WS_Capture::Magic)
+			throw Poco::DataFormatException(FileName + " is not a capture file");
+	}
+
+	bool AP_WS_CaptureReader::Next(AP_WS_Capture::Frame &F) {
+		Poco::UInt64 Offset = 0;
+		Poco::UInt32 Device = 0, Size = 0;
+		Reader_->read7BitEncoded(Offset);
+		if (!Reader_->good())
+			return false;
+		Reader_->read7BitEncoded(Device);
+		Reader_->read7BitEncoded(Size);
+		Reader_->readRaw(Size, F.Text);
+		if (!Reader_->good() || F.Text.size() != Size)
+			throw Poco::DataFormatException("capture file is truncated");
+		F.Offset = Offset;
+		F.Device = Device;
+		return true;
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,112 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Poco/BinaryReader.h"
+#include "Poco/BinaryWriter.h"
+#include "Poco/DeflatingStream.h"
+#include "Poco/InflatingStream.h"
+#include "Poco/JSON/Object.h"
+#include "Poco/Logger.h"
+
+namespace OpenWifi {
+
+	//	Records the text frames devices send, so the ingestion path can be replayed offline on
+	//	the same traffic (see AP_WS_Replay). Each device gets a pseudonym, and its serial number
+	//	is replaced in every frame it sends, compressed payloads included. The file is a zlib
+	//	stream: a magic, then one record per frame with the microseconds since the capture
+	//	started, the device index and the frame, lengths 7-bit encoded. The reactor threads only
+	//	copy each frame into a queue; parsing, anonymising and compressing happen on one writer
+	//	thread, so capture does not serialize the reactors. When the writer falls behind by more
+	//	than MaxQueuedBytes, frames are dropped and counted.
+	class AP_WS_Capture {
+	  public:
+		struct Frame {
+			std::uint64_t Offset = 0;
+			std::uint32_t Device = 0;
+			std::string Text;
+		};
+
+		static constexpr const char *Magic = "OWGWCAP1";
+		static constexpr std::size_t MaxQueuedBytes = 64 * 1024 * 1024;
+
+		explicit AP_WS_Capture(Poco::Logger &L) : Logger_(L) {}
+		~AP_WS_Capture() { Close(); }
+
+		bool Open(const std::string &FileName, std::uint64_t MaxFrames);
+		void Close();
+		void Record(const std::string &SerialNumber, const char *Frame, std::size_t Size);
+
+		void GetStatistics(Poco::JSON::Object &Obj);
+
+		//	A locally administered MAC, so it can never be a real device.
+		[[nodiscard]] static std::string Pseudonym(std::uint32_t Device);
+		//	Replaces the serial number, and the MAC written with colons, in either case.
+		static void Anonymise(std::string &Text, const std::string &SerialNumber,
+							  const std::string &Pseudonym);
+
+	  private:
+		struct Pending {
+			std::uint64_t Offset = 0;
+			std::string SerialNumber, Text;
+		};
+
+		Poco::Logger &Logger_;
+		std::atomic_bool Active_ = false;
+
+		//	between the reactors and the writer thread
+		std::mutex QueueMutex_;
+		std::condition_variable QueueReady_;
+		std::deque<Pending> Queue_;
+		std::size_t QueuedBytes_ = 0;
+		bool Stopping_ = false;
+		std::thread WriterThread_;
+		std::atomic_uint64_t Dropped_ = 0;
+
+		//	file and devices, written by the writer thread
+		std::mutex Mutex_;
+		std::string FileName_;
+		std::ofstream File_;
+		std::unique_ptr<Poco::DeflatingOutputStream> Deflater_;
+		std::unique_ptr<Poco::BinaryWriter> Writer_;
+		std::chrono::steady_clock::time_point Started_;
+		std::map<std::string, std::uint32_t> Devices_;
+		std::uint64_t MaxFrames_ = 0, Frames_ = 0, Bytes_ = 0, Failed_ = 0;
+
+		void WriterLoop();
+		void Write(Pending &P);
+		void Finish();
+		void AnonymiseCompressed(std::string &Text, const std::string &SerialNumber,
+								 const std::string &Pseudonym);
+	};
+
+	class AP_WS_CaptureReader {
+	  public:
+		//	Throws when the file cannot be opened or is not a capture.
+		explicit AP_WS_CaptureReader(const std::string &FileName);
+
+		//	False at the end of the file.
+		bool Next(AP_WS_Capture::Frame &F);
+
+	  private:
+		std::ifstream File_;
+		std::unique_ptr<Poco::InflatingInputStream> Inflater_;
+		std::unique_ptr<Poco::BinaryReader> Reader_;
+	};
+
+} // namespace OpenWifi
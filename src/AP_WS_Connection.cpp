@@ -3,7 +3,6 @@
 //
 
 
-#include <Poco/Base64Decoder.h>
 #include <Poco/Net/Context.h>
 #include <Poco/Net/HTTPServerRequestImpl.h>
 #include <Poco/Net/HTTPServerResponseImpl.h>
@@ -13,6 +12,7 @@
 #include <Poco/Net/WebSocketImpl.h>
 
 #include <framework/KafkaManager.h>
+#include <framework/MetricsRegistry.h>
 #include <framework/MicroServiceFuncs.h>
 #include <framework/utils.h>
 #include <framework/ow_constants.h>
@@ -31,6 +31,28 @@
 
 namespace OpenWifi {
 
+	static MetricCounter &FramesReceived(const char *Op) {
+		return MetricsRegistry()->Counter("owgw_websocket_frames_received_total",
+										  "WebSocket frames received from devices.", {{"op", Op}});
+	}
+	static auto &PingFrames = FramesReceived("ping");
+	static auto &PongFrames = FramesReceived("pong");
+	static auto &TextFrames = FramesReceived("text");
+	static auto &CloseFrames = FramesReceived("close");
+	static auto &OtherFrames = FramesReceived("other");
+	static auto &ReceivedBytes = MetricsRegistry()->Counter(
+		"owgw_websocket_received_bytes_total", "Bytes received from devices.");
+	static auto &SentBytes = MetricsRegistry()->Counter("owgw_websocket_sent_bytes_total",
+														"Bytes sent to devices.");
+	static auto &FramesSent = MetricsRegistry()->Counter("owgw_websocket_frames_sent_total",
+														 "WebSocket frames sent to devices.");
+	static auto &SendFailures = MetricsRegistry()->Counter(
+		"owgw_websocket_send_failures_total", "Frames that could not be delivered to a device.");
+	static auto &Disconnects = MetricsRegistry()->Counter(
+		"owgw_websocket_disconnects_total", "Device connections ended by an error or a close.");
+	static auto &TextFrameTime = MetricsRegistry()->Histogram(
+		"owgw_websocket_text_frame_seconds", "Time to parse and process a text frame.");
+
 	void AP_WS_Connection::LogException(const Poco::Exception &E) {
 		poco_information(Logger_, fmt::format("EXCEPTION({}): {}", CId_, E.displayText()));
 	}
@@ -38,11 +60,12 @@ namespace OpenWifi {
 	AP_WS_Connection::AP_WS_Connection(Poco::Net::HTTPServerRequest &request,
 									   Poco::Net::HTTPServerResponse &response,
 									   uint64_t session_id, Poco::Logger &L,
-									   std::pair<std::shared_ptr<Poco::Net::SocketReactor>, std::shared_ptr<LockedDbSession>> R)
+									   AP_WS_ReactorSlot R)
 		: Logger_(L) {
 
-		Reactor_ = R.first;
-		DbSession_ = R.second;
+		Reactor_ = R.Reactor;
+		DbSession_ = R.DbSession;
+		Timings_ = R.Timings;
 		State_.sessionId = session_id;
 
 		WS_ = std::make_unique<Poco::Net::WebSocket>(request, response);
@@ -59,6 +82,27 @@ namespace OpenWifi {
 		AP_WS_Server()->IncrementConnectionCount();
 	}
 
+	AP_WS_Connection::AP_WS_Connection(uint64_t session_id, const std::string &SerialNumber,
+									   Poco::Logger &L, AP_WS_ReactorSlot R)
+		: Logger_(L) {
+
+		Reactor_ = R.Reactor;
+		DbSession_ = R.DbSession;
+		Timings_ = R.Timings;
+		State_.sessionId = session_id;
+		State_.started = Utils::Now();
+		State_.VerifiedCertificate = GWObjects::VALID_CERTIFICATE;
+
+		PeerAddress_ = Poco::Net::IPAddress("127.0.0.1");
+		CId_ = "127.0.0.1:0";
+		CN_ = SerialNumber_ = SerialNumber;
+		SerialNumberInt_ = Utils::SerialNumberToInt(SerialNumber_);
+		DeviceValidated_ = true;
+		uuid_ = MicroServiceRandom(std::numeric_limits<std::uint64_t>::max()-1);
+
+		AP_WS_Server()->IncrementConnectionCount();
+	}
+
 	void AP_WS_Connection::Start() {
 		Registered_ = true;
 		LastContact_ = Utils::Now();
@@ -96,12 +140,20 @@ namespace OpenWifi {
 		}
 	}
 
+	void AP_WS_Connection::ReleaseAdmission(bool Completed) {
+		AP_WS_Server()->Admission().Release(AdmissionTicket_.exchange(0), Completed);
+	}
+
 	void AP_WS_Connection::EndConnection() {
 		bool expectedValue=false;
 		if (Dead_.compare_exchange_strong(expectedValue,true,std::memory_order_release,std::memory_order_relaxed)) {
+			ReleaseAdmission(false);
+			if (State_.Connected) {
+				AP_WS_Server()->SessionDisconnected(State_.started);
+			}
 
 			if(!SerialNumber_.empty() && State_.LastContact!=0) {
-				StorageService()->SetDeviceLastRecordedContact(SerialNumber_, State_.LastContact);
+				StorageService()->QueueDeviceLastRecordedContact(SerialNumber_, State_.LastContact);
 			}
 
 			if (Registered_) {
@@ -117,7 +169,8 @@ namespace OpenWifi {
 							  *this, &AP_WS_Connection::OnSocketError));
 				Registered_=false;
 			}
-			WS_->close();
+			if (WS_)
+				WS_->close();
 
 			if(!SerialNumber_.empty()) {
 				DeviceDisconnectionCleanup(SerialNumber_, uuid_);
@@ -216,7 +269,7 @@ namespace OpenWifi {
 
 			poco_trace(Logger_,
 					   fmt::format("TLS-CONNECTION({}): Session={} CN={} Completed. (t={})", CId_,
-								   State_.sessionId, CN_, ConcurrentStartingDevices_));
+								   State_.sessionId, CN_, AP_WS_Server()->Admission().InFlight()));
 			DeviceValidated_ = true;
 			return true;
 
@@ -309,9 +362,12 @@ namespace OpenWifi {
 			return;
 		}
 
+		AP_WS_RPCCall::SetEvent(EventType);
+
 		//  expand params if necessary
 		auto ParamsObj = Doc->get(uCentralProtocol::PARAMS).extract<Poco::JSON::Object::Ptr>();
 		if (ParamsObj->has(uCentralProtocol::COMPRESS_64)) {
+			AP_WS_RPCPhase Parse(AP_WS_RPCTimings::PARSE);
 			std::string UncompressedData;
 			try {
 				auto CompressedData = ParamsObj->get(uCentralProtocol::COMPRESS_64).toString();
@@ -376,6 +432,7 @@ namespace OpenWifi {
 		switch (EventType) {
 		case uCentralProtocol::Events::ET_CONNECT: {
 			Process_connect(ParamsObj, Serial);
+			ReleaseAdmission(true);
 		} break;
 
 		case uCentralProtocol::Events::ET_STATE: {
@@ -561,14 +618,18 @@ namespace OpenWifi {
 	void AP_WS_Connection::OnSocketShutdown(
 		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf) {
 		poco_trace(Logger_, fmt::format("SOCKET-SHUTDOWN({}): Closing.", CId_));
-//		std::lock_guard	G(ConnectionMutex_);
+		auto Self = weak_from_this().lock();
+		if (!Self)
+			return;
 		return EndConnection();
 	}
 
 	void AP_WS_Connection::OnSocketError(
 		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf) {
 		poco_trace(Logger_, fmt::format("SOCKET-ERROR({}): Closing.", CId_));
-//		std::lock_guard	G(ConnectionMutex_);
+		auto Self = weak_from_this().lock();
+		if (!Self)
+			return;
 		return EndConnection();
 	}
 
@@ -578,6 +639,12 @@ namespace OpenWifi {
 		if (Dead_) //	we are dead, so we do not process anything.
 			return;
 
+		//	EndConnection hands the session to the cleanup thread, which may drop the last
+		//	reference before this callback has unwound. Self keeps it alive until then, and is
+		//	declared first so the lock is released before.
+		auto Self = weak_from_this().lock();
+		if (!Self)
+			return;
 		std::lock_guard	G(ConnectionMutex_);
 
 		State_.LastContact = LastContact_ = Utils::Now();
@@ -599,6 +666,63 @@ namespace OpenWifi {
 		EndConnection();
 	}
 
+	//	Frame must be null terminated. Shared by the reactor and the replay.
+	void AP_WS_Connection::ProcessTextFrame(const char *Frame) {
+		auto FrameStart = std::chrono::steady_clock::now();
+		AP_WS_RPCCall Call(Timings_.get());
+		Poco::JSON::Object::Ptr IncomingJSON;
+		{
+			AP_WS_RPCPhase Parse(AP_WS_RPCTimings::PARSE);
+			Poco::JSON::Parser parser;
+			auto ParsedMessage = parser.parse(Frame);
+			IncomingJSON = ParsedMessage.extract<Poco::JSON::Object::Ptr>();
+		}
+
+		if (IncomingJSON->has(uCentralProtocol::JSONRPC)) {
+			if (IncomingJSON->has(uCentralProtocol::METHOD) &&
+				IncomingJSON->has(uCentralProtocol::PARAMS)) {
+				ProcessJSONRPCEvent(IncomingJSON);
+			} else if (IncomingJSON->has(uCentralProtocol::RESULT) &&
+					   IncomingJSON->has(uCentralProtocol::ID)) {
+				poco_trace(Logger_, fmt::format("RPC-RESULT({}): payload: {}", CId_, Frame));
+				ProcessJSONRPCResult(IncomingJSON);
+			} else {
+				poco_warning(Logger_,
+							 fmt::format("INVALID-PAYLOAD({}): Payload is not JSON-RPC 2.0: {}",
+										 CId_, Frame));
+			}
+		} else if (IncomingJSON->has(uCentralProtocol::RADIUS)) {
+			ProcessIncomingRadiusData(IncomingJSON);
+		} else {
+			std::ostringstream iS;
+			IncomingJSON->stringify(iS);
+			poco_warning(Logger_,
+						 fmt::format("FRAME({}): illegal transaction header, missing 'jsonrpc': {}",
+									 CId_, iS.str()));
+			Errors_++;
+		}
+		TextFrameTime.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+								 std::chrono::steady_clock::now() - FrameStart)
+								 .count());
+	}
+
+	bool AP_WS_Connection::ReplayFrame(const std::string &Frame) {
+		std::lock_guard G(ConnectionMutex_);
+		State_.RX += Frame.size();
+		State_.MessageCount++;
+		State_.LastContact = LastContact_ = Utils::Now();
+		try {
+			ProcessTextFrame(Frame.c_str());
+			return true;
+		} catch (const Poco::Exception &E) {
+			poco_debug(Logger_, fmt::format("REPLAY({}): {}", CId_, E.displayText()));
+		} catch (const std::exception &E) {
+			poco_debug(Logger_, fmt::format("REPLAY({}): {}", CId_, E.what()));
+		}
+		Errors_++;
+		return false;
+	}
+
 	void AP_WS_Connection::ProcessIncomingFrame() {
 		Poco::Buffer<char> IncomingFrame(0);
 
@@ -620,11 +744,13 @@ namespace OpenWifi {
 
 			State_.RX += IncomingSize;
 			AP_WS_Server()->AddRX(IncomingSize);
+			ReceivedBytes.Inc(IncomingSize);
 			State_.MessageCount++;
 			State_.LastContact = Utils::Now();
 
 			switch (Op) {
 				case Poco::Net::WebSocket::FRAME_OP_PING: {
+					PingFrames.Inc();
 					poco_trace(Logger_, fmt::format("WS-PING({}): received. PONG sent back.", CId_));
 					WS_->sendFrame("", 0,
 								   (int)Poco::Net::WebSocket::FRAME_OP_PONG |
@@ -647,53 +773,29 @@ namespace OpenWifi {
 				} break;
 
 				case Poco::Net::WebSocket::FRAME_OP_PONG: {
+					PongFrames.Inc();
 					poco_trace(Logger_, fmt::format("PONG({}): received and ignored.", CId_));
 				} break;
 
 				case Poco::Net::WebSocket::FRAME_OP_TEXT: {
+					TextFrames.Inc();
 					poco_trace(Logger_,
 							   fmt::format("FRAME({}): Frame received (length={}, flags={}). Msg={}",
 										   CId_, IncomingSize, flags, IncomingFrame.begin()));
-
-					Poco::JSON::Parser parser;
-					auto ParsedMessage = parser.parse(IncomingFrame.begin());
-					auto IncomingJSON = ParsedMessage.extract<Poco::JSON::Object::Ptr>();
-
-					if (IncomingJSON->has(uCentralProtocol::JSONRPC)) {
-						if (IncomingJSON->has(uCentralProtocol::METHOD) &&
-							IncomingJSON->has(uCentralProtocol::PARAMS)) {
-							ProcessJSONRPCEvent(IncomingJSON);
-						} else if (IncomingJSON->has(uCentralProtocol::RESULT) &&
-								   IncomingJSON->has(uCentralProtocol::ID)) {
-							poco_trace(Logger_, fmt::format("RPC-RESULT({}): payload: {}", CId_,
-															IncomingFrame.begin()));
-							ProcessJSONRPCResult(IncomingJSON);
-						} else {
-							poco_warning(
-								Logger_,
-								fmt::format("INVALID-PAYLOAD({}): Payload is not JSON-RPC 2.0: {}",
-											CId_, IncomingFrame.begin()));
-						}
-					} else if (IncomingJSON->has(uCentralProtocol::RADIUS)) {
-						ProcessIncomingRadiusData(IncomingJSON);
-					} else {
-						std::ostringstream iS;
-						IncomingJSON->stringify(iS);
-						poco_warning(
-							Logger_,
-							fmt::format("FRAME({}): illegal transaction header, missing 'jsonrpc': {}",
-										CId_, iS.str()));
-						Errors_++;
-					}
+					if (auto Capture = AP_WS_Server()->Capture())
+						Capture->Record(SerialNumber_, IncomingFrame.begin(), IncomingSize);
+					ProcessTextFrame(IncomingFrame.begin());
 				} break;
 
 				case Poco::Net::WebSocket::FRAME_OP_CLOSE: {
+					CloseFrames.Inc();
 					poco_information(Logger_,
 									 fmt::format("CLOSE({}): Device is closing its connection.", CId_));
 					KillConnection=true;
 				} break;
 
 				default: {
+					OtherFrames.Inc();
 					poco_warning(Logger_, fmt::format("UNKNOWN({}): unknown WS Frame operation: {}",
 													  CId_, std::to_string(Op)));
 					Errors_++;
@@ -776,10 +878,16 @@ namespace OpenWifi {
 			return;
 
 		poco_warning(Logger_, fmt::format("DISCONNECTING({}): ConnectionException: {} Errors: {}", CId_, KillConnection, Errors_ ));
+		Disconnects.Inc();
 		EndConnection();
 	}
 
 	bool AP_WS_Connection::Send(const std::string &Payload) {
+		if (!WS_) {
+			//	replayed device, nothing to deliver to.
+			State_.TX += Payload.size();
+			return true;
+		}
 		try {
 			size_t BytesSent = WS_->sendFrame(Payload.c_str(), (int)Payload.size());
 
@@ -817,10 +925,13 @@ namespace OpenWifi {
 #endif
 			State_.TX += BytesSent;
 			AP_WS_Server()->AddTX(BytesSent);
+			SentBytes.Inc(BytesSent);
+			FramesSent.Inc();
 			return BytesSent == Payload.size();
 		} catch (const Poco::Exception &E) {
 			Logger_.log(E);
 		}
+		SendFailures.Inc();
 		return false;
 	}
 
@@ -829,11 +940,10 @@ namespace OpenWifi {
 	}
 
 	std::string Base64Decode(const std::string &F) {
-		std::istringstream ifs(F);
-		Poco::Base64Decoder b64in(ifs);
-		std::ostringstream ofs;
-		Poco::StreamCopier::copyStream(b64in, ofs);
-		return ofs.str();
+		std::string Decoded;
+		if (!Utils::base64decode(F, Decoded))
+			throw Poco::DataFormatException("Invalid base64 encoded data");
+		return Decoded;
 	}
 
 	bool AP_WS_Connection::SendRadiusAuthenticationData(const unsigned char *buffer,
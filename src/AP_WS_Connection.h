@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -21,19 +22,28 @@
 
 namespace OpenWifi {
 
-	class AP_WS_Connection {
+	class AP_WS_Connection : public std::enable_shared_from_this<AP_WS_Connection> {
 		static constexpr int BufSize = 256000;
 
 	  public:
 		explicit AP_WS_Connection(Poco::Net::HTTPServerRequest &request,
 								  Poco::Net::HTTPServerResponse &response, uint64_t connection_id,
-								  Poco::Logger &L, std::pair<std::shared_ptr<Poco::Net::SocketReactor>, std::shared_ptr<LockedDbSession>> R);
+								  Poco::Logger &L, AP_WS_ReactorSlot R);
+		//	A device replayed from a capture, without a socket. Whatever is sent to it is dropped.
+		AP_WS_Connection(uint64_t session_id, const std::string &SerialNumber, Poco::Logger &L,
+						 AP_WS_ReactorSlot R);
 		~AP_WS_Connection();
 
 		void EndConnection();
+		//	Admission slot taken for this connection, given back once it is set up.
+		inline void SetAdmissionTicket(std::uint64_t Ticket) { AdmissionTicket_ = Ticket; }
+		void ReleaseAdmission(bool Completed);
 		void ProcessJSONRPCEvent(Poco::JSON::Object::Ptr &Doc);
 		void ProcessJSONRPCResult(Poco::JSON::Object::Ptr Doc);
 		void ProcessIncomingFrame();
+		void ProcessTextFrame(const char *Frame);
+		//	False when the frame could not be processed.
+		bool ReplayFrame(const std::string &Frame);
 		void ProcessIncomingRadiusData(const Poco::JSON::Object::Ptr &Doc);
 
 		[[nodiscard]] bool Send(const std::string &Payload);
@@ -113,6 +123,7 @@ namespace OpenWifi {
 		Poco::Logger &Logger_;
 		std::shared_ptr<Poco::Net::SocketReactor> 	Reactor_;
 		std::shared_ptr<LockedDbSession> 	DbSession_;
+		std::shared_ptr<AP_WS_RPCTimings>	Timings_;
 		std::unique_ptr<Poco::Net::WebSocket> WS_;
 		std::string SerialNumber_;
 		uint64_t SerialNumberInt_ = 0;
@@ -121,6 +132,7 @@ namespace OpenWifi {
 		std::string CId_;
 		std::string CN_;
 		uint64_t Errors_ = 0;
+		std::uint64_t DbRowsWritten_ = 0; //	rows this connection wrote, for connect path stats
 		Poco::Net::IPAddress PeerAddress_;
 		volatile bool TelemetryReporting_ = false;
 		std::atomic_uint64_t TelemetryWebSocketRefCount_ = 0;
@@ -146,7 +158,7 @@ namespace OpenWifi {
 		bool	Simulated_=false;
 		std::atomic_uint64_t 	LastContact_=0;
 
-		static inline std::atomic_uint64_t ConcurrentStartingDevices_ = 0;
+		std::atomic_uint64_t AdmissionTicket_ = 0;
 
 		bool StartTelemetry(uint64_t RPCID, const std::vector<std::string> &TelemetryTypes);
 		bool StopTelemetry(uint64_t RPCID);
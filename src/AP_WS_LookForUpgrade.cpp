@@ -22,11 +22,13 @@ namespace OpenWifi {
 		if (!StorageService()->GetDevice(Session,SerialNumber_, D)) {
 			return false;
 		}
+		const auto StoredDevice = D;
 
 		if(State_.PendingUUID!=0 && UUID==State_.PendingUUID) {
 			//	so we sent an upgrade to a device, and now it is completing now...
 			UpgradedUUID = UUID;
-			StorageService()->CompleteDeviceConfigurationChange(Session, SerialNumber_);
+			if (StorageService()->CompleteDeviceConfigurationChange(Session, SerialNumber_))
+				++DbRowsWritten_;
 			State_.PendingUUID = 0;
 			return true;
 		}
@@ -49,7 +51,7 @@ namespace OpenWifi {
 			State_.PendingUUID = D.pendingUUID = 0;
 			D.pendingConfiguration.clear();
 			D.pendingConfigurationCmd.clear();
-			StorageService()->UpdateDevice(Session, D);
+			StorageService()->UpdateDevice(Session, StoredDevice, D, DbRowsWritten_);
 			SetCurrentConfigurationID(SerialNumberInt_, UUID);
 //			std::cout << __LINE__ << ": " << SerialNumber_ << "  GoodConfig: " << GoodConfig << "   UUID:" << UUID << "  Pending:" << State_.PendingUUID << std::endl;
 			return false;
@@ -66,7 +68,7 @@ namespace OpenWifi {
 		Cfg.SetUUID(D.UUID);
 		D.Configuration = Cfg.get();
 		D.pendingUUID = State_.PendingUUID = UpgradedUUID = D.UUID;
-		StorageService()->UpdateDevice(Session, D);
+		StorageService()->UpdateDevice(Session, StoredDevice, D, DbRowsWritten_);
 
 		GWObjects::CommandDetails Cmd;
 		Cmd.SerialNumber = SerialNumber_;
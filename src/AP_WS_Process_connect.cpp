@@ -80,7 +80,7 @@ namespace OpenWifi {
 			State_.UUID = UUID;
 			State_.Firmware = Firmware;
 			State_.PendingUUID = 0;
-			State_.Address = Utils::FormatIPv6(WS_->peerAddress().toString());
+			State_.Address = WS_ ? Utils::FormatIPv6(WS_->peerAddress().toString()) : CId_;
 			CId_ = SerialNumber_ + "@" + CId_;
 
 			auto &Platform = Caps.Platform();
@@ -111,9 +111,14 @@ namespace OpenWifi {
 
 			State_.locale = FindCountryFromIP()->Get(IP);
 			GWObjects::Device DeviceInfo;
+			AP_WS_RPCPhase Db(AP_WS_RPCTimings::DB);
 			std::lock_guard DbSessionLock(DbSession_->Mutex());
 
-			auto DeviceExists = StorageService()->GetDevice(DbSession_->Session(), SerialNumber_, DeviceInfo);
+			auto DbStart = std::chrono::steady_clock::now();
+			auto RowsWrittenBefore = DbRowsWritten_;
+			auto DeviceExists = StorageService()->GetDevice(DbSession_->Session(), SerialNumber_, DeviceInfo,
+															&DbSession_->Prepared());
+			const auto StoredDeviceInfo = DeviceInfo;
 			if (Daemon()->AutoProvisioning() && !DeviceExists) {
 				//	check the firmware version. if this is too old, we cannot let that device connect yet, we must
 				//	force a firmware upgrade
@@ -146,16 +151,18 @@ namespace OpenWifi {
 					}
 					return;
 				} else {
-					StorageService()->CreateDefaultDevice( DbSession_->Session(),
-						SerialNumber_, Caps, Firmware, PeerAddress_,
-						State_.VerifiedCertificate == GWObjects::SIMULATED);
+					if (StorageService()->CreateDefaultDevice(
+							DbSession_->Session(), SerialNumber_, Caps, Firmware, PeerAddress_,
+							State_.VerifiedCertificate == GWObjects::SIMULATED))
+						++DbRowsWritten_;
 				}
 			} else if (!Daemon()->AutoProvisioning() && !DeviceExists) {
 				SendKafkaDeviceNotProvisioned(SerialNumber_, Firmware, Compatible_, CId_);
 				poco_warning(Logger(),fmt::format("Device {} is a {} from {} and cannot be provisioned.",SerialNumber_,Compatible_, CId_));
 				return EndConnection();
 			} else if (DeviceExists) {
-				StorageService()->UpdateDeviceCapabilities(DbSession_->Session(), SerialNumber_, Caps);
+				if (StorageService()->UpdateDeviceCapabilities(DbSession_->Session(), SerialNumber_, Caps))
+					++DbRowsWritten_;
 				int Updated{0};
 				if (!Firmware.empty()) {
 					if (Firmware != DeviceInfo.Firmware) {
@@ -232,7 +239,8 @@ namespace OpenWifi {
 				}
 
 				if (Updated) {
-					StorageService()->UpdateDevice(DbSession_->Session(), DeviceInfo);
+					StorageService()->UpdateDevice(DbSession_->Session(), StoredDeviceInfo,
+												   DeviceInfo, DbRowsWritten_);
 				}
 			}
 
@@ -242,8 +250,17 @@ namespace OpenWifi {
 					State_.UUID = UpgradedUUID;
 				}
 			}
+			StorageService()->RecordConnectPath(
+				std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - DbStart)
+					.count(),
+				DbRowsWritten_ - RowsWrittenBefore);
+			Db.Stop();
 
 			State_.Compatible = Compatible_;
+			if (!State_.Connected) {
+				AP_WS_Server()->SessionConnected(State_.started);
+			}
 			State_.Connected = true;
 			ConnectionCompletionTime_ =
 				std::chrono::high_resolution_clock::now() - ConnectionStart_;
@@ -284,11 +301,15 @@ namespace OpenWifi {
 											 State_.connectionCompletionTime));
 			}
 
-			GWWebSocketNotifications::SingleDevice_t Notification;
-			Notification.content.serialNumber = SerialNumber_;
-			GWWebSocketNotifications::DeviceConnected(Notification);
+			{
+				AP_WS_RPCPhase Notify(AP_WS_RPCTimings::NOTIFY);
+				GWWebSocketNotifications::SingleDevice_t Notification;
+				Notification.content.serialNumber = SerialNumber_;
+				GWWebSocketNotifications::DeviceConnected(Notification);
+			}
 
 			if (KafkaManager()->Enabled()) {
+				AP_WS_RPCPhase Kafka(AP_WS_RPCTimings::KAFKA);
 				ParamsObj->set(uCentralProtocol::CONNECTIONIP, CId_);
 				ParamsObj->set("locale", State_.locale);
 				ParamsObj->set(uCentralProtocol::TIMESTAMP, Utils::Now());
@@ -21,7 +21,10 @@ namespace OpenWifi {
 		if (ParamsObj->has("currentPassword")) {
 			auto Password = ParamsObj->get("currentPassword").toString();
 
-			StorageService()->SetDevicePassword(*DbSession_,Serial, Password);
+			{
+				AP_WS_RPCPhase Db(AP_WS_RPCTimings::DB);
+				StorageService()->SetDevicePassword(*DbSession_,Serial, Password);
+			}
 			poco_trace(
 				Logger_,
 				fmt::format("DEVICE-UPDATE({}): Device is updating its login password.", Serial));
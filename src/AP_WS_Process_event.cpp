@@ -34,6 +34,7 @@ namespace OpenWifi {
 					FullEvent.set("type", EventType);
 					FullEvent.set("timestamp", EventTimeStamp);
 					FullEvent.set("payload", EventPayload);
+					AP_WS_RPCPhase Kafka(AP_WS_RPCTimings::KAFKA);
 					if(strncmp(EventType.c_str(),"rrm.",4) == 0 ) {
 						KafkaManager()->PostMessage(KafkaTopics::RRM, SerialNumber_,
 													FullEvent);
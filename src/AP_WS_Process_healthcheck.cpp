@@ -50,14 +50,17 @@ namespace OpenWifi {
 			Check.Data = CheckData;
 			Check.Sanity = Sanity;
 
-			StorageService()->AddHealthCheckData(*DbSession_, Check);
-
-			if (!request_uuid.empty()) {
-				StorageService()->SetCommandResult(request_uuid, CheckData);
+			{
+				AP_WS_RPCPhase Db(AP_WS_RPCTimings::DB);
+				StorageService()->AddHealthCheckData(*DbSession_, Check, Compatible_);
+				if (!request_uuid.empty()) {
+					StorageService()->SetCommandResult(request_uuid, CheckData);
+				}
 			}
 
 			SetLastHealthCheck(Check);
 			if (KafkaManager()->Enabled() && !AP_WS_Server()->KafkaDisableHealthChecks()) {
+				AP_WS_RPCPhase Kafka(AP_WS_RPCTimings::KAFKA);
 				KafkaManager()->PostMessage(KafkaTopics::HEALTHCHECK, SerialNumber_, *ParamsObj);
 			}
 		} else {
@@ -36,7 +36,11 @@ namespace OpenWifi {
 										   .Recorded = (uint64_t)time(nullptr),
 										   .LogType = 0,
 										   .UUID = State_.UUID};
-			StorageService()->AddLog(*DbSession_, DeviceLog);
+			{
+				AP_WS_RPCPhase Db(AP_WS_RPCTimings::DB);
+				StorageService()->AddLog(*DbSession_, DeviceLog);
+			}
+			AP_WS_RPCPhase Kafka(AP_WS_RPCTimings::KAFKA);
 			DeviceLogKafkaEvent	E(DeviceLog);
 		} else {
 			poco_warning(Logger_, fmt::format("LOG({}): Missing parameters.", CId_));
@@ -35,7 +35,11 @@ namespace OpenWifi {
 										   .Recorded = ParamsObj->get(uCentralProtocol::DATE),
 										   .LogType = 2,
 										   .UUID = ParamsObj->get(uCentralProtocol::UUID)};
-			StorageService()->AddLog(*DbSession_, DeviceLog);
+			{
+				AP_WS_RPCPhase Db(AP_WS_RPCTimings::DB);
+				StorageService()->AddLog(*DbSession_, DeviceLog);
+			}
+			AP_WS_RPCPhase Kafka(AP_WS_RPCTimings::KAFKA);
 			DeviceLogKafkaEvent	E(DeviceLog);
 		} else {
 			poco_warning(Logger_, fmt::format("REBOOT-LOG({}): Missing parameters.", CId_));
@@ -35,7 +35,10 @@ namespace OpenWifi {
 										   .LogType = 1,
 										   .UUID = 0};
 
-			StorageService()->AddLog(*DbSession_, DeviceLog);
+			{
+				AP_WS_RPCPhase Db(AP_WS_RPCTimings::DB);
+				StorageService()->AddLog(*DbSession_, DeviceLog);
+			}
 
 			if (ParamsObj->get(uCentralProtocol::REBOOT).toString() == "true") {
 				GWObjects::CommandDetails Cmd;
@@ -54,6 +57,7 @@ namespace OpenWifi {
 				CommandManager()->PostCommand(CommandManager()->Next_RPC_ID(),
 											  APCommands::Commands::reboot, SerialNumber_,
 											  Cmd.Command, Params, Cmd.UUID, Sent, false, false);
+				AP_WS_RPCPhase Db(AP_WS_RPCTimings::DB);
 				StorageService()->AddCommand(SerialNumber_, Cmd,
 											 Storage::CommandExecutionType::COMMAND_EXECUTED);
 				poco_information(
@@ -40,6 +40,7 @@ namespace OpenWifi {
 												UUID, request_uuid));
 			}
 
+			AP_WS_RPCPhase Db(AP_WS_RPCTimings::DB);
 			std::lock_guard	Guard(DbSession_->Mutex());
 			if(!Simulated_) {
 				uint64_t UpgradedUUID;
@@ -52,18 +53,22 @@ namespace OpenWifi {
 			GWObjects::Statistics Stats{
 				.SerialNumber = SerialNumber_, .UUID = UUID, .Data = StateStr};
 			Stats.Recorded = Utils::Now();
-			StorageService()->AddStatisticsData(DbSession_->Session(),Stats);
+			StorageService()->AddStatisticsData(DbSession_->Session(), Stats, Compatible_,
+												&DbSession_->Prepared());
 			if (!request_uuid.empty()) {
 				StorageService()->SetCommandResult(request_uuid, StateStr);
 			}
+			Db.Stop();
 
 			StateUtils::ComputeAssociations(StateObj, State_.Associations_2G,
 											State_.Associations_5G, State_.Associations_6G, State_.uptime);
 
 			if (KafkaManager()->Enabled() && !AP_WS_Server()->KafkaDisableState()) {
+				AP_WS_RPCPhase Kafka(AP_WS_RPCTimings::KAFKA);
 				KafkaManager()->PostMessage(KafkaTopics::STATE, SerialNumber_, *ParamsObj);
 			}
 
+			AP_WS_RPCPhase Notify(AP_WS_RPCTimings::NOTIFY);
 			GWWebSocketNotifications::SingleDevice_t N;
 			N.content.serialNumber = SerialNumber_;
 			GWWebSocketNotifications::DeviceStatistics(N);
@@ -29,6 +29,7 @@ namespace OpenWifi {
 				auto now = Utils::Now();
 				auto KafkaPayload = SS.str();
 				if (ParamsObj->has("adhoc")) {
+					AP_WS_RPCPhase Kafka(AP_WS_RPCTimings::KAFKA);
 					KafkaManager()->PostMessage(KafkaTopics::DEVICE_TELEMETRY, SerialNumber_,
 												KafkaPayload);
 					return;
@@ -38,6 +39,7 @@ namespace OpenWifi {
 
 						TelemetryWebSocketPackets_++;
 						State_.websocketPackets = TelemetryWebSocketPackets_;
+						AP_WS_RPCPhase Notify(AP_WS_RPCTimings::NOTIFY);
 						TelemetryStream()->NotifyEndPoint(SerialNumberInt_, KafkaPayload);
 					} else {
 						StopWebSocketTelemetry(CommandManager()->Next_RPC_ID());
@@ -47,6 +49,7 @@ namespace OpenWifi {
 					if (KafkaManager()->Enabled() && now < TelemetryKafkaTimer_) {
 						TelemetryKafkaPackets_++;
 						State_.kafkaPackets = TelemetryKafkaPackets_;
+						AP_WS_RPCPhase Kafka(AP_WS_RPCTimings::KAFKA);
 						KafkaManager()->PostMessage(KafkaTopics::DEVICE_TELEMETRY, SerialNumber_,
 													KafkaPayload);
 					} else {
@@ -0,0 +1,60 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include "AP_WS_RPCTimings.h"
+#include "framework/MetricsRegistry.h"
+
+namespace OpenWifi {
+
+	static const std::array<const char *, AP_WS_RPCTimings::Events> EventNames{
+		"unknown",
+		uCentralProtocol::Events::CONNECT,
+		uCentralProtocol::Events::STATE,
+		uCentralProtocol::Events::HEALTHCHECK,
+		uCentralProtocol::Events::LOG,
+		uCentralProtocol::Events::CRASHLOG,
+		uCentralProtocol::Events::PING,
+		uCentralProtocol::Events::CFGPENDING,
+		uCentralProtocol::Events::RECOVERY,
+		uCentralProtocol::Events::DEVICEUPDATE,
+		uCentralProtocol::Events::TELEMETRY,
+		uCentralProtocol::Events::VENUE_BROADCAST,
+		uCentralProtocol::EVENT,
+		uCentralProtocol::WIFISCAN,
+		uCentralProtocol::Events::ALARM,
+		uCentralProtocol::Events::REBOOTLOG};
+
+	static const std::array<const char *, AP_WS_RPCTimings::PHASES> PhaseNames{
+		"total", "parse", "db", "kafka", "notify"};
+
+	AP_WS_RPCTimings::AP_WS_RPCTimings() {
+		//	every reactor feeds the same series, Prometheus sees the gateway as a whole.
+		for (std::size_t E = 1; E < Events; ++E) {
+			for (std::size_t P = 0; P < PHASES; ++P) {
+				Histograms_[E][P].Export(MetricsRegistry()->Histogram(
+					"owgw_rpc_event_seconds", "Time to process a device event, by phase.",
+					{{"method", EventNames[E]}, {"phase", PhaseNames[P]}}));
+			}
+		}
+	}
+
+	void AP_WS_RPCTimings::ToJSON(Poco::JSON::Object &Obj) const {
+		for (std::size_t E = 1; E < Events; ++E) {
+			if (Histograms_[E][TOTAL].Count() == 0)
+				continue;
+			Poco::JSON::Object Method;
+			for (std::size_t P = 0; P < PHASES; ++P) {
+				if (Histograms_[E][P].Count() == 0)
+					continue;
+				Poco::JSON::Object Phase;
+				Histograms_[E][P].ToJSON(Phase);
+				Method.set(PhaseNames[P], Phase);
+			}
+			Method.set("failed", Failed_[E].load());
+			Obj.set(EventNames[E], Method);
+		}
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,139 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+
+#include "Poco/JSON/Object.h"
+
+#include "framework/MetricsRegistry.h"
+#include "framework/ow_constants.h"
+
+namespace OpenWifi {
+
+	//	Time spent in each device event, per event type and phase, for one reactor thread.
+	class AP_WS_RPCTimings {
+	  public:
+		enum Phase { TOTAL, PARSE, DB, KAFKA, NOTIFY, PHASES };
+		static constexpr std::size_t Events = uCentralProtocol::Events::ET_REBOOTLOG + 1;
+
+		AP_WS_RPCTimings();
+
+		inline void Record(uCentralProtocol::Events::EVENT_MSG Event, Phase P, std::uint64_t Us,
+						   bool Failed) {
+			Histograms_[Event][P].Record(Us);
+			if (Failed && P == TOTAL)
+				Failed_[Event]++;
+		}
+
+		void ToJSON(Poco::JSON::Object &Obj) const;
+
+	  private:
+		std::array<std::array<MetricHistogram, PHASES>, Events> Histograms_;
+		std::array<std::atomic_uint64_t, Events> Failed_{};
+	};
+
+	//	One event being processed on this thread. Phase timers add to it, so the handlers do not
+	//	need to know whether timing is on. With no timings, nothing is read from the clock.
+	class AP_WS_RPCCall {
+	  public:
+		explicit AP_WS_RPCCall(AP_WS_RPCTimings *Timings) : Timings_(Timings) {
+			if (Timings_ == nullptr)
+				return;
+			Start_ = Clock::now();
+			Exceptions_ = std::uncaught_exceptions();
+			Outer_ = Current_;
+			Current_ = this;
+		}
+
+		~AP_WS_RPCCall() {
+			if (Timings_ == nullptr)
+				return;
+			Current_ = Outer_;
+			//	frames that were not events (results, RADIUS, junk) are not recorded.
+			if (Event_ == uCentralProtocol::Events::ET_UNKNOWN)
+				return;
+			auto Failed = std::uncaught_exceptions() > Exceptions_;
+			Timings_->Record(Event_, AP_WS_RPCTimings::TOTAL, Micros(Clock::now() - Start_),
+							 Failed);
+			for (int P = AP_WS_RPCTimings::PARSE; P < AP_WS_RPCTimings::PHASES; ++P) {
+				if (Entered_[P])
+					Timings_->Record(Event_, (AP_WS_RPCTimings::Phase)P, Micros(Spent_[P]),
+									 Failed);
+			}
+		}
+
+		//	The event type is only known once the frame has been parsed.
+		static inline void SetEvent(uCentralProtocol::Events::EVENT_MSG Event) {
+			if (Current_ != nullptr)
+				Current_->Event_ = Event;
+		}
+
+		AP_WS_RPCCall(const AP_WS_RPCCall &) = delete;
+		AP_WS_RPCCall &operator=(const AP_WS_RPCCall &) = delete;
+
+	  private:
+		friend class AP_WS_RPCPhase;
+		using Clock = std::chrono::steady_clock;
+
+		static inline thread_local AP_WS_RPCCall *Current_ = nullptr;
+
+		AP_WS_RPCTimings *Timings_;
+		AP_WS_RPCCall *Outer_ = nullptr;
+		uCentralProtocol::Events::EVENT_MSG Event_ = uCentralProtocol::Events::ET_UNKNOWN;
+		Clock::time_point Start_{};
+		int Exceptions_ = 0;
+		bool InPhase_ = false;
+		std::array<Clock::duration, AP_WS_RPCTimings::PHASES> Spent_{};
+		std::array<bool, AP_WS_RPCTimings::PHASES> Entered_{};
+
+		static inline std::uint64_t Micros(Clock::duration D) {
+			return std::chrono::duration_cast<std::chrono::microseconds>(D).count();
+		}
+	};
+
+	//	Adds the time until it goes out of scope to a phase of the event running on this thread.
+	//	A phase inside another one (a notification posted while the DB lock is held) counts for
+	//	the outer one only.
+	class AP_WS_RPCPhase {
+	  public:
+		explicit AP_WS_RPCPhase(AP_WS_RPCTimings::Phase P) : Call_(AP_WS_RPCCall::Current_), P_(P) {
+			if (Call_ == nullptr)
+				return;
+			if (Call_->InPhase_) {
+				Call_ = nullptr;
+				return;
+			}
+			Call_->InPhase_ = true;
+			Start_ = AP_WS_RPCCall::Clock::now();
+		}
+
+		~AP_WS_RPCPhase() { Stop(); }
+
+		//	Ends the phase before the end of the scope, when a lock taken for it is kept longer.
+		inline void Stop() {
+			if (Call_ == nullptr)
+				return;
+			Call_->Spent_[P_] += AP_WS_RPCCall::Clock::now() - Start_;
+			Call_->Entered_[P_] = true;
+			Call_->InPhase_ = false;
+			Call_ = nullptr;
+		}
+
+		AP_WS_RPCPhase(const AP_WS_RPCPhase &) = delete;
+		AP_WS_RPCPhase &operator=(const AP_WS_RPCPhase &) = delete;
+
+	  private:
+		AP_WS_RPCCall *Call_;
+		AP_WS_RPCTimings::Phase P_;
+		AP_WS_RPCCall::Clock::time_point Start_{};
+	};
+
+} // namespace OpenWifi
@@ -12,11 +12,21 @@
 #include <Poco/Environment.h>
 #include <Poco/Net/SocketAcceptor.h>
 #include <Poco/Data/SessionPool.h>
+#include <Poco/JSON/Array.h>
 
 #include <StorageService.h>
+#include <AP_WS_RPCTimings.h>
 
 namespace OpenWifi {
 
+	//	What a connection gets from the reactor it is assigned to. Timings is null when event
+	//	timing is off.
+	struct AP_WS_ReactorSlot {
+		std::shared_ptr<Poco::Net::SocketReactor> Reactor;
+		std::shared_ptr<LockedDbSession> DbSession;
+		std::shared_ptr<AP_WS_RPCTimings> Timings;
+	};
+
 	class AP_WS_ReactorThreadPool {
 	  public:
 		explicit AP_WS_ReactorThreadPool(Poco::Logger &Logger) : Logger_(Logger) {
@@ -28,9 +38,10 @@ namespace OpenWifi {
 
 		~AP_WS_ReactorThreadPool() { Stop(); }
 
-		void Start() {
+		void Start(bool Timings) {
 			Reactors_.reserve(NumberOfThreads_);
 			DbSessions_.reserve(NumberOfThreads_);
+			Timings_.reserve(NumberOfThreads_);
 			Threads_.reserve(NumberOfThreads_);
 			Logger_.information(fmt::format("WebSocket Processor: starting {} threads.", NumberOfThreads_));
 			for (uint64_t i = 0; i < NumberOfThreads_; ++i) {
@@ -42,6 +53,7 @@ namespace OpenWifi {
 				Reactors_.emplace_back(std::move(NewReactor));
 				Threads_.emplace_back(std::move(NewThread));
 				DbSessions_.emplace_back(std::make_shared<LockedDbSession>());
+				Timings_.emplace_back(Timings ? std::make_shared<AP_WS_RPCTimings>() : nullptr);
 			}
 			Logger_.information(fmt::format("WebSocket Processor: {} threads started.", NumberOfThreads_));
 		}
@@ -55,13 +67,32 @@ namespace OpenWifi {
 			Reactors_.clear();
 			Threads_.clear();
 			DbSessions_.clear();
+			Timings_.clear();
 		}
 
-		auto NextReactor() {
+		AP_WS_ReactorSlot NextReactor() {
 			std::lock_guard Lock(Mutex_);
 			NextReactor_++;
 			NextReactor_ %= NumberOfThreads_;
-			return std::make_pair(Reactors_[NextReactor_], DbSessions_[NextReactor_]);
+			return AP_WS_ReactorSlot{Reactors_[NextReactor_], DbSessions_[NextReactor_],
+									 Timings_[NextReactor_]};
+		}
+
+		//	One entry per reactor that has processed events.
+		void GetTimings(Poco::JSON::Array &Arr) {
+			std::lock_guard Lock(Mutex_);
+			for (std::size_t i = 0; i < Timings_.size(); ++i) {
+				if (!Timings_[i])
+					continue;
+				Poco::JSON::Object Events;
+				Timings_[i]->ToJSON(Events);
+				if (Events.size() == 0)
+					continue;
+				Poco::JSON::Object Reactor;
+				Reactor.set("reactor", "ap:react:" + std::to_string(i));
+				Reactor.set("events", Events);
+				Arr.add(Reactor);
+			}
 		}
 
 	  private:
@@ -71,6 +102,7 @@ namespace OpenWifi {
 		std::vector<std::shared_ptr<Poco::Net::SocketReactor>> 	Reactors_;
 		std::vector<std::unique_ptr<Poco::Thread>> 				Threads_;
 		std::vector<std::shared_ptr<LockedDbSession>>			DbSessions_;
+		std::vector<std::shared_ptr<AP_WS_RPCTimings>>			Timings_;
 		Poco::Logger &Logger_;
 
 	};
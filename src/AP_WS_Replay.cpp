@@ -0,0 +1,226 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include "Poco/JSON/Array.h"
+#include "Poco/String.h"
+#include "Poco/Util/ServerApplication.h"
+
+#include "fmt/format.h"
+
+#include "AP_WS_Capture.h"
+#include "AP_WS_Connection.h"
+#include "AP_WS_Replay.h"
+#include "AP_WS_Server.h"
+#include "framework/MicroServiceFuncs.h"
+#include "framework/ow_constants.h"
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	//	above anything the listeners hand out.
+	static constexpr std::uint64_t ReplaySessionBase = 1ULL << 48;
+
+	static std::uint64_t ThreadCpuNs() {
+		timespec T{};
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &T);
+		return (std::uint64_t)T.tv_sec * 1000000000ULL + T.tv_nsec;
+	}
+
+	static std::uint64_t ProcessCpuNs() {
+		rusage U{};
+		getrusage(RUSAGE_SELF, &U);
+		return ((std::uint64_t)U.ru_utime.tv_sec + U.ru_stime.tv_sec) * 1000000000ULL +
+			   ((std::uint64_t)U.ru_utime.tv_usec + U.ru_stime.tv_usec) * 1000ULL;
+	}
+
+	static std::uint64_t Allocations() {
+		return owgw_replay_allocations ? owgw_replay_allocations() : 0;
+	}
+
+	static std::uint64_t ThreadAllocations() {
+		return owgw_replay_thread_allocations ? owgw_replay_thread_allocations() : 0;
+	}
+
+	//	Good enough to group frames, the connection does the real parsing.
+	static std::string MethodOf(const std::string &Frame) {
+		static const std::string Key = fmt::format("\"{}\":\"", uCentralProtocol::METHOD);
+		auto Start = Frame.find(Key);
+		if (Start != std::string::npos) {
+			Start += Key.size();
+			auto End = Frame.find('"', Start);
+			if (End != std::string::npos)
+				return Frame.substr(Start, End - Start);
+		}
+		if (Frame.find(fmt::format("\"{}\"", uCentralProtocol::RESULT)) != std::string::npos)
+			return "result";
+		if (Frame.find(fmt::format("\"{}\"", uCentralProtocol::RADIUS)) != std::string::npos)
+			return "radius";
+		return "other";
+	}
+
+	int AP_WS_Replay::Start() {
+		FileName_ = MicroServiceConfigPath("openwifi.replay.file", "");
+		if (FileName_.empty())
+			return 0;
+		//	replayed frames write to the database and would be published like live ones.
+		auto StorageType = Poco::toLower(MicroServiceConfigGetString("storage.type", ""));
+		if (StorageType != "sqlite" || MicroServiceConfigGetBool("openwifi.kafka.enable", false)) {
+			poco_error(Logger(),
+					   fmt::format("Replay of {} refused: it needs storage.type = sqlite and "
+								   "openwifi.kafka.enable = false, not '{}' with Kafka {}.",
+								   FileName_, StorageType,
+								   MicroServiceConfigGetBool("openwifi.kafka.enable", false)
+									   ? "enabled"
+									   : "disabled"));
+			return 0;
+		}
+		ReportFile_ = MicroServiceConfigPath("openwifi.replay.report", "");
+		Exit_ = MicroServiceConfigGetBool("openwifi.replay.exit", true);
+		poco_notice(Logger(), fmt::format("Starting replay of {}...", FileName_));
+		Running_ = true;
+		Worker_.start(*this);
+		return 0;
+	}
+
+	void AP_WS_Replay::Stop() {
+		if (!Worker_.isRunning())
+			return;
+		poco_notice(Logger(), "Stopping...");
+		Running_ = false;
+		Worker_.join();
+		poco_notice(Logger(), "Stopped...");
+	}
+
+	void AP_WS_Replay::run() {
+		Utils::SetThreadName("ws:replay");
+		try {
+			Replay();
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		} catch (const std::exception &E) {
+			poco_error(Logger(), fmt::format("Replay failed: {}", E.what()));
+		}
+		if (Exit_ && Running_)
+			Poco::Util::ServerApplication::terminate();
+	}
+
+	void AP_WS_Replay::Replay() {
+		AP_WS_CaptureReader Reader(FileName_);
+		std::map<std::uint32_t, std::shared_ptr<AP_WS_Connection>> Devices;
+		std::map<std::string, MethodStats> Methods;
+
+		auto Start = std::chrono::steady_clock::now();
+		auto StartCpu = ProcessCpuNs();
+		auto StartAllocations = Allocations();
+
+		AP_WS_Capture::Frame F;
+		while (Running_ && Reader.Next(F)) {
+			auto &Connection = Devices[F.Device];
+			if (!Connection) {
+				Connection = std::make_shared<AP_WS_Connection>(
+					ReplaySessionBase + F.Device, AP_WS_Capture::Pseudonym(F.Device), Logger(),
+					AP_WS_Server()->NextReactor());
+				AP_WS_Server()->AddConnection(Connection);
+			}
+
+			auto &Method = Methods[MethodOf(F.Text)];
+			auto Cpu = ThreadCpuNs();
+			auto Allocated = ThreadAllocations();
+			if (!Connection->ReplayFrame(F.Text))
+				Method.Failed++;
+			Method.CpuNs += ThreadCpuNs() - Cpu;
+			Method.Allocations += ThreadAllocations() - Allocated;
+			Method.Frames++;
+			Method.Bytes += F.Text.size();
+		}
+
+		auto Seconds =
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		Report(Methods, Devices.size(), Seconds, ProcessCpuNs() - StartCpu,
+			   Allocations() - StartAllocations);
+
+		for (auto &[Device, Connection] : Devices)
+			Connection->EndConnection();
+	}
+
+	void AP_WS_Replay::Report(const std::map<std::string, MethodStats> &Methods,
+							  std::uint64_t Devices, double Seconds, std::uint64_t CpuNs,
+							  std::uint64_t ProcessAllocations) {
+		bool Counted = owgw_replay_allocations != nullptr;
+		MethodStats Total;
+		for (const auto &[Name, M] : Methods) {
+			Total.Frames += M.Frames;
+			Total.Failed += M.Failed;
+			Total.Bytes += M.Bytes;
+			Total.CpuNs += M.CpuNs;
+			Total.Allocations += M.Allocations;
+		}
+		Seconds = std::max(Seconds, 0.000001);
+		auto PerFrame = [](std::uint64_t V, std::uint64_t Frames) {
+			return Frames ? (double)V / (double)Frames : 0.0;
+		};
+
+		std::ostringstream OS;
+		OS << fmt::format("Replayed {} frames from {} devices in {:.2f}s: {:.0f} frames/s, {} "
+						  "failed.\n",
+						  Total.Frames, Devices, Seconds, Total.Frames / Seconds, Total.Failed);
+		OS << fmt::format("Process CPU {:.2f}s, allocations {}.\n", CpuNs / 1e9,
+						  Counted ? std::to_string(ProcessAllocations) : "not counted (build owgw_replay)");
+		OS << fmt::format("{:<16}{:>10}{:>8}{:>12}{:>14}{:>14}\n", "method", "frames", "failed",
+						  "bytes/frame", "cpu us/frame", "allocs/frame");
+		auto Row = [&](const std::string &Name, const MethodStats &M) {
+			OS << fmt::format("{:<16}{:>10}{:>8}{:>12.0f}{:>14.1f}{:>14.1f}\n", Name, M.Frames,
+							  M.Failed, PerFrame(M.Bytes, M.Frames),
+							  PerFrame(M.CpuNs, M.Frames) / 1000.0,
+							  PerFrame(M.Allocations, M.Frames));
+		};
+		for (const auto &[Name, M] : Methods)
+			Row(Name, M);
+		Row("total", Total);
+		std::cout << OS.str() << std::flush;
+		poco_notice(Logger(), OS.str());
+
+		if (ReportFile_.empty())
+			return;
+		Poco::JSON::Object Doc;
+		Doc.set("file", FileName_);
+		Doc.set("frames", Total.Frames);
+		Doc.set("failed", Total.Failed);
+		Doc.set("devices", Devices);
+		Doc.set("seconds", Seconds);
+		Doc.set("framesPerSecond", Total.Frames / Seconds);
+		Doc.set("processCpuSeconds", CpuNs / 1e9);
+		if (Counted)
+			Doc.set("allocations", ProcessAllocations);
+		Poco::JSON::Array Rows;
+		for (const auto &[Name, M] : Methods) {
+			Poco::JSON::Object Entry;
+			Entry.set("method", Name);
+			Entry.set("frames", M.Frames);
+			Entry.set("failed", M.Failed);
+			Entry.set("bytes", M.Bytes);
+			Entry.set("cpuNs", M.CpuNs);
+			if (Counted)
+				Entry.set("allocations", M.Allocations);
+			Rows.add(Entry);
+		}
+		Doc.set("methods", Rows);
+		std::ofstream Out(ReportFile_, std::ios::trunc);
+		Doc.stringify(Out, 2);
+		if (!Out)
+			poco_error(Logger(), fmt::format("Replay report cannot be written to {}.", ReportFile_));
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,60 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "Poco/Thread.h"
+
+#include "framework/SubSystemServer.h"
+
+//	Only the owgw_replay build counts allocations, see src/replay/ReplayAllocations.cpp.
+extern "C" {
+	[[gnu::weak]] std::uint64_t owgw_replay_allocations();
+	[[gnu::weak]] std::uint64_t owgw_replay_thread_allocations();
+}
+
+namespace OpenWifi {
+
+	//	Feeds a capture (see AP_WS_Capture) through AP_WS_Connection as fast as it can, one
+	//	socketless connection per captured device, then reports frames/s, and CPU time and
+	//	allocations per method. Runs once every other subsystem has started, so the frames go
+	//	through the configured storage like live ones. Nothing happens unless
+	//	openwifi.replay.file is set.
+	class AP_WS_Replay : public SubSystemServer, Poco::Runnable {
+	  public:
+		static auto instance() {
+			static auto instance_ = new AP_WS_Replay;
+			return instance_;
+		}
+
+		int Start() final;
+		void Stop() final;
+		void run() final;
+
+	  private:
+		struct MethodStats {
+			std::uint64_t Frames = 0, Failed = 0, Bytes = 0, CpuNs = 0, Allocations = 0;
+		};
+
+		Poco::Thread Worker_;
+		std::atomic_bool Running_ = false;
+		std::string FileName_, ReportFile_;
+		bool Exit_ = true;
+
+		void Replay();
+		void Report(const std::map<std::string, MethodStats> &Methods, std::uint64_t Devices,
+					double Seconds, std::uint64_t CpuNs, std::uint64_t Allocations);
+
+		AP_WS_Replay() noexcept : SubSystemServer("Replay", "WS-REPLAY", "openwifi.replay") {}
+	};
+
+	inline auto AP_WS_Replay() { return AP_WS_Replay::instance(); }
+
+} // namespace OpenWifi
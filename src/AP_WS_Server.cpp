@@ -9,14 +9,17 @@
 #include <Poco/Net/Context.h>
 #include <Poco/Net/HTTPHeaderStream.h>
 #include <Poco/Net/HTTPServerRequest.h>
+#include <Poco/Net/TCPServerConnectionFilter.h>
 
 #include <AP_WS_Connection.h>
 #include <AP_WS_Server.h>
 #include <ConfigurationCache.h>
 #include <TelemetryStream.h>
+#include <WarmStart.h>
 
 #include <fmt/format.h>
 
+#include <framework/MetricsRegistry.h>
 #include <framework/MicroServiceFuncs.h>
 #include <framework/utils.h>
 #include <framework/KafkaManager.h>
@@ -33,12 +36,16 @@ namespace OpenWifi {
 
 		void handleRequest(	Poco::Net::HTTPServerRequest &request,
 						 	Poco::Net::HTTPServerResponse &response) override {
+			//	the slot was taken when the connection was accepted.
+			auto Ticket = AP_WS_Server()->Admission().Claim(request.clientAddress().toString());
 			try {
 				auto NewConnection = std::make_shared<AP_WS_Connection>(request, response, session_id_, Logger_,
 																		AP_WS_Server()->NextReactor());
+				NewConnection->SetAdmissionTicket(Ticket);
 				AP_WS_Server()->AddConnection(NewConnection);
 				NewConnection->Start();
 			} catch (...) {
+				AP_WS_Server()->Admission().Release(Ticket, false);
 				poco_warning(Logger_, "Exception during WS creation");
 			}
 		};
@@ -48,6 +55,25 @@ namespace OpenWifi {
 		std::uint64_t session_id_;
 	};
 
+	//	Runs on the accept thread, before the TLS handshake: over the admission limit the
+	//	connection is closed without spending a handshake on it.
+	class AP_WS_AdmissionFilter : public Poco::Net::TCPServerConnectionFilter {
+	  public:
+		explicit AP_WS_AdmissionFilter(AP_WS_Admission &Admission) : Admission_(Admission) {}
+
+		bool accept(const Poco::Net::StreamSocket &Socket) override {
+			try {
+				return Admission_.Admit(Socket.peerAddress().toString());
+			} catch (const Poco::Exception &) {
+				//	the peer is already gone.
+			}
+			return false;
+		}
+
+	  private:
+		AP_WS_Admission &Admission_;
+	};
+
 	class AP_WS_RequestHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory {
 	  public:
 		inline explicit AP_WS_RequestHandlerFactory(Poco::Logger &L) : Logger_(L) {}
@@ -92,7 +118,20 @@ namespace OpenWifi {
 		SessionTimeOut_ = MicroServiceConfigGetInt("openwifi.session.timeout", 10*60);
 
 		Reactor_pool_ = std::make_unique<AP_WS_ReactorThreadPool>(Logger());
-		Reactor_pool_->Start();
+		Reactor_pool_->Start(MicroServiceConfigGetBool("openwifi.rpc.timing", false));
+
+		TLSSessions_ = std::make_unique<AP_WS_TLSSessions>(Logger());
+		TLSSessions_->Start();
+
+		auto CaptureFile = MicroServiceConfigPath("openwifi.capture.file", "");
+		if (!CaptureFile.empty()) {
+			Capture_ = std::make_unique<AP_WS_Capture>(Logger());
+			if (!Capture_->Open(CaptureFile,
+								MicroServiceConfigGetInt("openwifi.capture.maxframes", 1000000)))
+				Capture_.reset();
+		}
+
+		Admission_.Start();
 
 		for (const auto &Svr : ConfigServersList_) {
 
@@ -136,17 +175,18 @@ namespace OpenWifi {
 			Poco::Crypto::RSAKey Key("", Svr.KeyFile(), Svr.KeyFilePassword());
 			Context->usePrivateKey(Key);
 
-			Context->setSessionCacheSize(0);
-			Context->setSessionTimeout(120);
-			Context->flushSessionCache();
-			Context->enableSessionCache(true);
+			TLSSessions_->Configure(*Context);
 			Context->enableExtendedCertificateVerification(false);
 			Context->disableProtocols(Poco::Net::Context::PROTO_TLSV1 |
 									  Poco::Net::Context::PROTO_TLSV1_1);
 
 			auto WebServerHttpParams = new Poco::Net::HTTPServerParams;
-			WebServerHttpParams->setMaxThreads(50);
-			WebServerHttpParams->setMaxQueued(200);
+			//	TLS handshakes run on these threads, so this also caps concurrent handshakes.
+			//	Connections over it wait in the accept queue, in order.
+			WebServerHttpParams->setMaxThreads(
+				(int)MicroServiceConfigGetInt("openwifi.websocket.handshakes", 50));
+			WebServerHttpParams->setMaxQueued(
+				(int)MicroServiceConfigGetInt("openwifi.websocket.handshakes.queue", 200));
 			WebServerHttpParams->setKeepAlive(true);
 			WebServerHttpParams->setName("ws:ap_dispatch");
 
@@ -175,6 +215,7 @@ namespace OpenWifi {
 		}
 
 		for (auto &server : WebServers_) {
+			server->setConnectionFilter(new AP_WS_AdmissionFilter(Admission_));
 			server->start();
 		}
 
@@ -197,172 +238,121 @@ namespace OpenWifi {
 		SimulatorEnabled_ = !SimulatorId_.empty();
 		Utils::SetThreadName(ReactorThread_, "dev:react:head");
 
+		MetricsRegistry()->GaugeFunction("owgw_websocket_connections", "Open device connections.",
+										 {}, [this] { return (double)NumberOfConnectedDevices_; });
+		MetricsRegistry()->GaugeFunction("owgw_websocket_connecting", "Devices in connection setup.",
+										 {}, [this] { return (double)Admission_.InFlight(); });
+
 		Running_ = true;
+		IdleTimers_.Start(Utils::Now());
 		GarbageCollector_.setName("ws:garbage");
 		GarbageCollector_.start(*this);
 
-		std::thread CleanupThread([this](){ CleanupSessions(); });
-		CleanupThread.detach();
+		CleanupThread_ = std::thread([this](){ CleanupSessions(); });
 
+		WarmStart()->Ready("gateway", WarmStart()->Created() != 0);
 		return 0;
 	}
 
+	//	Sessions are ended as soon as they are queued. A reactor callback still running for one
+	//	holds its own reference, see AP_WS_Connection::OnSocketReadable.
 	void AP_WS_Server::CleanupSessions() {
-
-		while(Running_) {
-			std::this_thread::sleep_for(std::chrono::seconds(10));
-
-			while(Running_ && !CleanupSessions_.empty()) {
-				std::pair<uint64_t, uint64_t> Session;
-				{
-					std::lock_guard G(CleanupMutex_);
-					Session = CleanupSessions_.front();
-					CleanupSessions_.pop_front();
-				}
-				poco_trace(this->Logger(),fmt::format("Cleaning up session: {} for device: {}", Session.first, Utils::IntToSerialNumber(Session.second)));
-				EndSession(Session.first, Session.second);
+		Utils::SetThreadName("ws:cleanup");
+		while(true) {
+			std::pair<uint64_t, uint64_t> Session;
+			{
+				std::unique_lock G(CleanupMutex_);
+				CleanupAvailable_.wait(G, [this] { return !Running_ || !CleanupSessions_.empty(); });
+				if(!Running_)
+					return;
+				Session = CleanupSessions_.front();
+				CleanupSessions_.pop_front();
+				CleanedUp_++;
 			}
+			poco_trace(this->Logger(),fmt::format("Cleaning up session: {} for device: {}", Session.first, Utils::IntToSerialNumber(Session.second)));
+			EndSession(Session.first, Session.second);
 		}
 	}
 
+	//	Called by the janitor for each idle deadline that came due.
+	void AP_WS_Server::CheckIdle(std::weak_ptr<AP_WS_Connection> Entry, std::uint64_t Now,
+								 Poco::Logger &LocalLogger) {
+		auto Device = Entry.lock();
+		if (Device == nullptr) {
+			//	already gone, it queued its own cleanup on the way out.
+			IdleGone_++;
+			return;
+		}
+		auto LastContact = Device->LastContact_.load();
+		if (Device->Dead_) {
+			AddCleanupSession(Device->State_.sessionId, Device->SerialNumberInt_);
+		} else if (Now > LastContact && (Now - LastContact) > SessionTimeOut_) {
+			poco_information(
+				LocalLogger,
+				fmt::format("{}: Session seems idle. Controller disconnecting device.",
+							Device->SerialNumber_));
+			AddCleanupSession(Device->State_.sessionId, Device->SerialNumberInt_);
+			IdleExpired_++;
+		} else {
+			IdleRescheduled_++;
+			IdleTimers_.Add(LastContact + SessionTimeOut_ + 1, std::move(Entry));
+			return;
+		}
+		//	check again later in case the cleanup did not take it out.
+		IdleTimers_.Add(Now + SessionTimeOut_, std::move(Entry));
+	}
+
 	void AP_WS_Server::run() {
 		uint64_t last_log = Utils::Now(),
-				 last_zombie_run = 0,
-				 last_garbage_run = 0;
+				 last_garbage_run = Utils::Now();
 
 		Poco::Logger &LocalLogger = Poco::Logger::create(
 			"WS-Session-Janitor", Poco::Logger::root().getChannel(), Poco::Logger::root().getLevel());
 
+		std::vector<std::weak_ptr<AP_WS_Connection>> Expired;
 		while(Running_) {
 
-			if(!Poco::Thread::trySleep(30000)) {
+			if(!Poco::Thread::trySleep(1000)) {
 				break;
 			}
 
-			LocalLogger.information(fmt::format("Garbage collecting starting run."	));
-
-			uint64_t total_connected_time = 0, now = Utils::Now();
-
-			if(now-last_zombie_run > 60) {
-				try {
-					poco_information(LocalLogger,
-									 fmt::format("Garbage collecting zombies... (step 1)"));
-					NumberOfConnectingDevices_ = 0;
-					AverageDeviceConnectionTime_ = 0;
-					int waits = 0;
-					for (int hashIndex = 0; hashIndex < MACHash::HashMax(); hashIndex++) {
-						last_zombie_run = now;
-						waits = 0;
-						while (true) {
-							if (SerialNumbersMutex_[hashIndex].try_lock()) {
-								waits = 0;
-								auto hint = SerialNumbers_[hashIndex].begin();
-								while (hint != end(SerialNumbers_[hashIndex])) {
-									if (hint->second == nullptr) {
-										poco_information(
-											LocalLogger,
-											fmt::format("Dead device found in hash index {}", hashIndex));
-										hint = SerialNumbers_[hashIndex].erase(hint);
-									} else {
-										auto Device = hint->second;
-										auto RightNow = Utils::Now();
-										if (Device->Dead_) {
-											AddCleanupSession(Device->State_.sessionId, Device->SerialNumberInt_);
-											++hint;
-											// hint = SerialNumbers_[hashIndex].erase(hint);
-										} else if (RightNow > Device->LastContact_ &&
-												   (RightNow - Device->LastContact_) > SessionTimeOut_) {
-											poco_information(
-												LocalLogger,
-												fmt::format(
-													"{}: Session seems idle. Controller disconnecting device.",
-													Device->SerialNumber_));
-											// hint = SerialNumbers_[hashIndex].erase(hint);
-											AddCleanupSession(Device->State_.sessionId, Device->SerialNumberInt_);
-											++hint;
-										} else {
-											if (Device->State_.Connected) {
-												total_connected_time +=
-													(RightNow - Device->State_.started);
-											}
-											++hint;
-										}
-									}
-								}
-								SerialNumbersMutex_[hashIndex].unlock();
-								break;
-							} else if (waits < 5) {
-								waits++;
-								Poco::Thread::trySleep(10);
-							} else {
-								break;
-							}
-						}
-					}
-
-					poco_information(LocalLogger, fmt::format("Garbage collecting zombies... (step 2)"));
-					LeftOverSessions_ = 0;
-					for (int i = 0; i < SessionHash::HashMax(); i++) {
-						waits = 0;
-						while (true) {
-							if (SessionMutex_[i].try_lock()) {
-								waits = 0;
-								auto hint = Sessions_[i].begin();
-								auto RightNow = Utils::Now();
-								while (hint != end(Sessions_[i])) {
-									if (hint->second == nullptr) {
-										hint = Sessions_[i].erase(hint);
-									} else if (hint->second->Dead_) {
-										// hint = Sessions_[i].erase(hint);
-										AddCleanupSession(hint->second->State_.sessionId, hint->second->SerialNumberInt_);
-										++hint;
-									} else if (RightNow > hint->second->LastContact_ &&
-											   (RightNow - hint->second->LastContact_) >
-												   SessionTimeOut_) {
-										poco_information(
-											LocalLogger,
-											fmt::format("{}: Session seems idle. Controller disconnecting device.",
-														hint->second->SerialNumber_));
-										AddCleanupSession(hint->second->State_.sessionId, hint->second->SerialNumberInt_);
-										++hint;
-										// hint = Sessions_[i].erase(hint);
-									} else {
-										++LeftOverSessions_;
-										++hint;
-									}
-								}
-								SessionMutex_[i].unlock();
-								break;
-							} else if (waits < 5) {
-								Poco::Thread::trySleep(10);
-								waits++;
-							} else {
-								break;
-							}
-						}
-					}
-
-					AverageDeviceConnectionTime_ = NumberOfConnectedDevices_ > 0
-													   ? total_connected_time / NumberOfConnectedDevices_
-													   : 0;
-					poco_information(LocalLogger, fmt::format("Garbage collecting zombies done..."));
-				} catch (const Poco::Exception &E) {
-					poco_error(LocalLogger, fmt::format("Poco::Exception: Garbage collecting zombies failed: {}", E.displayText()));
-				} catch (const std::exception &E) {
-					poco_error(LocalLogger, fmt::format("std::exception: Garbage collecting zombies failed: {}", E.what()));
-				} catch (...) {
-					poco_error(LocalLogger, fmt::format("exception:Garbage collecting zombies failed: {}", "unknown"));
-				}
+			uint64_t now = Utils::Now();
 
+			try {
+				auto PauseStart = std::chrono::steady_clock::now();
+				Expired.clear();
+				IdleTimers_.Advance(now, Expired);
+				for (auto &Entry : Expired) {
+					CheckIdle(std::move(Entry), now, LocalLogger);
+				}
+				JanitorPause_.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+										 std::chrono::steady_clock::now() - PauseStart)
+										 .count());
+			} catch (const Poco::Exception &E) {
+				poco_error(LocalLogger, fmt::format("Poco::Exception: Garbage collecting zombies failed: {}", E.displayText()));
+			} catch (const std::exception &E) {
+				poco_error(LocalLogger, fmt::format("std::exception: Garbage collecting zombies failed: {}", E.what()));
+			} catch (...) {
+				poco_error(LocalLogger, fmt::format("exception:Garbage collecting zombies failed: {}", "unknown"));
 			}
 
-			if(NumberOfConnectedDevices_) {
-				if (last_garbage_run > 0) {
-					AverageDeviceConnectionTime_ += (now - last_garbage_run);
-				}
+			if (now - last_garbage_run < 30) {
+				continue;
 			}
+			last_garbage_run = now;
 
 			try {
+				LeftOverSessions_ = 0;
+				for (int i = 0; i < SessionHash::HashMax(); i++) {
+					std::lock_guard SessionLock(SessionMutex_[i]);
+					LeftOverSessions_ += Sessions_[i].size();
+				}
+				NumberOfConnectingDevices_ = Admission_.InFlight();
+				std::uint64_t Connected = ConnectedSessions_, Since = ConnectedSince_;
+				AverageDeviceConnectionTime_ =
+					(Connected > 0 && Connected * now > Since) ? (Connected * now - Since) / Connected
+															  : 0;
+
 				if ((now - last_log) > 60) {
 					last_log = now;
 					poco_information(
@@ -389,7 +379,6 @@ namespace OpenWifi {
 
 				KafkaManager()->PostMessage(KafkaTopics::DEVICE_EVENT_QUEUE, "system", FullEvent);
 				LocalLogger.information(fmt::format("Garbage collection finished run."));
-				last_garbage_run = now;
 			} catch (const Poco::Exception &E) {
 				LocalLogger.error(fmt::format("Poco::Exception: Garbage collecting failed: {}", E.displayText()));
 			} catch (const std::exception &E) {
@@ -408,6 +397,13 @@ namespace OpenWifi {
 		GarbageCollector_.wakeUp();
 		GarbageCollector_.join();
 
+		{
+			std::lock_guard G(CleanupMutex_);
+		}
+		CleanupAvailable_.notify_all();
+		if (CleanupThread_.joinable())
+			CleanupThread_.join();
+
 		for (auto &server : WebServers_) {
 			server->stopAll();
 		}
@@ -415,9 +411,49 @@ namespace OpenWifi {
 		Reactor_pool_->Stop();
 		Reactor_.stop();
 		ReactorThread_.join();
+		TLSSessions_->Stop();
+		if (Capture_)
+			Capture_->Close();
 		poco_information(Logger(), "Stopped...");
 	}
 
+	void AP_WS_Server::GetStatistics(Poco::JSON::Object &Stats) {
+		if (TLSSessions_) {
+			Poco::JSON::Object TLS;
+			TLSSessions_->GetStatistics(TLS);
+			Stats.set("tls", TLS);
+		}
+		Poco::JSON::Object Admission;
+		Admission_.GetStatistics(Admission);
+		Stats.set("admission", Admission);
+
+		Poco::JSON::Object Janitor, Pause;
+		JanitorPause_.ToJSON(Pause);
+		Janitor.set("pause", Pause);
+		Janitor.set("timers", IdleTimers_.Size());
+		Janitor.set("idleExpired", IdleExpired_.load());
+		Janitor.set("idleRescheduled", IdleRescheduled_.load());
+		Janitor.set("idleGone", IdleGone_.load());
+		{
+			std::lock_guard G(CleanupMutex_);
+			Janitor.set("cleanupQueue", CleanupSessions_.size());
+			Janitor.set("cleanedUp", CleanedUp_);
+		}
+		Stats.set("janitor", Janitor);
+
+		if (Reactor_pool_) {
+			Poco::JSON::Array Rpc;
+			Reactor_pool_->GetTimings(Rpc);
+			Stats.set("rpc", Rpc);
+		}
+
+		if (Capture_) {
+			Poco::JSON::Object Capture;
+			Capture_->GetStatistics(Capture);
+			Stats.set("capture", Capture);
+		}
+	}
+
 	bool AP_WS_Server::GetHealthDevices(std::uint64_t lowLimit, std::uint64_t  highLimit, std::vector<std::string> & SerialNumbers) {
 		SerialNumbers.clear();
 		for(int i=0;i<SessionHash::HashMax();i++) {
@@ -592,6 +628,21 @@ namespace OpenWifi {
 		return false;
 	}
 
+	void AP_WS_Server::GetConnectionsByReactor(const Types::StringVec &SerialNumbers,
+											   ConnectionBatches &Batches) const {
+		for (const auto &SerialNumber : SerialNumbers) {
+			auto SerialNumberInt = Utils::SerialNumberToInt(SerialNumber);
+			auto hashIndex = MACHash::Hash(SerialNumberInt);
+			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
+			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumberInt);
+			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr ||
+				DeviceHint->second->Dead_) {
+				continue;
+			}
+			Batches[DeviceHint->second->Reactor_.get()].push_back(DeviceHint->second);
+		}
+	}
+
 	void AP_WS_Server::StopWebSocketTelemetry(uint64_t RPCID, uint64_t SerialNumber) {
 		std::shared_ptr<AP_WS_Connection> Connection;
 		{
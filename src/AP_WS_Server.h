@@ -9,6 +9,7 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
 #include <ctime>
 #include <mutex>
 #include <thread>
@@ -23,9 +24,14 @@
 #include "Poco/Net/SocketReactor.h"
 #include "Poco/Timer.h"
 
+#include "AP_WS_Admission.h"
+#include "AP_WS_Capture.h"
 #include "AP_WS_Connection.h"
 #include "AP_WS_Reactor_Pool.h"
+#include "AP_WS_TLSSessions.h"
+#include "AP_WS_TimerWheel.h"
 
+#include "framework/MetricsRegistry.h"
 #include "framework/SubSystemServer.h"
 #include "framework/utils.h"
 
@@ -97,14 +103,17 @@ namespace OpenWifi {
 		[[nodiscard]] inline bool UseProvisioning() const { return LookAtProvisioning_; }
 		[[nodiscard]] inline bool UseDefaults() const { return UseDefaultConfig_; }
 		[[nodiscard]] inline bool Running() const { return Running_; }
-		[[nodiscard]] inline std::pair<std::shared_ptr<Poco::Net::SocketReactor>, std::shared_ptr<LockedDbSession>> NextReactor() {
+		[[nodiscard]] inline AP_WS_ReactorSlot NextReactor() {
 			return Reactor_pool_->NextReactor();
 		}
+		//	Null unless device frames are being captured.
+		[[nodiscard]] inline AP_WS_Capture *Capture() { return Capture_.get(); }
 
 		inline void AddConnection(std::shared_ptr<AP_WS_Connection> Connection) {
 			std::uint64_t sessionHash = SessionHash::Hash(Connection->State_.sessionId);
 			std::lock_guard SessionLock(SessionMutex_[sessionHash]);
 			if(Sessions_[sessionHash].find(Connection->State_.sessionId)==end(Sessions_[sessionHash])) {
+				IdleTimers_.Add(Utils::Now() + SessionTimeOut_ + 1, Connection);
 				Sessions_[sessionHash][Connection->State_.sessionId] = std::move(Connection);
 			}
 		}
@@ -126,6 +135,8 @@ namespace OpenWifi {
 			return GetStatistics(Utils::SerialNumberToInt(SerialNumber), Statistics);
 		}
 		[[nodiscard]] bool GetStatistics(uint64_t SerialNumber, std::string &Statistics) const;
+		void GetStatistics(Poco::JSON::Object &Stats) override;
+		inline AP_WS_Admission &Admission() { return Admission_; }
 
 		inline bool GetState(const std::string &SerialNumber,
 							 GWObjects::ConnectionState &State) const {
@@ -182,6 +193,11 @@ namespace OpenWifi {
 			return SendFrame(Utils::SerialNumberToInt(SerialNumber), Payload);
 		}
 
+		using ConnectionBatches = std::map<Poco::Net::SocketReactor *,
+										   std::vector<std::shared_ptr<AP_WS_Connection>>>;
+		void GetConnectionsByReactor(const Types::StringVec &SerialNumbers,
+									 ConnectionBatches &Batches) const;
+
 		inline void AddRX(std::uint64_t bytes) {
 			RX_ += bytes;
 		}
@@ -206,12 +222,28 @@ namespace OpenWifi {
 			--NumberOfConnectedDevices_;
 		}
 
+		//	Connected time is summed from the start times, no need to visit every device.
+		inline void SessionConnected(std::uint64_t Started) {
+			++ConnectedSessions_;
+			ConnectedSince_ += Started;
+		}
+
+		inline void SessionDisconnected(std::uint64_t Started) {
+			--ConnectedSessions_;
+			ConnectedSince_ -= Started;
+		}
+
 		inline void AddCleanupSession(uint64_t session_id, uint64_t SerialNumber) {
-			std::lock_guard G(CleanupMutex_);
-			CleanupSessions_.emplace_back(session_id, SerialNumber);
+			{
+				std::lock_guard G(CleanupMutex_);
+				CleanupSessions_.emplace_back(session_id, SerialNumber);
+			}
+			CleanupAvailable_.notify_one();
 		}
 
 		void CleanupSessions();
+		void CheckIdle(std::weak_ptr<AP_WS_Connection> Entry, std::uint64_t Now,
+					   Poco::Logger &LocalLogger);
 
 	  private:
 		std::array<std::mutex,SessionHashMax> 			SessionMutex_;
@@ -232,11 +264,22 @@ namespace OpenWifi {
 		bool SimulatorEnabled_ = false;
 		bool AllowSerialNumberMismatch_ = true;
 
-		Poco::Thread            CleanupThread_;
+		std::thread             CleanupThread_;
 		std::mutex              CleanupMutex_;
+		std::condition_variable CleanupAvailable_;
 		std::deque<std::pair<uint64_t, uint64_t>> CleanupSessions_;
+		std::uint64_t           CleanedUp_ = 0;
+
+		//	Idle deadlines. An entry that comes due for a device that talked since is put back
+		//	at its new deadline, so activity costs nothing on the data path.
+		AP_WS_TimerWheel<std::weak_ptr<AP_WS_Connection>> IdleTimers_;
+		MetricHistogram			JanitorPause_;
+		std::atomic_uint64_t	IdleExpired_ = 0, IdleRescheduled_ = 0, IdleGone_ = 0;
 
 		std::unique_ptr<AP_WS_ReactorThreadPool> Reactor_pool_;
+		std::unique_ptr<AP_WS_TLSSessions> TLSSessions_;
+		std::unique_ptr<AP_WS_Capture> Capture_;
+		AP_WS_Admission Admission_;
 		std::atomic_bool Running_ = false;
 
 		std::uint64_t 			MismatchDepth_ = 2;
@@ -246,6 +289,7 @@ namespace OpenWifi {
 		std::uint64_t 			NumberOfConnectingDevices_ = 0;
 		std::uint64_t 			SessionTimeOut_ = 10*60;
 		std::uint64_t 			LeftOverSessions_ = 0;
+		std::atomic_uint64_t 	ConnectedSessions_ = 0, ConnectedSince_ = 0;
 		std::atomic_uint64_t 	TX_=0,RX_=0;
 
 		std::atomic_bool 		KafkaDisableState_=false,
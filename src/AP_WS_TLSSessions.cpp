@@ -0,0 +1,403 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#else
+#include <openssl/hmac.h>
+#endif
+
+#include "Poco/File.h"
+#include "Poco/NumberParser.h"
+#include "Poco/StringTokenizer.h"
+
+#include "fmt/format.h"
+
+#include "AP_WS_TLSSessions.h"
+#include "framework/MicroServiceFuncs.h"
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	//	OpenSSL callbacks have no user pointer, there is only one set of listeners. Null once
+	//	stopped, so a late handshake never reaches a deleted instance.
+	static std::atomic<AP_WS_TLSSessions *> CurrentSessions = nullptr;
+
+	static constexpr const char *SessionIdContext = "owgw-ap";
+
+	//	seconds after which a leftover temporary key file is from a crash, not a writer.
+	static constexpr std::uint64_t StaleKeyFile = 60;
+
+	static void HandshakeInfo(const SSL *ssl, int where, [[maybe_unused]] int ret) {
+		auto Sessions = CurrentSessions.load();
+		if (Sessions == nullptr || (where & SSL_CB_HANDSHAKE_DONE) == 0)
+			return;
+		if (SSL_session_reused(ssl))
+			Sessions->ResumedHandshakes_++;
+		else
+			Sessions->FullHandshakes_++;
+	}
+
+	//	Returns the key to use, and whether the ticket should be renewed with the current key.
+	static const AP_WS_TLSSessions::TicketKey *
+	FindTicketKey(const AP_WS_TLSSessions::TicketKeys &Keys, const unsigned char *Name,
+				  bool &Renew) {
+		for (std::size_t i = 0; i < Keys.size(); ++i) {
+			if (std::memcmp(Keys[i].Name.data(), Name, Keys[i].Name.size()) == 0) {
+				Renew = i != 0;
+				return &Keys[i];
+			}
+		}
+		return nullptr;
+	}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	static bool SetTicketHMAC(EVP_MAC_CTX *HMAC, const AP_WS_TLSSessions::TicketKey &Key) {
+		char Digest[] = "SHA256";
+		OSSL_PARAM Params[3];
+		Params[0] = OSSL_PARAM_construct_octet_string(
+			OSSL_MAC_PARAM_KEY, (void *)Key.HMACKey.data(), Key.HMACKey.size());
+		Params[1] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, Digest, 0);
+		Params[2] = OSSL_PARAM_construct_end();
+		return EVP_MAC_CTX_set_params(HMAC, Params) == 1;
+	}
+
+	static int TicketKeyCallback([[maybe_unused]] SSL *ssl, unsigned char *Name,
+								 unsigned char *IV, EVP_CIPHER_CTX *Cipher, EVP_MAC_CTX *HMAC,
+								 int Encrypt) {
+#else
+	static bool SetTicketHMAC(HMAC_CTX *HMAC, const AP_WS_TLSSessions::TicketKey &Key) {
+		return HMAC_Init_ex(HMAC, Key.HMACKey.data(), (int)Key.HMACKey.size(), EVP_sha256(),
+							nullptr) == 1;
+	}
+
+	static int TicketKeyCallback([[maybe_unused]] SSL *ssl, unsigned char *Name,
+								 unsigned char *IV, EVP_CIPHER_CTX *Cipher, HMAC_CTX *HMAC,
+								 int Encrypt) {
+#endif
+		auto Sessions = CurrentSessions.load();
+		if (Sessions == nullptr)
+			return 0;
+		auto Keys = Sessions->Keys();
+		if (!Keys || Keys->empty())
+			return 0;
+
+		if (Encrypt) {
+			const auto &Key = Keys->front();
+			std::memcpy(Name, Key.Name.data(), Key.Name.size());
+			if (RAND_bytes(IV, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1 ||
+				EVP_EncryptInit_ex(Cipher, EVP_aes_256_cbc(), nullptr, Key.AESKey.data(), IV) !=
+					1 ||
+				!SetTicketHMAC(HMAC, Key))
+				return -1;
+			Sessions->TicketsIssued_++;
+			return 1;
+		}
+
+		bool Renew = false;
+		auto Key = FindTicketKey(*Keys, Name, Renew);
+		if (Key == nullptr) {
+			//	unknown or retired key: full handshake, and a new ticket.
+			Sessions->TicketsRejected_++;
+			return 0;
+		}
+		if (EVP_DecryptInit_ex(Cipher, EVP_aes_256_cbc(), nullptr, Key->AESKey.data(), IV) != 1 ||
+			!SetTicketHMAC(HMAC, *Key))
+			return -1;
+		Sessions->TicketsAccepted_++;
+		if (Renew) {
+			Sessions->TicketsRenewed_++;
+			return 2;
+		}
+		return 1;
+	}
+
+	void AP_WS_TLSSessions::Start() {
+		CacheSize_ = MicroServiceConfigGetInt("openwifi.tls.session.cache", 20000);
+		Timeout_ = MicroServiceConfigGetInt("openwifi.tls.session.timeout", 7200);
+		Tickets_ = MicroServiceConfigGetBool("openwifi.tls.tickets", true);
+		Rotate_ = MicroServiceConfigGetBool("openwifi.tls.tickets.rotate", true);
+		Rotation_ = std::max((std::uint64_t)60,
+							 MicroServiceConfigGetInt("openwifi.tls.tickets.rotation", 3600));
+		KeysKept_ = std::max((std::uint64_t)2,
+							 MicroServiceConfigGetInt("openwifi.tls.tickets.keys", 3));
+		KeyFile_ = MicroServiceConfigPath("openwifi.tls.tickets.keyfile",
+										  MicroServiceDataDirectory() + "/tls_ticket_keys");
+		CurrentSessions = this;
+
+		if (!Tickets_)
+			return;
+		Refresh();
+		auto Period = std::min(Rotation_, (std::uint64_t)60) * 1000;
+		TimerCallback_ = std::make_unique<Poco::TimerCallback<AP_WS_TLSSessions>>(
+			*this, &AP_WS_TLSSessions::onTimer);
+		Timer_.setStartInterval(Period);
+		Timer_.setPeriodicInterval(Period);
+		Timer_.start(*TimerCallback_, MicroServiceTimerPool());
+	}
+
+	void AP_WS_TLSSessions::Stop() {
+		auto Self = this;
+		CurrentSessions.compare_exchange_strong(Self, nullptr);
+		if (TimerCallback_)
+			Timer_.stop();
+	}
+
+	void AP_WS_TLSSessions::Configure(Poco::Net::Context &Context) {
+		//	the session id context is needed to resume sessions with a verified client certificate.
+		Context.enableSessionCache(CacheSize_ > 0, SessionIdContext);
+		Context.setSessionCacheSize(CacheSize_);
+		Context.setSessionTimeout(Timeout_);
+
+		auto Ctx = Context.sslContext();
+		SSL_CTX_set_info_callback(Ctx, HandshakeInfo);
+		if (Tickets_) {
+			SSL_CTX_clear_options(Ctx, SSL_OP_NO_TICKET);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+			SSL_CTX_set_tlsext_ticket_key_evp_cb(Ctx, TicketKeyCallback);
+#else
+			SSL_CTX_set_tlsext_ticket_key_cb(Ctx, TicketKeyCallback);
+#endif
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+			//	a device holds one connection, one TLS 1.3 ticket is enough.
+			SSL_CTX_set_num_tickets(Ctx, 1);
+#endif
+		} else {
+			SSL_CTX_set_options(Ctx, SSL_OP_NO_TICKET);
+		}
+	}
+
+	std::shared_ptr<const AP_WS_TLSSessions::TicketKeys> AP_WS_TLSSessions::Keys() const {
+		std::shared_lock Lock(Mutex_);
+		return Keys_;
+	}
+
+	void AP_WS_TLSSessions::GetStatistics(Poco::JSON::Object &Obj) const {
+		Obj.set("fullHandshakes", FullHandshakes_.load());
+		Obj.set("resumedHandshakes", ResumedHandshakes_.load());
+		Obj.set("ticketsIssued", TicketsIssued_.load());
+		Obj.set("ticketsAccepted", TicketsAccepted_.load());
+		Obj.set("ticketsRenewed", TicketsRenewed_.load());
+		Obj.set("ticketsRejected", TicketsRejected_.load());
+		auto Current = Keys();
+		Obj.set("ticketKeys", Current ? Current->size() : 0);
+		Obj.set("ticketKeyCreated", Current && !Current->empty() ? Current->front().Created : 0);
+	}
+
+	void AP_WS_TLSSessions::onTimer([[maybe_unused]] Poco::Timer &timer) { Refresh(); }
+
+	static bool NewTicketKey(AP_WS_TLSSessions::TicketKey &Key, std::uint64_t Now) {
+		if (RAND_bytes(Key.Name.data(), (int)Key.Name.size()) != 1 ||
+			RAND_bytes(Key.HMACKey.data(), (int)Key.HMACKey.size()) != 1 ||
+			RAND_bytes(Key.AESKey.data(), (int)Key.AESKey.size()) != 1)
+			return false;
+		Key.Created = Now;
+		return true;
+	}
+
+	//	Picks up keys written by another gateway, and adds a new key when the current one is due.
+	void AP_WS_TLSSessions::Refresh() {
+		try {
+			TicketKeys Loaded;
+			bool Changed = LoadKeyFile(Loaded);
+			if (!Changed) {
+				auto Current = Keys();
+				if (Current)
+					Loaded = *Current;
+			}
+			auto Now = Utils::Now();
+			if (Loaded.empty() || (Rotate_ && Now >= Loaded.front().Created + Rotation_)) {
+				if (!Rotate_ || !RotateKeyFile(Loaded, Now)) {
+					//	another gateway is rotating: pick its keys up on the next refresh.
+					auto Current = Keys();
+					if (Rotate_ && Current && !Current->empty())
+						return;
+					//	nothing to serve tickets with yet: a key of our own until the file has one.
+					TicketKey Key;
+					if (!NewTicketKey(Key, Now)) {
+						poco_error(Logger(), "TLS-TICKETS: cannot generate a ticket key.");
+						return;
+					}
+					Loaded.insert(Loaded.begin(), Key);
+					if (Loaded.size() > KeysKept_)
+						Loaded.resize(KeysKept_);
+				}
+				Changed = true;
+				poco_information(Logger(), fmt::format("TLS-TICKETS: ticket keys rotated, {} kept.",
+													   Loaded.size()));
+			}
+			if (Changed)
+				Publish(std::move(Loaded));
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		} catch (const std::exception &E) {
+			poco_error(Logger(), fmt::format("TLS-TICKETS: refresh failed: {}", E.what()));
+		}
+	}
+
+	bool AP_WS_TLSSessions::LoadKeyFile(TicketKeys &Keys) {
+		Poco::File F(KeyFile_);
+		if (!F.exists())
+			return false;
+		auto Modified = F.getLastModified().epochMicroseconds();
+		if (Modified == KeyFileModified_)
+			return false;
+		ReadKeyFile(Keys);
+		KeyFileModified_ = Modified;
+		if (Keys.empty()) {
+			poco_warning(Logger(),
+						 fmt::format("TLS-TICKETS: no valid key in '{}'.", KeyFile_));
+			return false;
+		}
+		return true;
+	}
+
+	//	One key per line, newest first: "<created> <base64 of name, hmac key and aes key>". Lines
+	//	that do not parse are skipped.
+	void AP_WS_TLSSessions::ReadKeyFile(TicketKeys &Keys) {
+		std::ifstream In(KeyFile_);
+		std::string Line, Raw;
+		std::uint64_t Skipped = 0;
+		while (std::getline(In, Line)) {
+			Poco::StringTokenizer Tokens(Line, " ", Poco::StringTokenizer::TOK_TRIM |
+														Poco::StringTokenizer::TOK_IGNORE_EMPTY);
+			if (Tokens.count() == 0)
+				continue;
+			TicketKey Key;
+			if (Tokens.count() != 2 ||
+				!Poco::NumberParser::tryParseUnsigned64(Tokens[0], Key.Created) ||
+				!Utils::base64decode(Tokens[1], Raw) ||
+				Raw.size() != Key.Name.size() + Key.HMACKey.size() + Key.AESKey.size()) {
+				Skipped++;
+				continue;
+			}
+			auto It = Raw.begin();
+			std::copy_n(It, Key.Name.size(), Key.Name.begin());
+			It += (std::ptrdiff_t)Key.Name.size();
+			std::copy_n(It, Key.HMACKey.size(), Key.HMACKey.begin());
+			It += (std::ptrdiff_t)Key.HMACKey.size();
+			std::copy_n(It, Key.AESKey.size(), Key.AESKey.begin());
+			Keys.push_back(Key);
+		}
+		if (Skipped > 0)
+			poco_warning(Logger(), fmt::format("TLS-TICKETS: skipped {} invalid line(s) in '{}'.",
+											   Skipped, KeyFile_));
+	}
+
+	//	The temporary file next to the key file is the lock: it is created owner-only and
+	//	exclusively, and if it exists, another gateway is rotating now, unless it was left behind
+	//	by a crash. Holding it, the key file is read again, so keys another gateway added since
+	//	our last refresh are kept, and a new key is only added if none was added meanwhile. The
+	//	result is written to the temporary file and renamed, so other gateways never read half a
+	//	file. Keys holds what we have and gets what was written. False when the lock is taken or
+	//	the file cannot be written.
+	bool AP_WS_TLSSessions::RotateKeyFile(TicketKeys &Keys, std::uint64_t Now) {
+		auto TmpName = KeyFile_ + ".tmp";
+		auto fd = ::open(TmpName.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0600);
+		if (fd < 0 && errno == EEXIST) {
+			struct stat St {};
+			if (::stat(TmpName.c_str(), &St) == 0 &&
+				(std::uint64_t)St.st_mtime + StaleKeyFile > Now) {
+				poco_warning(Logger(), fmt::format("TLS-TICKETS: '{}' is being written by another "
+												   "gateway, keeping its keys.",
+												   TmpName));
+				return false;
+			}
+			::unlink(TmpName.c_str());
+			fd = ::open(TmpName.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0600);
+		}
+		if (fd < 0) {
+			poco_error(Logger(), fmt::format("TLS-TICKETS: cannot create '{}': {}", TmpName,
+											 std::strerror(errno)));
+			return false;
+		}
+
+		TicketKeys Merged;
+		try {
+			ReadKeyFile(Merged);
+		} catch (...) {
+			::close(fd);
+			::unlink(TmpName.c_str());
+			throw;
+		}
+		for (const auto &Key : Keys) {
+			if (std::none_of(Merged.begin(), Merged.end(), [&](const TicketKey &K) {
+					return K.Name == Key.Name;
+				}))
+				Merged.push_back(Key);
+		}
+		std::stable_sort(Merged.begin(), Merged.end(), [](const TicketKey &L, const TicketKey &R) {
+			return L.Created > R.Created;
+		});
+		if (Merged.empty() || Now >= Merged.front().Created + Rotation_) {
+			TicketKey Key;
+			if (!NewTicketKey(Key, Now)) {
+				poco_error(Logger(), "TLS-TICKETS: cannot generate a ticket key.");
+				::close(fd);
+				::unlink(TmpName.c_str());
+				return false;
+			}
+			Merged.insert(Merged.begin(), Key);
+		}
+		if (Merged.size() > KeysKept_)
+			Merged.resize(KeysKept_);
+
+		std::string Content;
+		for (const auto &Key : Merged) {
+			std::vector<Utils::byte> Raw;
+			Raw.insert(Raw.end(), Key.Name.begin(), Key.Name.end());
+			Raw.insert(Raw.end(), Key.HMACKey.begin(), Key.HMACKey.end());
+			Raw.insert(Raw.end(), Key.AESKey.begin(), Key.AESKey.end());
+			Content += fmt::format("{} {}\n", Key.Created, Utils::base64encode(Raw.data(), Raw.size()));
+		}
+		const char *Data = Content.data();
+		auto Left = Content.size();
+		while (Left > 0) {
+			auto Written = ::write(fd, Data, Left);
+			if (Written < 0 && errno == EINTR)
+				continue;
+			if (Written <= 0) {
+				poco_error(Logger(), fmt::format("TLS-TICKETS: cannot write '{}': {}", TmpName,
+												 std::strerror(errno)));
+				::close(fd);
+				::unlink(TmpName.c_str());
+				return false;
+			}
+			Data += Written;
+			Left -= Written;
+		}
+		auto Synced = ::fsync(fd) == 0;
+		if (::close(fd) != 0 || !Synced || ::rename(TmpName.c_str(), KeyFile_.c_str()) != 0) {
+			poco_error(Logger(), fmt::format("TLS-TICKETS: cannot replace '{}': {}", KeyFile_,
+											 std::strerror(errno)));
+			::unlink(TmpName.c_str());
+			return false;
+		}
+		KeyFileModified_ = Poco::File(KeyFile_).getLastModified().epochMicroseconds();
+		Keys = std::move(Merged);
+		return true;
+	}
+
+	void AP_WS_TLSSessions::Publish(TicketKeys Keys) {
+		auto Snapshot = std::make_shared<const TicketKeys>(std::move(Keys));
+		std::unique_lock Lock(Mutex_);
+		Keys_ = std::move(Snapshot);
+	}
+
+} // namespace OpenWifi
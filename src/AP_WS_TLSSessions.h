@@ -0,0 +1,78 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "Poco/JSON/Object.h"
+#include "Poco/Logger.h"
+#include "Poco/Net/Context.h"
+#include "Poco/Timer.h"
+
+namespace OpenWifi {
+
+	//	TLS session resumption for the device listeners. Resumed handshakes skip the certificate
+	//	exchange and verification, which is what makes a mass reconnect expensive. TLS 1.2
+	//	clients resume from the server session cache, and all clients can resume with stateless
+	//	tickets. Ticket keys live in a key file, so gateways sharing it accept each other's
+	//	tickets. The first key of the file encrypts new tickets, and all keys decrypt them.
+	class AP_WS_TLSSessions {
+	  public:
+		struct TicketKey {
+			std::array<unsigned char, 16> Name{};
+			std::array<unsigned char, 32> HMACKey{};
+			std::array<unsigned char, 32> AESKey{};
+			std::uint64_t Created = 0;
+		};
+		using TicketKeys = std::vector<TicketKey>;
+
+		explicit AP_WS_TLSSessions(Poco::Logger &L) : Logger_(L) {}
+
+		void Start();
+		void Stop();
+
+		//	Called on the context of each listener.
+		void Configure(Poco::Net::Context &Context);
+
+		void GetStatistics(Poco::JSON::Object &Obj) const;
+
+		//	Used by the OpenSSL callbacks.
+		std::shared_ptr<const TicketKeys> Keys() const;
+		std::atomic_uint64_t FullHandshakes_ = 0, ResumedHandshakes_ = 0, TicketsIssued_ = 0,
+							 TicketsAccepted_ = 0, TicketsRenewed_ = 0, TicketsRejected_ = 0;
+
+	  private:
+		Poco::Logger &Logger_;
+		bool Tickets_ = true;
+		bool Rotate_ = true;
+		std::uint64_t CacheSize_ = 20000;
+		std::uint64_t Timeout_ = 7200;
+		std::uint64_t Rotation_ = 3600;
+		std::uint64_t KeysKept_ = 3;
+		std::string KeyFile_;
+		std::int64_t KeyFileModified_ = 0;
+
+		mutable std::shared_mutex Mutex_;
+		std::shared_ptr<const TicketKeys> Keys_;
+
+		Poco::Timer Timer_;
+		std::unique_ptr<Poco::TimerCallback<AP_WS_TLSSessions>> TimerCallback_;
+
+		void onTimer(Poco::Timer &timer);
+		void Refresh();
+		bool LoadKeyFile(TicketKeys &Keys);
+		void ReadKeyFile(TicketKeys &Keys);
+		bool RotateKeyFile(TicketKeys &Keys, std::uint64_t Now);
+		void Publish(TicketKeys Keys);
+		Poco::Logger &Logger() { return Logger_; }
+	};
+
+} // namespace OpenWifi
@@ -0,0 +1,91 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace OpenWifi {
+
+	//	Hierarchical timer wheel with a one second tick. Level 0 has a slot for each of the next
+	//	64 seconds, and each level above covers 64 times the span of the one below. Entries in a
+	//	higher level move down when their slot comes up, so advancing costs the entries that
+	//	expire or move, not the number of entries. Deadlines are in seconds, as Utils::Now().
+	template <typename T> class AP_WS_TimerWheel {
+	  public:
+		static constexpr std::uint64_t SlotBits = 6;
+		static constexpr std::uint64_t Slots = 1 << SlotBits;
+		static constexpr std::uint64_t Levels = 4;
+		static constexpr std::uint64_t MaxDelay = (1ULL << (SlotBits * Levels)) - 1;
+
+		inline void Start(std::uint64_t Now) {
+			std::lock_guard G(Mutex_);
+			if (Now_ == 0)
+				Now_ = Now;
+		}
+
+		//	A deadline that already passed expires on the next tick.
+		inline void Add(std::uint64_t Deadline, T Item) {
+			std::lock_guard G(Mutex_);
+			Place(Entry{Deadline, std::move(Item)}, Now_ + 1);
+			Size_++;
+		}
+
+		//	Moves the wheel up to Now and appends the entries that expired to Expired.
+		inline void Advance(std::uint64_t Now, std::vector<T> &Expired) {
+			std::lock_guard G(Mutex_);
+			while (Now_ < Now) {
+				++Now_;
+				for (auto Level = Levels - 1; Level > 0; --Level) {
+					if ((Now_ & ((1ULL << (SlotBits * Level)) - 1)) != 0)
+						continue;
+					auto &Slot = Wheel_[Level][(Now_ >> (SlotBits * Level)) & (Slots - 1)];
+					if (Slot.empty())
+						continue;
+					std::vector<Entry> Cascade;
+					Cascade.swap(Slot);
+					for (auto &E : Cascade)
+						Place(std::move(E), Now_);
+				}
+				auto &Slot = Wheel_[0][Now_ & (Slots - 1)];
+				for (auto &E : Slot)
+					Expired.push_back(std::move(E.Item));
+				Size_ -= Slot.size();
+				Slot.clear();
+			}
+		}
+
+		[[nodiscard]] inline std::uint64_t Size() {
+			std::lock_guard G(Mutex_);
+			return Size_;
+		}
+
+	  private:
+		struct Entry {
+			std::uint64_t Deadline;
+			T Item;
+		};
+
+		std::mutex Mutex_;
+		std::uint64_t Now_ = 0;
+		std::uint64_t Size_ = 0;
+		std::array<std::array<std::vector<Entry>, Slots>, Levels> Wheel_;
+
+		//	Called with Mutex_ held. Earliest is the first tick that has not been processed yet.
+		inline void Place(Entry E, std::uint64_t Earliest) {
+			E.Deadline = std::clamp(E.Deadline, Earliest, Now_ + MaxDelay);
+			auto Delay = E.Deadline - Now_;
+			std::uint64_t Level = 0;
+			while (Level < Levels - 1 && Delay >= (1ULL << (SlotBits * (Level + 1))))
+				++Level;
+			Wheel_[Level][(E.Deadline >> (SlotBits * Level)) & (Slots - 1)].push_back(std::move(E));
+		}
+	};
+
+} // namespace OpenWifi
@@ -13,6 +13,7 @@
 #include "AP_WS_Server.h"
 #include "CommandManager.h"
 #include "StorageService.h"
+#include "framework/MetricsRegistry.h"
 #include "framework/MicroServiceFuncs.h"
 #include "framework/ow_constants.h"
 #include "framework/utils.h"
@@ -21,6 +22,22 @@ using namespace std::chrono_literals;
 
 namespace OpenWifi {
 
+	//	Series per command are looked up on each call: commands are rare next to frames.
+	static inline MetricCounter &CommandCounter(const char *Name, const char *Help,
+												APCommands::Commands Command) {
+		return MetricsRegistry()->Counter(Name, Help, {{"command", APCommands::to_string(Command)}});
+	}
+
+	static inline void CommandCompletedMetrics(APCommands::Commands Command,
+											   std::chrono::duration<double, std::milli> Elapsed) {
+		CommandCounter("owgw_commands_completed_total", "Commands answered by the device.", Command)
+			.Inc();
+		MetricsRegistry()
+			->Histogram("owgw_command_rpc_seconds", "Time from sending a command to its answer.",
+						{{"command", APCommands::to_string(Command)}})
+			.Record((std::uint64_t)(Elapsed.count() * 1000.0));
+	}
+
 	void CommandManager::run() {
 		Utils::SetThreadName("cmd:mgr");
 		Running_ = true;
@@ -62,6 +79,7 @@ namespace OpenWifi {
 										   fmt::format("({}): Received RPC answer {}. Command={}",
 													   SerialNumberStr, ID,
 													   APCommands::to_string(RPC->second.Command)));
+								CommandCompletedMetrics(RPC->second.Command, rpc_execution_time);
 								if (RPC->second.Command == APCommands::Commands::script) {
 									CompleteScriptCommand(RPC->second, Payload, rpc_execution_time);
 								} else if (RPC->second.Command == APCommands::Commands::telemetry) {
@@ -260,6 +278,9 @@ namespace OpenWifi {
 					StorageService()->CancelWaitFile(request->second.UUID, TimeOutError);
 				}
 				StorageService()->SetCommandTimedOut(request->second.UUID);
+				CommandCounter("owgw_commands_timed_out_total", "Commands the device never answered.",
+							   request->second.Command)
+					.Inc();
 				request = OutStandingRequests_.erase(request);
 			} else {
 				++request;
@@ -267,6 +288,9 @@ namespace OpenWifi {
 		}
 		poco_information(MyLogger,
 						 fmt::format("Outstanding-requests {}", OutStandingRequests_.size()));
+		MetricsRegistry()
+			->Gauge("owgw_commands_outstanding", "Commands waiting for an answer.")
+			.Set((std::int64_t)OutStandingRequests_.size());
 	}
 
 	bool CommandManager::IsCommandRunning(const std::string &C) {
@@ -287,13 +311,14 @@ namespace OpenWifi {
 			StorageService()->RemovedExpiredCommands();
 			StorageService()->RemoveTimedOutCommands();
 
-			std::uint64_t offset = 0;
+			StorageCursor Cursor;
 			bool Done = false;
 			while (!Done) {
 				std::vector<GWObjects::CommandDetails> Commands;
-				if (StorageService()->GetReadyToExecuteCommands(offset, 200, Commands)) {
+				if (StorageService()->GetReadyToExecuteCommands(Cursor, 200, Commands)) {
+					//	a page may hold only commands for disconnected devices.
 					if(Commands.empty()) {
-						Done=true;
+						Done = Cursor.Done;
 						continue;
 					}
 					poco_trace(MyLogger, fmt::format("Scheduler about to process {} commands.",
@@ -386,7 +411,7 @@ namespace OpenWifi {
 							StorageService()->SetCommandExecuted(Cmd.UUID);
 						}
 					}
-					offset += Commands.size();
+					Done = Cursor.Done || !Running_;
 				} else {
 					Done=true;
 					continue;
@@ -442,6 +467,7 @@ namespace OpenWifi {
 		}
 		if (AP_WS_Server()->SendFrame(SerialNumber, ToSend.str())) {
 			poco_debug(Logger(), fmt::format("{}: Sent command. ID: {}", UUID, RPC_ID));
+			CommandCounter("owgw_commands_sent_total", "Commands sent to devices.", Command).Inc();
 			Sent = true;
 			return CInfo.rpc_entry;
 		} else if (!oneway_rpc) {
@@ -449,6 +475,9 @@ namespace OpenWifi {
 			OutStandingRequests_.erase(RPC_ID);
 		}
 
+		CommandCounter("owgw_commands_send_failures_total", "Commands that could not be sent.",
+					   Command)
+			.Inc();
 		poco_warning(Logger(), fmt::format("{}: Failed to send command. ID: {}", UUID, RPC_ID));
 		return nullptr;
 	}
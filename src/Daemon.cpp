@@ -15,6 +15,7 @@
 #include <framework/UI_WebSocketClientServer.h>
 #include <framework/default_device_types.h>
 
+#include "AP_WS_Replay.h"
 #include "AP_WS_Server.h"
 #include "CommandManager.h"
 #include "Daemon.h"
@@ -33,6 +34,7 @@
 #include "GenericScheduler.h"
 #include "UI_GW_WebSocketNotifications.h"
 #include "VenueBroadcaster.h"
+#include "WarmStart.h"
 #include "AP_WS_ConfigAutoUpgrader.h"
 #include "rttys/RTTYS_server.h"
 #include "firmware_revision_cache.h"
@@ -42,7 +44,8 @@ namespace OpenWifi {
 		static Daemon instance(
 			vDAEMON_PROPERTIES_FILENAME, vDAEMON_ROOT_ENV_VAR, vDAEMON_CONFIG_ENV_VAR,
 			vDAEMON_APP_NAME, vDAEMON_BUS_TIMER,
-			SubSystemVec{GenericScheduler(), StorageService(), SerialNumberCache(), ConfigurationValidator(),
+			SubSystemVec{WarmStart(), GenericScheduler(), StorageService(), SerialNumberCache(),
+				ConfigurationValidator(),
 				UI_WebSocketClientServer(), OUIServer(), FindCountryFromIP(),
 				CommandManager(), FileUploader(), StorageArchiver(), TelemetryStream(),
 				RTTYS_server(), RADIUS_proxy_server(), VenueBroadcaster(), ScriptManager(),
@@ -50,7 +53,8 @@ namespace OpenWifi {
 				RegulatoryInfo(),
 				RADIUSSessionTracker(),
 			 	AP_WS_ConfigAutoUpgradeAgent(),
-				FirmwareRevisionCache()
+				FirmwareRevisionCache(),
+				AP_WS_Replay()
 			});
 		return &instance;
 	}
@@ -6,9 +6,12 @@
 //	Arilia Wireless Inc.
 //
 
+#include <array>
+#include <fstream>
 #include <iostream>
 
 #include "Poco/CountingStream.h"
+#include "Poco/Crypto/DigestEngine.h"
 #include "Poco/DynamicAny.h"
 #include "Poco/Exception.h"
 #include "Poco/File.h"
@@ -17,6 +20,8 @@
 #include "Poco/Net/MessageHeader.h"
 #include "Poco/Net/MultipartReader.h"
 #include "Poco/Net/PartHandler.h"
+#include "Poco/NullStream.h"
+#include "Poco/Path.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/StringTokenizer.h"
 
@@ -46,6 +51,19 @@ namespace OpenWifi {
 			}
 		}
 
+		StorePath_ = Poco::Path(Path_).makeDirectory().pushDirectory("store").toString();
+		IncomingPath_ = Poco::Path(Path_).makeDirectory().pushDirectory("incoming").toString();
+		try {
+			Poco::File(StorePath_).createDirectories();
+			//	partial uploads left by a previous run are useless.
+			Poco::File Incoming(IncomingPath_);
+			if (Incoming.exists())
+				Incoming.remove(true);
+			Incoming.createDirectories();
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+
 		for (const auto &Svr : ConfigServersList_) {
 			if (MicroServiceNoAPISecurity()) {
 				poco_notice(Logger(), fmt::format("Starting: {}:{}", Svr.Address(), Svr.Port()));
@@ -152,6 +170,97 @@ namespace OpenWifi {
 			OutStandingUploads_.end());
 	}
 
+	bool FileUploader::ReceiveFile(std::istream &In, std::string &TmpFile, std::string &Hash,
+								   std::uint64_t &Size) {
+		TmpFile = Poco::Path(IncomingPath_, MicroServiceCreateUUID() + ".part").toString();
+		Size = 0;
+		try {
+			Poco::Crypto::DigestEngine Digest("SHA256");
+			std::ofstream Out(TmpFile, std::ios::binary | std::ios::trunc);
+			std::array<char, 64 * 1024> Buffer{};
+			bool TooLarge = false;
+			while (In && Out) {
+				In.read(Buffer.data(), Buffer.size());
+				auto Read = In.gcount();
+				if (Read <= 0)
+					break;
+				Size += Read;
+				if (Size > MaxSize_) {
+					TooLarge = true;
+					break;
+				}
+				Digest.update(Buffer.data(), Read);
+				Out.write(Buffer.data(), Read);
+			}
+			Out.close();
+			if (TooLarge) {
+				poco_warning(Logger(), fmt::format("Upload larger than {} bytes rejected.",
+												   MaxSize_));
+			} else if (!Out) {
+				poco_warning(Logger(), fmt::format("Could not write '{}'.", TmpFile));
+			} else {
+				Hash = Poco::DigestEngine::digestToHex(Digest.digest());
+				return true;
+			}
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		} catch (const std::exception &E) {
+			poco_warning(Logger(), fmt::format("Could not receive '{}': {}", TmpFile, E.what()));
+		}
+		RemoveIncoming(TmpFile);
+		return false;
+	}
+
+	void FileUploader::RemoveIncoming(const std::string &TmpFile) {
+		try {
+			Poco::File Tmp(TmpFile);
+			if (Tmp.exists())
+				Tmp.remove();
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+	}
+
+	std::string FileUploader::StoredFile(const std::string &Hash) const {
+		return Poco::Path(StorePath_)
+			.pushDirectory(Hash.substr(0, 2))
+			.setFileName(Hash)
+			.toString();
+	}
+
+	bool FileUploader::CommitFile(const std::string &TmpFile, const std::string &Hash) {
+		try {
+			Poco::File Target(StoredFile(Hash));
+			Poco::File Tmp(TmpFile);
+			if (Target.exists()) {
+				//	same content already stored.
+				Tmp.remove();
+				return true;
+			}
+			Poco::File(Poco::Path(Target.path()).parent()).createDirectories();
+			Tmp.renameTo(Target.path());
+			return true;
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		} catch (const std::exception &E) {
+			poco_warning(Logger(), fmt::format("Could not store '{}': {}", TmpFile, E.what()));
+		}
+		RemoveIncoming(TmpFile);
+		return false;
+	}
+
+	void FileUploader::RemoveStoredFile(const std::string &Hash) {
+		if (Hash.size() < 2)
+			return;
+		try {
+			Poco::File Stored(StoredFile(Hash));
+			if (Stored.exists())
+				Stored.remove();
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+	}
+
 	class FileUploaderPartHandler2 : public Poco::Net::PartHandler {
 	  public:
 		FileUploaderPartHandler2(std::string Id, Poco::Logger &Logger, std::stringstream &ofs)
@@ -199,6 +308,7 @@ namespace OpenWifi {
 
 			poco_debug(Logger(), fmt::format("{}: Preparing to upload a file.", UUID_));
 			Poco::JSON::Object Answer;
+			std::string ErrorText{"Attached file is too large"};
 
 			try {
 				if (Poco::icompare(Tokens[0], "multipart/form-data") == 0 ||
@@ -218,18 +328,35 @@ namespace OpenWifi {
 
 							const auto PartContentType = Hdr.get("Content-Type", "");
 							if (PartContentType == "application/octet-stream") {
-								std::stringstream FileContent;
-								Poco::StreamCopier::copyStream(Reader.stream(), FileContent);
+								std::string TmpFile, Hash;
+								std::uint64_t Size = 0;
+								if (!FileUploader()->ReceiveFile(Reader.stream(), TmpFile, Hash,
+																 Size))
+									break;
+								bool Attached;
+								{
+									std::lock_guard G(FileUploader()->StoreMutex());
+									if (!FileUploader()->CommitFile(TmpFile, Hash))
+										break;
+									Attached = StorageService()->AttachFileDataToCommand(
+										UUID_, Hash, Size, Type_);
+								}
+								if (!Attached) {
+									//	the stored file goes unless another upload uses it.
+									ErrorText = "Attached file could not be recorded";
+									Poco::Data::Session Sess = StorageService()->StartSession();
+									StorageService()->ReleaseStoredFiles(Sess, {Hash});
+									break;
+								}
 								Answer.set("filename", UUID_);
 								Answer.set("error", 0);
-								poco_debug(Logger(), fmt::format("{}: File uploaded.", UUID_));
-								StorageService()->AttachFileDataToCommand(UUID_, FileContent,
-																		  Type_);
+								poco_debug(Logger(), fmt::format("{}: File uploaded. Size={}",
+																 UUID_, Size));
 								std::ostream &ResponseStream = Response.send();
 								Poco::JSON::Stringifier::stringify(Answer, ResponseStream);
 								return;
 							} else {
-								std::stringstream OO;
+								Poco::NullOutputStream OO;
 								Poco::StreamCopier::copyStream(Reader.stream(), OO);
 							}
 
@@ -249,7 +376,7 @@ namespace OpenWifi {
 			StorageService()->CancelWaitFile(UUID_, Error);
 			Answer.set("filename", UUID_);
 			Answer.set("error", 13);
-			Answer.set("errorText", "Attached file is too large");
+			Answer.set("errorText", ErrorText);
 			StorageService()->CancelWaitFile(UUID_, Error);
 			std::ostream &ResponseStream = Response.send();
 			Poco::JSON::Stringifier::stringify(Answer, ResponseStream);
@@ -44,13 +44,31 @@ namespace OpenWifi {
 
 		bool Find(const std::string &UUID, UploadId &V);
 
+		//	Content addressed store: files are named after the SHA-256 of their content, so
+		//	identical uploads share one file and the database only keeps the hash. ReceiveFile and
+		//	CommitFile remove TmpFile when they fail.
+		bool ReceiveFile(std::istream &In, std::string &TmpFile, std::string &Hash,
+						 std::uint64_t &Size);
+		//	Both need StoreMutex() held, so that a file is never removed while a new row starts
+		//	referencing it.
+		bool CommitFile(const std::string &TmpFile, const std::string &Hash);
+		void RemoveStoredFile(const std::string &Hash);
+		[[nodiscard]] std::string StoredFile(const std::string &Hash) const;
+		inline std::mutex &StoreMutex() { return StoreMutex_; }
+
 	  private:
 		std::vector<std::unique_ptr<Poco::Net::HTTPServer>> Servers_;
 		std::string FullName_;
 		std::list<UploadId> OutStandingUploads_;
 		std::string Path_;
+		std::string StorePath_;
+		std::string IncomingPath_;
+		std::mutex StoreMutex_;
 		uint64_t MaxSize_ = 10000000;
 
+		//	Never throws, it runs on error paths.
+		void RemoveIncoming(const std::string &TmpFile);
+
 		explicit FileUploader() noexcept
 			: SubSystemServer("FileUploader", "FILE-UPLOAD", "openwifi.fileuploader") {}
 	};
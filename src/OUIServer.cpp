@@ -5,7 +5,9 @@
 #include <thread>
 #include <vector>
 
+#include "Poco/BinaryReader.h"
 #include "Poco/File.h"
+#include "Poco/MemoryStream.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/String.h"
 #include "Poco/StringTokenizer.h"
@@ -17,6 +19,7 @@
 #include "fmt/format.h"
 
 #include "OUIServer.h"
+#include "WarmStart.h"
 
 namespace OpenWifi {
 
@@ -25,11 +28,16 @@ namespace OpenWifi {
 		LatestOUIFileName_ = MicroServiceDataDirectory() + "/newOUIFile.txt";
 		CurrentOUIFileName_ = MicroServiceDataDirectory() + "/current_oui.txt";
 
-		bool Recovered = false;
+		WarmStart()->Register("oui", [this](Poco::BinaryWriter &W) { Save(W); });
+
+		bool Recovered = false, FromSnapshot = false;
 		Poco::File OuiFile(CurrentOUIFileName_);
 		if (OuiFile.exists()) {
 			std::lock_guard Lock(LocalMutex_);
-			Recovered = ProcessFile(CurrentOUIFileName_, OUIs_);
+			FromSnapshot = Recovered = Load(WarmStart()->Section("oui"),
+											OuiFile.getLastModified().epochMicroseconds());
+			if (!Recovered)
+				Recovered = ProcessFile(CurrentOUIFileName_, OUIs_);
 			if (Recovered) {
 				poco_notice(Logger(),
 							fmt::format("Recovered last OUI file - {}", CurrentOUIFileName_));
@@ -37,6 +45,7 @@ namespace OpenWifi {
 		} else {
 			poco_notice(Logger(), fmt::format("No existing OUIFile.", CurrentOUIFileName_));
 		}
+		WarmStart()->Ready("oui", FromSnapshot);
 
 		UpdaterCallBack_ =
 			std::make_unique<Poco::TimerCallback<OUIServer>>(*this, &OUIServer::onTimer);
@@ -57,6 +66,47 @@ namespace OpenWifi {
 		poco_notice(Logger(), "Stopped...");
 	}
 
+	bool OUIServer::Load(std::string_view Section, Poco::Int64 Modified) {
+		if (Section.empty())
+			return false;
+		try {
+			Poco::MemoryInputStream IS(Section.data(), Section.size());
+			Poco::BinaryReader R(IS);
+			Poco::Int64 SourceModified = 0;
+			Poco::UInt32 Count = 0;
+			R >> SourceModified;
+			if (SourceModified != Modified)
+				return false;
+			R.read7BitEncoded(Count);
+			OUIMap Map;
+			for (Poco::UInt32 i = 0; i < Count && R.good(); ++i) {
+				Poco::UInt64 OUI = 0;
+				std::string Manufacturer;
+				R >> OUI >> Manufacturer;
+				Map.emplace_hint(Map.end(), OUI, std::move(Manufacturer));
+			}
+			if (!R.good() || Map.empty() || Map.size() != Count)
+				return false;
+			OUIs_ = std::move(Map);
+			return true;
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+		return false;
+	}
+
+	void OUIServer::Save(Poco::BinaryWriter &W) {
+		Poco::Int64 Modified = 0;
+		Poco::File Current(CurrentOUIFileName_);
+		if (Current.exists())
+			Modified = Current.getLastModified().epochMicroseconds();
+		std::lock_guard Lock(LocalMutex_);
+		W << Modified;
+		W.write7BitEncoded((Poco::UInt32)OUIs_.size());
+		for (const auto &[OUI, Manufacturer] : OUIs_)
+			W << (Poco::UInt64)OUI << Manufacturer;
+	}
+
 	void OUIServer::reinitialize([[maybe_unused]] Poco::Util::Application &self) {
 		MicroServiceLoadConfigurationFile();
 		poco_information(Logger(), "Reinitializing.");
@@ -6,8 +6,11 @@
 
 #include <mutex>
 
+#include <string_view>
+
 #include "framework/SubSystemServer.h"
 
+#include "Poco/BinaryWriter.h"
 #include "Poco/Timer.h"
 
 namespace OpenWifi {
@@ -42,6 +45,10 @@ namespace OpenWifi {
 		std::unique_ptr<Poco::TimerCallback<OUIServer>> UpdaterCallBack_;
 		std::string LatestOUIFileName_, CurrentOUIFileName_;
 
+		//	The snapshot holds the parsed map with the modification time of the file it came from.
+		bool Load(std::string_view Section, Poco::Int64 Modified);
+		void Save(Poco::BinaryWriter &W);
+
 		OUIServer() noexcept : SubSystemServer("OUIServer", "OUI-SVR", "ouiserver") {}
 	};
 
@@ -9,10 +9,23 @@
 #include "RADIUS_proxy_server.h"
 
 #include "RADIUSSessionTracker.h"
+#include "framework/MetricsRegistry.h"
 #include "framework/MicroServiceFuncs.h"
 
 namespace OpenWifi {
 
+	static MetricCounter &RadiusPackets(const char *Type, const char *Result) {
+		return MetricsRegistry()->Counter("owgw_radius_packets_total",
+										  "RADIUS packets from devices, by type and outcome.",
+										  {{"type", Type}, {"result", Result}});
+	}
+	static auto &AuthProxied = RadiusPackets("auth", "proxied");
+	static auto &AuthDropped = RadiusPackets("auth", "dropped");
+	static auto &AcctProxied = RadiusPackets("acct", "proxied");
+	static auto &AcctDropped = RadiusPackets("acct", "dropped");
+	static auto &CoAProxied = RadiusPackets("coa", "proxied");
+	static auto &CoADropped = RadiusPackets("coa", "dropped");
+
 /*
  	const int SMALLEST_RADIUS_PACKET = 20 + 19 + 4;
 	const int DEFAULT_RADIUS_AUTHENTICATION_PORT = 1812;
@@ -110,10 +123,15 @@ namespace OpenWifi {
 					DestinationServer->second->SendRadiusDataAcctData(
 						serialNumber, (const unsigned char *)P.Buffer(), P.Size());
 				}
+				AcctProxied.Inc();
+				return;
 			}
+			AcctDropped.Inc();
 		} catch (const Poco::Exception &E) {
+			AcctDropped.Inc();
 			Logger().log(E);
 		} catch (...) {
+			AcctDropped.Inc();
 			poco_warning(Logger(),
 						 fmt::format("Bad RADIUS ACCT Packet from {}. Dropped.", serialNumber));
 		}
@@ -187,10 +205,15 @@ namespace OpenWifi {
 					DestinationServer->second->SendRadiusDataAuthData(
 						serialNumber, (const unsigned char *)buffer, size);
 				}
+				AuthProxied.Inc();
+				return;
 			}
+			AuthDropped.Inc();
 		} catch (const Poco::Exception &E) {
+			AuthDropped.Inc();
 			Logger().log(E);
 		} catch (...) {
+			AuthDropped.Inc();
 			poco_warning(Logger(),
 						 fmt::format("Bad RADIUS AUTH Packet from {}. Dropped.", serialNumber));
 		}
@@ -220,10 +243,15 @@ namespace OpenWifi {
 					DestinationServer->second->SendRadiusDataCoAData(
 						serialNumber, (const unsigned char *)buffer, size);
 				}
+				CoAProxied.Inc();
+				return;
 			}
+			CoADropped.Inc();
 		} catch (const Poco::Exception &E) {
+			CoADropped.Inc();
 			Logger().log(E);
 		} catch (...) {
+			CoADropped.Inc();
 			poco_warning(Logger(),
 						 fmt::format("Bad RADIUS AUTH Packet from {}. Dropped.", serialNumber));
 		}
@@ -17,6 +17,16 @@ namespace OpenWifi {
 		if (QB_.CountOnly) {
 			auto Count = StorageService()->GetBlackListDeviceCount();
 			return ReturnCountOnly(Count);
+		} else if (QB_.UseCursor) {
+			StorageCursor Cursor;
+			if (!Cursor.Decode(QB_.Cursor))
+				return BadRequest(RESTAPI::Errors::InvalidCursor);
+			if (StorageService()->GetBlackListDevices(Cursor, QB_.Limit, Devices)) {
+				Poco::JSON::Object Answer;
+				RESTAPI_utils::field_to_json(Answer, "devices", Devices);
+				Answer.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Encode());
+				return ReturnObject(Answer);
+			}
 		} else if (StorageService()->GetBlackListDevices(QB_.Offset, QB_.Limit, Devices)) {
 			return Object("devices", Devices);
 		}
@@ -17,13 +17,19 @@ namespace OpenWifi {
 			return BadRequest(RESTAPI::Errors::MissingSerialNumber);
 		}
 
-		std::vector<GWObjects::CommandDetails> Commands;
-		if (QB_.Newest) {
-			StorageService()->GetNewestCommands(SerialNumber, QB_.Limit, Commands);
-		} else {
-			StorageService()->GetCommands(SerialNumber, QB_.StartDate, QB_.EndDate, QB_.Offset,
-										  QB_.Limit, Commands);
+		if (!QB_.Newest) {
+			return StreamList(RESTAPI::Protocol::COMMANDS, [&](JSONListWriter &Writer) {
+				return StorageService()->StreamCommands(
+					SerialNumber, QB_.StartDate, QB_.EndDate, QB_.Offset, QB_.Limit,
+					[&Writer](const GWObjects::CommandDetails &C) {
+						Writer.Add(C);
+						return true;
+					});
+			});
 		}
+
+		std::vector<GWObjects::CommandDetails> Commands;
+		StorageService()->GetNewestCommands(SerialNumber, QB_.Limit, Commands);
 		return Object(RESTAPI::Protocol::COMMANDS, Commands);
 	}
 
@@ -265,6 +265,7 @@ namespace OpenWifi {
 		}
 
 		std::vector<GWObjects::Statistics> Stats;
+		StorageCursor Cursor;
 		if (QB_.Newest) {
 			StorageService()->GetNewestStatisticsData(SerialNumber_, QB_.Limit, Stats);
 		} else {
@@ -277,8 +278,26 @@ namespace OpenWifi {
 			if (QB_.Limit > 100)
 				QB_.Limit = 100;
 
-			StorageService()->GetStatisticsData(SerialNumber_, QB_.StartDate, QB_.EndDate,
-												QB_.Offset, QB_.Limit, Stats);
+			if (!QB_.UseCursor) {
+				//	statistics payloads are large: send each one as it is read.
+				Poco::JSON::Object Trailer;
+				Trailer.set(RESTAPI::Protocol::SERIALNUMBER, SerialNumber_);
+				return StreamList(
+					RESTAPI::Protocol::DATA,
+					[&](JSONListWriter &Writer) {
+						return StorageService()->StreamStatisticsData(
+							SerialNumber_, QB_.StartDate, QB_.EndDate, QB_.Offset, QB_.Limit,
+							[&Writer](const GWObjects::Statistics &S) {
+								Writer.Add(S);
+								return true;
+							});
+					},
+					Trailer);
+			}
+			if (!Cursor.Decode(QB_.Cursor))
+				return BadRequest(RESTAPI::Errors::InvalidCursor);
+			StorageService()->GetStatisticsData(SerialNumber_, QB_.StartDate, QB_.EndDate, Cursor,
+												QB_.Limit, Stats);
 		}
 
 		Poco::JSON::Array::Ptr ArrayObj = Poco::SharedPtr<Poco::JSON::Array>(new Poco::JSON::Array);
@@ -292,6 +311,8 @@ namespace OpenWifi {
 		Poco::JSON::Object RetObj;
 		RetObj.set(RESTAPI::Protocol::DATA, ArrayObj);
 		RetObj.set(RESTAPI::Protocol::SERIALNUMBER, SerialNumber_);
+		if (QB_.UseCursor && !QB_.Newest)
+			RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Encode());
 		return ReturnObject(RetObj);
 	}
 
@@ -328,11 +349,29 @@ namespace OpenWifi {
 				   fmt::format("GET-LOGS: TID={} user={} serial={}. thr_id={}", TransactionId_,
 							   Requester(), SerialNumber_, Poco::Thread::current()->id()));
 		std::vector<GWObjects::DeviceLog> Logs;
+		StorageCursor Cursor;
 		if (QB_.Newest) {
 			StorageService()->GetNewestLogData(SerialNumber_, QB_.Limit, Logs, QB_.LogType);
-		} else {
-			StorageService()->GetLogData(SerialNumber_, QB_.StartDate, QB_.EndDate, QB_.Offset,
+		} else if (QB_.UseCursor) {
+			if (!Cursor.Decode(QB_.Cursor))
+				return BadRequest(RESTAPI::Errors::InvalidCursor);
+			StorageService()->GetLogData(SerialNumber_, QB_.StartDate, QB_.EndDate, Cursor,
 										 QB_.Limit, Logs, QB_.LogType);
+		} else {
+			Poco::JSON::Object Trailer;
+			Trailer.set(RESTAPI::Protocol::SERIALNUMBER, SerialNumber_);
+			return StreamList(
+				RESTAPI::Protocol::VALUES,
+				[&](JSONListWriter &Writer) {
+					return StorageService()->StreamLogData(
+						SerialNumber_, QB_.StartDate, QB_.EndDate, QB_.Offset, QB_.Limit,
+						[&Writer](const GWObjects::DeviceLog &L) {
+							Writer.Add(L);
+							return true;
+						},
+						QB_.LogType);
+				},
+				Trailer);
 		}
 
 		Poco::JSON::Array ArrayObj;
@@ -344,6 +383,8 @@ namespace OpenWifi {
 		Poco::JSON::Object RetObj;
 		RetObj.set(RESTAPI::Protocol::VALUES, ArrayObj);
 		RetObj.set(RESTAPI::Protocol::SERIALNUMBER, SerialNumber_);
+		if (QB_.UseCursor && !QB_.Newest)
+			RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Encode());
 		ReturnObject(RetObj);
 	}
 
@@ -374,8 +415,14 @@ namespace OpenWifi {
 			}
 		} else {
 			std::vector<GWObjects::HealthCheck> Checks;
+			StorageCursor Cursor;
 			if (QB_.Newest) {
 				StorageService()->GetNewestHealthCheckData(SerialNumber_, QB_.Limit, Checks);
+			} else if (QB_.UseCursor) {
+				if (!Cursor.Decode(QB_.Cursor))
+					return BadRequest(RESTAPI::Errors::InvalidCursor);
+				StorageService()->GetHealthCheckData(SerialNumber_, QB_.StartDate, QB_.EndDate,
+													 Cursor, QB_.Limit, Checks);
 			} else {
 				StorageService()->GetHealthCheckData(SerialNumber_, QB_.StartDate, QB_.EndDate,
 													 QB_.Offset, QB_.Limit, Checks);
@@ -391,6 +438,8 @@ namespace OpenWifi {
 			Poco::JSON::Object RetObj;
 			RetObj.set(RESTAPI::Protocol::VALUES, ArrayObj);
 			RetObj.set(RESTAPI::Protocol::SERIALNUMBER, SerialNumber_);
+			if (QB_.UseCursor && !QB_.Newest)
+				RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Encode());
 			ReturnObject(RetObj);
 		}
 	}
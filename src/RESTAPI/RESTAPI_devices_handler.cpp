@@ -77,11 +77,17 @@ namespace OpenWifi {
 
 		std::string OrderBy{" ORDER BY serialNumber ASC "}, Arg;
 		if (HasParameter("orderBy", Arg)) {
-			if (!PrepareOrderBy(Arg, OrderBy)) {
+			//	keyset pages always follow the serial number order.
+			if (QB_.UseCursor || !PrepareOrderBy(Arg, OrderBy)) {
 				return BadRequest(RESTAPI::Errors::InvalidLOrderBy);
 			}
 		}
 
+		StorageCursor Cursor;
+		if (QB_.UseCursor && !Cursor.Decode(QB_.Cursor)) {
+			return BadRequest(RESTAPI::Errors::InvalidCursor);
+		}
+
 		auto platform = Poco::toLower(GetParameter("platform", ""));
 		auto serialOnly = GetBoolParameter(RESTAPI::Protocol::SERIALONLY, false);
 		auto deviceWithStatus = GetBoolParameter(RESTAPI::Protocol::DEVICEWITHSTATUS, false);
@@ -132,7 +138,12 @@ namespace OpenWifi {
 			}
 		} else if (serialOnly) {
 			std::vector<std::string> SerialNumbers;
-			StorageService()->GetDeviceSerialNumbers(QB_.Offset, QB_.Limit, SerialNumbers, OrderBy, platform, includeProvisioned);
+			if (QB_.UseCursor) {
+				StorageService()->GetDeviceSerialNumbers(Cursor, QB_.Limit, SerialNumbers, platform, includeProvisioned);
+				RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Encode());
+			} else {
+				StorageService()->GetDeviceSerialNumbers(QB_.Offset, QB_.Limit, SerialNumbers, OrderBy, platform, includeProvisioned);
+			}
 			Poco::JSON::Array Objects;
 			for (const auto &i : SerialNumbers) {
 				Objects.add(i);
@@ -148,9 +159,28 @@ namespace OpenWifi {
 			for(const auto &s:SerialNumbers)
 				Objects.add(s);
 			RetObj.set("serialNumbers", Objects);
+		} else if (!QB_.UseCursor) {
+			//	offset pages can be large: rows go out as they are read.
+			return StreamList(deviceWithStatus ? RESTAPI::Protocol::DEVICESWITHSTATUS
+											   : RESTAPI::Protocol::DEVICES,
+							  [&](JSONListWriter &Writer) {
+								  return StorageService()->StreamDevices(
+									  QB_.Offset, QB_.Limit,
+									  [&](const GWObjects::Device &D) {
+										  Poco::JSON::Object Obj;
+										  if (deviceWithStatus)
+											  D.to_json_with_status(Obj);
+										  else
+											  D.to_json(Obj);
+										  Writer.Add(Obj);
+										  return true;
+									  },
+									  OrderBy, platform, includeProvisioned);
+							  });
 		} else {
 			std::vector<GWObjects::Device> Devices;
-			StorageService()->GetDevices(QB_.Offset, QB_.Limit, Devices, OrderBy, platform, includeProvisioned);
+			StorageService()->GetDevices(Cursor, QB_.Limit, Devices, platform, includeProvisioned);
+			RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Encode());
 			Poco::JSON::Array Objects;
 			for (const auto &i : Devices) {
 				Poco::JSON::Object Obj;
@@ -21,22 +21,38 @@ namespace OpenWifi {
 		auto SerialNumber = GetParameter(RESTAPI::Protocol::SERIALNUMBER, "");
 
 		std::string FileType;
+		std::string FileHash;
 		std::string FileContent;
-		if (!StorageService()->GetAttachedFileContent(UUID, SerialNumber, FileContent, FileType) || FileContent.empty()) {
+		if (!StorageService()->GetAttachedFile(UUID, SerialNumber, FileHash, FileContent, FileType)) {
 			return NotFound();
 		}
+
+		std::string Name;
 		if (FileType == "pcap") {
-			SendFileContent(FileContent, "application/vnd.tcpdump.pcap", UUID + ".pcap");
+			Name = UUID + ".pcap";
 		}
 		else if (FileType == "tgz" ) {
-			SendFileContent(FileContent, "application/gzip", UUID + ".tgz");
+			Name = UUID + ".tgz";
 		}
 		else if (FileType == "txt") {
-			SendFileContent(FileContent, "txt/plain", UUID + ".txt");
+			Name = UUID + ".txt";
 		}
 		else {
-			SendFileContent(FileContent, "application/octet-stream", UUID + ".bin");
+			Name = UUID + ".bin";
+		}
+
+		if (!FileHash.empty()) {
+			Poco::File Stored(FileUploader()->StoredFile(FileHash));
+			if (!Stored.exists()) {
+				return NotFound();
+			}
+			return SendNamedFile(Stored, Name);
+		}
+
+		if (FileContent.empty()) {
+			return NotFound();
 		}
+		SendFileContent(FileContent, FileType, Name);
 	}
 
 	void RESTAPI_file::DoDelete() {
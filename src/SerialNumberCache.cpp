@@ -2,31 +2,130 @@
 // Created by stephane bourque on 2021-08-11.
 //
 
+#include <cstring>
 #include <mutex>
 
+#include "fmt/format.h"
+
 #include "SerialNumberCache.h"
 #include "StorageService.h"
+#include "WarmStart.h"
 #include "framework/utils.h"
 
 namespace OpenWifi {
 
+	//	devices created shortly before the snapshot was taken may not have been in it.
+	static constexpr uint64_t SnapshotSlack = 5 * 60;
+
 	int SerialNumberCache::Start() {
 		poco_notice(Logger(), "Starting...");
-		StorageService()->UpdateSerialNumberCache();
+		WarmStart()->Register("serials", [this](Poco::BinaryWriter &W) { Save(W); });
+		auto FromSnapshot = Load(WarmStart()->Section("serials"));
+		if (FromSnapshot) {
+			auto Since = WarmStart()->Created();
+			std::vector<uint64_t> Added;
+			StorageService()->GetSerialNumbers(Added, Since > SnapshotSlack ? Since - SnapshotSlack : 0);
+			Update(std::move(Added));
+			//	deletions, and creations the slack did not cover, are only in the database.
+			{
+				std::lock_guard G(Mutex_);
+				Reconciling_ = true;
+			}
+			Reconciler_ = std::thread([this] { Reconcile(); });
+		} else {
+			StorageService()->UpdateSerialNumberCache();
+		}
+		WarmStart()->Ready("serials", FromSnapshot);
 		return 0;
 	}
 
 	void SerialNumberCache::Stop() {
 		poco_notice(Logger(), "Stopping...");
-		SNs_.clear();
-		Reverse_SNs_.clear();
+		if (Reconciler_.joinable())
+			Reconciler_.join();
+		//	the numbers are kept, WarmStart saves them once every subsystem has stopped.
 		poco_notice(Logger(), "Stopped...");
 	}
 
+	bool SerialNumberCache::Load(std::string_view Section) {
+		uint64_t Count = 0;
+		if (Section.size() < sizeof(Count))
+			return false;
+		std::memcpy(&Count, Section.data(), sizeof(Count));
+		if (Section.size() != sizeof(Count) + 2 * Count * sizeof(uint64_t)) {
+			poco_warning(Logger(), "Serial number snapshot has the wrong size.");
+			return false;
+		}
+		std::vector<uint64_t> SNs(Count), Reverse_SNs(Count);
+		std::memcpy(SNs.data(), Section.data() + sizeof(Count), Count * sizeof(uint64_t));
+		std::memcpy(Reverse_SNs.data(), Section.data() + sizeof(Count) + Count * sizeof(uint64_t),
+					Count * sizeof(uint64_t));
+		if (!std::is_sorted(SNs.begin(), SNs.end()) ||
+			!std::is_sorted(Reverse_SNs.begin(), Reverse_SNs.end())) {
+			poco_warning(Logger(), "Serial number snapshot is not sorted.");
+			return false;
+		}
+		std::lock_guard G(Mutex_);
+		SNs_ = std::move(SNs);
+		Reverse_SNs_ = std::move(Reverse_SNs);
+		poco_notice(Logger(), fmt::format("Loaded {} serial numbers from the snapshot.", Count));
+		return true;
+	}
+
+	void SerialNumberCache::Save(Poco::BinaryWriter &W) {
+		std::lock_guard G(Mutex_);
+		W << (Poco::UInt64)SNs_.size();
+		W.writeRaw((const char *)SNs_.data(), SNs_.size() * sizeof(uint64_t));
+		W.writeRaw((const char *)Reverse_SNs_.data(), Reverse_SNs_.size() * sizeof(uint64_t));
+	}
+
+	//	Brings the cache loaded from the snapshot in line with the database. Devices created or
+	//	deleted while the list is read are recorded in Touched_ and left as they are, the diff is
+	//	taken against the live cache under the lock.
+	void SerialNumberCache::Reconcile() {
+		Utils::SetThreadName("sncache-sync");
+		std::vector<uint64_t> Database;
+		if (!StorageService()->GetSerialNumbers(Database)) {
+			std::lock_guard G(Mutex_);
+			Reconciling_ = false;
+			Touched_.clear();
+			return;
+		}
+		std::sort(Database.begin(), Database.end());
+		Database.erase(std::unique(Database.begin(), Database.end()), Database.end());
+
+		std::lock_guard G(Mutex_);
+		std::vector<uint64_t> Missing, Stale, Remaining;
+		std::set_difference(Database.begin(), Database.end(), SNs_.begin(), SNs_.end(),
+							std::back_inserter(Missing));
+		std::set_difference(SNs_.begin(), SNs_.end(), Database.begin(), Database.end(),
+							std::back_inserter(Stale));
+		auto Touched = [this](uint64_t SN) { return Touched_.find(SN) != Touched_.end(); };
+		Missing.erase(std::remove_if(Missing.begin(), Missing.end(), Touched), Missing.end());
+		Stale.erase(std::remove_if(Stale.begin(), Stale.end(), Touched), Stale.end());
+		Reconciling_ = false;
+		Touched_.clear();
+		poco_notice(Logger(), fmt::format("Reconciled: {} serial numbers added, {} stale removed.",
+										  Missing.size(), Stale.size()));
+		if (Missing.empty() && Stale.empty())
+			return;
+		Remaining.reserve(SNs_.size() + Missing.size());
+		std::set_difference(SNs_.begin(), SNs_.end(), Stale.begin(), Stale.end(),
+							std::back_inserter(Remaining));
+		std::vector<uint64_t> Merged;
+		Merged.reserve(Remaining.size() + Missing.size());
+		std::merge(Remaining.begin(), Remaining.end(), Missing.begin(), Missing.end(),
+				   std::back_inserter(Merged));
+		SNs_ = std::move(Merged);
+		RebuildReverse();
+	}
+
 	void SerialNumberCache::AddSerialNumber(const std::string &S) {
 		std::lock_guard G(Mutex_);
 
 		uint64_t SN = std::stoull(S, nullptr, 16);
+		if (Reconciling_)
+			Touched_.insert(SN);
 		if (std::find(std::begin(SNs_), std::end(SNs_), SN) == std::end(SNs_)) {
 			auto insert_point = std::lower_bound(SNs_.begin(), SNs_.end(), SN);
 			SNs_.insert(insert_point, SN);
@@ -42,6 +141,8 @@ namespace OpenWifi {
 		std::lock_guard G(Mutex_);
 
 		uint64_t SN = std::stoull(S, nullptr, 16);
+		if (Reconciling_)
+			Touched_.insert(SN);
 		auto It = std::find(SNs_.begin(), SNs_.end(), SN);
 		if (It != SNs_.end()) {
 			SNs_.erase(It);
@@ -66,6 +167,42 @@ namespace OpenWifi {
 		return Res;
 	}
 
+	void SerialNumberCache::RebuildReverse() {
+		Reverse_SNs_.resize(SNs_.size());
+		std::transform(SNs_.begin(), SNs_.end(), Reverse_SNs_.begin(), Reverse);
+		std::sort(Reverse_SNs_.begin(), Reverse_SNs_.end());
+	}
+
+	void SerialNumberCache::Assign(std::vector<uint64_t> SerialNumbers) {
+		std::sort(SerialNumbers.begin(), SerialNumbers.end());
+		SerialNumbers.erase(std::unique(SerialNumbers.begin(), SerialNumbers.end()),
+							SerialNumbers.end());
+		std::lock_guard G(Mutex_);
+		SNs_ = std::move(SerialNumbers);
+		RebuildReverse();
+	}
+
+	void SerialNumberCache::Update(std::vector<uint64_t> Add, std::vector<uint64_t> Remove) {
+		if (Add.empty() && Remove.empty())
+			return;
+		std::sort(Add.begin(), Add.end());
+		std::sort(Remove.begin(), Remove.end());
+		std::lock_guard G(Mutex_);
+		if (Reconciling_) {
+			Touched_.insert(Add.begin(), Add.end());
+			Touched_.insert(Remove.begin(), Remove.end());
+		}
+		std::vector<uint64_t> Merged, Remaining;
+		Merged.reserve(SNs_.size() + Add.size());
+		std::set_union(SNs_.begin(), SNs_.end(), Add.begin(), Add.end(), std::back_inserter(Merged));
+		Merged.erase(std::unique(Merged.begin(), Merged.end()), Merged.end());
+		Remaining.reserve(Merged.size());
+		std::set_difference(Merged.begin(), Merged.end(), Remove.begin(), Remove.end(),
+							std::back_inserter(Remaining));
+		SNs_ = std::move(Remaining);
+		RebuildReverse();
+	}
+
 	void SerialNumberCache::ReturnNumbers(const std::string &S, uint HowMany,
 										  const std::vector<uint64_t> &SNArr,
 										  std::vector<uint64_t> &A, bool ReverseResult) {
@@ -4,6 +4,12 @@
 
 #pragma once
 
+#include <set>
+#include <string_view>
+#include <thread>
+
+#include "Poco/BinaryWriter.h"
+
 #include "framework/SubSystemServer.h"
 
 namespace OpenWifi {
@@ -18,6 +24,9 @@ namespace OpenWifi {
 		void Stop() override;
 		void AddSerialNumber(const std::string &SerialNumber);
 		void DeleteSerialNumber(const std::string &SerialNumber);
+		//	Bulk changes, sorted once rather than one insertion at a time.
+		void Assign(std::vector<uint64_t> SerialNumbers);
+		void Update(std::vector<uint64_t> Add, std::vector<uint64_t> Remove = {});
 		void FindNumbers(const std::string &SerialNumber, uint HowMany, std::vector<uint64_t> &A);
 		inline bool NumberExists(uint64_t SerialNumber) {
 			std::lock_guard G(Mutex_);
@@ -33,6 +42,15 @@ namespace OpenWifi {
 	  private:
 		std::vector<uint64_t> SNs_;
 		std::vector<uint64_t> Reverse_SNs_;
+		std::thread Reconciler_;
+		//	set while Reconcile reads the database, with the numbers changed meanwhile.
+		bool Reconciling_ = false;
+		std::set<uint64_t> Touched_;
+
+		bool Load(std::string_view Section);
+		void Save(Poco::BinaryWriter &W);
+		void Reconcile();
+		void RebuildReverse();
 
 		void ReturnNumbers(const std::string &S, uint HowMany, const std::vector<uint64_t> &SNArr,
 						   std::vector<uint64_t> &A, bool ReverseResult);
@@ -0,0 +1,116 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+#include "Poco/JSON/Object.h"
+
+namespace OpenWifi {
+
+	//	Image signatures by file hash. The first request for a hash computes the signature,
+	//	requests for the same hash that arrive meanwhile wait for that result, and requests for
+	//	other hashes go on in parallel. Failures, an empty signature, are not cached.
+	class SignatureCache {
+	  public:
+		inline void Set(const std::string &FileHash, const std::string &Signature) {
+			std::unique_lock L(Mutex_);
+			Signatures_[FileHash] = Signature;
+		}
+
+		//	Returns the cached signature or the one Compute() returns. Added tells whether this
+		//	call computed a new signature, which the caller may want to persist.
+		template <typename F>
+		inline std::string Get(const std::string &FileHash, F Compute, bool &Added) {
+			Added = false;
+			{
+				std::shared_lock L(Mutex_);
+				auto Entry = Signatures_.find(FileHash);
+				if (Entry != end(Signatures_)) {
+					Hits_++;
+					return Entry->second;
+				}
+			}
+
+			std::promise<std::string> Result;
+			{
+				std::unique_lock L(Mutex_);
+				auto Entry = Signatures_.find(FileHash);
+				if (Entry != end(Signatures_)) {
+					Hits_++;
+					return Entry->second;
+				}
+				auto Pending = InFlight_.find(FileHash);
+				if (Pending != end(InFlight_)) {
+					auto Signature = Pending->second;
+					L.unlock();
+					Joined_++;
+					return Signature.get();
+				}
+				InFlight_[FileHash] = Result.get_future().share();
+			}
+
+			std::string Signature;
+			try {
+				Signature = Compute();
+			} catch (...) {
+				Finish(FileHash, Result, Signature);
+				throw;
+			}
+			Finish(FileHash, Result, Signature);
+			Added = !Signature.empty();
+			return Signature;
+		}
+
+		inline void GetStatistics(Poco::JSON::Object &Stats) const {
+			{
+				std::shared_lock L(Mutex_);
+				Stats.set("cached", Signatures_.size());
+				Stats.set("inFlight", InFlight_.size());
+			}
+			Stats.set("signed", Signed_.load());
+			Stats.set("cacheHits", Hits_.load());
+			Stats.set("joined", Joined_.load());
+			Stats.set("failures", Failures_.load());
+		}
+
+		[[nodiscard]] inline std::size_t size() const {
+			std::shared_lock L(Mutex_);
+			return Signatures_.size();
+		}
+		[[nodiscard]] inline std::uint64_t Signed() const { return Signed_.load(); }
+		[[nodiscard]] inline std::uint64_t Hits() const { return Hits_.load(); }
+		[[nodiscard]] inline std::uint64_t Joined() const { return Joined_.load(); }
+		[[nodiscard]] inline std::uint64_t Failures() const { return Failures_.load(); }
+
+	  private:
+		mutable std::shared_mutex Mutex_;
+		std::map<std::string, std::string> Signatures_;
+		std::map<std::string, std::shared_future<std::string>> InFlight_;
+		std::atomic_uint64_t Signed_ = 0, Hits_ = 0, Joined_ = 0, Failures_ = 0;
+
+		inline void Finish(const std::string &FileHash, std::promise<std::string> &Result,
+						   const std::string &Signature) {
+			{
+				std::unique_lock L(Mutex_);
+				if (!Signature.empty())
+					Signatures_[FileHash] = Signature;
+				InFlight_.erase(FileHash);
+			}
+			Result.set_value(Signature);
+			if (Signature.empty())
+				Failures_++;
+			else
+				Signed_++;
+		}
+	};
+
+} // namespace OpenWifi
@@ -7,6 +7,7 @@
 #include <fstream>
 #include <mutex>
 
+#include "SignatureCache.h"
 #include "framework/MicroServiceFuncs.h"
 #include "framework/SubSystemServer.h"
 #include "framework/utils.h"
@@ -17,7 +18,6 @@
 #include "Poco/File.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/StringTokenizer.h"
-#include "Poco/TemporaryFile.h"
 #include "RESTObjects/RESTAPI_GWobjects.h"
 #include "fmt/format.h"
 
@@ -38,8 +38,6 @@ namespace OpenWifi {
 		inline int Start() final {
 			poco_notice(Logger(), "Starting...");
 
-			std::lock_guard L(KeyMutex_);
-
 			CacheFilename_ = MicroServiceDataDirectory() + "/signature_cache";
 			Poco::File CacheFile(CacheFilename_);
 
@@ -49,12 +47,12 @@ namespace OpenWifi {
 				while (std::getline(CacheFileContent, line)) {
 					auto Tokens = Poco::StringTokenizer(line, ":");
 					if (Tokens.count() == 2) {
-						SignatureCache_[Tokens[0]] = Tokens[1];
+						Cache_.Set(Tokens[0], Tokens[1]);
 					}
 				}
 			}
 			poco_information(Logger(), fmt::format("Found {} entries in signature cache.",
-												   SignatureCache_.size()));
+												   Cache_.size()));
 
 			// read all the key vendors.
 			//		signature.manager.0.key.public
@@ -91,7 +89,6 @@ namespace OpenWifi {
 
 		inline std::string Sign(const GWObjects::DeviceRestrictions &Restrictions,
 								const std::string &Data) const {
-			std::lock_guard L(KeyMutex_);
 			try {
 				if (Restrictions.key_info.algo == "static") {
 					return "aaaaaaaaaa";
@@ -118,9 +115,10 @@ namespace OpenWifi {
 			return "";
 		}
 
+		//	Keys_ does not change after Start(), so signing takes no lock. Cache_ makes sure one
+		//	request downloads and hashes an image while the others for it wait.
 		inline std::string Sign(const GWObjects::DeviceRestrictions &Restrictions,
 								const Poco::URI &uri) {
-			std::lock_guard L(KeyMutex_);
 			try {
 				if (Restrictions.key_info.algo == "static") {
 					return "aaaaaaaaaa";
@@ -137,25 +135,26 @@ namespace OpenWifi {
 					auto FileHash =
 						Utils::ComputeHash(Restrictions.key_info.vendor, Restrictions.key_info.algo,
 										   uri.getPathAndQuery());
-					auto CacheEntry = SignatureCache_.find(FileHash);
-					if (CacheEntry != end(SignatureCache_)) {
-						return CacheEntry->second;
-					}
-
-					Poco::TemporaryFile TempDownloadedFile;
-					if (Utils::wgetfile(uri, TempDownloadedFile.path())) {
-						Poco::Crypto::RSADigestEngine R(*Vendor->second, "SHA256");
-						Poco::DigestOutputStream ofs(R);
-						std::fstream ifs(TempDownloadedFile.path(),
-										 std::ios_base::in | std::ios_base::binary);
-						Poco::StreamCopier::copyStream(ifs, ofs);
-						ofs.flush();
-						auto Signature = Utils::base64encode(
-							(const unsigned char *)R.signature().data(), R.signature().size());
-						SignatureCache_[FileHash] = Signature;
-						SaveCache();
-						return Signature;
-					}
+					bool Added = false;
+					auto Signature = Cache_.Get(
+						FileHash,
+						[&]() -> std::string {
+							try {
+								return SignFile(*Vendor->second, uri);
+							} catch (const Poco::Exception &E) {
+								Logger().log(E);
+							} catch (const std::exception &E) {
+								poco_error(Logger(), fmt::format("Signing {} failed: {}",
+																 uri.toString(), E.what()));
+							}
+							return "";
+						},
+						Added);
+					if (Added)
+						AppendCache(FileHash, Signature);
+					else if (Signature.empty())
+						poco_warning(Logger(), fmt::format("Could not sign {}.", uri.toString()));
+					return Signature;
 				}
 			} catch (const Poco::Exception &E) {
 				Logger().log(E);
@@ -163,19 +162,32 @@ namespace OpenWifi {
 			return "";
 		}
 
-		void SaveCache() {
-			std::ofstream ofs(CacheFilename_, std::ios_base::trunc | std::ios_base::out);
-
-			for (const auto &[hash, signature] : SignatureCache_) {
-				ofs << hash << ":" << signature << std::endl;
-			}
+		//	Later lines win when the cache is read back, so new entries are only appended.
+		void AppendCache(const std::string &FileHash, const std::string &Signature) {
+			std::lock_guard L(FileMutex_);
+			std::ofstream ofs(CacheFilename_, std::ios_base::app | std::ios_base::out);
+			ofs << FileHash << ":" << Signature << std::endl;
 		}
 
+		inline void GetStatistics(Poco::JSON::Object &Stats) final { Cache_.GetStatistics(Stats); }
+
 	  private:
-		mutable std::mutex KeyMutex_;
 		std::map<std::string, Poco::SharedPtr<Poco::Crypto::RSAKey>> Keys_;
-		std::map<std::string, std::string> SignatureCache_;
+		SignatureCache Cache_;
+		std::mutex FileMutex_;
 		std::string CacheFilename_;
+
+		//	The image goes straight from the socket into the digest.
+		inline static std::string SignFile(Poco::Crypto::RSAKey &Key, const Poco::URI &uri) {
+			Poco::Crypto::RSADigestEngine R(Key, "SHA256");
+			Poco::DigestOutputStream ofs(R);
+			if (!Utils::wgetstream(uri, ofs)) {
+				return "";
+			}
+			ofs.flush();
+			return Utils::base64encode((const unsigned char *)R.signature().data(),
+									   R.signature().size());
+		}
 		explicit SignatureManager() noexcept
 			: SubSystemServer("SignatureManager", "SIGNATURE-MGR", "signature.manager") {}
 	};
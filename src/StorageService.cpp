@@ -14,8 +14,11 @@ namespace OpenWifi {
 		std::lock_guard Guard(Mutex_);
 		StorageClass::Start();
 
+		MigrateRowIds_ = MicroServiceConfigGetBool("storage.rowid.migrate", false);
 		Create_Tables();
 		InitializeBlackListCache();
+		DefaultConfigRefresh_ = MicroServiceConfigGetInt("storage.defaultconfigs.refresh", 60);
+		RefreshDefaultConfigurationIndex();
 
 		ScriptDB_ =
 			std::make_unique<OpenWifi::ScriptDB>("Scripts", "scr", dbType_, *Pool_, Logger());
@@ -23,6 +26,29 @@ namespace OpenWifi {
 		ScriptDB_->Initialize();
 
 		FixDeviceTypeBug();
+		InitializePayloadCodec();
+		Reads_.Configure(Logger(), Pool_, ReplicaPool_,
+						 MicroServiceConfigGetInt("storage.replica.retry", 30));
+		ExportMetrics();
+
+		auto FlushInterval = MicroServiceConfigGetInt("storage.lastcontact.flush", 2000);
+		LastContactsCallback_ =
+			std::make_unique<Poco::TimerCallback<Storage>>(*this, &Storage::FlushLastContacts);
+		LastContactsTimer_.setStartInterval(FlushInterval);
+		LastContactsTimer_.setPeriodicInterval(FlushInterval);
+		LastContactsTimer_.start(*LastContactsCallback_, MicroServiceTimerPool());
+
+		DefaultConfigsCallback_ = std::make_unique<Poco::TimerCallback<Storage>>(
+			*this, &Storage::RefreshDefaultConfigurationIndex);
+		DefaultConfigsTimer_.setStartInterval(DefaultConfigRefresh_ * 1000);
+		DefaultConfigsTimer_.setPeriodicInterval(DefaultConfigRefresh_ * 1000);
+		DefaultConfigsTimer_.start(*DefaultConfigsCallback_, MicroServiceTimerPool());
+
+		UsePreparedStatements_ = MicroServiceConfigGetBool("storage.preparedstatements", true);
+		MaxPreparedSessions_ =
+			UsePreparedStatements_
+				? MicroServiceConfigGetInt("storage.preparedstatements.sessions", 16)
+				: 0;
 
 		return 0;
 	}
@@ -30,8 +56,111 @@ namespace OpenWifi {
 	void Storage::Stop() {
 		std::lock_guard Guard(Mutex_);
 		poco_notice(Logger(), "Stopping...");
+		Migrator_.Stop();
+		LastContactsTimer_.stop();
+		DefaultConfigsTimer_.stop();
+		FlushLastContacts();
+		{
+			std::lock_guard G(PreparedSessionsMutex_);
+			PreparedSessionsOpen_ -= IdlePreparedSessions_.size();
+			IdlePreparedSessions_.clear();
+			MaxPreparedSessions_ = 0;
+		}
 		StorageClass::Stop();
 		poco_notice(Logger(), "Stopped...");
 	}
+
+	std::shared_ptr<LockedDbSession> Storage::PreparedSession() {
+		std::unique_ptr<LockedDbSession> Session;
+		{
+			std::lock_guard G(PreparedSessionsMutex_);
+			if (!IdlePreparedSessions_.empty()) {
+				Session = std::move(IdlePreparedSessions_.back());
+				IdlePreparedSessions_.pop_back();
+			} else if (PreparedSessionsOpen_ < MaxPreparedSessions_) {
+				PreparedSessionsOpen_++;
+			} else {
+				if (MaxPreparedSessions_ > 0)
+					PreparedSessionsExhausted_++;
+				return nullptr;
+			}
+		}
+		if (!Session) {
+			try {
+				Session = std::make_unique<LockedDbSession>();
+			} catch (const Poco::Exception &E) {
+				std::lock_guard G(PreparedSessionsMutex_);
+				PreparedSessionsOpen_--;
+				Logger().log(E);
+				return nullptr;
+			}
+		}
+		return {Session.release(), [this](LockedDbSession *Released) {
+					std::unique_ptr<LockedDbSession> Session(Released);
+					std::lock_guard G(PreparedSessionsMutex_);
+					//	after Stop() the session is closed instead.
+					if (PreparedSessionsOpen_ <= MaxPreparedSessions_) {
+						IdlePreparedSessions_.emplace_back(std::move(Session));
+						return;
+					}
+					PreparedSessionsOpen_--;
+				}};
+	}
+
+	void Storage::ExportMetrics() {
+		for (std::size_t i = 0; i < QueryStats_.size(); ++i) {
+			QueryStats_[i].Export(MetricsRegistry()->Histogram(
+				"owgw_db_query_seconds", "Time spent in the hot database queries.",
+				{{"query", to_string((PreparedQuery)i)}}));
+		}
+		ConnectPath_.Export(MetricsRegistry()->Histogram(
+			"owgw_db_connect_path_seconds", "Database time spent on one device connect message."));
+		LastContactFlushes_.Export(MetricsRegistry()->Histogram(
+			"owgw_db_last_contact_flush_seconds", "Time to write one batch of last contact times."));
+		Reads_.ExportMetrics();
+	}
+
+	void Storage::GetStatistics(Poco::JSON::Object &Stats) {
+		Stats.set("preparedStatements", UsePreparedStatements_);
+		Poco::JSON::Object Queries;
+		for (std::size_t i = 0; i < QueryStats_.size(); ++i) {
+			Poco::JSON::Object Query;
+			QueryStats_[i].ToJSON(Query);
+			Queries.set(to_string((PreparedQuery)i), Query);
+		}
+		Stats.set("queries", Queries);
+		{
+			Poco::JSON::Object Sessions;
+			std::lock_guard G(PreparedSessionsMutex_);
+			Sessions.set("max", MaxPreparedSessions_);
+			Sessions.set("open", PreparedSessionsOpen_);
+			Sessions.set("idle", IdlePreparedSessions_.size());
+			Sessions.set("exhausted", PreparedSessionsExhausted_.load());
+			Stats.set("preparedSessions", Sessions);
+		}
+		Poco::JSON::Object DeviceUpdates;
+		DeviceUpdates.set("skipped", DeviceUpdatesSkipped_.load());
+		DeviceUpdates.set("narrow", DeviceUpdatesNarrow_.load());
+		DeviceUpdates.set("columnsWritten", DeviceColumnsWritten_.load());
+		Stats.set("deviceUpdates", DeviceUpdates);
+		Poco::JSON::Object ConnectPath;
+		ConnectPath_.ToJSON(ConnectPath);
+		ConnectPath.set("rowsWritten", ConnectRowsWritten_.load());
+		Stats.set("connectPath", ConnectPath);
+		Poco::JSON::Object LastContacts;
+		LastContactFlushes_.ToJSON(LastContacts);
+		LastContacts.set("written", LastContactsWritten_.load());
+		LastContacts.set("pending", PendingLastContacts_.size());
+		Stats.set("lastContacts", LastContacts);
+		Poco::JSON::Object Compression;
+		Codec_.GetStatistics(Compression);
+		Stats.set("compression", Compression);
+		Poco::JSON::Object Reads;
+		Reads_.ToJSON(Reads);
+		Stats.set("reads", Reads);
+		Poco::JSON::Object Pools;
+		GetPoolStatistics(Pools);
+		Stats.set("pools", Pools);
+	}
 } // namespace OpenWifi
   // namespace
\ No newline at end of file
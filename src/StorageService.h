@@ -8,10 +8,23 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <shared_mutex>
+
 #include "CentralConfig.h"
 #include "Poco/Net/IPAddress.h"
+#include "Poco/Timer.h"
 #include "RESTObjects//RESTAPI_GWobjects.h"
 #include "framework/StorageClass.h"
+#include "storage/storage_blacklist.h"
+#include "storage/storage_codec.h"
+#include "storage/storage_cursor.h"
+#include "storage/storage_defconfig.h"
+#include "storage/storage_lastcontact.h"
+#include "storage/storage_prepared.h"
+#include "storage/storage_replica.h"
 #include "storage/storage_scripts.h"
 
 namespace OpenWifi {
@@ -23,15 +36,22 @@ namespace OpenWifi {
 		inline std::mutex &Mutex() { return *Mutex_; };
 		inline Poco::Data::Session &Session() {
 			if(!Session_->isConnected()) {
+				Prepared_->Clear();
 				Session_->reconnect();
 			}
 			return *Session_;
 		};
+		inline PreparedStatementCache &Prepared() { return *Prepared_; }
 	  private:
 		std::shared_ptr<Poco::Data::Session> 	Session_;
 		std::shared_ptr<std::mutex> 			Mutex_;
+		//	declared after Session_ so the statements go away before their connection.
+		std::shared_ptr<PreparedStatementCache>	Prepared_;
 	};
 
+	//	Called once per row of a streamed listing. Returning false stops the listing.
+	template <typename T> using RowFunction = std::function<bool(const T &)>;
+
 	class Storage : public StorageClass {
 
 	  public:
@@ -107,11 +127,19 @@ namespace OpenWifi {
 		// typedef std::map<std::string,std::string>	DeviceCapabilitiesCache;
 
 		bool AddLog(LockedDbSession &Session, const GWObjects::DeviceLog &Log);
-		bool AddStatisticsData(Poco::Data::Session &Session, const GWObjects::Statistics &Stats);
+		bool AddStatisticsData(Poco::Data::Session &Session, const GWObjects::Statistics &Stats,
+							   const std::string &Model = "",
+							   PreparedStatementCache *Prepared = nullptr);
 		bool AddStatisticsData(const GWObjects::Statistics &Stats);
 		bool GetStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 							   uint64_t Offset, uint64_t HowMany,
 							   std::vector<GWObjects::Statistics> &Stats);
+		bool StreamStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+								  uint64_t Offset, uint64_t HowMany,
+								  const RowFunction<GWObjects::Statistics> &Row);
+		bool GetStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+							   StorageCursor &Cursor, uint64_t HowMany,
+							   std::vector<GWObjects::Statistics> &Stats);
 		bool GetNumberOfStatisticsDataRecords(std::string &SerialNumber, uint64_t FromDate,
 											  uint64_t ToDate, std::uint64_t &Count);
 		bool DeleteStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate);
@@ -119,10 +147,14 @@ namespace OpenWifi {
 									 std::vector<GWObjects::Statistics> &Stats);
 
 		bool AddHealthCheckData(const GWObjects::HealthCheck &Check);
-		bool AddHealthCheckData(LockedDbSession &Session, const GWObjects::HealthCheck &Check);
+		bool AddHealthCheckData(LockedDbSession &Session, const GWObjects::HealthCheck &Check,
+								const std::string &Model = "");
 		bool GetHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 								uint64_t Offset, uint64_t HowMany,
 								std::vector<GWObjects::HealthCheck> &Checks);
+		bool GetHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+								StorageCursor &Cursor, uint64_t HowMany,
+								std::vector<GWObjects::HealthCheck> &Checks);
 		bool DeleteHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate);
 		bool GetNewestHealthCheckData(std::string &SerialNumber, uint64_t HowMany,
 									  std::vector<GWObjects::HealthCheck> &Checks);
@@ -144,12 +176,19 @@ namespace OpenWifi {
 		bool CreateDevice(Poco::Data::Session &Sess, GWObjects::Device &DeviceDetails);
 
 		bool GetDevice(LockedDbSession &Session, const std::string &SerialNumber, GWObjects::Device &);
-		bool GetDevice(Poco::Data::Session &Session, const std::string &SerialNumber, GWObjects::Device &DeviceDetails);
+		bool GetDevice(Poco::Data::Session &Session, const std::string &SerialNumber, GWObjects::Device &DeviceDetails,
+					   PreparedStatementCache *Prepared = nullptr);
 		bool GetDevice(const std::string &SerialNumber, GWObjects::Device &);
 		bool GetDevices(uint64_t From, uint64_t HowMany, std::vector<GWObjects::Device> &Devices,
 						const std::string &orderBy = "",
 						const std::string &platform = "",
 						bool includeProvisioned = true);
+		bool StreamDevices(uint64_t From, uint64_t HowMany,
+						   const RowFunction<GWObjects::Device> &Row, const std::string &orderBy = "",
+						   const std::string &platform = "", bool includeProvisioned = true);
+		bool GetDevices(StorageCursor &Cursor, uint64_t HowMany, std::vector<GWObjects::Device> &Devices,
+						const std::string &platform = "",
+						bool includeProvisioned = true);
 		//		bool GetDevices(uint64_t From, uint64_t HowMany, const std::string & Select,
 		// std::vector<GWObjects::Device> &Devices, const std::string & orderBy="");
 		bool DeleteDevice(std::string &SerialNumber);
@@ -158,7 +197,11 @@ namespace OpenWifi {
 
 		bool UpdateDevice(GWObjects::Device &);
 		bool UpdateDevice(LockedDbSession &Session, GWObjects::Device &);
-		bool UpdateDevice(Poco::Data::Session &Sess, GWObjects::Device &NewDeviceDetails);
+		bool UpdateDevice(Poco::Data::Session &Sess, GWObjects::Device &NewDeviceDetails,
+						  PreparedStatementCache *Prepared = nullptr);
+		//	Writes only the columns that differ from Original, nothing when they are the same.
+		bool UpdateDevice(Poco::Data::Session &Sess, const GWObjects::Device &Original,
+						  GWObjects::Device &NewDeviceDetails, std::uint64_t &RowsWritten);
 		bool DeviceExists(std::string &SerialNumber);
 		bool SetConnectInfo(std::string &SerialNumber, std::string &Firmware);
 		bool GetDeviceCount(uint64_t &Count, const std::string &platform = "");
@@ -166,10 +209,16 @@ namespace OpenWifi {
 									std::vector<std::string> &SerialNumbers,
 									const std::string &orderBy = "",
 									const std::string &platform = "",
-									bool includeProvisioned = true);									
+									bool includeProvisioned = true);
+		bool GetDeviceSerialNumbers(StorageCursor &Cursor, uint64_t HowMany,
+									std::vector<std::string> &SerialNumbers,
+									const std::string &platform = "",
+									bool includeProvisioned = true);
 		bool GetDeviceFWUpdatePolicy(std::string &SerialNumber, std::string &Policy);
 		bool SetDevicePassword(LockedDbSession &Session, std::string &SerialNumber, std::string &Password);
 		bool UpdateSerialNumberCache();
+		//	Every serial number, or those of devices created since CreatedSince.
+		bool GetSerialNumbers(std::vector<uint64_t> &SerialNumbers, uint64_t CreatedSince = 0);
 		static void GetDeviceDbFieldList(Types::StringVec &Fields);
 
 		bool ExistingConfiguration(std::string &SerialNumber, uint64_t CurrentConfig,
@@ -188,6 +237,12 @@ namespace OpenWifi {
 		bool GetLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 						uint64_t Offset, uint64_t HowMany, std::vector<GWObjects::DeviceLog> &Stats,
 						uint64_t Type);
+		bool StreamLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+						   uint64_t Offset, uint64_t HowMany,
+						   const RowFunction<GWObjects::DeviceLog> &Row, uint64_t Type);
+		bool GetLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+						StorageCursor &Cursor, uint64_t HowMany,
+						std::vector<GWObjects::DeviceLog> &Stats, uint64_t Type);
 		bool DeleteLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 						   uint64_t Type);
 		bool GetNewestLogData(std::string &SerialNumber, uint64_t HowMany,
@@ -205,6 +260,8 @@ namespace OpenWifi {
 											  const std::string &Platform,
 											  GWObjects::DefaultConfiguration &DefConfig);
 		uint64_t GetDefaultConfigurationsCount();
+		bool RefreshDefaultConfigurationIndex();
+		void RefreshDefaultConfigurationIndex(Poco::Timer &timer);
 		bool DefaultConfigurationAlreadyExists(std::string &Name);
 
 		bool UpdateDefaultFirmware(GWObjects::DefaultFirmware &DefFirmware);
@@ -225,6 +282,9 @@ namespace OpenWifi {
 		bool GetCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 						 uint64_t Offset, uint64_t HowMany,
 						 std::vector<GWObjects::CommandDetails> &Commands);
+		bool StreamCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+							uint64_t Offset, uint64_t HowMany,
+							const RowFunction<GWObjects::CommandDetails> &Row);
 		bool DeleteCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate);
 		bool GetNonExecutedCommands(uint64_t Offset, uint64_t HowMany,
 									std::vector<GWObjects::CommandDetails> &Commands);
@@ -233,16 +293,21 @@ namespace OpenWifi {
 		bool DeleteCommand(std::string &UUID);
 		bool GetReadyToExecuteCommands(uint64_t Offset, uint64_t HowMany,
 									   std::vector<GWObjects::CommandDetails> &Commands);
+		bool GetReadyToExecuteCommands(StorageCursor &Cursor, uint64_t HowMany,
+									   std::vector<GWObjects::CommandDetails> &Commands);
 		bool CommandExecuted(std::string &UUID);
 		bool SetCommandLastTry(std::string &UUID);
 		bool CommandCompleted(std::string &UUID, Poco::JSON::Object::Ptr ReturnVars,
 							  const std::chrono::duration<double, std::milli> &execution_time,
 							  bool FullCommand);
-		bool AttachFileDataToCommand(std::string &UUID, const std::stringstream &s,
-									 const std::string &Type);
+		bool AttachFileDataToCommand(std::string &UUID, const std::string &FileHash,
+									 std::uint64_t Size, const std::string &Type);
 		bool CancelWaitFile(std::string &UUID, std::string &ErrorText);
-		bool GetAttachedFileContent(std::string &UUID, const std::string &SerialNumber,
-									std::string &FileContent, std::string &Type);
+		//	FileHash names the file in the FileUploader store. Uploads older than the store come
+		//	back in FileContent with an empty FileHash.
+		bool GetAttachedFile(std::string &UUID, const std::string &SerialNumber,
+							 std::string &FileHash, std::string &FileContent, std::string &Type);
+		void ReleaseStoredFiles(Poco::Data::Session &Sess, const std::vector<std::string> &Hashes);
 		bool RemoveAttachedFile(std::string &UUID);
 		bool SetCommandResult(std::string &UUID, std::string &Result);
 		bool GetNewestCommands(std::string &SerialNumber, uint64_t HowMany,
@@ -255,6 +320,8 @@ namespace OpenWifi {
 		void RemoveTimedOutCommands();
 
 		bool RemoveOldCommands(std::string &SerialNumber, std::string &Command);
+		bool RemoveOldCommands(Poco::Data::Session &Sess, std::string &SerialNumber,
+							   std::string &Command, PreparedStatementCache *Prepared);
 
 		bool AddBlackListDevices(std::vector<GWObjects::BlackListedDevice> &Devices);
 		bool AddBlackListDevice(GWObjects::BlackListedDevice &Device);
@@ -266,6 +333,8 @@ namespace OpenWifi {
 		bool InitializeBlackListCache();
 		bool GetBlackListDevices(uint64_t Offset, uint64_t HowMany,
 								 std::vector<GWObjects::BlackListedDevice> &Devices);
+		bool GetBlackListDevices(StorageCursor &Cursor, uint64_t HowMany,
+								 std::vector<GWObjects::BlackListedDevice> &Devices);
 		bool UpdateBlackListDevice(std::string &SerialNumber, GWObjects::BlackListedDevice &Device);
 		uint64_t GetBlackListDeviceCount();
 
@@ -280,6 +349,11 @@ namespace OpenWifi {
 		bool SetDeviceLastRecordedContact(LockedDbSession &Session, std::string & SerialNumber, std::uint64_t lastRecordedContact);
 		bool SetDeviceLastRecordedContact(std::string & SerialNumber, std::uint64_t lastRecordedContact);
 		bool SetDeviceLastRecordedContact(Poco::Data::Session & Session, std::string & SerialNumber, std::uint64_t lastRecordedContact);
+		//	Buffered, written in batches by FlushLastContacts.
+		void QueueDeviceLastRecordedContact(const std::string &SerialNumber,
+											std::uint64_t lastRecordedContact);
+		void FlushLastContacts();
+		void FlushLastContacts(Poco::Timer &timer);
 
 		int Create_Tables();
 		int Create_Statistics();
@@ -292,6 +366,14 @@ namespace OpenWifi {
 		int Create_BlackList();
 		int Create_FileUploads();
 		int Create_DefaultFirmwares();
+		int Create_PayloadDictionaries();
+		void AddRowId(Poco::Data::Session &Sess, const std::string &Table);
+		bool HasColumn(Poco::Data::Session &Sess, const std::string &Table,
+					   const std::string &Column);
+		//	Listings on Recorded seek on (Recorded, rowid) when true, page with OFFSET otherwise.
+		[[nodiscard]] inline bool HasRowId(const std::string &Table) const {
+			return RowIdTables_.find(Table) != RowIdTables_.end();
+		}
 
 		bool AnalyzeCommands(Types::CountedMap &R);
 		bool AnalyzeDevices(GWObjects::Dashboard &D);
@@ -300,13 +382,126 @@ namespace OpenWifi {
 
 		int Start() override;
 		void Stop() override;
+		void GetStatistics(Poco::JSON::Object &Stats) override;
 
-		inline Poco::Data::Session	StartSession() {
-			return Pool_->get();
+		inline Poco::Data::Session
+		StartSession(const std::source_location &Caller = std::source_location::current()) {
+			return Pool_->get(Caller);
 		}
 
+		//	Runs Query(PooledSession &), a read-only query that can live with replication lag, on
+		//	the read replica when one is configured and reachable, otherwise on the primary. See
+		//	ReadRouter::Read. A query that fails on the replica runs again on the primary, so Query
+		//	works on locals and only hands its results to the caller once it has them all.
+		template <typename F>
+		inline bool
+		ReadQuery(F Query, const bool *Emitted = nullptr,
+				  const std::source_location &Caller = std::source_location::current()) {
+			return Reads_.Read(std::move(Query), Emitted, Caller);
+		}
+
+		inline QueryStatistics &QueryStats(PreparedQuery Q) {
+			return QueryStats_[(std::size_t)Q];
+		}
+
+		//	A session keeping its own prepared statements, for calls that do not come with their
+		//	own session. The caller has it to itself until the pointer goes away, then it goes back
+		//	to the idle list with its statements. Null when prepared statements are disabled or all
+		//	storage.preparedstatements.sessions are out: use a plain pooled session then.
+		std::shared_ptr<LockedDbSession> PreparedSession();
+
+		inline PayloadCodec &Codec() { return Codec_; }
+
+		//	Database time and rows written while processing one connect message.
+		inline void RecordConnectPath(std::uint64_t Us, std::uint64_t Rows) {
+			ConnectPath_.Record(Us);
+			ConnectRowsWritten_ += Rows;
+		}
+		bool CompressStoredPayloads(const std::string &Table, const std::atomic_bool &Running);
+
 	  private:
 		std::unique_ptr<OpenWifi::ScriptDB> ScriptDB_;
+		PayloadCodec Codec_;
+		PayloadMigrator Migrator_;
+		std::array<QueryStatistics, (std::size_t)PreparedQuery::Count> QueryStats_;
+		std::mutex PreparedSessionsMutex_;
+		std::vector<std::unique_ptr<LockedDbSession>> IdlePreparedSessions_;
+		std::uint64_t PreparedSessionsOpen_ = 0, MaxPreparedSessions_ = 0;
+		std::atomic_uint64_t PreparedSessionsExhausted_ = 0;
+		bool UsePreparedStatements_ = true;
+		bool MigrateRowIds_ = false;
+		std::set<std::string> RowIdTables_; //	filled by Create_Tables, read only afterwards
+		MetricHistogram ConnectPath_;
+
+		std::mutex LastContactsFlushMutex_;
+		LastContactQueue PendingLastContacts_;
+		QueryStatistics LastContactFlushes_;
+		std::atomic_uint64_t LastContactsWritten_ = 0;
+		Poco::Timer LastContactsTimer_;
+		std::unique_ptr<Poco::TimerCallback<Storage>> LastContactsCallback_;
+		std::atomic_uint64_t ConnectRowsWritten_ = 0, DeviceUpdatesSkipped_ = 0,
+							 DeviceUpdatesNarrow_ = 0, DeviceColumnsWritten_ = 0;
+		std::uint64_t DefaultConfigRefresh_ = 60;
+		std::mutex DefaultConfigsRefreshMutex_;
+		std::shared_mutex DefaultConfigsMutex_;
+		std::shared_ptr<const DefaultConfigIndex> DefaultConfigs_;
+		Poco::Timer DefaultConfigsTimer_;
+		std::unique_ptr<Poco::TimerCallback<Storage>> DefaultConfigsCallback_;
+
+		std::mutex BlackListUpdateMutex_;
+		SharedBlackList BlackList_;
+
+		ReadRouter Reads_;
+
+		void InitializePayloadCodec();
+		void ExportMetrics();
+		bool InsertBlackListDevice(GWObjects::BlackListedDevice &Device);
+		template <typename F> void UpdateBlackList(F Change);
+		bool SavePayloadDictionary(const PayloadCodec::Dictionary &D);
+		bool FetchPayloadDictionary(std::uint32_t Id, PayloadCodec::Dictionary &D);
+
+		//	Rows of a streamed listing are fetched this many at a time.
+		static constexpr std::uint64_t StreamBatchSize = 256;
+
+		//	Hands the HowMany rows from Offset to Row, StreamBatchSize at a time. Fetch(From, Count,
+		//	Page, Read) reads one batch in its own ReadQuery and sets Read to the records it read,
+		//	Page may hold fewer when some could not be converted. Row runs with no session held, so
+		//	a slow client never keeps a pooled session. Batches are separate queries: rows inserted
+		//	meanwhile may shift a later batch by a few rows.
+		template <typename T, typename F>
+		static inline bool StreamPages(std::uint64_t Offset, std::uint64_t HowMany,
+									   const RowFunction<T> &Row, F Fetch) {
+			std::vector<T> Page;
+			for (std::uint64_t Done = 0; Done < HowMany;) {
+				auto Count = std::min(StreamBatchSize, HowMany - Done);
+				std::uint64_t Read = 0;
+				Page.clear();
+				if (!Fetch(Offset + Done, Count, Page, Read))
+					return false;
+				for (const auto &R : Page)
+					if (!Row(R))
+						return true;
+				if (Read < Count)
+					break;
+				Done += Read;
+			}
+			return true;
+		}
+
+		template <typename T>
+		inline T *GetPrepared(PreparedStatementCache *Cache, PreparedQuery Q,
+							  Poco::Data::Session &Sess) {
+			if (Cache == nullptr || !UsePreparedStatements_)
+				return nullptr;
+			//	a statement that cannot be prepared runs unprepared this time.
+			try {
+				return &Cache->Get<T>(Q, Sess);
+			} catch (const Poco::Exception &E) {
+				Cache->Invalidate(Q);
+				Logger().log(E);
+			}
+			return nullptr;
+		}
 	};
 
 	inline auto StorageService() { return Storage::instance(); }
@@ -314,6 +509,7 @@ namespace OpenWifi {
 	inline LockedDbSession::LockedDbSession() {
 		Session_ = std::make_shared<Poco::Data::Session>(Poco::Data::Session(StorageService()->StartSession()));
 		Mutex_ = std::make_shared<std::mutex>();
+		Prepared_ = std::make_shared<PreparedStatementCache>();
 	}
 
 } // namespace OpenWifi
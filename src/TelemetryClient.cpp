@@ -14,9 +14,10 @@ namespace OpenWifi {
 
 	TelemetryClient::TelemetryClient(std::string UUID, uint64_t SerialNumber,
 									 std::unique_ptr<Poco::Net::WebSocket> WSock,
-									 Poco::Net::SocketReactor &Reactor, Poco::Logger &Logger)
+									 Poco::Net::SocketReactor &Reactor, Poco::Logger &Logger,
+									 std::uint64_t MaxQueueSize)
 		: UUID_(std::move(UUID)), SerialNumber_(SerialNumber), Reactor_(Reactor), Logger_(Logger),
-		  WS_(std::move(WSock)) {
+		  WS_(std::move(WSock)), MaxQueueSize_(MaxQueueSize) {
 		CompleteStartup();
 	}
 
@@ -53,6 +54,8 @@ namespace OpenWifi {
 	}
 
 	void TelemetryClient::DeRegister() {
+		std::lock_guard Guard(Mutex_);
+		StopWriting();
 		if (Registered_) {
 			Registered_ = false;
 			Reactor_.removeEventHandler(
@@ -67,17 +70,69 @@ namespace OpenWifi {
 		}
 	}
 
-	bool TelemetryClient::Send(const std::string &Payload) {
+	//	Called from the telemetry shard worker. The frame is only queued here, the reactor writes it
+	//	when the socket can take it. A slow client loses its oldest frames instead of holding up
+	//	the other subscribers of its shard.
+	bool TelemetryClient::Send(const TelemetryPayload &Payload,
+							   std::chrono::steady_clock::time_point Published) {
 		std::lock_guard Guard(Mutex_);
-		size_t BytesSent = WS_->sendFrame(Payload.c_str(), (int)Payload.size());
-		return BytesSent == Payload.size();
+		if (!Registered_)
+			return false;
+		bool Overflow = false;
+		while (!OutQueue_.empty() && OutQueue_.size() >= MaxQueueSize_) {
+			OutQueue_.pop_front();
+			Dropped_++;
+			Overflow = true;
+		}
+		OutQueue_.emplace_back(Payload, Published);
+		if (!WritableRegistered_) {
+			WritableRegistered_ = true;
+			Reactor_.addEventHandler(
+				*WS_, Poco::NObserver<TelemetryClient, Poco::Net::WritableNotification>(
+						  *this, &TelemetryClient::OnSocketWritable));
+		}
+		return !Overflow;
+	}
+
+	void TelemetryClient::StopWriting() {
+		if (WritableRegistered_) {
+			WritableRegistered_ = false;
+			Reactor_.removeEventHandler(
+				*WS_, Poco::NObserver<TelemetryClient, Poco::Net::WritableNotification>(
+						  *this, &TelemetryClient::OnSocketWritable));
+		}
+	}
+
+	void TelemetryClient::OnSocketWritable(
+		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf) {
+		try {
+			std::lock_guard Guard(Mutex_);
+			if (OutQueue_.empty()) {
+				StopWriting();
+				return;
+			}
+			auto [Payload, Published] = std::move(OutQueue_.front());
+			OutQueue_.pop_front();
+			if (OutQueue_.empty())
+				StopWriting();
+			WS_->sendFrame(Payload->c_str(), (int)Payload->size());
+			TelemetryStream()->RecordDelivery(Published);
+			return;
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		} catch (const std::exception &E) {
+			poco_information(
+				Logger(), fmt::format("TELEMETRY-std::exception caught: {}. Connection terminated with {}",
+									  E.what(), CId_));
+		}
+		SendTelemetryShutdown();
 	}
 
 	void TelemetryClient::SendTelemetryShutdown() {
 		poco_information(Logger(), fmt::format("TELEMETRY-SHUTDOWN({}): Closing.", CId_));
 		DeRegister();
 		AP_WS_Server()->StopWebSocketTelemetry(CommandManager()->Next_RPC_ID(), SerialNumber_);
-		TelemetryStream()->DeRegisterClient(UUID_);
+		TelemetryStream()->DeRegisterClient(SerialNumber_, UUID_);
 	}
 
 	void TelemetryClient::OnSocketShutdown(
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -14,21 +18,33 @@
 #include "Poco/Net/WebSocket.h"
 
 namespace OpenWifi {
+
+	//	Telemetry payloads are shared by all the subscribers of a device and never modified once queued.
+	using TelemetryPayload = std::shared_ptr<const std::string>;
+
 	class TelemetryClient {
 		static constexpr int BufSize = 64000;
 
 	  public:
 		TelemetryClient(std::string UUID, uint64_t SerialNumber,
 						std::unique_ptr<Poco::Net::WebSocket> WSock,
-						Poco::Net::SocketReactor &Reactor, Poco::Logger &Logger);
+						Poco::Net::SocketReactor &Reactor, Poco::Logger &Logger,
+						std::uint64_t MaxQueueSize);
 		~TelemetryClient();
 
 		void OnSocketReadable(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf);
+		void OnSocketWritable(const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf);
 		void OnSocketShutdown(const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf);
 		void OnSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf);
-		bool Send(const std::string &Payload);
+		bool Send(const TelemetryPayload &Payload,
+				  std::chrono::steady_clock::time_point Published);
 		void ProcessIncomingFrame();
 		inline Poco::Logger &Logger() { return Logger_; }
+		[[nodiscard]] inline std::uint64_t Dropped() const { return Dropped_; }
+		[[nodiscard]] inline std::uint64_t QueueDepth() {
+			std::lock_guard Guard(Mutex_);
+			return OutQueue_.size();
+		}
 
 	  private:
 		std::recursive_mutex Mutex_;
@@ -40,8 +56,13 @@ namespace OpenWifi {
 		std::string CId_;
 		std::unique_ptr<Poco::Net::WebSocket> WS_;
 		bool Registered_ = false;
+		bool WritableRegistered_ = false;
+		std::uint64_t MaxQueueSize_;
+		std::deque<std::pair<TelemetryPayload, std::chrono::steady_clock::time_point>> OutQueue_;
+		std::atomic_uint64_t Dropped_ = 0;
 		void SendTelemetryShutdown();
 		void CompleteStartup();
 		void DeRegister();
+		void StopWriting();
 	};
 } // namespace OpenWifi
\ No newline at end of file
@@ -1,8 +1,10 @@
 //
 // Created by stephane bourque on 2021-09-07.
 //
+#include <algorithm>
 #include <thread>
 
+#include "Poco/Environment.h"
 #include "Poco/JSON/Array.h"
 #include "Poco/Net/HTTPHeaderStream.h"
 #include "Poco/URI.h"
@@ -15,25 +17,51 @@
 namespace OpenWifi {
 
 	int TelemetryStream::Start() {
-		Running_ = true;
-		ReactorThr_.start(Reactor_);
-		Utils::SetThreadName(ReactorThr_, "tel:reactor");
-		NotificationMgr_.start(*this);
+		auto NumberOfShards =
+			MicroServiceConfigGetInt("openwifi.telemetry.shards",
+									 std::min((std::uint64_t)Poco::Environment::processorCount(),
+											  (std::uint64_t)8));
+		NumberOfShards = std::clamp(NumberOfShards, (std::uint64_t)1, (std::uint64_t)64);
+		ClientQueueSize_ =
+			std::max(MicroServiceConfigGetInt("openwifi.telemetry.client.queuesize", 256),
+					 (std::uint64_t)1);
+
+		for (std::uint64_t i = 0; i < NumberOfShards; ++i) {
+			Shards_.emplace_back(std::make_unique<TelemetryShard>(i, Logger()));
+			Shards_.back()->Start();
+		}
+		poco_information(Logger(), fmt::format("Started {} telemetry shards.", NumberOfShards));
 		return 0;
 	}
 
 	void TelemetryStream::Stop() {
 		poco_information(Logger(), "Stopping...");
-		Running_ = false;
+		for (auto &Shard : Shards_)
+			Shard->Stop();
+		poco_information(Logger(), "Stopped...");
+	}
+
+	void TelemetryShard::Start() {
+		ReactorThr_.start(Reactor_);
+		Utils::SetThreadName(ReactorThr_, fmt::format("tel:reactor:{}", Id_).c_str());
+		NotificationMgr_.start(*this);
+	}
+
+	void TelemetryShard::Stop() {
 		Reactor_.stop();
 		ReactorThr_.join();
 		MsgQueue_.wakeUpAll();
 		NotificationMgr_.wakeUp();
 		NotificationMgr_.join();
-		poco_information(Logger(), "Stopped...");
 	}
 
 	bool TelemetryStream::IsValidEndPoint(uint64_t SerialNumber, const std::string &UUID) {
+		if (Shards_.empty())
+			return false;
+		return Shard(SerialNumber).IsValidEndPoint(SerialNumber, UUID);
+	}
+
+	bool TelemetryShard::IsValidEndPoint(uint64_t SerialNumber, const std::string &UUID) {
 		std::lock_guard G(Mutex_);
 
 		auto U = Clients_.find(UUID);
@@ -49,7 +77,8 @@ namespace OpenWifi {
 
 	bool TelemetryStream::CreateEndpoint(uint64_t SerialNumber, std::string &EndPoint,
 										 const std::string &UUID) {
-		std::lock_guard G(Mutex_);
+		if (Shards_.empty())
+			return false;
 
 		Poco::URI Public(MicroServiceConfigGetString("openwifi.system.uri.public", ""));
 		Poco::URI U;
@@ -61,17 +90,64 @@ namespace OpenWifi {
 		U.addQueryParameter("uuid", UUID);
 		U.addQueryParameter("serialNumber", Utils::IntToSerialNumber(SerialNumber));
 		EndPoint = U.toString();
-		auto S = SerialNumbers_[SerialNumber];
-		S.insert(UUID);
-		SerialNumbers_[SerialNumber] = S;
-		Clients_[UUID] = nullptr;
+		Shard(SerialNumber).AddEndPoint(SerialNumber, UUID);
 		return true;
 	}
 
-	void TelemetryStream::run() {
-		Utils::SetThreadName("tel:notifier");
+	void TelemetryShard::AddEndPoint(uint64_t SerialNumber, const std::string &UUID) {
+		std::lock_guard G(Mutex_);
+		SerialNumbers_[SerialNumber].insert(UUID);
+		Clients_[UUID] = nullptr;
+	}
+
+	void TelemetryStream::RecordDelivery(std::chrono::steady_clock::time_point Published) {
+		std::uint64_t Latency = std::chrono::duration_cast<std::chrono::microseconds>(
+									std::chrono::steady_clock::now() - Published)
+									.count();
+		Delivered_++;
+		TotalLatency_ += Latency;
+		auto CurrentMax = MaxLatency_.load();
+		while (Latency > CurrentMax && !MaxLatency_.compare_exchange_weak(CurrentMax, Latency))
+			;
+	}
+
+	void TelemetryStream::GetStatistics(Poco::JSON::Object &Stats) {
+		std::uint64_t Delivered = Delivered_;
+		Stats.set("published", Published_.load());
+		Stats.set("delivered", Delivered);
+		Stats.set("dropped", Dropped_.load());
+		Stats.set("averageLatencyUs", Delivered ? TotalLatency_.load() / Delivered : 0);
+		Stats.set("maxLatencyUs", MaxLatency_.load());
+		Poco::JSON::Array ShardsStats;
+		for (auto &Shard : Shards_) {
+			Poco::JSON::Object ShardStats;
+			Shard->GetStatistics(ShardStats);
+			ShardsStats.add(ShardStats);
+		}
+		Stats.set("shards", ShardsStats);
+	}
+
+	void TelemetryShard::GetStatistics(Poco::JSON::Object &Stats) {
+		std::lock_guard G(Mutex_);
+		std::uint64_t QueueDepth = 0, Dropped = 0;
+		for (const auto &[UUID, Client] : Clients_) {
+			if (Client != nullptr) {
+				QueueDepth += Client->QueueDepth();
+				Dropped += Client->Dropped();
+			}
+		}
+		Stats.set("shard", Id_);
+		Stats.set("pending", MsgQueue_.size());
+		Stats.set("devices", SerialNumbers_.size());
+		Stats.set("clients", Clients_.size());
+		Stats.set("clientQueueDepth", QueueDepth);
+		Stats.set("clientDropped", Dropped);
+	}
+
+	void TelemetryShard::run() {
+		Utils::SetThreadName(fmt::format("tel:notifier:{}", Id_).c_str());
 		Poco::AutoPtr<Poco::Notification> NextNotification(MsgQueue_.waitDequeueNotification());
-		while (NextNotification && Running_) {
+		while (NextNotification) {
 			auto Notification = dynamic_cast<TelemetryNotification *>(NextNotification.get());
 			if (Notification != nullptr) {
 				std::lock_guard Lock(Mutex_);
@@ -83,8 +159,9 @@ namespace OpenWifi {
 							auto Client = Clients_.find(uuid);
 							if (Client != Clients_.end() && Client->second != nullptr) {
 								try {
-									// std::cout << "Sent WS telemetry notification" << std::endl;
-									Client->second->Send(Notification->Data_);
+									if (!Client->second->Send(Notification->Payload_,
+															  Notification->Published_))
+										TelemetryStream()->RecordDrop();
 								} catch (const Poco::Exception &E) {
 									Logger().log(E);
 								} catch (std::exception &E) {
@@ -140,13 +217,19 @@ namespace OpenWifi {
 
 	bool TelemetryStream::NewClient(const std::string &UUID, uint64_t SerialNumber,
 									std::unique_ptr<Poco::Net::WebSocket> Client) {
+		if (Shards_.empty())
+			return false;
+		return Shard(SerialNumber).NewClient(UUID, SerialNumber, std::move(Client), ClientQueueSize_);
+	}
+
+	bool TelemetryShard::NewClient(const std::string &UUID, uint64_t SerialNumber,
+								   std::unique_ptr<Poco::Net::WebSocket> Client,
+								   std::uint64_t MaxQueueSize) {
 		std::lock_guard G(Mutex_);
 		try {
 			Clients_[UUID] = std::make_unique<TelemetryClient>(
-				UUID, SerialNumber, std::move(Client), NextReactor(), Logger());
-			auto set = SerialNumbers_[SerialNumber];
-			set.insert(UUID);
-			SerialNumbers_[SerialNumber] = set;
+				UUID, SerialNumber, std::move(Client), Reactor_, Logger(), MaxQueueSize);
+			SerialNumbers_[SerialNumber].insert(UUID);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
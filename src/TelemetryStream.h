@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
 
 #include "Poco/Net/HTTPRequestHandler.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
@@ -32,24 +35,55 @@ namespace OpenWifi {
 	  public:
 		enum class NotificationType { data, unregister };
 
-		explicit TelemetryNotification(std::uint64_t SerialNumber, const std::string &Payload)
-			: Type_(NotificationType::data), SerialNumber_(SerialNumber), Data_(Payload) {}
+		explicit TelemetryNotification(std::uint64_t SerialNumber, TelemetryPayload Payload)
+			: Type_(NotificationType::data), SerialNumber_(SerialNumber),
+			  Payload_(std::move(Payload)), Published_(std::chrono::steady_clock::now()) {}
 
-		explicit TelemetryNotification(const std::string &UUID)
-			: Type_(NotificationType::unregister), Data_(UUID) {}
+		explicit TelemetryNotification(std::uint64_t SerialNumber, const std::string &UUID)
+			: Type_(NotificationType::unregister), SerialNumber_(SerialNumber), Data_(UUID) {}
 
 		NotificationType Type_;
 		std::uint64_t SerialNumber_ = 0;
 		std::string Data_;
+		TelemetryPayload Payload_;
+		std::chrono::steady_clock::time_point Published_;
 	};
 
-	class TelemetryStream : public SubSystemServer, Poco::Runnable {
+	//	A shard owns the subscribers of a subset of serial numbers: its own queue, notifier thread
+	//	and reactor. Shards never share locks, so a busy device only slows down its own shard.
+	class TelemetryShard : public Poco::Runnable {
 	  public:
-		struct QueueUpdate {
-			uint64_t SerialNumber;
-			std::string Payload;
-		};
+		TelemetryShard(std::uint64_t Id, Poco::Logger &Logger) : Id_(Id), Logger_(Logger) {}
 
+		void Start();
+		void Stop();
+		void run() final;
+
+		inline void Enqueue(TelemetryNotification *Notification) {
+			MsgQueue_.enqueueNotification(Notification);
+		}
+
+		bool IsValidEndPoint(uint64_t SerialNumber, const std::string &UUID);
+		void AddEndPoint(uint64_t SerialNumber, const std::string &UUID);
+		bool NewClient(const std::string &UUID, uint64_t SerialNumber,
+					   std::unique_ptr<Poco::Net::WebSocket> Client, std::uint64_t MaxQueueSize);
+		void GetStatistics(Poco::JSON::Object &Stats);
+		inline Poco::Logger &Logger() { return Logger_; }
+
+	  private:
+		std::uint64_t Id_;
+		Poco::Logger &Logger_;
+		std::mutex Mutex_;
+		std::map<uint64_t, std::set<std::string>> SerialNumbers_; //	serialNumber -> uuid
+		std::map<std::string, std::unique_ptr<TelemetryClient>> Clients_; // 	uuid -> client
+		Poco::Net::SocketReactor Reactor_;
+		Poco::Thread ReactorThr_;
+		Poco::Thread NotificationMgr_;
+		Poco::NotificationQueue MsgQueue_;
+	};
+
+	class TelemetryStream : public SubSystemServer {
+	  public:
 		static auto instance() {
 			static auto instance_ = new TelemetryStream;
 			return instance_;
@@ -57,33 +91,44 @@ namespace OpenWifi {
 
 		int Start() override;
 		void Stop() override;
-		void run() final;
+		void GetStatistics(Poco::JSON::Object &Stats) override;
 
 		bool IsValidEndPoint(uint64_t SerialNumber, const std::string &UUID);
 		bool CreateEndpoint(uint64_t SerialNumber, std::string &EndPoint, const std::string &UUID);
 
 		inline void NotifyEndPoint(uint64_t SerialNumber, const std::string &PayLoad) {
-			MsgQueue_.enqueueNotification(new TelemetryNotification(SerialNumber, PayLoad));
+			if (Shards_.empty())
+				return;
+			Published_++;
+			Shard(SerialNumber).Enqueue(new TelemetryNotification(
+				SerialNumber, std::make_shared<const std::string>(PayLoad)));
 		}
 
-		inline void DeRegisterClient(const std::string &UUID) {
-			MsgQueue_.enqueueNotification(new TelemetryNotification(UUID));
+		inline void DeRegisterClient(uint64_t SerialNumber, const std::string &UUID) {
+			if (Shards_.empty())
+				return;
+			Shard(SerialNumber).Enqueue(new TelemetryNotification(SerialNumber, UUID));
 		}
 
 		bool NewClient(const std::string &UUID, uint64_t SerialNumber,
 					   std::unique_ptr<Poco::Net::WebSocket> Client);
 
-		Poco::Net::SocketReactor &NextReactor() { return Reactor_; }
+		void RecordDelivery(std::chrono::steady_clock::time_point Published);
+		inline void RecordDrop() { Dropped_++; }
 
 	  private:
-		volatile std::atomic_bool Running_ = false;
-		std::map<uint64_t, std::set<std::string>> SerialNumbers_; //	serialNumber -> uuid
-		Poco::Net::SocketReactor Reactor_;
-		Poco::Thread ReactorThr_;
-		Poco::Thread NotificationMgr_;
-		Poco::NotificationQueue MsgQueue_;
+		std::vector<std::unique_ptr<TelemetryShard>> Shards_;
+		std::uint64_t ClientQueueSize_ = 256;
 
-		std::map<std::string, std::unique_ptr<TelemetryClient>> Clients_; // 	uuid -> client
+		std::atomic_uint64_t Published_ = 0;
+		std::atomic_uint64_t Delivered_ = 0;
+		std::atomic_uint64_t Dropped_ = 0;
+		std::atomic_uint64_t TotalLatency_ = 0; //	microseconds
+		std::atomic_uint64_t MaxLatency_ = 0;	//	microseconds
+
+		inline TelemetryShard &Shard(uint64_t SerialNumber) {
+			return *Shards_[SerialNumber % Shards_.size()];
+		}
 
 		TelemetryStream() noexcept
 			: SubSystemServer("TelemetryServer", "TELEMETRY-SVR", "openwifi.telemetry") {}
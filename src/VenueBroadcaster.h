@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+
 #include "Poco/Notification.h"
 #include "Poco/NotificationQueue.h"
 
 #include "AP_WS_Server.h"
+#include "VenueIndex.h"
 #include "sdks/sdk_prov.h"
 
 #include "framework/MicroServiceFuncs.h"
@@ -24,6 +28,40 @@ namespace OpenWifi {
 		std::string SourceSerialNumber_;
 		Poco::JSON::Object::Ptr Data_;
 		uint64_t TimeStamp_ = Utils::Now();
+		bool Retried_ = false;
+		std::chrono::steady_clock::time_point Queued_ = std::chrono::steady_clock::now();
+	};
+
+	//	A lookup of the venue of a serial number in the provisioning service. When a broadcast is
+	//	attached, it is re-queued once the venue is known.
+	class VenueLookupNotification : public Poco::Notification {
+	  public:
+		VenueLookupNotification(const std::string &SerialNumber,
+								Poco::AutoPtr<VenueBroadcastNotification> Broadcast)
+			: SerialNumber_(SerialNumber), Broadcast_(std::move(Broadcast)) {}
+		std::string SerialNumber_;
+		Poco::AutoPtr<VenueBroadcastNotification> Broadcast_;
+	};
+
+	//	All the devices of one reactor for a single broadcast. The payload is serialized once and
+	//	shared by every batch. Batches are sent by the broadcaster's worker threads, not by the
+	//	reactor threads: a batch only groups the connections a reactor owns, so two workers never
+	//	write to the sockets of the same reactor for the same broadcast.
+	class VenueBroadcastBatch : public Poco::Notification {
+	  public:
+		struct Progress {
+			std::atomic_uint64_t PendingBatches = 0;
+			std::chrono::steady_clock::time_point Queued;
+		};
+
+		VenueBroadcastBatch(std::shared_ptr<const std::string> Payload,
+							std::vector<std::shared_ptr<AP_WS_Connection>> Connections,
+							std::shared_ptr<Progress> Tracker)
+			: Payload_(std::move(Payload)), Connections_(std::move(Connections)),
+			  Tracker_(std::move(Tracker)) {}
+		std::shared_ptr<const std::string> Payload_;
+		std::vector<std::shared_ptr<AP_WS_Connection>> Connections_;
+		std::shared_ptr<Progress> Tracker_;
 	};
 
 	class VenueBroadcaster : public SubSystemServer, Poco::Runnable {
@@ -35,7 +73,17 @@ namespace OpenWifi {
 
 		inline int Start() override {
 			Enabled_ = MicroServiceConfigGetBool("venue_broadcast.enabled", true);
+			Index_.SetTTL(MicroServiceConfigGetInt("venue_broadcast.cache.ttl", 600));
 			if (Enabled_) {
+				auto NumberOfWorkers = std::clamp(
+					MicroServiceConfigGetInt("venue_broadcast.workers", 8), (std::uint64_t)1,
+					(std::uint64_t)64);
+				for (std::uint64_t i = 0; i < NumberOfWorkers; ++i) {
+					auto Worker = std::make_unique<BatchWorker>(*this);
+					Worker->Thread_.start(*Worker);
+					Workers_.emplace_back(std::move(Worker));
+				}
+				LookupManager_.start(LookupWorker_);
 				BroadcastManager_.start(*this);
 			}
 			return 0;
@@ -47,6 +95,12 @@ namespace OpenWifi {
 				BroadcastQueue_.wakeUpAll();
 				BroadcastManager_.wakeUp();
 				BroadcastManager_.join();
+				LookupQueue_.wakeUpAll();
+				LookupManager_.join();
+				BatchQueue_.wakeUpAll();
+				for (auto &Worker : Workers_)
+					Worker->Thread_.join();
+				Workers_.clear();
 			}
 			poco_information(Logger(), "Stopped...");
 		}
@@ -55,47 +109,65 @@ namespace OpenWifi {
 			poco_information(Logger(), "Reinitializing.");
 		}
 
-		struct VenueInfo {
-			uint64_t timestamp = Utils::Now();
-			Types::StringVec serialNumbers;
-		};
+		inline void GetStatistics(Poco::JSON::Object &Stats) override {
+			std::uint64_t Broadcasts = Broadcasts_;
+			Stats.set("broadcasts", Broadcasts);
+			Stats.set("framesSent", FramesSent_.load());
+			Stats.set("framesFailed", FramesFailed_.load());
+			Stats.set("cacheHits", CacheHits_.load());
+			Stats.set("cacheMisses", CacheMisses_.load());
+			Stats.set("lookups", Lookups_.load());
+			Stats.set("pendingBatches", BatchQueue_.size());
+			Stats.set("averageLatencyMs", Broadcasts ? TotalLatency_.load() / Broadcasts : 0);
+			Stats.set("maxLatencyMs", MaxLatency_.load());
+			Stats.set("venues", Index_.Venues());
+			Stats.set("devices", Index_.Devices());
+		}
 
-		inline bool FindSerialNumberList(const std::string &Source,
-										 OpenWifi::Types::StringVec &SerialNumbers) {
-			//	Can we find our serial number in any of the lists so far...
-			for (const auto &venue : Venues_) {
-				auto entry = std::find(venue.second.serialNumbers.begin(),
-									   venue.second.serialNumbers.end(), Source);
-				if (entry != venue.second.serialNumbers.end() &&
-					(Utils::Now() - venue.second.timestamp) < 600) {
-					SerialNumbers = venue.second.serialNumbers;
-					auto entry2 = std::find(SerialNumbers.begin(), SerialNumbers.end(), Source);
-					SerialNumbers.erase(entry2);
-					return true;
-				}
-			}
+		inline void RequestLookup(const std::string &SerialNumber,
+								  Poco::AutoPtr<VenueBroadcastNotification> Broadcast) {
+			if (!Index_.AddPending(SerialNumber) && Broadcast.isNull())
+				return;
+			LookupQueue_.enqueueNotification(
+				new VenueLookupNotification(SerialNumber, std::move(Broadcast)));
+		}
 
-			//	get the venue from Prov and the serial numbers.
+		inline void UpdateVenue(const std::string &SerialNumber) {
 			Types::UUID_t Venue;
-			Types::StringVec TmpSerialNumbers;
-			if (OpenWifi::SDK::Prov::GetSerialNumbersForVenueOfSerialNumber(
-					Source, Venue, TmpSerialNumbers, Logger())) {
-				std::sort(TmpSerialNumbers.begin(), TmpSerialNumbers.end());
-				VenueInfo V{.timestamp = Utils::Now(), .serialNumbers = TmpSerialNumbers};
-				Venues_[Venue] = V;
-				auto p = std::find(TmpSerialNumbers.begin(), TmpSerialNumbers.end(), Source);
-				if (p != TmpSerialNumbers.end()) {
-					TmpSerialNumbers.erase(p);
-					SerialNumbers = TmpSerialNumbers;
-					return true;
-				}
-			}
+			Types::StringVec SerialNumbers;
+			Lookups_++;
+			auto Found = OpenWifi::SDK::Prov::GetSerialNumbersForVenueOfSerialNumber(
+				SerialNumber, Venue, SerialNumbers, Logger());
+			Index_.Update(SerialNumber, Found, Venue, std::move(SerialNumbers), Utils::Now());
+		}
 
-			return false;
+		inline void SendToDevices(const std::string &Payload, const Types::StringVec &SerialNumbers,
+								  std::chrono::steady_clock::time_point Queued) {
+			AP_WS_Server::ConnectionBatches Batches;
+			AP_WS_Server()->GetConnectionsByReactor(SerialNumbers, Batches);
+			Broadcasts_++;
+			if (Batches.empty()) {
+				RecordLatency(Queued);
+				return;
+			}
+			auto SharedPayload = std::make_shared<const std::string>(Payload);
+			auto Tracker = std::make_shared<VenueBroadcastBatch::Progress>();
+			Tracker->PendingBatches = Batches.size();
+			Tracker->Queued = Queued;
+			for (auto &[Reactor, Connections] : Batches) {
+				BatchQueue_.enqueueNotification(
+					new VenueBroadcastBatch(SharedPayload, std::move(Connections), Tracker));
+			}
 		}
 
-		inline void SendToDevice(const std::string &SerialNumber, const std::string &Payload) {
-			AP_WS_Server()->SendFrame(SerialNumber, Payload);
+		inline void RecordLatency(std::chrono::steady_clock::time_point Queued) {
+			std::uint64_t Latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+										std::chrono::steady_clock::now() - Queued)
+										.count();
+			TotalLatency_ += Latency;
+			auto CurrentMax = MaxLatency_.load();
+			while (Latency > CurrentMax && !MaxLatency_.compare_exchange_weak(CurrentMax, Latency))
+				;
 		}
 
 		inline void run() final {
@@ -108,7 +180,12 @@ namespace OpenWifi {
 					dynamic_cast<VenueBroadcastNotification *>(NextNotification.get());
 				if (Notification != nullptr) {
 					Types::StringVec SerialNumbers;
-					if (FindSerialNumberList(Notification->SourceSerialNumber_, SerialNumbers)) {
+					bool MustRefresh = false;
+					if (Index_.Find(Notification->SourceSerialNumber_, SerialNumbers, MustRefresh,
+									Utils::Now())) {
+						CacheHits_++;
+						if (MustRefresh)
+							RequestLookup(Notification->SourceSerialNumber_, nullptr);
 						Poco::JSON::Object Payload;
 						Payload.set("jsonrpc", "2.0");
 						Payload.set("method", "venue_broadcast");
@@ -119,9 +196,12 @@ namespace OpenWifi {
 						Payload.set("params", ParamBlock);
 						std::ostringstream o;
 						Payload.stringify(o);
-						for (const auto &Device : SerialNumbers) {
-							SendToDevice(Device, o.str());
-						}
+						SendToDevices(o.str(), SerialNumbers, Notification->Queued_);
+					} else if (!Notification->Retried_) {
+						CacheMisses_++;
+						Notification->Retried_ = true;
+						RequestLookup(Notification->SourceSerialNumber_,
+									  Poco::AutoPtr<VenueBroadcastNotification>(Notification, true));
 					}
 				}
 				NextNotification = BroadcastQueue_.waitDequeueNotification();
@@ -136,16 +216,84 @@ namespace OpenWifi {
 		}
 
 	  private:
+		class LookupRunner : public Poco::Runnable {
+		  public:
+			explicit LookupRunner(VenueBroadcaster &Parent) : Parent_(Parent) {}
+			inline void run() final {
+				Utils::SetThreadName("venue-lookup");
+				Poco::AutoPtr<Poco::Notification> NextNotification(
+					Parent_.LookupQueue_.waitDequeueNotification());
+				while (NextNotification) {
+					auto Lookup = dynamic_cast<VenueLookupNotification *>(NextNotification.get());
+					if (Lookup != nullptr) {
+						//	several broadcasts from the same unknown device may wait on one lookup.
+						if (!Parent_.Index_.IsFresh(Lookup->SerialNumber_, Utils::Now()))
+							Parent_.UpdateVenue(Lookup->SerialNumber_);
+						else
+							Parent_.Index_.ClearPending(Lookup->SerialNumber_);
+						if (!Lookup->Broadcast_.isNull())
+							Parent_.BroadcastQueue_.enqueueNotification(Lookup->Broadcast_);
+					}
+					NextNotification = Parent_.LookupQueue_.waitDequeueNotification();
+				}
+			}
+
+		  private:
+			VenueBroadcaster &Parent_;
+		};
+
+		class BatchWorker : public Poco::Runnable {
+		  public:
+			explicit BatchWorker(VenueBroadcaster &Parent) : Parent_(Parent) {}
+			inline void run() final {
+				Utils::SetThreadName("venue-bcast-w");
+				Poco::AutoPtr<Poco::Notification> NextNotification(
+					Parent_.BatchQueue_.waitDequeueNotification());
+				while (NextNotification) {
+					auto Batch = dynamic_cast<VenueBroadcastBatch *>(NextNotification.get());
+					if (Batch != nullptr) {
+						for (const auto &Connection : Batch->Connections_) {
+							bool Sent = false;
+							try {
+								Sent = Connection->Send(*Batch->Payload_);
+							} catch (...) {
+							}
+							if (Sent)
+								Parent_.FramesSent_++;
+							else
+								Parent_.FramesFailed_++;
+						}
+						if (--Batch->Tracker_->PendingBatches == 0)
+							Parent_.RecordLatency(Batch->Tracker_->Queued);
+					}
+					NextNotification = Parent_.BatchQueue_.waitDequeueNotification();
+				}
+			}
+			Poco::Thread Thread_;
+
+		  private:
+			VenueBroadcaster &Parent_;
+		};
+
 		std::atomic_bool Running_ = false;
 		bool Enabled_ = false;
 		Poco::NotificationQueue BroadcastQueue_;
 		Poco::Thread BroadcastManager_;
+		Poco::NotificationQueue LookupQueue_;
+		Poco::Thread LookupManager_;
+		LookupRunner LookupWorker_{*this};
+		Poco::NotificationQueue BatchQueue_;
+		std::vector<std::unique_ptr<BatchWorker>> Workers_;
+
+		VenueIndex Index_;
 
-		std::map<OpenWifi::Types::UUID_t, VenueInfo> Venues_;
+		std::atomic_uint64_t Broadcasts_ = 0, FramesSent_ = 0, FramesFailed_ = 0;
+		std::atomic_uint64_t CacheHits_ = 0, CacheMisses_ = 0, Lookups_ = 0;
+		std::atomic_uint64_t TotalLatency_ = 0, MaxLatency_ = 0; //	milliseconds
 
 		VenueBroadcaster() noexcept
 			: SubSystemServer("VenueBroadcaster", "VENUE-BCAST", "venue.broacast") {}
 	};
 
 	inline auto VenueBroadcaster() { return VenueBroadcaster::instance(); }
-} // namespace OpenWifi
\ No newline at end of file
+} // namespace OpenWifi
@@ -0,0 +1,120 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace OpenWifi {
+
+	//	Venue membership as the provisioning service last reported it, with a serial number ->
+	//	venue reverse index so finding the other devices of a venue is a map lookup. Times are in
+	//	seconds, as Utils::Now() returns them.
+	class VenueIndex {
+	  public:
+		explicit VenueIndex(std::uint64_t TTL = 600) : TTL_(TTL) {}
+
+		inline void SetTTL(std::uint64_t TTL) {
+			std::lock_guard G(Mutex_);
+			TTL_ = TTL;
+		}
+
+		//	The other devices in the venue of Source. A stale venue is still returned, MustRefresh
+		//	tells the caller to look it up again.
+		inline bool Find(const std::string &Source, std::vector<std::string> &SerialNumbers,
+						 bool &MustRefresh, std::uint64_t Now) {
+			std::lock_guard G(Mutex_);
+			auto Venue = SerialToVenue_.find(Source);
+			if (Venue == SerialToVenue_.end()) {
+				MustRefresh = true;
+				return false;
+			}
+			auto Info = Venues_.find(Venue->second);
+			if (Info == Venues_.end()) {
+				MustRefresh = true;
+				return false;
+			}
+			MustRefresh = (Now - Info->second.Updated) >= TTL_;
+			SerialNumbers.clear();
+			SerialNumbers.reserve(Info->second.SerialNumbers.size());
+			for (const auto &SerialNumber : Info->second.SerialNumbers) {
+				if (SerialNumber != Source)
+					SerialNumbers.push_back(SerialNumber);
+			}
+			return true;
+		}
+
+		inline bool IsFresh(const std::string &SerialNumber, std::uint64_t Now) {
+			std::lock_guard G(Mutex_);
+			auto Venue = SerialToVenue_.find(SerialNumber);
+			if (Venue == SerialToVenue_.end())
+				return false;
+			auto Info = Venues_.find(Venue->second);
+			return Info != Venues_.end() && (Now - Info->second.Updated) < TTL_;
+		}
+
+		//	False when a lookup for this serial number is already queued.
+		inline bool AddPending(const std::string &SerialNumber) {
+			std::lock_guard G(Mutex_);
+			return Pending_.insert(SerialNumber).second;
+		}
+
+		inline void ClearPending(const std::string &SerialNumber) {
+			std::lock_guard G(Mutex_);
+			Pending_.erase(SerialNumber);
+		}
+
+		//	The result of a lookup. Not found keeps what we had, the provisioning service may just
+		//	be unreachable.
+		inline void Update(const std::string &SerialNumber, bool Found, const std::string &Venue,
+						   std::vector<std::string> SerialNumbers, std::uint64_t Now) {
+			std::lock_guard G(Mutex_);
+			Pending_.erase(SerialNumber);
+			if (!Found)
+				return;
+			std::sort(SerialNumbers.begin(), SerialNumbers.end());
+			auto Previous = Venues_.find(Venue);
+			if (Previous != Venues_.end()) {
+				for (const auto &OldSerialNumber : Previous->second.SerialNumbers) {
+					auto Hint = SerialToVenue_.find(OldSerialNumber);
+					if (Hint != SerialToVenue_.end() && Hint->second == Venue)
+						SerialToVenue_.erase(Hint);
+				}
+			}
+			for (const auto &NewSerialNumber : SerialNumbers)
+				SerialToVenue_[NewSerialNumber] = Venue;
+			Venues_[Venue] = VenueInfo{.Updated = Now, .SerialNumbers = std::move(SerialNumbers)};
+		}
+
+		[[nodiscard]] inline std::size_t Venues() {
+			std::lock_guard G(Mutex_);
+			return Venues_.size();
+		}
+
+		[[nodiscard]] inline std::size_t Devices() {
+			std::lock_guard G(Mutex_);
+			return SerialToVenue_.size();
+		}
+
+	  private:
+		struct VenueInfo {
+			std::uint64_t Updated = 0;
+			std::vector<std::string> SerialNumbers;
+		};
+
+		std::mutex Mutex_;
+		std::uint64_t TTL_;
+		std::map<std::string, VenueInfo> Venues_;
+		std::map<std::string, std::string> SerialToVenue_;
+		std::set<std::string> Pending_;
+	};
+
+} // namespace OpenWifi
@@ -0,0 +1,244 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Poco/File.h"
+#include "Poco/zlib.h"
+
+#include "fmt/format.h"
+
+#include "WarmStart.h"
+#include "framework/MetricsRegistry.h"
+#include "framework/MicroServiceFuncs.h"
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	static constexpr char Magic[8] = {'O', 'W', 'G', 'W', 'W', 'A', 'R', 'M'};
+	static constexpr std::uint32_t ByteOrderMark = 0x01020304;
+	static constexpr std::uint32_t MaxSections = 64;
+
+	struct FileHeader {
+		char Magic[8];
+		std::uint32_t Version;
+		std::uint32_t ByteOrder;
+		std::uint32_t Sections;
+		std::uint32_t Reserved;
+		std::uint64_t Created;
+	};
+	static_assert(sizeof(FileHeader) == 32);
+
+	struct SectionEntry {
+		char Name[16];
+		std::uint64_t Offset;
+		std::uint64_t Size;
+		std::uint32_t Crc;
+		std::uint32_t Reserved;
+	};
+	static_assert(sizeof(SectionEntry) == 40);
+
+	static std::uint32_t Crc32(const char *Data, std::size_t Size) {
+		return (std::uint32_t)crc32(0L, (const Bytef *)Data, (uInt)Size);
+	}
+
+	int WarmStart::Start() {
+		Started_ = std::chrono::steady_clock::now();
+		Enabled_ = MicroServiceConfigGetBool("openwifi.warmstart.enable", true);
+		if (!Enabled_) {
+			poco_notice(Logger(), "Disabled, caches are loaded from the database.");
+			return 0;
+		}
+
+		FileName_ = MicroServiceConfigPath("openwifi.warmstart.file",
+										   MicroServiceDataDirectory() + "/warmstart.bin");
+		MaxAge_ = MicroServiceConfigGetInt("openwifi.warmstart.maxage", 7 * 24 * 60 * 60);
+		auto Interval = std::max((std::uint64_t)60,
+								 MicroServiceConfigGetInt("openwifi.warmstart.interval", 900));
+		Load();
+
+		TimerCallback_ = std::make_unique<Poco::TimerCallback<WarmStart>>(*this, &WarmStart::onTimer);
+		Timer_.setStartInterval(Interval * 1000);
+		Timer_.setPeriodicInterval(Interval * 1000);
+		Timer_.start(*TimerCallback_, MicroServiceTimerPool());
+		return 0;
+	}
+
+	void WarmStart::Stop() {
+		if (!Enabled_)
+			return;
+		poco_notice(Logger(), "Stopping...");
+		Timer_.stop();
+		Save();
+		poco_notice(Logger(), "Stopped...");
+	}
+
+	bool WarmStart::Load() {
+		auto Reject = [this](const std::string &Reason) {
+			poco_warning(Logger(), fmt::format("Snapshot {} ignored: {}.", FileName_, Reason));
+			Sections_.clear();
+			Map_.reset();
+			return false;
+		};
+
+		try {
+			Poco::File F(FileName_);
+			if (!F.exists()) {
+				poco_notice(Logger(), fmt::format("No snapshot in {}.", FileName_));
+				return false;
+			}
+			if (F.getSize() < sizeof(FileHeader))
+				return Reject("too short");
+			Map_ = std::make_unique<Poco::SharedMemory>(F, Poco::SharedMemory::AM_READ);
+		} catch (const Poco::Exception &E) {
+			return Reject(E.displayText());
+		}
+
+		const char *Base = Map_->begin();
+		std::uint64_t Size = Map_->end() - Map_->begin();
+		FileHeader H{};
+		std::memcpy(&H, Base, sizeof(H));
+		if (std::memcmp(H.Magic, Magic, sizeof(Magic)) != 0)
+			return Reject("not a snapshot");
+		if (H.Version != Version || H.ByteOrder != ByteOrderMark)
+			return Reject(fmt::format("version {} is not supported", H.Version));
+		if (H.Sections > MaxSections || sizeof(H) + H.Sections * sizeof(SectionEntry) > Size)
+			return Reject("bad section table");
+		auto Now = Utils::Now();
+		auto Age = Now > H.Created ? Now - H.Created : 0;
+		if (H.Created > Now + 60 || (MaxAge_ && Age > MaxAge_))
+			return Reject(fmt::format("created at {}, {}s old", H.Created, Age));
+
+		for (std::uint32_t i = 0; i < H.Sections; ++i) {
+			SectionEntry E{};
+			std::memcpy(&E, Base + sizeof(H) + i * sizeof(E), sizeof(E));
+			if (E.Offset > Size || E.Size > Size - E.Offset)
+				return Reject("section out of bounds");
+			if (Crc32(Base + E.Offset, E.Size) != E.Crc)
+				return Reject("checksum mismatch");
+			Sections_[std::string(E.Name, strnlen(E.Name, sizeof(E.Name)))] =
+				std::string_view(Base + E.Offset, E.Size);
+		}
+		Created_ = H.Created;
+		poco_notice(Logger(), fmt::format("Snapshot {} taken {}s ago, {} sections.", FileName_, Age,
+										  H.Sections));
+		return true;
+	}
+
+	void WarmStart::Register(const std::string &Name, SectionWriter Writer) {
+		if (!Enabled_)
+			return;
+		std::lock_guard G(WritersMutex_);
+		//	a subsystem restarted by reinitialize registers again.
+		for (auto &[Existing, W] : Writers_) {
+			if (Existing == Name) {
+				W = std::move(Writer);
+				return;
+			}
+		}
+		Writers_.emplace_back(Name, std::move(Writer));
+	}
+
+	std::string_view WarmStart::Section(const std::string &Name) const {
+		auto Hint = Sections_.find(Name);
+		return Hint == Sections_.end() ? std::string_view{} : Hint->second;
+	}
+
+	void WarmStart::Ready(const std::string &Part, bool FromSnapshot) {
+		auto Elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+						   std::chrono::steady_clock::now() - Started_)
+						   .count();
+		auto Source = FromSnapshot ? "snapshot" : "database";
+		MetricsRegistry()
+			->Gauge("owgw_startup_ready_milliseconds",
+					"Time from startup until each cache, and the gateway, were ready.",
+					{{"part", Part}, {"source", Source}})
+			.Set(Elapsed);
+		poco_notice(Logger(), fmt::format("{} ready {}ms after startup, from the {}.", Part,
+										  Elapsed, Source));
+		//	the caches are loaded once devices are accepted, nothing reads the snapshot after.
+		if (Part == "gateway") {
+			Sections_.clear();
+			Map_.reset();
+		}
+	}
+
+	void WarmStart::onTimer([[maybe_unused]] Poco::Timer &timer) {
+		Utils::SetThreadName("warm-start");
+		Save();
+	}
+
+	void WarmStart::Save() {
+		auto Start = std::chrono::steady_clock::now();
+		std::vector<std::pair<std::string, std::string>> Payloads;
+		{
+			std::lock_guard G(WritersMutex_);
+			for (const auto &[Name, Writer] : Writers_) {
+				try {
+					std::ostringstream OS;
+					Poco::BinaryWriter W(OS);
+					Writer(W);
+					W.flush();
+					Payloads.emplace_back(Name, OS.str());
+				} catch (const Poco::Exception &E) {
+					poco_warning(Logger(), fmt::format("Section {} not saved: {}", Name,
+													   E.displayText()));
+				}
+			}
+		}
+
+		FileHeader H{};
+		std::memcpy(H.Magic, Magic, sizeof(Magic));
+		H.Version = Version;
+		H.ByteOrder = ByteOrderMark;
+		H.Sections = (std::uint32_t)Payloads.size();
+		H.Created = Utils::Now();
+
+		std::vector<SectionEntry> Entries(Payloads.size());
+		std::uint64_t Offset = sizeof(H) + Entries.size() * sizeof(SectionEntry);
+		for (std::size_t i = 0; i < Payloads.size(); ++i) {
+			Offset = (Offset + 7) & ~(std::uint64_t)7;
+			std::strncpy(Entries[i].Name, Payloads[i].first.c_str(), sizeof(Entries[i].Name));
+			Entries[i].Offset = Offset;
+			Entries[i].Size = Payloads[i].second.size();
+			Entries[i].Crc = Crc32(Payloads[i].second.data(), Payloads[i].second.size());
+			Offset += Entries[i].Size;
+		}
+
+		//	written aside and renamed, a crash never leaves half a snapshot and the file mapped
+		//	at startup stays valid.
+		auto TmpFileName = FileName_ + ".tmp";
+		try {
+			{
+				std::ofstream Out(TmpFileName, std::ios::binary | std::ios::trunc);
+				Out.write((const char *)&H, sizeof(H));
+				Out.write((const char *)Entries.data(), Entries.size() * sizeof(SectionEntry));
+				std::uint64_t Written = sizeof(H) + Entries.size() * sizeof(SectionEntry);
+				for (std::size_t i = 0; i < Payloads.size(); ++i) {
+					static const char Padding[8]{};
+					Out.write(Padding, Entries[i].Offset - Written);
+					Out.write(Payloads[i].second.data(), Payloads[i].second.size());
+					Written = Entries[i].Offset + Entries[i].Size;
+				}
+				Out.close();
+				if (!Out)
+					throw Poco::WriteFileException(TmpFileName);
+			}
+			Poco::File(TmpFileName).renameTo(FileName_);
+			poco_information(
+				Logger(),
+				fmt::format("Snapshot saved to {}: {} bytes in {}ms.", FileName_, Offset,
+							std::chrono::duration_cast<std::chrono::milliseconds>(
+								std::chrono::steady_clock::now() - Start)
+								.count()));
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("Snapshot not saved: {}", E.displayText()));
+		}
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,82 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Poco/BinaryWriter.h"
+#include "Poco/SharedMemory.h"
+#include "Poco/Timer.h"
+
+#include "framework/SubSystemServer.h"
+
+namespace OpenWifi {
+
+	//	Caches that take a database scan or a file parse to rebuild are saved to one snapshot
+	//	file, periodically and at shutdown. At startup the file is mapped and validated, and each
+	//	cache loads its section, then catches up with the database. Starts before every cache
+	//	and stops after them.
+	//
+	//	File layout, in host byte order: a header (magic, version, byte order mark, section
+	//	count, creation time), a table of sections (name, offset, size, CRC-32), then the
+	//	sections, each aligned on 8 bytes.
+	class WarmStart : public SubSystemServer {
+	  public:
+		using SectionWriter = std::function<void(Poco::BinaryWriter &)>;
+
+		static auto instance() {
+			static auto instance_ = new WarmStart;
+			return instance_;
+		}
+
+		int Start() override;
+		void Stop() override;
+
+		//	Called by a cache when it starts, Name is at most 15 characters. Writer runs on the
+		//	snapshot timer and at shutdown.
+		void Register(const std::string &Name, SectionWriter Writer);
+		//	The section from the snapshot found at startup, empty if there is none.
+		[[nodiscard]] std::string_view Section(const std::string &Name) const;
+		//	When that snapshot was taken, 0 if none was loaded.
+		[[nodiscard]] inline std::uint64_t Created() const { return Created_; }
+
+		//	Records how long Part took to be ready since startup began.
+		void Ready(const std::string &Part, bool FromSnapshot);
+
+		void Save();
+		void onTimer(Poco::Timer &timer);
+
+	  private:
+		static constexpr std::uint32_t Version = 1;
+
+		bool Enabled_ = true;
+		std::string FileName_;
+		std::uint64_t MaxAge_ = 0;
+		std::uint64_t Created_ = 0;
+		std::unique_ptr<Poco::SharedMemory> Map_;
+		std::map<std::string, std::string_view> Sections_;
+		std::chrono::steady_clock::time_point Started_;
+
+		std::mutex WritersMutex_;
+		std::vector<std::pair<std::string, SectionWriter>> Writers_;
+		Poco::Timer Timer_;
+		std::unique_ptr<Poco::TimerCallback<WarmStart>> TimerCallback_;
+
+		bool Load();
+
+		WarmStart() noexcept : SubSystemServer("WarmStart", "WARM-START", "openwifi.warmstart") {}
+	};
+
+	inline auto WarmStart() { return WarmStart::instance(); }
+
+} // namespace OpenWifi
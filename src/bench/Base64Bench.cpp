@@ -0,0 +1,146 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Decoding of compress_64 payloads, as devices send them, at 5 to 200 KB of base64. Compares
+//	the stream decoder and uncompress() the gateway used before with each base64 kernel the
+//	CPU has, and times base64 alone both ways. Build and run:
+//		cmake --build . --target owgw_base64_bench && ./owgw_base64_bench
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Poco/Base64Decoder.h"
+#include "Poco/StreamCopier.h"
+
+#include "fmt/format.h"
+
+#include "framework/utils.h"
+
+namespace OpenWifi::Bench {
+
+	//	What ExtractBase64CompressedData did before the buffer versions.
+	static bool StreamExtract(const std::string &CompressedData, std::string &UnCompressedData,
+							  uint64_t compress_sz) {
+		std::istringstream ifs(CompressedData);
+		Poco::Base64Decoder b64in(ifs);
+		std::ostringstream ofs;
+		Poco::StreamCopier::copyStream(b64in, ofs);
+
+		int factor = 20;
+		unsigned long MaxSize = compress_sz ? (unsigned long)(compress_sz + 5000)
+											: (unsigned long)(ofs.str().size() * factor);
+		while (true) {
+			std::vector<uint8_t> UncompressedBuffer(MaxSize);
+			unsigned long FinalSize = MaxSize;
+			auto status = uncompress((uint8_t *)&UncompressedBuffer[0], &FinalSize,
+									 (uint8_t *)ofs.str().c_str(), ofs.str().size());
+			if (status == Z_OK) {
+				UncompressedBuffer[FinalSize] = 0;
+				UnCompressedData = (char *)&UncompressedBuffer[0];
+				return true;
+			}
+			if (status == Z_BUF_ERROR && factor < 300) {
+				factor += 10;
+				MaxSize = ofs.str().size() * factor;
+				continue;
+			}
+			return false;
+		}
+	}
+
+	//	A state message: repetitive keys, varying counters.
+	static std::string StateText(std::size_t Interfaces, std::mt19937 &R) {
+		std::string Text = R"({"interfaces":[)";
+		for (std::size_t i = 0; i < Interfaces; ++i) {
+			Text += fmt::format(
+				R"({{"name":"wlan{}","counters":{{"rx_bytes":{},"tx_bytes":{},"rx_packets":{},)"
+				R"("tx_packets":{}}},"clients":[{{"mac":"{:012x}","rssi":-{},"inactive":{}}}]}},)",
+				i, R(), R(), R() % 100000, R() % 100000, (std::uint64_t)R() << 16 | R() % 65536,
+				30 + R() % 60, R() % 300);
+		}
+		Text.back() = ']';
+		return Text + "}";
+	}
+
+	struct Payload {
+		std::string Text, Base64;
+	};
+
+	static Payload MakePayload(std::size_t Target, std::mt19937 &R) {
+		Payload P;
+		for (std::size_t Interfaces = 8;; Interfaces += Interfaces / 4) {
+			P.Text = StateText(Interfaces, R);
+			uLongf Size = compressBound(P.Text.size());
+			std::vector<Utils::byte> Compressed(Size);
+			compress2(Compressed.data(), &Size, (const Bytef *)P.Text.data(), P.Text.size(), 6);
+			P.Base64 = Utils::base64encode(Compressed.data(), Size);
+			if (P.Base64.size() >= Target)
+				return P;
+		}
+	}
+
+	//	Nanoseconds per call, repeated for at least 200ms.
+	template <typename F> static double Time(F &&Call) {
+		using Clock = std::chrono::steady_clock;
+		std::uint64_t Calls = 0;
+		auto Start = Clock::now();
+		std::chrono::nanoseconds Elapsed{};
+		do {
+			for (int i = 0; i < 16; ++i)
+				Call();
+			Calls += 16;
+			Elapsed = Clock::now() - Start;
+		} while (Elapsed < std::chrono::milliseconds(200));
+		return (double)Elapsed.count() / (double)Calls;
+	}
+
+	static int Run() {
+		std::mt19937 R(20240601);
+		std::vector<std::string> Kernels;
+		for (const auto &K : {"avx2", "ssse3", "scalar"})
+			if (Utils::base64implementation(K))
+				Kernels.emplace_back(K);
+
+		fmt::print("{:>8}{:>10}{:>8}{:>14}{:>14}{:>16}\n", "base64", "text", "impl",
+				   "decode MB/s", "encode MB/s", "payload us");
+		for (std::size_t Target : {5000, 20000, 50000, 100000, 200000}) {
+			auto P = MakePayload(Target, R);
+			std::vector<Utils::byte> Raw(Utils::base64decodedsize(P.Base64.size()));
+			std::string Encoded(P.Base64.size(), '\0'), Text;
+			std::size_t RawSize = 0;
+
+			auto Stream = Time([&] { StreamExtract(P.Base64, Text, P.Text.size()); });
+			if (Text != P.Text)
+				return fmt::print(stderr, "stream decoder mismatch\n"), 1;
+			fmt::print("{:>8}{:>10}{:>8}{:>14}{:>14}{:>16.1f}\n", P.Base64.size(), P.Text.size(),
+					   "stream", "", "", Stream / 1000.0);
+
+			for (const auto &K : Kernels) {
+				Utils::base64implementation(K);
+				auto Decode = Time([&] {
+					(void)Utils::base64decode(P.Base64.data(), P.Base64.size(), Raw.data(),
+											  RawSize);
+				});
+				auto Encode =
+					Time([&] { Utils::base64encode(Raw.data(), RawSize, Encoded.data()); });
+				auto Extract = Time(
+					[&] { Utils::ExtractBase64CompressedData(P.Base64, Text, P.Text.size()); });
+				if (Text != P.Text || Encoded != P.Base64)
+					return fmt::print(stderr, "{} mismatch\n", K), 1;
+				fmt::print("{:>8}{:>10}{:>8}{:>14.0f}{:>14.0f}{:>16.1f}\n", "", "", K,
+						   P.Base64.size() / Decode * 1000.0, P.Base64.size() / Encode * 1000.0,
+						   Extract / 1000.0);
+			}
+		}
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main() { return OpenWifi::Bench::Run(); }
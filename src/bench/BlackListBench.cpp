@@ -0,0 +1,187 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Blacklist lookups as connections make them, from several threads while the list is
+//	republished now and then. Compares the map behind one mutex the gateway used before with the
+//	snapshot published under a shared_mutex, as a std::atomic<std::shared_ptr> loaded on every
+//	lookup, and through SharedBlackList as Storage does it. The differences between the last
+//	three only show with several cores. Build and run:
+//		cmake --build . --target owgw_blacklist_bench && ./owgw_blacklist_bench
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "storage/storage_blacklist.h"
+
+namespace OpenWifi::Bench {
+
+	//	What Storage::IsBlackListed did before the snapshot.
+	class MapBlackList {
+	  public:
+		explicit MapBlackList(const BlackListMap &Devices) : Devices_(Devices) {}
+		bool IsBlackListed(std::uint64_t Serial) {
+			std::lock_guard G(Mutex_);
+			return Devices_.find(Serial) != Devices_.end();
+		}
+		void Update(std::uint64_t Serial) {
+			std::lock_guard G(Mutex_);
+			Devices_[Serial] = BlackListDetails{};
+		}
+
+	  private:
+		std::recursive_mutex Mutex_;
+		BlackListMap Devices_;
+	};
+
+	//	The snapshot behind a shared_mutex, as Storage published it before SharedBlackList.
+	class LockedSnapshotBlackList {
+	  public:
+		explicit LockedSnapshotBlackList(const BlackListMap &Devices)
+			: Current_(std::make_shared<const BlackListSnapshot>(Devices)) {}
+		bool IsBlackListed(std::uint64_t Serial) {
+			std::shared_ptr<const BlackListSnapshot> Current;
+			{
+				std::shared_lock Lock(Mutex_);
+				Current = Current_;
+			}
+			return Current->Find(Serial) != nullptr;
+		}
+		void Update(std::uint64_t Serial) {
+			std::lock_guard G(UpdateMutex_);
+			auto Devices = Current_->Devices();
+			Devices[Serial] = BlackListDetails{};
+			auto Next = std::make_shared<const BlackListSnapshot>(Devices);
+			std::unique_lock Lock(Mutex_);
+			Current_ = std::move(Next);
+		}
+
+	  private:
+		std::mutex UpdateMutex_;
+		std::shared_mutex Mutex_;
+		std::shared_ptr<const BlackListSnapshot> Current_;
+	};
+
+	//	The snapshot as a std::atomic<std::shared_ptr>, loaded on every lookup.
+	class AtomicSnapshotBlackList {
+	  public:
+		explicit AtomicSnapshotBlackList(const BlackListMap &Devices)
+			: Current_(std::make_shared<const BlackListSnapshot>(Devices)) {}
+		bool IsBlackListed(std::uint64_t Serial) {
+			return Current_.load()->Find(Serial) != nullptr;
+		}
+		void Update(std::uint64_t Serial) {
+			std::lock_guard G(UpdateMutex_);
+			auto Devices = Current_.load()->Devices();
+			Devices[Serial] = BlackListDetails{};
+			Current_.store(std::make_shared<const BlackListSnapshot>(Devices));
+		}
+
+	  private:
+		std::mutex UpdateMutex_;
+		std::atomic<std::shared_ptr<const BlackListSnapshot>> Current_;
+	};
+
+	//	As Storage::IsBlackListed and UpdateBlackList do it.
+	class SharedSnapshotBlackList {
+	  public:
+		explicit SharedSnapshotBlackList(const BlackListMap &Devices) {
+			List_.Store(std::make_shared<const BlackListSnapshot>(Devices));
+		}
+		bool IsBlackListed(std::uint64_t Serial) { return List_.Lookup().Find(Serial) != nullptr; }
+		void Update(std::uint64_t Serial) {
+			std::lock_guard G(UpdateMutex_);
+			auto Devices = List_.Load()->Devices();
+			Devices[Serial] = BlackListDetails{};
+			List_.Store(std::make_shared<const BlackListSnapshot>(Devices));
+		}
+
+	  private:
+		std::mutex UpdateMutex_;
+		SharedBlackList List_;
+	};
+
+	//	Millions of lookups per second over all threads. One lookup in a hundred is for a
+	//	listed device, and the list changes ten times a second.
+	template <typename List>
+	static double Run(List &L, const std::vector<std::uint64_t> &Listed, unsigned Threads) {
+		std::atomic_bool Running = true;
+		std::atomic_uint64_t Lookups = 0, Found = 0;
+		std::vector<std::thread> Workers;
+		for (unsigned t = 0; t < Threads; ++t) {
+			Workers.emplace_back([&, t] {
+				std::mt19937_64 R(t + 1);
+				std::uint64_t Local = 0, Hits = 0;
+				while (Running.load(std::memory_order_relaxed)) {
+					for (int i = 0; i < 1024; ++i) {
+						auto Serial = (!Listed.empty() && R() % 100 == 0)
+										  ? Listed[R() % Listed.size()]
+										  : (R() & 0xffffffffffffULL);
+						Hits += L.IsBlackListed(Serial);
+					}
+					Local += 1024;
+				}
+				Lookups += Local;
+				Found += Hits;
+			});
+		}
+		auto Start = std::chrono::steady_clock::now();
+		std::mt19937_64 R(0);
+		for (int i = 0; i < 10; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			L.Update(R() & 0xffffffffffffULL);
+		}
+		Running = false;
+		for (auto &W : Workers)
+			W.join();
+		auto Seconds =
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		return (double)Lookups / Seconds / 1e6;
+	}
+
+	static int Run() {
+		auto Cores = std::max(1u, std::thread::hardware_concurrency());
+		fmt::print("{} cores, millions of lookups per second\n", Cores);
+		fmt::print("{:>8}{:>9}{:>10}{:>14}{:>10}{:>12}\n", "listed", "threads", "map",
+				   "shared_mutex", "atomic", "per thread");
+		for (std::size_t Size : {0, 1000, 100000}) {
+			std::mt19937_64 R(Size);
+			BlackListMap Devices;
+			std::vector<std::uint64_t> Listed;
+			while (Devices.size() < Size) {
+				auto Serial = R() & 0xffffffffffffULL;
+				if (Devices.emplace(Serial, BlackListDetails{}).second)
+					Listed.push_back(Serial);
+			}
+			std::vector<unsigned> ThreadCounts{1};
+			for (auto T : {4u, Cores})
+				if (T > ThreadCounts.back())
+					ThreadCounts.push_back(T);
+			for (auto Threads : ThreadCounts) {
+				MapBlackList Map(Devices);
+				LockedSnapshotBlackList Locked(Devices);
+				AtomicSnapshotBlackList Atomic(Devices);
+				SharedSnapshotBlackList PerThread(Devices);
+				auto MapRate = Run(Map, Listed, Threads);
+				auto LockedRate = Run(Locked, Listed, Threads);
+				auto AtomicRate = Run(Atomic, Listed, Threads);
+				auto PerThreadRate = Run(PerThread, Listed, Threads);
+				fmt::print("{:>8}{:>9}{:>10.1f}{:>14.1f}{:>10.1f}{:>12.1f}\n", Size, Threads,
+						   MapRate, LockedRate, AtomicRate, PerThreadRate);
+			}
+		}
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main() { return OpenWifi::Bench::Run(); }
@@ -0,0 +1,211 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Provisioning lookups per second: the default configuration picked for a new device, read as
+//	the gateway did before the index, every row of DefaultConfigs selected and its models parsed
+//	on each lookup, and as FindDefaultConfigurationForModel does it now, through the published
+//	DefaultConfigIndex. Devices ask for known models, for models only a wildcard covers, and
+//	for models nothing covers. The table is on SQLite, read with its C API where the gateway
+//	goes through Poco::Data. Build and run:
+//		cmake --build . --target owgw_defconfig_bench && ./owgw_defconfig_bench
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "fmt/format.h"
+
+#include "framework/RESTAPI_utils.h"
+#include "storage/storage_defconfig.h"
+
+namespace OpenWifi::Bench {
+
+	static void Exec(sqlite3 *Db, const std::string &Sql) {
+		char *Error = nullptr;
+		if (sqlite3_exec(Db, Sql.c_str(), nullptr, nullptr, &Error) != SQLITE_OK) {
+			std::string Reason = Error ? Error : "unknown";
+			sqlite3_free(Error);
+			throw std::runtime_error(fmt::format("{}: {}", Sql.substr(0, 60), Reason));
+		}
+	}
+
+	static std::string Text(sqlite3_stmt *S, int Column) {
+		auto T = (const char *)sqlite3_column_text(S, Column);
+		return T == nullptr ? std::string{} : std::string(T);
+	}
+
+	static std::string ModelName(std::uint64_t i) { return fmt::format("vendor_model{:04}", i); }
+
+	//	Configs rows, each listing 4 models, one in ten a wildcard, on two platforms.
+	static void Load(sqlite3 *Db, std::uint64_t Configs) {
+		Exec(Db, "CREATE TABLE DefaultConfigs (Name VARCHAR(30) PRIMARY KEY, Configuration TEXT, "
+				 "Models TEXT, Description TEXT, Created BIGINT, LastModified BIGINT, "
+				 "Platform TEXT)");
+		sqlite3_stmt *S = nullptr;
+		if (sqlite3_prepare_v2(Db, "INSERT INTO DefaultConfigs VALUES(?,?,?,?,0,0,?)", -1, &S,
+							   nullptr) != SQLITE_OK)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+		std::string Configuration(4096, 'c');
+		Exec(Db, "BEGIN");
+		for (std::uint64_t i = 0; i < Configs; ++i) {
+			Types::StringVec Models;
+			if (i % 10 == 9)
+				Models.emplace_back("*");
+			else
+				for (std::uint64_t m = 0; m < 4; ++m)
+					Models.push_back(ModelName(i * 4 + m));
+			auto Name = fmt::format("config{:05}", i);
+			auto ModelText = RESTAPI_utils::to_string(Models);
+			sqlite3_bind_text(S, 1, Name.c_str(), -1, SQLITE_TRANSIENT);
+			sqlite3_bind_text(S, 2, Configuration.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_text(S, 3, ModelText.c_str(), -1, SQLITE_TRANSIENT);
+			sqlite3_bind_text(S, 4, "bench", -1, SQLITE_STATIC);
+			sqlite3_bind_text(S, 5, i % 2 ? "switch" : "ap", -1, SQLITE_STATIC);
+			sqlite3_step(S);
+			sqlite3_reset(S);
+		}
+		Exec(Db, "COMMIT");
+		sqlite3_finalize(S);
+	}
+
+	static void Convert(sqlite3_stmt *S, GWObjects::DefaultConfiguration &T) {
+		T.name = Text(S, 0);
+		T.configuration = Text(S, 1);
+		T.models = RESTAPI_utils::to_object_array(Text(S, 2));
+		T.description = Text(S, 3);
+		T.created = (std::uint64_t)sqlite3_column_int64(S, 4);
+		T.lastModified = (std::uint64_t)sqlite3_column_int64(S, 5);
+		T.platform = Text(S, 6);
+	}
+
+	//	Before: the whole table on every lookup, the first row that matches wins.
+	static bool Scan(sqlite3 *Db, const std::string &Model, const std::string &Platform,
+					 GWObjects::DefaultConfiguration &Config) {
+		sqlite3_stmt *S = nullptr;
+		if (sqlite3_prepare_v2(Db,
+							   "SELECT Name, Configuration, Models, Description, Created, "
+							   "LastModified, Platform FROM DefaultConfigs",
+							   -1, &S, nullptr) != SQLITE_OK)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+		std::vector<GWObjects::DefaultConfiguration> Rows;
+		while (sqlite3_step(S) == SQLITE_ROW)
+			Convert(S, Rows.emplace_back());
+		sqlite3_finalize(S);
+		for (const auto &C : Rows) {
+			if (C.platform != Platform)
+				continue;
+			for (const auto &M : C.models) {
+				if (M == "*" || M == Model) {
+					Config = C;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	//	After: as Storage::RefreshDefaultConfigurationIndex and FindDefaultConfigurationForModel.
+	struct Published {
+		std::shared_mutex Mutex;
+		std::shared_ptr<const DefaultConfigIndex> Index;
+
+		explicit Published(sqlite3 *Db) {
+			sqlite3_stmt *S = nullptr;
+			if (sqlite3_prepare_v2(Db,
+								   "SELECT Name, Configuration, Models, Description, Created, "
+								   "LastModified, Platform FROM DefaultConfigs",
+								   -1, &S, nullptr) != SQLITE_OK)
+				throw std::runtime_error(sqlite3_errmsg(Db));
+			auto Built = std::make_shared<DefaultConfigIndex>();
+			while (sqlite3_step(S) == SQLITE_ROW) {
+				auto C = std::make_shared<GWObjects::DefaultConfiguration>();
+				Convert(S, *C);
+				Built->Add(C);
+			}
+			sqlite3_finalize(S);
+			Index = std::move(Built);
+		}
+
+		bool Find(const std::string &Model, const std::string &Platform,
+				  GWObjects::DefaultConfiguration &Config) {
+			std::shared_ptr<const DefaultConfigIndex> Current;
+			{
+				std::shared_lock Lock(Mutex);
+				Current = Index;
+			}
+			if (auto C = Current->Find(Platform, Model); C != nullptr) {
+				Config = *C;
+				return true;
+			}
+			return false;
+		}
+	};
+
+	//	Lookups per second for about a second of lookups. Device i asks for a known model, a
+	//	model nobody lists, or a model of the other platform, in turn.
+	template <typename F> static double PerSecond(std::uint64_t Configs, F Lookup) {
+		std::uint64_t Lookups = 0, Found = 0;
+		auto Start = std::chrono::steady_clock::now();
+		double Seconds = 0;
+		while (Seconds < 1.0) {
+			for (int k = 0; k < 16; ++k, ++Lookups) {
+				auto Model = Lookups % 3 == 1 ? std::string("unknown_model")
+											  : ModelName((Lookups * 7919) % (Configs * 4));
+				const char *Platform = Lookups % 3 == 2 ? "switch" : "ap";
+				GWObjects::DefaultConfiguration Config;
+				Found += Lookup(Model, Platform, Config);
+			}
+			Seconds =
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		}
+		if (Found == 0)
+			throw std::runtime_error("no lookup matched");
+		return (double)Lookups / Seconds;
+	}
+
+	static int Run() {
+		fmt::print("{:>10}{:>16}{:>16}{:>10}\n", "configs", "scan /s", "index /s", "speedup");
+		for (std::uint64_t Configs : {10, 100, 1000}) {
+			auto File = fmt::format("/tmp/owgw_defconfig_bench_{}.db",
+									std::chrono::steady_clock::now().time_since_epoch().count());
+			sqlite3 *Db = nullptr;
+			if (sqlite3_open(File.c_str(), &Db) != SQLITE_OK)
+				throw std::runtime_error("cannot open " + File);
+			Load(Db, Configs);
+			auto ScanRate = PerSecond(Configs, [Db](const std::string &Model, const char *Platform,
+													GWObjects::DefaultConfiguration &Config) {
+				return Scan(Db, Model, Platform, Config);
+			});
+			Published Index(Db);
+			auto IndexRate = PerSecond(Configs, [&Index](const std::string &Model,
+														 const char *Platform,
+														 GWObjects::DefaultConfiguration &Config) {
+				return Index.Find(Model, Platform, Config);
+			});
+			fmt::print("{:>10}{:>16.0f}{:>16.0f}{:>9.0f}x\n", Configs, ScanRate, IndexRate,
+					   IndexRate / ScanRate);
+			std::fflush(stdout);
+			sqlite3_close(Db);
+			std::remove(File.c_str());
+		}
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main() {
+	try {
+		return OpenWifi::Bench::Run();
+	} catch (const std::exception &E) {
+		fmt::print(stderr, "{}\n", E.what());
+	}
+	return 1;
+}
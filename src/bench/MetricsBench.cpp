@@ -0,0 +1,112 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	What a metric update costs on the paths that make them: a counter kept by reference as the
+//	frame counters are, the same counter shared by several threads, a histogram feeding a
+//	shared series as the storage timings do, and a series looked up on every update as the
+//	command counters are. The empty loop is the baseline. Contention between threads only
+//	shows with several cores. Build and run:
+//		cmake --build . --target owgw_metrics_bench && ./owgw_metrics_bench
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "framework/MetricsRegistry.h"
+
+namespace OpenWifi::Bench {
+
+	static constexpr std::uint64_t Updates = 20000000;
+
+	//	Keeps the loop from being folded away.
+	static inline void Escape(std::uint64_t &V) { asm volatile("" : "+r"(V)); }
+
+	//	Nanoseconds per update, Threads threads each running Update Updates / Threads times.
+	template <typename F> static double PerUpdate(unsigned Threads, std::uint64_t Count, F Update) {
+		std::atomic_bool Go = false;
+		std::vector<std::thread> Pool;
+		for (unsigned t = 0; t < Threads; ++t) {
+			Pool.emplace_back([&, t] {
+				while (!Go)
+					std::this_thread::yield();
+				for (std::uint64_t i = t; i < Count; i += Threads)
+					Update(i);
+			});
+		}
+		auto Start = std::chrono::steady_clock::now();
+		Go = true;
+		for (auto &T : Pool)
+			T.join();
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start)
+				   .count() /
+			   (double)Count;
+	}
+
+	static int Run() {
+		auto Registry = MetricsRegistry();
+		auto &Counter = Registry->Counter("bench_frames_total", "Frames.", {{"op", "text"}});
+		auto &Shared = Registry->Histogram("bench_query_seconds", "Queries.");
+		MetricHistogram Local;
+		Local.Export(Shared);
+		//	as many series as the command counters have.
+		std::vector<std::string> Commands;
+		for (int i = 0; i < 40; ++i) {
+			Commands.push_back(fmt::format("command{}", i));
+			for (const char *Name : {"bench_sent_total", "bench_completed_total",
+									 "bench_timed_out_total", "bench_failures_total"})
+				Registry->Counter(Name, "Commands.", {{"command", Commands.back()}});
+		}
+
+		fmt::print("{:>40}{:>10}{:>12}\n", "update", "threads", "ns/update");
+		auto Line = [](const char *What, unsigned Threads, double Ns) {
+			fmt::print("{:>40}{:>10}{:>12.2f}\n", What, Threads, Ns);
+			std::fflush(stdout);
+		};
+		Line("empty loop", 1, PerUpdate(1, Updates, [](std::uint64_t i) { Escape(i); }));
+		for (unsigned Threads : {1u, 4u})
+			Line("counter by reference", Threads,
+				 PerUpdate(Threads, Updates, [&Counter](std::uint64_t) { Counter.Inc(); }));
+		for (unsigned Threads : {1u, 4u})
+			Line("histogram with exported series", Threads,
+				 PerUpdate(Threads, Updates / 4,
+						   [&Local](std::uint64_t i) { Local.Record(i & 0xffff); }));
+		for (unsigned Threads : {1u, 4u})
+			Line("counter looked up on each update", Threads,
+				 PerUpdate(Threads, Updates / 20, [&](std::uint64_t i) {
+					 Registry
+						 ->Counter("bench_sent_total", "Commands.",
+								   {{"command", Commands[i % Commands.size()]}})
+						 .Inc();
+				 }));
+
+		std::ostringstream Scrape;
+		auto Start = std::chrono::steady_clock::now();
+		Registry->Render(Scrape);
+		fmt::print("one scrape of {} bytes: {:.0f}us\n", Scrape.str().size(),
+				   std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() -
+															 Start)
+					   .count());
+		if (Counter.Value() == 0 || Shared.Count() != Local.Count())
+			throw std::runtime_error("updates were lost");
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main() {
+	try {
+		return OpenWifi::Bench::Run();
+	} catch (const std::exception &E) {
+		fmt::print(stderr, "{}\n", E.what());
+	}
+	return 1;
+}
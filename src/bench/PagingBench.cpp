@@ -0,0 +1,169 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Statistics listings on SQLite, paged with OFFSET and with the (Recorded, rowid) cursor, for
+//	one device with a million records. Pages of 100 are read at increasing depths, as a client
+//	walking the whole history would read them. The table and its indexes are the gateway's, many
+//	records share a Recorded value as they do when a device reports faster than once a second.
+//	Build and run:
+//		cmake --build . --target owgw_paging_bench && ./owgw_paging_bench [rows]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "fmt/format.h"
+
+namespace OpenWifi::Bench {
+
+	static constexpr std::uint64_t PageSize = 100;
+
+	static void Exec(sqlite3 *Db, const std::string &Sql) {
+		char *Error = nullptr;
+		if (sqlite3_exec(Db, Sql.c_str(), nullptr, nullptr, &Error) != SQLITE_OK) {
+			std::string Reason = Error ? Error : "unknown";
+			sqlite3_free(Error);
+			throw std::runtime_error(fmt::format("{}: {}", Sql.substr(0, 60), Reason));
+		}
+	}
+
+	static sqlite3_stmt *Prepare(sqlite3 *Db, const std::string &Sql) {
+		sqlite3_stmt *S = nullptr;
+		if (sqlite3_prepare_v2(Db, Sql.c_str(), -1, &S, nullptr) != SQLITE_OK)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+		return S;
+	}
+
+	struct Position {
+		std::uint64_t Recorded = 0, RowId = 0;
+	};
+
+	//	One page as GetStatisticsData builds it, the SQL text included. Returns the rows read
+	//	and leaves the last row in Last.
+	static std::uint64_t Page(sqlite3 *Db, bool Seek, std::uint64_t Offset, Position &Last) {
+		std::string St{"SELECT SerialNumber, UUID, Data, Recorded, rowid FROM Statistics WHERE "
+					   "SerialNumber='903cb3bb2496'"};
+		if (Seek && (Last.Recorded || Last.RowId))
+			St += fmt::format(" AND (Recorded>{0} OR (Recorded={0} AND rowid>{1}))", Last.Recorded,
+							  Last.RowId);
+		St += Seek ? fmt::format(" ORDER BY Recorded ASC, rowid ASC LIMIT 0, {}", PageSize)
+				   : fmt::format(" ORDER BY Recorded ASC LIMIT {}, {}", Offset, PageSize);
+		auto S = Prepare(Db, St);
+		std::uint64_t Rows = 0;
+		while (sqlite3_step(S) == SQLITE_ROW) {
+			sqlite3_column_text(S, 2);
+			Last.Recorded = (std::uint64_t)sqlite3_column_int64(S, 3);
+			Last.RowId = (std::uint64_t)sqlite3_column_int64(S, 4);
+			Rows++;
+		}
+		sqlite3_finalize(S);
+		return Rows;
+	}
+
+	//	Milliseconds to read the page starting at row Depth. The seek cursor is positioned on
+	//	the row before, as a token from the previous page would.
+	static double At(sqlite3 *Db, bool Seek, std::uint64_t Depth) {
+		Position Last;
+		if (Seek && Depth > 0) {
+			auto S = Prepare(Db, fmt::format("SELECT Recorded, rowid FROM Statistics WHERE "
+											 "SerialNumber='903cb3bb2496' ORDER BY Recorded ASC, "
+											 "rowid ASC LIMIT {}, 1",
+											 Depth - 1));
+			if (sqlite3_step(S) == SQLITE_ROW) {
+				Last.Recorded = (std::uint64_t)sqlite3_column_int64(S, 0);
+				Last.RowId = (std::uint64_t)sqlite3_column_int64(S, 1);
+			}
+			sqlite3_finalize(S);
+		}
+		const int Repeat = 5;
+		auto Start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Repeat; ++i) {
+			auto Copy = Last;
+			if (Page(Db, Seek, Depth, Copy) != PageSize)
+				throw std::runtime_error(fmt::format("short page at {}", Depth));
+		}
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start)
+				   .count() /
+			   Repeat;
+	}
+
+	//	Walks Pages pages from the start, as a client reading the history would.
+	static void Walk(sqlite3 *Db, std::uint64_t Pages) {
+		double Ms[2] = {0, 0};
+		for (bool Seek : {false, true}) {
+			Position Last;
+			auto Start = std::chrono::steady_clock::now();
+			for (std::uint64_t p = 0; p < Pages; ++p)
+				Page(Db, Seek, p * PageSize, Last);
+			Ms[Seek] = std::chrono::duration<double, std::milli>(
+						   std::chrono::steady_clock::now() - Start)
+						   .count();
+		}
+		fmt::print("first {} pages: OFFSET {:.0f}ms, cursor {:.0f}ms\n", Pages, Ms[0], Ms[1]);
+	}
+
+	static int Run(std::uint64_t Rows) {
+		auto File = fmt::format("/tmp/owgw_paging_bench_{}.db",
+								std::chrono::steady_clock::now().time_since_epoch().count());
+		sqlite3 *Db = nullptr;
+		if (sqlite3_open(File.c_str(), &Db) != SQLITE_OK)
+			throw std::runtime_error("cannot open " + File);
+		Exec(Db, "PRAGMA journal_mode=WAL");
+		Exec(Db, "PRAGMA synchronous=NORMAL");
+		Exec(Db, "CREATE TABLE Statistics (SerialNumber VARCHAR(30), UUID INTEGER, Data TEXT, "
+				 "Recorded BIGINT)");
+		Exec(Db, "CREATE INDEX StatsSerial ON Statistics (SerialNumber ASC, Recorded ASC)");
+		Exec(Db, "CREATE INDEX StatsSerial0 ON Statistics (SerialNumber ASC)");
+
+		auto Start = std::chrono::steady_clock::now();
+		auto Insert = Prepare(Db, "INSERT INTO Statistics (SerialNumber, UUID, Data, Recorded) "
+								  "VALUES('903cb3bb2496', ?, ?, ?)");
+		std::string Data(200, 's');
+		Exec(Db, "BEGIN");
+		for (std::uint64_t i = 0; i < Rows; ++i) {
+			sqlite3_bind_int64(Insert, 1, (sqlite3_int64)i);
+			sqlite3_bind_text(Insert, 2, Data.c_str(), (int)Data.size(), SQLITE_STATIC);
+			//	four records a second.
+			sqlite3_bind_int64(Insert, 3, (sqlite3_int64)(1700000000 + i / 4));
+			sqlite3_step(Insert);
+			sqlite3_reset(Insert);
+		}
+		Exec(Db, "COMMIT");
+		sqlite3_finalize(Insert);
+		fmt::print("{} records loaded in {:.1f}s, pages of {}\n", Rows,
+				   std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count(),
+				   PageSize);
+
+		fmt::print("{:>10}{:>14}{:>14}\n", "depth", "OFFSET ms", "cursor ms");
+		for (auto Fraction : {0.0, 0.01, 0.1, 0.5, 0.99}) {
+			auto Depth = (std::uint64_t)((double)(Rows - PageSize) * Fraction);
+			fmt::print("{:>10}{:>14.2f}{:>14.2f}\n", Depth, At(Db, false, Depth),
+					   At(Db, true, Depth));
+		}
+		Walk(Db, std::min<std::uint64_t>(1000, Rows / PageSize));
+
+		sqlite3_close(Db);
+		for (const auto &Suffix : {"", "-wal", "-shm"})
+			std::remove((File + Suffix).c_str());
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main(int argc, char **argv) {
+	try {
+		return OpenWifi::Bench::Run(
+			std::max<std::uint64_t>(1000, argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000));
+	} catch (const std::exception &E) {
+		fmt::print(stderr, "{}\n", E.what());
+	}
+	return 1;
+}
@@ -0,0 +1,286 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Statistics records on SQLite, stored plain, deflated, and deflated with a per model preset
+//	dictionary as PayloadCodec stores them. Payloads are generated state messages of 50 devices
+//	of one model, with counters that move from one record to the next. Reports the bytes a record
+//	takes in the database file, inserts per second with encoding, in transactions of 100, and
+//	reads per second with decoding, one device at a time in Recorded order. PayloadCodec needs
+//	Poco, so its encoding is written out here: "~z1:<size>:<base64 of deflate>". Build and run:
+//		cmake --build . --target owgw_codec_bench && ./owgw_codec_bench [records]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sqlite3.h>
+#include <zlib.h>
+
+#include "fmt/format.h"
+
+namespace OpenWifi::Bench {
+
+	static constexpr std::uint64_t Devices = 50;
+
+	static void Exec(sqlite3 *Db, const std::string &Sql) {
+		char *Error = nullptr;
+		if (sqlite3_exec(Db, Sql.c_str(), nullptr, nullptr, &Error) != SQLITE_OK) {
+			std::string Reason = Error ? Error : "unknown";
+			sqlite3_free(Error);
+			throw std::runtime_error(fmt::format("{}: {}", Sql.substr(0, 60), Reason));
+		}
+	}
+
+	static sqlite3_stmt *Prepare(sqlite3 *Db, const std::string &Sql) {
+		sqlite3_stmt *S = nullptr;
+		if (sqlite3_prepare_v2(Db, Sql.c_str(), -1, &S, nullptr) != SQLITE_OK)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+		return S;
+	}
+
+	static std::string Serial(std::uint64_t i) {
+		return fmt::format("{:012x}", 0x903cb3000000ULL + i);
+	}
+
+	//	A state message of the size and shape a dual band AP with a few clients sends.
+	static std::string Payload(std::uint64_t Device, std::uint64_t Record, std::mt19937_64 &Random) {
+		std::uniform_int_distribution<std::uint64_t> Jitter(0, 5000);
+		auto Base = Record * 100000 + Device * 7;
+		std::string Clients;
+		for (int c = 0; c < 4; ++c)
+			Clients += fmt::format(
+				R"({}{{"mac":"a4:83:e7:{:02x}:{:02x}:{:02x}","ipv4_addresses":["10.0.{}.{}"],"rssi":-{},"rx_bytes":{},"tx_bytes":{},"rx_packets":{},"tx_packets":{},"inactive":{}}})",
+				c ? "," : "", Device & 0xff, c, Record & 0xff, Device, 10 + c, 40 + Jitter(Random) % 40,
+				Base + Jitter(Random), Base * 3 + Jitter(Random), Base / 1500 + Jitter(Random),
+				Base / 500 + Jitter(Random), Jitter(Random) % 60);
+		std::string Radios;
+		for (int r = 0; r < 2; ++r)
+			Radios += fmt::format(
+				R"({}{{"band":["{}"],"channel":{},"channel_width":"{}","noise":-{},"tx_power":{},"active_ms":{},"busy_ms":{},"receive_ms":{},"transmit_ms":{},"phy":"platform/soc/c000000.wifi{}"}})",
+				r ? "," : "", r ? "5G" : "2G", r ? 36 : 6, r ? 80 : 20, 90 + Jitter(Random) % 10,
+				r ? 23 : 20, Base + Jitter(Random), Base / 3 + Jitter(Random),
+				Base / 5 + Jitter(Random), Base / 7 + Jitter(Random), r ? "+1" : "");
+		return fmt::format(
+			R"({{"interfaces":[{{"name":"up0v0","location":"/interfaces/0","ipv4":{{"addresses":["192.168.{}.{}/24"],"leasetime":43200}},"counters":{{"collisions":0,"multicast":{},"rx_bytes":{},"rx_dropped":{},"rx_errors":0,"rx_packets":{},"tx_bytes":{},"tx_dropped":0,"tx_errors":0,"tx_packets":{}}},"ssids":[{{"ssid":"OpenWifi","bssid":"24:f5:a2:{:02x}:00:{:02x}","mode":"ap","iface":"wlan0","associations":[{}]}}]}}],"radios":[{}],"unit":{{"load":[0.{},0.{},0.{}],"localtime":{},"memory":{{"buffered":10993664,"cached":27639808,"free":{},"total":973385728}},"uptime":{}}},"version":1}})",
+			Device / 250, Device % 250 + 2, Jitter(Random), Base * 4 + Jitter(Random),
+			Jitter(Random) % 10, Base / 400 + Jitter(Random), Base * 2 + Jitter(Random),
+			Base / 700 + Jitter(Random), Device & 0xff, Record & 0xff, Clients, Radios,
+			Jitter(Random) % 100, Jitter(Random) % 100, Jitter(Random) % 100,
+			1700000000 + Record * 60, 700000000 + Jitter(Random) * 100, Record * 60 + 86400);
+	}
+
+	static const char *Base64Chars =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	static std::string Base64Encode(const unsigned char *In, std::size_t Size) {
+		std::string Out;
+		Out.reserve((Size + 2) / 3 * 4);
+		for (std::size_t i = 0; i < Size; i += 3) {
+			std::uint32_t V = (std::uint32_t)In[i] << 16;
+			if (i + 1 < Size)
+				V |= (std::uint32_t)In[i + 1] << 8;
+			if (i + 2 < Size)
+				V |= In[i + 2];
+			Out.push_back(Base64Chars[(V >> 18) & 63]);
+			Out.push_back(Base64Chars[(V >> 12) & 63]);
+			Out.push_back(i + 1 < Size ? Base64Chars[(V >> 6) & 63] : '=');
+			Out.push_back(i + 2 < Size ? Base64Chars[V & 63] : '=');
+		}
+		return Out;
+	}
+
+	static std::string Base64Decode(const char *In, std::size_t Size) {
+		static int Values[256];
+		if (Values['B'] == 0) {
+			std::fill(std::begin(Values), std::end(Values), -1);
+			for (int i = 0; i < 64; ++i)
+				Values[(unsigned char)Base64Chars[i]] = i;
+		}
+		std::string Out;
+		Out.reserve(Size / 4 * 3);
+		std::uint32_t V = 0;
+		int Bits = 0;
+		for (std::size_t i = 0; i < Size && In[i] != '='; ++i) {
+			auto D = Values[(unsigned char)In[i]];
+			if (D < 0)
+				throw std::runtime_error("bad base64");
+			V = (V << 6) | (std::uint32_t)D;
+			if ((Bits += 6) >= 8) {
+				Bits -= 8;
+				Out.push_back((char)((V >> Bits) & 0xff));
+			}
+		}
+		return Out;
+	}
+
+	//	What PayloadCodec::Encode stores, with or without a dictionary.
+	static std::string Encode(const std::string &Payload, const std::string &Dictionary) {
+		z_stream Stream{};
+		if (deflateInit(&Stream, 6) != Z_OK)
+			throw std::runtime_error("deflateInit");
+		if (!Dictionary.empty())
+			deflateSetDictionary(&Stream, (const Bytef *)Dictionary.data(),
+								 (uInt)Dictionary.size());
+		std::vector<unsigned char> Out(deflateBound(&Stream, Payload.size()));
+		Stream.next_in = (Bytef *)Payload.data();
+		Stream.avail_in = (uInt)Payload.size();
+		Stream.next_out = Out.data();
+		Stream.avail_out = (uInt)Out.size();
+		auto Result = deflate(&Stream, Z_FINISH);
+		auto OutSize = Stream.total_out;
+		deflateEnd(&Stream);
+		if (Result != Z_STREAM_END)
+			throw std::runtime_error("deflate");
+		return "~z1:" + std::to_string(Payload.size()) + ":" + Base64Encode(Out.data(), OutSize);
+	}
+
+	static std::string Decode(const char *Stored, std::size_t Size, const std::string &Dictionary) {
+		std::string_view S(Stored, Size);
+		if (S.compare(0, 4, "~z1:") != 0)
+			return std::string(S);
+		auto Sep = S.find(':', 4);
+		auto Length = std::strtoull(std::string(S.substr(4, Sep - 4)).c_str(), nullptr, 10);
+		auto In = Base64Decode(Stored + Sep + 1, Size - Sep - 1);
+		std::string Out(Length, '\0');
+		z_stream Stream{};
+		inflateInit(&Stream);
+		Stream.next_in = (Bytef *)In.data();
+		Stream.avail_in = (uInt)In.size();
+		Stream.next_out = (Bytef *)Out.data();
+		Stream.avail_out = (uInt)Out.size();
+		auto Result = inflate(&Stream, Z_FINISH);
+		if (Result == Z_NEED_DICT) {
+			inflateSetDictionary(&Stream, (const Bytef *)Dictionary.data(), (uInt)Dictionary.size());
+			Result = inflate(&Stream, Z_FINISH);
+		}
+		inflateEnd(&Stream);
+		if (Result != Z_STREAM_END)
+			throw std::runtime_error("inflate");
+		return Out;
+	}
+
+	struct Result {
+		double BytesPerRecord = 0, Inserts = 0, Reads = 0;
+	};
+
+	//	Mode 0 plain, 1 deflate, 2 deflate with the dictionary.
+	static Result Run(const std::vector<std::string> &Payloads, int Mode,
+					  const std::string &Dictionary) {
+		auto File = fmt::format("/tmp/owgw_codec_bench_{}.db",
+								std::chrono::steady_clock::now().time_since_epoch().count());
+		sqlite3 *Db = nullptr;
+		if (sqlite3_open(File.c_str(), &Db) != SQLITE_OK)
+			throw std::runtime_error("cannot open " + File);
+		Exec(Db, "PRAGMA journal_mode=WAL");
+		Exec(Db, "PRAGMA synchronous=NORMAL");
+		Exec(Db, "CREATE TABLE Statistics (SerialNumber VARCHAR(30), UUID INTEGER, Data TEXT, "
+				 "Recorded BIGINT)");
+		Exec(Db, "CREATE INDEX StatsSerial ON Statistics (SerialNumber ASC, Recorded ASC)");
+		Exec(Db, "CREATE INDEX StatsSerial0 ON Statistics (SerialNumber ASC)");
+		const std::string NoDictionary;
+		const auto &UsedDictionary = Mode == 2 ? Dictionary : NoDictionary;
+
+		Result R;
+		auto Insert = Prepare(Db, "INSERT INTO Statistics (SerialNumber, UUID, Data, Recorded) "
+								  "VALUES(?,?,?,?)");
+		auto Start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < Payloads.size(); ++i) {
+			if (i % 100 == 0)
+				Exec(Db, "BEGIN");
+			auto Data = Mode == 0 ? Payloads[i] : Encode(Payloads[i], UsedDictionary);
+			auto SerialNumber = Serial(i % Devices);
+			sqlite3_bind_text(Insert, 1, SerialNumber.c_str(), -1, SQLITE_TRANSIENT);
+			sqlite3_bind_int64(Insert, 2, (sqlite3_int64)i);
+			sqlite3_bind_text(Insert, 3, Data.c_str(), (int)Data.size(), SQLITE_TRANSIENT);
+			sqlite3_bind_int64(Insert, 4, (sqlite3_int64)(1700000000 + i / Devices * 60));
+			if (sqlite3_step(Insert) != SQLITE_DONE)
+				throw std::runtime_error(sqlite3_errmsg(Db));
+			sqlite3_reset(Insert);
+			if (i % 100 == 99 || i + 1 == Payloads.size())
+				Exec(Db, "COMMIT");
+		}
+		R.Inserts = (double)Payloads.size() /
+					std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		sqlite3_finalize(Insert);
+
+		Exec(Db, "PRAGMA wal_checkpoint(TRUNCATE)");
+		auto Pages = Prepare(Db, "SELECT page_count * page_size FROM pragma_page_count, "
+								 "pragma_page_size");
+		if (sqlite3_step(Pages) == SQLITE_ROW)
+			R.BytesPerRecord = (double)sqlite3_column_int64(Pages, 0) / (double)Payloads.size();
+		sqlite3_finalize(Pages);
+
+		auto Select = Prepare(Db, "SELECT SerialNumber, UUID, Data, Recorded FROM Statistics "
+								  "WHERE SerialNumber=? ORDER BY Recorded ASC");
+		std::size_t Read = 0, Bytes = 0;
+		Start = std::chrono::steady_clock::now();
+		for (std::uint64_t d = 0; d < Devices; ++d) {
+			auto SerialNumber = Serial(d);
+			sqlite3_bind_text(Select, 1, SerialNumber.c_str(), -1, SQLITE_TRANSIENT);
+			while (sqlite3_step(Select) == SQLITE_ROW) {
+				auto Data = Decode((const char *)sqlite3_column_text(Select, 2),
+								   (std::size_t)sqlite3_column_bytes(Select, 2), UsedDictionary);
+				Bytes += Data.size();
+				Read++;
+			}
+			sqlite3_reset(Select);
+		}
+		R.Reads = (double)Read /
+				  std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		sqlite3_finalize(Select);
+		if (Read != Payloads.size() || Bytes == 0)
+			throw std::runtime_error(fmt::format("read {} of {} records", Read, Payloads.size()));
+
+		sqlite3_close(Db);
+		for (const auto &Suffix : {"", "-wal", "-shm"})
+			std::remove((File + Suffix).c_str());
+		return R;
+	}
+
+	static int Run(std::uint64_t Records) {
+		std::mt19937_64 Random(42);
+		std::vector<std::string> Payloads;
+		std::size_t Bytes = 0;
+		for (std::uint64_t i = 0; i < Records; ++i) {
+			Payloads.emplace_back(Payload(i % Devices, i / Devices, Random));
+			Bytes += Payloads.back().size();
+		}
+		//	as PayloadCodec::Train builds it: the first 16 payloads, cut to the deflate window.
+		std::string Dictionary;
+		for (std::size_t i = 0; i < 16; ++i)
+			Dictionary += Payload(i % Devices, 1000000 + i, Random);
+		if (Dictionary.size() > 32768)
+			Dictionary.erase(0, Dictionary.size() - 32768);
+
+		fmt::print("{} records of {} devices, {} bytes of payload on average\n", Records, Devices,
+				   Bytes / Records);
+		fmt::print("{:>18}{:>14}{:>14}{:>14}\n", "storage", "bytes/record", "inserts/s",
+				   "reads/s");
+		const char *Names[] = {"plain", "deflate", "deflate+dict"};
+		for (int Mode = 0; Mode < 3; ++Mode) {
+			auto R = Run(Payloads, Mode, Dictionary);
+			fmt::print("{:>18}{:>14.0f}{:>14.0f}{:>14.0f}\n", Names[Mode], R.BytesPerRecord,
+					   R.Inserts, R.Reads);
+		}
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main(int argc, char **argv) {
+	try {
+		return OpenWifi::Bench::Run(
+			std::max<std::uint64_t>(1000, argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000));
+	} catch (const std::exception &E) {
+		fmt::print(stderr, "{}\n", E.what());
+	}
+	return 1;
+}
@@ -0,0 +1,211 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	The hot queries of the device path on SQLite, prepared for every call as a Poco::Data
+//	"Session << sql, use(...), now" does it, and prepared once and re-executed as the
+//	PreparedStatementCache does it. Tables are the gateway's Devices and Statistics, in a WAL
+//	database file with synchronous=NORMAL. Build and run:
+//		cmake --build . --target owgw_prepared_bench && ./owgw_prepared_bench [devices] [seconds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "fmt/format.h"
+
+namespace OpenWifi::Bench {
+
+	static const std::vector<std::string> DeviceColumns{
+		"SerialNumber", "DeviceType", "MACAddress", "Manufacturer", "Configuration", "Notes",
+		"Owner", "Location", "Firmware", "Compatible", "FWUpdatePolicy", "UUID",
+		"CreationTimestamp", "LastConfigurationChange", "LastConfigurationDownload",
+		"LastFWUpdate", "Venue", "DevicePassword", "subscriber", "entity", "modified", "locale",
+		"restrictedDevice", "pendingConfiguration", "pendingConfigurationCmd",
+		"restrictionDetails", "pendingUUID", "simulated", "lastRecordedContact",
+		"certificateExpiryDate", "connectReason"};
+
+	static void Exec(sqlite3 *Db, const std::string &Sql) {
+		char *Error = nullptr;
+		if (sqlite3_exec(Db, Sql.c_str(), nullptr, nullptr, &Error) != SQLITE_OK) {
+			std::string Reason = Error ? Error : "unknown";
+			sqlite3_free(Error);
+			throw std::runtime_error(fmt::format("{}: {}", Sql.substr(0, 60), Reason));
+		}
+	}
+
+	static std::string Serial(std::uint64_t i) {
+		return fmt::format("{:012x}", 0x903cb3000000ULL + i);
+	}
+
+	//	One query with its SQL and the values it binds for device i. Reset runs before each
+	//	mode, so both start from the same table.
+	struct Query {
+		const char *Name;
+		std::string Sql;
+		void (*Bind)(sqlite3_stmt *, std::uint64_t i, std::uint64_t Call);
+		std::string Reset;
+	};
+
+	static void BindDevice(sqlite3_stmt *S, std::uint64_t i, std::uint64_t Call) {
+		static const std::string Config(2000, 'c');
+		auto SerialNumber = Serial(i);
+		int Column = 1;
+		for (const auto &Name : DeviceColumns) {
+			if (Name == "SerialNumber")
+				sqlite3_bind_text(S, Column, SerialNumber.c_str(), -1, SQLITE_TRANSIENT);
+			else if (Name == "Configuration")
+				sqlite3_bind_text(S, Column, Config.c_str(), (int)Config.size(), SQLITE_STATIC);
+			else if (Name == "UUID" || Name == "modified" || Name == "lastRecordedContact" ||
+					 Name == "CreationTimestamp" || Name == "pendingUUID")
+				sqlite3_bind_int64(S, Column, (sqlite3_int64)(1700000000 + Call));
+			else if (Name == "restrictedDevice" || Name == "simulated")
+				sqlite3_bind_int(S, Column, 0);
+			else
+				sqlite3_bind_text(S, Column, "value", -1, SQLITE_STATIC);
+			++Column;
+		}
+		//	the WHERE SerialNumber=? of an update.
+		if (Column <= sqlite3_bind_parameter_count(S))
+			sqlite3_bind_text(S, Column, SerialNumber.c_str(), -1, SQLITE_TRANSIENT);
+	}
+
+	static void BindSerial(sqlite3_stmt *S, std::uint64_t i, std::uint64_t) {
+		auto SerialNumber = Serial(i);
+		sqlite3_bind_text(S, 1, SerialNumber.c_str(), -1, SQLITE_TRANSIENT);
+	}
+
+	static void BindStatistics(sqlite3_stmt *S, std::uint64_t i, std::uint64_t Call) {
+		static const std::string Data(1500, 's');
+		auto SerialNumber = Serial(i);
+		sqlite3_bind_text(S, 1, SerialNumber.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int64(S, 2, (sqlite3_int64)Call);
+		sqlite3_bind_text(S, 3, Data.c_str(), (int)Data.size(), SQLITE_STATIC);
+		sqlite3_bind_int64(S, 4, (sqlite3_int64)(1700000000 + Call));
+	}
+
+	static void Step(sqlite3 *Db, sqlite3_stmt *S) {
+		int R;
+		while ((R = sqlite3_step(S)) == SQLITE_ROW)
+			sqlite3_column_text(S, 4);
+		if (R != SQLITE_DONE)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+	}
+
+	static double Run(sqlite3 *Db, const Query &Q, std::uint64_t Devices, bool Prepared,
+					  double Seconds) {
+		if (!Q.Reset.empty())
+			Exec(Db, Q.Reset);
+		Exec(Db, "PRAGMA wal_checkpoint(TRUNCATE)");
+		sqlite3_stmt *Kept = nullptr;
+		if (Prepared && sqlite3_prepare_v2(Db, Q.Sql.c_str(), -1, &Kept, nullptr) != SQLITE_OK)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+		std::uint64_t Calls = 0;
+		auto Start = std::chrono::steady_clock::now();
+		double Elapsed = 0;
+		while (Elapsed < Seconds) {
+			Exec(Db, "BEGIN");
+			for (int k = 0; k < 100; ++k, ++Calls) {
+				sqlite3_stmt *S = Kept;
+				if (!Prepared &&
+					sqlite3_prepare_v2(Db, Q.Sql.c_str(), -1, &S, nullptr) != SQLITE_OK)
+					throw std::runtime_error(sqlite3_errmsg(Db));
+				Q.Bind(S, (Calls * 7919) % Devices, Calls);
+				Step(Db, S);
+				if (Prepared) {
+					sqlite3_reset(S);
+					sqlite3_clear_bindings(S);
+				} else {
+					sqlite3_finalize(S);
+				}
+			}
+			Exec(Db, "COMMIT");
+			Elapsed =
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		}
+		sqlite3_finalize(Kept);
+		return (double)Calls / Elapsed;
+	}
+
+	static int Run(std::uint64_t Devices, double Seconds) {
+		auto File = fmt::format("/tmp/owgw_prepared_bench_{}.db",
+								std::chrono::steady_clock::now().time_since_epoch().count());
+		sqlite3 *Db = nullptr;
+		if (sqlite3_open(File.c_str(), &Db) != SQLITE_OK)
+			throw std::runtime_error("cannot open " + File);
+		Exec(Db, "PRAGMA journal_mode=WAL");
+		Exec(Db, "PRAGMA synchronous=NORMAL");
+
+		std::string Columns, Placeholders, Updates;
+		for (const auto &Name : DeviceColumns) {
+			if (!Columns.empty()) {
+				Columns += ", ";
+				Placeholders += ",";
+				Updates += ", ";
+			}
+			Columns +=
+				Name + (Name == "SerialNumber" ? " VARCHAR(30) UNIQUE PRIMARY KEY" : " TEXT");
+			Placeholders += "?";
+			Updates += Name + "=?";
+		}
+		Exec(Db, "CREATE TABLE Devices (" + Columns + ")");
+		Exec(Db, "CREATE TABLE Statistics (SerialNumber VARCHAR(30), UUID INTEGER, Data TEXT, "
+				 "Recorded BIGINT)");
+		Exec(Db, "CREATE INDEX StatsSerial ON Statistics (SerialNumber ASC, Recorded ASC)");
+		Exec(Db, "CREATE INDEX StatsSerial0 ON Statistics (SerialNumber ASC)");
+
+		std::string Names;
+		for (const auto &Name : DeviceColumns)
+			Names += (Names.empty() ? "" : ", ") + Name;
+		sqlite3_stmt *Insert = nullptr;
+		auto InsertSql = "INSERT INTO Devices (" + Names + ") VALUES (" + Placeholders + ")";
+		if (sqlite3_prepare_v2(Db, InsertSql.c_str(), -1, &Insert, nullptr) != SQLITE_OK)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+		Exec(Db, "BEGIN");
+		for (std::uint64_t i = 0; i < Devices; ++i) {
+			BindDevice(Insert, i, 0);
+			Step(Db, Insert);
+			sqlite3_reset(Insert);
+		}
+		Exec(Db, "COMMIT");
+		sqlite3_finalize(Insert);
+
+		std::vector<Query> Queries{
+			{"GetDevice", "SELECT " + Names + " FROM Devices WHERE SerialNumber=?", BindSerial, ""},
+			{"UpdateDevice", "UPDATE Devices SET " + Updates + " WHERE SerialNumber=?", BindDevice,
+			 ""},
+			{"AddStatisticsData",
+			 "INSERT INTO Statistics (SerialNumber, UUID, Data, Recorded) VALUES(?,?,?,?)",
+			 BindStatistics, "DELETE FROM Statistics"}};
+
+		fmt::print("{} devices, 100 calls per transaction\n", Devices);
+		fmt::print("{:>20}{:>16}{:>16}{:>10}\n", "query", "every call/s", "prepared/s", "gain");
+		for (const auto &Q : Queries) {
+			auto Before = Run(Db, Q, Devices, false, Seconds);
+			auto After = Run(Db, Q, Devices, true, Seconds);
+			fmt::print("{:>20}{:>16.0f}{:>16.0f}{:>9.2f}x\n", Q.Name, Before, After,
+					   After / Before);
+		}
+		sqlite3_close(Db);
+		for (const auto &Suffix : {"", "-wal", "-shm"})
+			std::remove((File + Suffix).c_str());
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main(int argc, char **argv) {
+	try {
+		return OpenWifi::Bench::Run(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000,
+									argc > 2 ? std::strtod(argv[2], nullptr) : 2.0);
+	} catch (const std::exception &E) {
+		fmt::print(stderr, "{}\n", E.what());
+	}
+	return 1;
+}
@@ -0,0 +1,120 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	REST rate limiter checks from several threads, for one client, a thousand clients and a
+//	flood of new addresses. Compares the LRU cache the gateway used before with the token
+//	buckets. Build and run:
+//		cmake --build . --target owgw_ratelimiter_bench && ./owgw_ratelimiter_bench
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Poco/ExpireLRUCache.h"
+
+#include "fmt/format.h"
+
+#include "framework/TokenBuckets.h"
+
+namespace OpenWifi::Bench {
+
+	//	What RESTAPI_RateLimiter::IsRateLimited did before the token buckets.
+	class LRULimiter {
+	  public:
+		struct ClientCacheEntry {
+			int64_t Start = 0;
+			int Count = 0;
+		};
+
+		bool IsRateLimited(std::uint64_t H, int64_t Period, int64_t MaxCalls) {
+			auto E = Cache_.get(H);
+			auto Now = std::chrono::duration_cast<std::chrono::milliseconds>(
+						   std::chrono::system_clock::now().time_since_epoch())
+						   .count();
+			if (E.isNull()) {
+				Cache_.add(H, ClientCacheEntry{.Start = Now, .Count = 1});
+				return false;
+			}
+			if ((Now - E->Start) < Period) {
+				E->Count++;
+				Cache_.update(H, E);
+				return E->Count > MaxCalls;
+			}
+			E->Start = Now;
+			E->Count = 1;
+			Cache_.update(H, E);
+			return false;
+		}
+
+	  private:
+		Poco::ExpireLRUCache<uint64_t, ClientCacheEntry> Cache_{2048};
+	};
+
+	class BucketLimiter {
+	  public:
+		bool IsRateLimited(std::uint64_t H, int64_t Period, int64_t MaxCalls) {
+			return Buckets_.IsRateLimited(H, Period, MaxCalls);
+		}
+
+	  private:
+		TokenBuckets Buckets_;
+	};
+
+	//	Clients 0 is a flood: every check comes from a new address.
+	template <typename Limiter>
+	static double Run(unsigned Threads, std::uint64_t Clients) {
+		Limiter L;
+		std::atomic_bool Running = true;
+		std::atomic_uint64_t Checks = 0;
+		std::vector<std::thread> Workers;
+		for (unsigned t = 0; t < Threads; ++t) {
+			Workers.emplace_back([&, t] {
+				std::mt19937_64 R(t + 1);
+				std::uint64_t Local = 0;
+				while (Running.load(std::memory_order_relaxed)) {
+					for (int i = 0; i < 256; ++i) {
+						auto Key = Clients ? R() % Clients + 1 : R();
+						(void)L.IsRateLimited(Key, 1000, 100);
+					}
+					Local += 256;
+				}
+				Checks += Local;
+			});
+		}
+		auto Start = std::chrono::steady_clock::now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		Running = false;
+		for (auto &W : Workers)
+			W.join();
+		auto Seconds =
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		return (double)Checks / Seconds / 1e6;
+	}
+
+	static int Run() {
+		auto Cores = std::max(1u, std::thread::hardware_concurrency());
+		std::vector<unsigned> ThreadCounts{1};
+		for (auto T : {4u, Cores})
+			if (T > ThreadCounts.back())
+				ThreadCounts.push_back(T);
+
+		fmt::print("{:>8}{:>9}{:>12}{:>16}\n", "clients", "threads", "LRU M/s", "buckets M/s");
+		for (std::uint64_t Clients : {1, 1000, 0}) {
+			for (auto Threads : ThreadCounts) {
+				auto LRU = Run<LRULimiter>(Threads, Clients);
+				auto Buckets = Run<BucketLimiter>(Threads, Clients);
+				fmt::print("{:>8}{:>9}{:>12.2f}{:>16.2f}\n",
+						   Clients ? std::to_string(Clients) : std::string("flood"), Threads, LRU,
+						   Buckets);
+			}
+		}
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main() { return OpenWifi::Bench::Run(); }
@@ -0,0 +1,218 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Time to first byte, total time and peak memory of a large device listing served by a local
+//	HTTP server, built as one JSON document as ReturnObject does, and streamed through
+//	JSONListWriter in batches of 256 rows, sent 64 KB at a time, as RESTAPIHandler::StreamList
+//	does. Linux only, peak memory comes from /proc/self. Build and run:
+//		cmake --build . --target owgw_streamlist_bench && ./owgw_streamlist_bench
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Poco/JSON/Array.h"
+#include "Poco/JSON/Object.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/NumberParser.h"
+#include "Poco/URI.h"
+
+#include "fmt/format.h"
+
+#include "framework/JSONListWriter.h"
+
+namespace OpenWifi::Bench {
+
+	//	About the size of a device record.
+	struct Row {
+		std::string serialNumber, deviceType, macAddress, manufacturer, configuration, notes,
+			owner, location, firmware, compatible, venue, entity, subscriber, devicePassword,
+			locale, connectReason;
+		std::uint64_t UUID = 0, createdTimestamp = 0, lastConfigurationChange = 0,
+					  lastConfigurationDownload = 0, lastFWUpdate = 0, modified = 0,
+					  lastRecordedContact = 0;
+		bool blackListed = false, restrictedDevice = false;
+
+		void to_json(Poco::JSON::Object &Obj) const {
+			Obj.set("serialNumber", serialNumber);
+			Obj.set("deviceType", deviceType);
+			Obj.set("macAddress", macAddress);
+			Obj.set("manufacturer", manufacturer);
+			Obj.set("configuration", configuration);
+			Obj.set("notes", notes);
+			Obj.set("owner", owner);
+			Obj.set("location", location);
+			Obj.set("firmware", firmware);
+			Obj.set("compatible", compatible);
+			Obj.set("venue", venue);
+			Obj.set("entity", entity);
+			Obj.set("subscriber", subscriber);
+			Obj.set("devicePassword", devicePassword);
+			Obj.set("locale", locale);
+			Obj.set("connectReason", connectReason);
+			Obj.set("UUID", UUID);
+			Obj.set("createdTimestamp", createdTimestamp);
+			Obj.set("lastConfigurationChange", lastConfigurationChange);
+			Obj.set("lastConfigurationDownload", lastConfigurationDownload);
+			Obj.set("lastFWUpdate", lastFWUpdate);
+			Obj.set("modified", modified);
+			Obj.set("lastRecordedContact", lastRecordedContact);
+			Obj.set("blackListed", blackListed);
+			Obj.set("restrictedDevice", restrictedDevice);
+		}
+	};
+
+	//	Stands in for a database fetch.
+	static void Fetch(std::uint64_t From, std::uint64_t HowMany, std::vector<Row> &Rows) {
+		for (auto i = From; i < From + HowMany; ++i) {
+			Row R;
+			R.serialNumber = fmt::format("{:012x}", 0x903cb3000000 + i);
+			R.deviceType = "edgecore_eap101";
+			R.macAddress = R.serialNumber;
+			R.manufacturer = "Edgecore";
+			R.configuration = std::string(1500, 'c');
+			R.firmware = "OpenWrt 21.02-SNAPSHOT r16399+120-c67509efd7 / TIP-v2.7.0";
+			R.compatible = "edgecore_eap101";
+			R.locale = "CA";
+			R.connectReason = "reconnect";
+			R.UUID = R.createdTimestamp = R.modified = R.lastRecordedContact = 1700000000 + i;
+			Rows.push_back(std::move(R));
+		}
+	}
+
+	//	/buffered?rows=N and /streamed?rows=N.
+	class ListHandler : public Poco::Net::HTTPRequestHandler {
+	  public:
+		void handleRequest(Poco::Net::HTTPServerRequest &Request,
+						   Poco::Net::HTTPServerResponse &Response) override {
+			Poco::URI uri(Request.getURI());
+			std::uint64_t Count = 0;
+			for (const auto &[Key, Value] : uri.getQueryParameters())
+				if (Key == "rows")
+					Count = Poco::NumberParser::parseUnsigned64(Value);
+			Response.setChunkedTransferEncoding(true);
+			Response.setContentType("application/json");
+			if (uri.getPath() == "/buffered") {
+				std::vector<Row> Rows;
+				Fetch(0, Count, Rows);
+				Poco::JSON::Array Arr;
+				for (const auto &R : Rows) {
+					Poco::JSON::Object Obj;
+					R.to_json(Obj);
+					Arr.add(Obj);
+				}
+				Poco::JSON::Object Answer;
+				Answer.set("devices", Arr);
+				std::ostringstream OS;
+				Answer.stringify(OS);
+				Response.send() << OS.str();
+				return;
+			}
+			std::ostream *Answer = nullptr;
+			JSONListWriter Writer("devices", [&](const std::string &Text) {
+				if (Answer == nullptr)
+					Answer = &Response.send();
+				*Answer << Text;
+			});
+			std::vector<Row> Rows;
+			for (std::uint64_t From = 0; From < Count; From += 256) {
+				Rows.clear();
+				Fetch(From, std::min<std::uint64_t>(256, Count - From), Rows);
+				for (const auto &R : Rows)
+					Writer.Add(R);
+			}
+			Writer.Close(Poco::JSON::Object());
+		}
+	};
+
+	class ListHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory {
+	  public:
+		Poco::Net::HTTPRequestHandler *
+		createRequestHandler(const Poco::Net::HTTPServerRequest &) override {
+			return new ListHandler;
+		}
+	};
+
+	static std::uint64_t ProcKB(const std::string &Field) {
+		std::ifstream Status("/proc/self/status");
+		std::string Line;
+		while (std::getline(Status, Line))
+			if (Line.rfind(Field + ":", 0) == 0)
+				return std::stoull(Line.substr(Field.size() + 1));
+		return 0;
+	}
+
+	struct Result {
+		double TTFB = 0, Total = 0;
+		std::uint64_t Bytes = 0, PeakKB = 0;
+	};
+
+	static Result Get(std::uint16_t Port, const std::string &Path, std::uint64_t Rows) {
+		//	resets the peak resident size to the current one.
+		std::ofstream("/proc/self/clear_refs") << "5";
+		auto Baseline = ProcKB("VmRSS");
+
+		Result R;
+		auto Start = std::chrono::steady_clock::now();
+		Poco::Net::HTTPClientSession Session("127.0.0.1", Port);
+		Session.setTimeout(Poco::Timespan(600, 0));
+		Poco::Net::HTTPRequest Request(Poco::Net::HTTPRequest::HTTP_GET,
+									   fmt::format("{}?rows={}", Path, Rows),
+									   Poco::Net::HTTPMessage::HTTP_1_1);
+		Session.sendRequest(Request);
+		Poco::Net::HTTPResponse Response;
+		auto &Body = Session.receiveResponse(Response);
+		Body.peek();
+		R.TTFB = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		char Buffer[65536];
+		while (Body.read(Buffer, sizeof(Buffer)) || Body.gcount() > 0)
+			R.Bytes += Body.gcount();
+		R.Total = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		auto Peak = ProcKB("VmHWM");
+		R.PeakKB = Peak > Baseline ? Peak - Baseline : 0;
+		return R;
+	}
+
+	static int Run() {
+		Poco::Net::ServerSocket Socket(Poco::Net::SocketAddress("127.0.0.1", 0));
+		Poco::Net::HTTPServer Server(new ListHandlerFactory, Socket,
+									 new Poco::Net::HTTPServerParams);
+		Server.start();
+		auto Port = Socket.address().port();
+
+		fmt::print("{:>8}{:>10}{:>10}{:>10}{:>12}{:>14}\n", "rows", "path", "TTFB ms",
+				   "total ms", "MB sent", "peak RSS MB");
+		for (std::uint64_t Rows : {1000, 10000, 100000}) {
+			for (const auto &Path : {"/buffered", "/streamed"}) {
+				auto R = Get(Port, Path, Rows);
+				fmt::print("{:>8}{:>10}{:>10.1f}{:>10.1f}{:>12.1f}{:>14.1f}\n", Rows, Path + 1,
+						   R.TTFB * 1000, R.Total * 1000, R.Bytes / 1e6, R.PeakKB / 1024.0);
+			}
+		}
+		Server.stop();
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main() {
+	try {
+		return OpenWifi::Bench::Run();
+	} catch (const Poco::Exception &E) {
+		fmt::print(stderr, "{}\n", E.displayText());
+	}
+	return 1;
+}
@@ -0,0 +1,216 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Mutual TLS handshakes per second between a device and a listener configured as
+//	AP_WS_TLSSessions does: full handshakes, TLS 1.2 resumption from the server session cache,
+//	and resumption from tickets in TLS 1.2 and 1.3. Both ends run in this thread over memory
+//	BIOs, so the numbers are the CPU cost of a handshake without the network. Tickets use the
+//	OpenSSL built-in key, the gateway's key callback adds one HMAC key lookup to it. Build and run:
+//		cmake --build . --target owgw_handshake_bench && ./owgw_handshake_bench [seconds]
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <openssl/bio.h>
+#include <openssl/ec.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include "fmt/format.h"
+
+namespace OpenWifi::Bench {
+
+	static constexpr const char *SessionIdContext = "owgw-ap";
+
+	static void Fail(const std::string &What) {
+		char Reason[256];
+		ERR_error_string_n(ERR_get_error(), Reason, sizeof(Reason));
+		throw std::runtime_error(fmt::format("{}: {}", What, Reason));
+	}
+
+	//	Self-signed P-256 certificate, as the devices and the gateway test certificates use.
+	static void MakeCertificate(const std::string &CN, EVP_PKEY *&Key, X509 *&Cert) {
+		auto KeyCtx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+		Key = nullptr;
+		if (KeyCtx == nullptr || EVP_PKEY_keygen_init(KeyCtx) <= 0 ||
+			EVP_PKEY_CTX_set_ec_paramgen_curve_nid(KeyCtx, NID_X9_62_prime256v1) <= 0 ||
+			EVP_PKEY_keygen(KeyCtx, &Key) <= 0)
+			Fail("key");
+		EVP_PKEY_CTX_free(KeyCtx);
+
+		Cert = X509_new();
+		X509_set_version(Cert, 2);
+		ASN1_INTEGER_set(X509_get_serialNumber(Cert), 1);
+		X509_gmtime_adj(X509_getm_notBefore(Cert), 0);
+		X509_gmtime_adj(X509_getm_notAfter(Cert), 86400);
+		X509_set_pubkey(Cert, Key);
+		auto Name = X509_get_subject_name(Cert);
+		X509_NAME_add_entry_by_txt(Name, "CN", MBSTRING_ASC, (const unsigned char *)CN.c_str(), -1,
+								   -1, 0);
+		X509_set_issuer_name(Cert, Name);
+		if (X509_sign(Cert, Key, EVP_sha256()) <= 0)
+			Fail("certificate");
+	}
+
+	struct Endpoint {
+		EVP_PKEY *Key = nullptr;
+		X509 *Cert = nullptr;
+	};
+
+	enum class Mode { Full, Cache, Ticket };
+
+	static SSL_CTX *ServerContext(const Endpoint &Server, const Endpoint &Device, int Version,
+								  Mode M) {
+		auto Ctx = SSL_CTX_new(TLS_server_method());
+		SSL_CTX_set_min_proto_version(Ctx, Version);
+		SSL_CTX_set_max_proto_version(Ctx, Version);
+		SSL_CTX_use_certificate(Ctx, Server.Cert);
+		SSL_CTX_use_PrivateKey(Ctx, Server.Key);
+		X509_STORE_add_cert(SSL_CTX_get_cert_store(Ctx), Device.Cert);
+		SSL_CTX_set_verify(Ctx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, nullptr);
+		SSL_CTX_set_session_id_context(Ctx, (const unsigned char *)SessionIdContext,
+									   (unsigned int)std::strlen(SessionIdContext));
+		if (M == Mode::Full) {
+			SSL_CTX_set_session_cache_mode(Ctx, SSL_SESS_CACHE_OFF);
+			SSL_CTX_set_options(Ctx, SSL_OP_NO_TICKET);
+			SSL_CTX_set_num_tickets(Ctx, 0);
+		} else {
+			SSL_CTX_set_session_cache_mode(Ctx, SSL_SESS_CACHE_SERVER);
+			SSL_CTX_sess_set_cache_size(Ctx, 20000);
+			if (M == Mode::Cache)
+				SSL_CTX_set_options(Ctx, SSL_OP_NO_TICKET);
+		}
+		return Ctx;
+	}
+
+	static SSL_CTX *DeviceContext(const Endpoint &Server, const Endpoint &Device, int Version) {
+		auto Ctx = SSL_CTX_new(TLS_client_method());
+		SSL_CTX_set_min_proto_version(Ctx, Version);
+		SSL_CTX_set_max_proto_version(Ctx, Version);
+		SSL_CTX_use_certificate(Ctx, Device.Cert);
+		SSL_CTX_use_PrivateKey(Ctx, Device.Key);
+		X509_STORE_add_cert(SSL_CTX_get_cert_store(Ctx), Server.Cert);
+		SSL_CTX_set_verify(Ctx, SSL_VERIFY_PEER, nullptr);
+		SSL_CTX_set_session_cache_mode(Ctx, SSL_SESS_CACHE_CLIENT);
+		return Ctx;
+	}
+
+	//	One connection, offering Session when it is set. Returns the session to resume next and
+	//	whether this one was resumed.
+	static SSL_SESSION *Connect(SSL_CTX *ServerCtx, SSL_CTX *DeviceCtx, SSL_SESSION *Session,
+								bool &Resumed) {
+		auto Server = SSL_new(ServerCtx);
+		auto Device = SSL_new(DeviceCtx);
+		BIO *ServerBIO = nullptr, *DeviceBIO = nullptr;
+		BIO_new_bio_pair(&ServerBIO, 0, &DeviceBIO, 0);
+		SSL_set_bio(Server, ServerBIO, ServerBIO);
+		SSL_set_bio(Device, DeviceBIO, DeviceBIO);
+		SSL_set_accept_state(Server);
+		SSL_set_connect_state(Device);
+		if (Session != nullptr)
+			SSL_set_session(Device, Session);
+
+		bool ServerDone = false, DeviceDone = false;
+		for (int Round = 0; (!ServerDone || !DeviceDone) && Round < 100; ++Round) {
+			if (!DeviceDone) {
+				auto R = SSL_do_handshake(Device);
+				if (R == 1)
+					DeviceDone = true;
+				else if (SSL_get_error(Device, R) != SSL_ERROR_WANT_READ)
+					Fail("device handshake");
+			}
+			if (!ServerDone) {
+				auto R = SSL_do_handshake(Server);
+				if (R == 1)
+					ServerDone = true;
+				else if (SSL_get_error(Server, R) != SSL_ERROR_WANT_READ)
+					Fail("server handshake");
+			}
+		}
+		if (!ServerDone || !DeviceDone)
+			Fail("handshake did not finish");
+
+		//	TLS 1.3 sends tickets after the handshake, the device reads them with its first frame.
+		char Byte = 0;
+		SSL_write(Server, &Byte, 1);
+		SSL_read(Device, &Byte, 1);
+
+		Resumed = SSL_session_reused(Device) == 1;
+		auto Next = SSL_get1_session(Device);
+		//	a connection freed without a shutdown drops its session from the cache.
+		SSL_set_shutdown(Server, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+		SSL_set_shutdown(Device, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+		SSL_free(Server);
+		SSL_free(Device);
+		return Next;
+	}
+
+	static void Run(const Endpoint &Server, const Endpoint &Device, int Version, Mode M,
+					double Seconds) {
+		auto ServerCtx = ServerContext(Server, Device, Version, M);
+		auto DeviceCtx = DeviceContext(Server, Device, Version);
+
+		bool Resumed = false;
+		auto Session = Connect(ServerCtx, DeviceCtx, nullptr, Resumed);
+		std::uint64_t Handshakes = 0, Reused = 0;
+		auto Start = std::chrono::steady_clock::now();
+		double Elapsed = 0;
+		while (Elapsed < Seconds) {
+			for (int i = 0; i < 16; ++i) {
+				auto Next = Connect(ServerCtx, DeviceCtx, M == Mode::Full ? nullptr : Session,
+									Resumed);
+				SSL_SESSION_free(Session);
+				Session = Next;
+				Handshakes++;
+				Reused += Resumed;
+			}
+			Elapsed =
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		}
+		SSL_SESSION_free(Session);
+		SSL_CTX_free(ServerCtx);
+		SSL_CTX_free(DeviceCtx);
+
+		static const char *Names[] = {"full", "cache", "ticket"};
+		fmt::print("{:>8}{:>8}{:>14.0f}{:>14.1f}{:>10.0f}%\n",
+				   Version == TLS1_3_VERSION ? "1.3" : "1.2", Names[(int)M], Handshakes / Elapsed,
+				   Elapsed * 1e6 / Handshakes, Reused * 100.0 / Handshakes);
+	}
+
+	static int Run(double Seconds) {
+		Endpoint Server, Device;
+		MakeCertificate("owgw", Server.Key, Server.Cert);
+		MakeCertificate("903cb3bb2496", Device.Key, Device.Cert);
+
+		fmt::print("{:>8}{:>8}{:>14}{:>14}{:>11}\n", "TLS", "mode", "handshakes/s", "us each",
+				   "resumed");
+		Run(Server, Device, TLS1_2_VERSION, Mode::Full, Seconds);
+		Run(Server, Device, TLS1_2_VERSION, Mode::Cache, Seconds);
+		Run(Server, Device, TLS1_2_VERSION, Mode::Ticket, Seconds);
+		Run(Server, Device, TLS1_3_VERSION, Mode::Full, Seconds);
+		Run(Server, Device, TLS1_3_VERSION, Mode::Ticket, Seconds);
+
+		for (auto &E : {Server, Device}) {
+			X509_free(E.Cert);
+			EVP_PKEY_free(E.Key);
+		}
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main(int argc, char **argv) {
+	try {
+		return OpenWifi::Bench::Run(argc > 1 ? std::strtod(argv[1], nullptr) : 2.0);
+	} catch (const std::exception &E) {
+		fmt::print(stderr, "{}\n", E.what());
+	}
+	return 1;
+}
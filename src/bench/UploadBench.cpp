@@ -0,0 +1,228 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Upload throughput and peak memory of a file upload, received as the gateway did before the
+//	content addressed store, copied into a stringstream and inserted as a BLOB, and as
+//	FileUploader::ReceiveFile and CommitFile do it, 64 KB at a time to incoming/ with a running
+//	SHA-256, then renamed into store/. The upload is generated while it is read, so the sender
+//	takes no memory, and each run is a child process so its peak RSS is its own. ReceiveFile
+//	needs Poco, its loop is written out here with OpenSSL's SHA-256. Linux only, peak memory
+//	comes from /proc/self. Build and run:
+//		cmake --build . --target owgw_upload_bench && ./owgw_upload_bench [directory]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+
+#include "fmt/format.h"
+
+namespace OpenWifi::Bench {
+
+	//	Size bytes of pseudo random content, produced as the reader asks for it.
+	class UploadBuf : public std::streambuf {
+	  public:
+		explicit UploadBuf(std::uint64_t Size) : Left_(Size) {}
+
+	  protected:
+		int_type underflow() override {
+			if (Left_ == 0)
+				return traits_type::eof();
+			auto Size = (std::size_t)std::min<std::uint64_t>(Left_, Chunk_.size());
+			for (std::size_t i = 0; i < Size; i += 8) {
+				State_ ^= State_ << 13;
+				State_ ^= State_ >> 7;
+				State_ ^= State_ << 17;
+				std::memcpy(&Chunk_[i], &State_, std::min<std::size_t>(8, Size - i));
+			}
+			Left_ -= Size;
+			setg(Chunk_.data(), Chunk_.data(), Chunk_.data() + Size);
+			return traits_type::to_int_type(Chunk_[0]);
+		}
+
+	  private:
+		std::uint64_t Left_;
+		std::uint64_t State_ = 0x9e3779b97f4a7c15ULL;
+		std::array<char, 16 * 1024> Chunk_{};
+	};
+
+	static std::uint64_t PeakKB() {
+		std::ifstream Status("/proc/self/status");
+		std::string Line;
+		while (std::getline(Status, Line))
+			if (Line.compare(0, 6, "VmHWM:") == 0)
+				return std::strtoull(Line.c_str() + 6, nullptr, 10);
+		return 0;
+	}
+
+	static void Exec(sqlite3 *Db, const std::string &Sql) {
+		char *Error = nullptr;
+		if (sqlite3_exec(Db, Sql.c_str(), nullptr, nullptr, &Error) != SQLITE_OK) {
+			std::string Reason = Error ? Error : "unknown";
+			sqlite3_free(Error);
+			throw std::runtime_error(fmt::format("{}: {}", Sql.substr(0, 60), Reason));
+		}
+	}
+
+	static void Insert(sqlite3 *Db, const void *Content, std::size_t Size,
+					   const std::string &Hash) {
+		sqlite3_stmt *S = nullptr;
+		if (sqlite3_prepare_v2(Db,
+							   "INSERT INTO FileUploads (UUID, Type, Created, FileContent, "
+							   "FileHash, FileSize) VALUES('upload', 'trace', 0, ?, ?, ?)",
+							   -1, &S, nullptr) != SQLITE_OK)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+		if (Content != nullptr)
+			sqlite3_bind_blob64(S, 1, Content, Size, SQLITE_STATIC);
+		else
+			sqlite3_bind_null(S, 1);
+		sqlite3_bind_text(S, 2, Hash.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int64(S, 3, (sqlite3_int64)Size);
+		auto R = sqlite3_step(S);
+		sqlite3_finalize(S);
+		if (R != SQLITE_DONE)
+			throw std::runtime_error(sqlite3_errmsg(Db));
+	}
+
+	//	Before: Poco::StreamCopier into a stringstream, then a BLOB built from str().
+	static void Buffered(std::istream &In, sqlite3 *Db) {
+		std::stringstream FileContent;
+		std::array<char, 8192> Buffer{};
+		while (In) {
+			In.read(Buffer.data(), Buffer.size());
+			if (In.gcount() > 0)
+				FileContent.write(Buffer.data(), In.gcount());
+		}
+		std::uint64_t Size = FileContent.str().size();
+		std::vector<unsigned char> Blob;
+		auto AppendRaw = [&Blob](const unsigned char *Data, std::size_t Length) {
+			Blob.insert(Blob.end(), Data, Data + Length);
+		};
+		AppendRaw((const unsigned char *)FileContent.str().c_str(), FileContent.str().size());
+		Insert(Db, Blob.data(), Size, "");
+	}
+
+	//	After: as ReceiveFile and CommitFile.
+	static void Streamed(std::istream &In, sqlite3 *Db, const std::filesystem::path &Root) {
+		auto TmpFile = Root / "incoming" / "upload.part";
+		auto Digest = EVP_MD_CTX_new();
+		EVP_DigestInit_ex(Digest, EVP_sha256(), nullptr);
+		std::uint64_t Size = 0;
+		{
+			std::ofstream Out(TmpFile, std::ios::binary | std::ios::trunc);
+			std::array<char, 64 * 1024> Buffer{};
+			while (In && Out) {
+				In.read(Buffer.data(), Buffer.size());
+				auto Read = In.gcount();
+				if (Read <= 0)
+					break;
+				Size += Read;
+				EVP_DigestUpdate(Digest, Buffer.data(), (std::size_t)Read);
+				Out.write(Buffer.data(), Read);
+			}
+			Out.close();
+			if (!Out)
+				throw std::runtime_error("cannot write " + TmpFile.string());
+		}
+		unsigned char Raw[EVP_MAX_MD_SIZE];
+		unsigned int RawSize = 0;
+		EVP_DigestFinal_ex(Digest, Raw, &RawSize);
+		EVP_MD_CTX_free(Digest);
+		std::string Hash;
+		for (unsigned i = 0; i < RawSize; ++i)
+			Hash += fmt::format("{:02x}", Raw[i]);
+		auto Stored = Root / "store" / Hash.substr(0, 2);
+		std::filesystem::create_directories(Stored);
+		std::filesystem::rename(TmpFile, Stored / Hash);
+		Insert(Db, nullptr, Size, Hash);
+	}
+
+	//	In a child process: prints MB/s and peak RSS of one upload.
+	static void Child(bool Stream, std::uint64_t Size, const std::filesystem::path &Root) {
+		auto Dir = Root / fmt::format("{}_{}", Stream ? "streamed" : "buffered", Size);
+		std::filesystem::create_directories(Dir / "incoming");
+		sqlite3 *Db = nullptr;
+		if (sqlite3_open((Dir / "gw.db").c_str(), &Db) != SQLITE_OK)
+			throw std::runtime_error("cannot open the database");
+		Exec(Db, "PRAGMA journal_mode=WAL");
+		Exec(Db, "PRAGMA synchronous=NORMAL");
+		Exec(Db, "CREATE TABLE FileUploads (UUID VARCHAR(64), Type VARCHAR(32), Created BIGINT, "
+				 "FileContent BYTEA, FileHash VARCHAR(64), FileSize BIGINT)");
+		auto Before = PeakKB();
+
+		UploadBuf Buf(Size);
+		std::istream In(&Buf);
+		auto Start = std::chrono::steady_clock::now();
+		if (Stream)
+			Streamed(In, Db, Dir);
+		else
+			Buffered(In, Db);
+		auto Seconds =
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		auto Peak = PeakKB();
+		sqlite3_close(Db);
+		std::filesystem::remove_all(Dir);
+		fmt::print("{:>10}{:>10}{:>12.0f}{:>16.1f}{:>16.1f}\n", Stream ? "streamed" : "buffered",
+				   Size >> 20, (double)Size / (1 << 20) / Seconds, (double)Peak / 1024,
+				   (double)(Peak - Before) / 1024);
+		std::fflush(stdout);
+	}
+
+	static int Run(const std::filesystem::path &Root) {
+		fmt::print("{:>10}{:>10}{:>12}{:>16}{:>16}\n", "upload", "MB", "MB/s", "peak RSS MB",
+				   "added MB");
+		std::fflush(stdout);
+		for (std::uint64_t MB : {1, 10, 100}) {
+			for (bool Stream : {false, true}) {
+				auto Pid = fork();
+				if (Pid < 0)
+					throw std::runtime_error("fork failed");
+				if (Pid == 0) {
+					try {
+						Child(Stream, MB << 20, Root);
+						_exit(0);
+					} catch (const std::exception &E) {
+						fmt::print(stderr, "{}\n", E.what());
+					}
+					_exit(1);
+				}
+				int Status = 0;
+				waitpid(Pid, &Status, 0);
+				if (!WIFEXITED(Status) || WEXITSTATUS(Status) != 0) {
+					std::filesystem::remove_all(Root);
+					return 1;
+				}
+			}
+		}
+		std::filesystem::remove_all(Root);
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main(int argc, char **argv) {
+	try {
+		std::filesystem::path Root = argc > 1 ? argv[1] : "/tmp";
+		return OpenWifi::Bench::Run(Root / fmt::format("owgw_upload_bench_{}", getpid()));
+	} catch (const std::exception &E) {
+		fmt::print(stderr, "{}\n", E.what());
+	}
+	return 1;
+}
@@ -0,0 +1,286 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Venue broadcast latency, from the moment a device's message is queued to the moment the last
+//	device of its venue has its frame, for venues of 100 to 5000 devices. The pipeline is the one
+//	VenueBroadcaster runs: the venue is found in a VenueIndex, unknown devices are looked up by a
+//	lookup thread, the destinations are split into one batch per reactor and the batches are sent
+//	by a pool of workers. The provisioning service is a local stand-in that answers after a fixed
+//	delay and connections write a websocket frame into memory, so the numbers leave out the
+//	network. "cold" is the first broadcast of a venue, which waits for the lookup. "warm" is one
+//	broadcast at a time from a known venue, "burst" is 100 broadcasts queued at once. Build and run:
+//		cmake --build . --target owgw_venue_bench && ./owgw_venue_bench [lookup ms] [workers]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "VenueIndex.h"
+
+namespace OpenWifi::Bench {
+
+	using Clock = std::chrono::steady_clock;
+
+	template <typename T> class Queue {
+	  public:
+		void Push(T Item) {
+			{
+				std::lock_guard G(Mutex_);
+				Items_.push_back(std::move(Item));
+			}
+			Ready_.notify_one();
+		}
+		std::optional<T> Pop() {
+			std::unique_lock L(Mutex_);
+			Ready_.wait(L, [this] { return Stopped_ || !Items_.empty(); });
+			if (Items_.empty())
+				return std::nullopt;
+			auto Item = std::move(Items_.front());
+			Items_.pop_front();
+			return Item;
+		}
+		void Stop() {
+			{
+				std::lock_guard G(Mutex_);
+				Stopped_ = true;
+			}
+			Ready_.notify_all();
+		}
+
+	  private:
+		std::mutex Mutex_;
+		std::condition_variable Ready_;
+		std::deque<T> Items_;
+		bool Stopped_ = false;
+	};
+
+	//	Stands in for AP_WS_Connection::Send: a text frame header and the payload, under the
+	//	connection's lock.
+	struct Connection {
+		std::size_t Reactor = 0;
+		std::mutex Mutex;
+		std::string Out;
+		bool Send(const std::string &Payload) {
+			std::lock_guard G(Mutex);
+			Out.clear();
+			Out.push_back((char)0x81);
+			if (Payload.size() < 126) {
+				Out.push_back((char)Payload.size());
+			} else {
+				Out.push_back((char)126);
+				Out.push_back((char)(Payload.size() >> 8));
+				Out.push_back((char)(Payload.size() & 0xff));
+			}
+			Out.append(Payload);
+			return true;
+		}
+	};
+
+	struct Broadcast {
+		std::string Source;
+		Clock::time_point Queued;
+		bool Retried = false;
+	};
+
+	struct Progress {
+		std::atomic_uint64_t PendingBatches = 0;
+		Clock::time_point Queued;
+	};
+
+	struct Batch {
+		std::shared_ptr<const std::string> Payload;
+		std::vector<Connection *> Connections;
+		std::shared_ptr<Progress> Tracker;
+	};
+
+	class Gateway {
+	  public:
+		Gateway(std::size_t Devices, std::size_t Reactors, std::size_t Workers,
+				std::chrono::milliseconds LookupDelay)
+			: Reactors_(Reactors), LookupDelay_(LookupDelay) {
+			for (std::size_t i = 0; i < Devices; ++i) {
+				auto Serial = fmt::format("{:012x}", 0x903cb3000000ULL + i);
+				Venue_.push_back(Serial);
+				auto C = std::make_unique<Connection>();
+				C->Reactor = std::hash<std::string>{}(Serial) % Reactors;
+				Connections_[Serial] = std::move(C);
+			}
+			for (std::size_t i = 0; i < Workers; ++i)
+				Threads_.emplace_back([this] { SendBatches(); });
+			Threads_.emplace_back([this] { Lookups(); });
+			Threads_.emplace_back([this] { Broadcasts(); });
+		}
+
+		~Gateway() {
+			BroadcastQueue_.Stop();
+			LookupQueue_.Stop();
+			BatchQueue_.Stop();
+			for (auto &T : Threads_)
+				T.join();
+		}
+
+		const std::vector<std::string> &Devices() const { return Venue_; }
+
+		void Send(const std::string &Source) { BroadcastQueue_.Push({Source, Clock::now()}); }
+
+		//	Latencies in microseconds of the next Count broadcasts to complete.
+		std::vector<double> Wait(std::size_t Count) {
+			std::unique_lock L(DoneMutex_);
+			DoneReady_.wait(L, [&] { return Done_.size() >= Count; });
+			std::vector<double> R(Done_.begin(), Done_.begin() + (std::ptrdiff_t)Count);
+			Done_.erase(Done_.begin(), Done_.begin() + (std::ptrdiff_t)Count);
+			return R;
+		}
+
+	  private:
+		std::size_t Reactors_;
+		std::chrono::milliseconds LookupDelay_;
+		std::vector<std::string> Venue_;
+		std::unordered_map<std::string, std::unique_ptr<Connection>> Connections_;
+		VenueIndex Index_;
+		Queue<Broadcast> BroadcastQueue_;
+		Queue<Broadcast> LookupQueue_;
+		Queue<Batch> BatchQueue_;
+		std::vector<std::thread> Threads_;
+
+		std::mutex DoneMutex_;
+		std::condition_variable DoneReady_;
+		std::vector<double> Done_;
+
+		static std::uint64_t Now() {
+			return (std::uint64_t)std::chrono::duration_cast<std::chrono::seconds>(
+					   std::chrono::system_clock::now().time_since_epoch())
+				.count();
+		}
+
+		void Record(Clock::time_point Queued) {
+			auto Us = std::chrono::duration<double, std::micro>(Clock::now() - Queued).count();
+			{
+				std::lock_guard G(DoneMutex_);
+				Done_.push_back(Us);
+			}
+			DoneReady_.notify_all();
+		}
+
+		//	The provisioning stand-in: one venue holding every device.
+		void Lookups() {
+			while (auto B = LookupQueue_.Pop()) {
+				if (!Index_.IsFresh(B->Source, Now())) {
+					std::this_thread::sleep_for(LookupDelay_);
+					Index_.Update(B->Source, true, "venue-1", Venue_, Now());
+				} else {
+					Index_.ClearPending(B->Source);
+				}
+				BroadcastQueue_.Push(*B);
+			}
+		}
+
+		void Broadcasts() {
+			std::vector<std::string> SerialNumbers;
+			while (auto B = BroadcastQueue_.Pop()) {
+				bool MustRefresh = false;
+				if (!Index_.Find(B->Source, SerialNumbers, MustRefresh, Now())) {
+					if (!B->Retried) {
+						B->Retried = true;
+						Index_.AddPending(B->Source);
+						LookupQueue_.Push(*B);
+					}
+					continue;
+				}
+				auto Payload = std::make_shared<const std::string>(fmt::format(
+					R"({{"jsonrpc":"2.0","method":"venue_broadcast","params":{{"serial":"{}","timestamp":{},"data":{{"ssid":"venue","clients":[{}]}}}}}})",
+					B->Source, Now(), std::string(900, '1')));
+				std::vector<std::vector<Connection *>> Batches(Reactors_);
+				for (const auto &Serial : SerialNumbers) {
+					auto C = Connections_.find(Serial);
+					if (C != Connections_.end())
+						Batches[C->second->Reactor].push_back(C->second.get());
+				}
+				auto Tracker = std::make_shared<Progress>();
+				Tracker->Queued = B->Queued;
+				Tracker->PendingBatches = (std::uint64_t)std::count_if(
+					Batches.begin(), Batches.end(), [](const auto &V) { return !V.empty(); });
+				if (Tracker->PendingBatches == 0) {
+					Record(B->Queued);
+					continue;
+				}
+				for (auto &Connections : Batches)
+					if (!Connections.empty())
+						BatchQueue_.Push({Payload, std::move(Connections), Tracker});
+			}
+		}
+
+		void SendBatches() {
+			while (auto B = BatchQueue_.Pop()) {
+				for (auto C : B->Connections)
+					C->Send(*B->Payload);
+				if (--B->Tracker->PendingBatches == 0)
+					Record(B->Tracker->Queued);
+			}
+		}
+	};
+
+	static double Percentile(std::vector<double> V, double P) {
+		std::sort(V.begin(), V.end());
+		return V[std::min(V.size() - 1, (std::size_t)(P * (double)V.size()))];
+	}
+
+	static void Run(std::size_t Devices, std::chrono::milliseconds LookupDelay, std::size_t Workers) {
+		Gateway G(Devices, 20, Workers, LookupDelay);
+		const auto &Serials = G.Devices();
+
+		G.Send(Serials[0]);
+		auto Cold = G.Wait(1)[0];
+
+		std::vector<double> Warm;
+		for (std::size_t i = 0; i < 200; ++i) {
+			G.Send(Serials[(i * 7919) % Serials.size()]);
+			Warm.push_back(G.Wait(1)[0]);
+		}
+
+		const std::size_t Burst = 100;
+		auto Start = Clock::now();
+		for (std::size_t i = 0; i < Burst; ++i)
+			G.Send(Serials[(i * 104729) % Serials.size()]);
+		auto Bursts = G.Wait(Burst);
+		auto Seconds = std::chrono::duration<double>(Clock::now() - Start).count();
+
+		fmt::print("{:>8}{:>12.1f}{:>12.2f}{:>12.2f}{:>12.2f}{:>12.2f}{:>14.0f}\n", Devices,
+				   Cold / 1000, Percentile(Warm, 0.5) / 1000, Percentile(Warm, 0.99) / 1000,
+				   Percentile(Bursts, 0.5) / 1000, *std::max_element(Bursts.begin(), Bursts.end()) / 1000,
+				   (double)(Burst * (Devices - 1)) / Seconds);
+	}
+
+	static int Run(std::chrono::milliseconds LookupDelay, std::size_t Workers) {
+		fmt::print("lookup stand-in {}ms, {} workers, 20 reactors, latency in ms\n",
+				   LookupDelay.count(), Workers);
+		fmt::print("{:>8}{:>12}{:>12}{:>12}{:>12}{:>12}{:>14}\n", "devices", "cold", "warm p50",
+				   "warm p99", "burst p50", "burst max", "frames/s");
+		for (std::size_t Devices : {100, 500, 1000, 2000, 5000})
+			Run(Devices, LookupDelay, Workers);
+		return 0;
+	}
+
+} // namespace OpenWifi::Bench
+
+int main(int argc, char **argv) {
+	auto LookupMs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20;
+	auto Workers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+	return OpenWifi::Bench::Run(std::chrono::milliseconds(LookupMs),
+								std::max((std::size_t)1, (std::size_t)Workers));
+}
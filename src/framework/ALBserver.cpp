@@ -5,6 +5,7 @@
 #include "ALBserver.h"
 
 #include "fmt/format.h"
+#include "framework/MetricsRegistry.h"
 #include "framework/MicroServiceFuncs.h"
 #include "framework/utils.h"
 
@@ -31,12 +32,31 @@ namespace OpenWifi {
 		}
 	}
 
+	void ALBMetricsRequestHandler::handleRequest([[maybe_unused]] Poco::Net::HTTPServerRequest &Request,
+												 Poco::Net::HTTPServerResponse &Response) {
+		Utils::SetThreadName("alb-metrics");
+		try {
+			Response.setChunkedTransferEncoding(true);
+			Response.setContentType("text/plain; version=0.0.4");
+			Response.setDate(Poco::Timestamp());
+			Response.setStatus(Poco::Net::HTTPResponse::HTTP_OK);
+			Response.setVersion(Poco::Net::HTTPMessage::HTTP_1_1);
+			std::ostream &Answer = Response.send();
+			MetricsRegistry()->Render(Answer);
+		} catch (const Poco::Exception &E) {
+			Logger_.log(E);
+		} catch (...) {
+		}
+	}
+
 	ALBRequestHandlerFactory::ALBRequestHandlerFactory(Poco::Logger &L) : Logger_(L) {}
 
-	ALBRequestHandler *
+	Poco::Net::HTTPRequestHandler *
 	ALBRequestHandlerFactory::createRequestHandler(const Poco::Net::HTTPServerRequest &request) {
 		if (request.getURI() == "/")
 			return new ALBRequestHandler(Logger_, req_id_++);
+		else if (request.getURI() == "/metrics" && ALBHealthCheckServer()->MetricsEnabled())
+			return new ALBMetricsRequestHandler(Logger_);
 		else
 			return nullptr;
 	}
@@ -49,6 +69,7 @@ namespace OpenWifi {
 			poco_information(Logger(), "Starting...");
 			Running_ = true;
 			Port_ = (int)MicroServiceConfigGetInt("alb.port", 15015);
+			Metrics_ = MicroServiceConfigGetBool("alb.metrics", true);
 			Poco::Net::IPAddress Addr(Poco::Net::IPAddress::wildcard(
 				Poco::Net::Socket::supportsIPv6() ? Poco::Net::AddressFamily::IPv6
 												  : Poco::Net::AddressFamily::IPv4));
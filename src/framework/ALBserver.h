@@ -26,10 +26,21 @@ namespace OpenWifi {
 		uint64_t id_;
 	};
 
+	class ALBMetricsRequestHandler : public Poco::Net::HTTPRequestHandler {
+	  public:
+		explicit ALBMetricsRequestHandler(Poco::Logger &L) : Logger_(L) {}
+
+		void handleRequest([[maybe_unused]] Poco::Net::HTTPServerRequest &Request,
+						   Poco::Net::HTTPServerResponse &Response) override;
+
+	  private:
+		Poco::Logger &Logger_;
+	};
+
 	class ALBRequestHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory {
 	  public:
 		explicit ALBRequestHandlerFactory(Poco::Logger &L);
-		ALBRequestHandler *
+		Poco::Net::HTTPRequestHandler *
 		createRequestHandler(const Poco::Net::HTTPServerRequest &request) override;
 
 	  private:
@@ -54,6 +65,8 @@ namespace OpenWifi {
 			Callback_=F;
 		};
 
+		[[nodiscard]] inline bool MetricsEnabled() const { return Metrics_; }
+
 		inline std::string CallbackText() {
 			if(Callback_== nullptr) {
 				return "process Alive and kicking!";
@@ -67,6 +80,7 @@ namespace OpenWifi {
 		std::unique_ptr<Poco::Net::ServerSocket> Socket_;
 		ALBHealthMessageCallback	*Callback_= nullptr;
 		int Port_ = 0;
+		bool Metrics_ = true;
 		mutable std::atomic_bool Running_ = false;
 	};
 
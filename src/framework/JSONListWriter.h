@@ -0,0 +1,72 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+
+#include "Poco/JSON/Object.h"
+
+namespace OpenWifi {
+
+	//	Writes {"<Name>":[<rows>],<trailer fields>} one row at a time. Text is kept until there
+	//	is FlushSize of it, then handed to Flush: nothing goes out before the first rows are
+	//	known, and the response stream sees a few large writes.
+	class JSONListWriter {
+	  public:
+		using FlushFunction = std::function<void(const std::string &)>;
+		static constexpr std::size_t FlushSize = 64 * 1024;
+
+		JSONListWriter(const std::string &Name, FlushFunction Flush) : Flush_(std::move(Flush)) {
+			Buffer_ << "{\"" << Name << "\":[";
+		}
+
+		inline void Add(const Poco::JSON::Object &Obj) {
+			if (Rows_++)
+				Buffer_ << ",";
+			Obj.stringify(Buffer_);
+			if ((std::size_t)Buffer_.tellp() >= FlushSize)
+				Flush();
+		}
+
+		template <typename T> inline void Add(const T &Value) {
+			Poco::JSON::Object Obj;
+			Value.to_json(Obj);
+			Add(Obj);
+		}
+
+		inline void Close(const Poco::JSON::Object &Trailer) {
+			Buffer_ << "]";
+			if (Trailer.size() == 0) {
+				Buffer_ << "}";
+			} else {
+				std::ostringstream T;
+				Trailer.stringify(T);
+				Buffer_ << "," << T.str().substr(1);
+			}
+			Flush();
+		}
+
+		[[nodiscard]] inline std::uint64_t Rows() const { return Rows_; }
+		//	True once some of the document was handed to Flush.
+		[[nodiscard]] inline bool Flushed() const { return Flushed_; }
+
+	  private:
+		FlushFunction Flush_;
+		std::ostringstream Buffer_;
+		std::uint64_t Rows_ = 0;
+		bool Flushed_ = false;
+
+		inline void Flush() {
+			Flushed_ = true;
+			Flush_(Buffer_.str());
+			Buffer_.str("");
+		}
+	};
+
+} // namespace OpenWifi
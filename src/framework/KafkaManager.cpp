@@ -5,11 +5,23 @@
 #include "KafkaManager.h"
 
 #include "fmt/format.h"
+#include "framework/MetricsRegistry.h"
 #include "framework/MicroServiceFuncs.h"
 #include "cppkafka/utils/consumer_dispatcher.h"
 
 namespace OpenWifi {
 
+	static auto &MessagesProduced = MetricsRegistry()->Counter(
+		"owgw_kafka_messages_produced_total", "Messages handed to the Kafka broker.");
+	static auto &ProduceErrors = MetricsRegistry()->Counter(
+		"owgw_kafka_produce_errors_total", "Messages that could not be produced.");
+	static auto &ProduceTime = MetricsRegistry()->Histogram(
+		"owgw_kafka_produce_seconds", "Time to produce and flush one message.");
+	static auto &MessagesConsumed = MetricsRegistry()->Counter(
+		"owgw_kafka_messages_consumed_total", "Messages received from Kafka.");
+	static auto &ConsumeErrors = MetricsRegistry()->Counter(
+		"owgw_kafka_consume_errors_total", "Kafka consumer errors.");
+
 	void KafkaLoggerFun([[maybe_unused]] cppkafka::KafkaHandleBase &handle, int level,
 						const std::string &facility, const std::string &message) {
 		switch ((cppkafka::LogLevel)level) {
@@ -102,19 +114,27 @@ namespace OpenWifi {
 			try {
 				auto Msg = dynamic_cast<KafkaMessage *>(Note.get());
 				if (Msg != nullptr) {
+					auto Start = std::chrono::steady_clock::now();
 					auto NewMessage = cppkafka::MessageBuilder(Msg->Topic());
 					NewMessage.key(Msg->Key());
 					NewMessage.partition(0);
 					NewMessage.payload(Msg->Payload());
 					Producer.produce(NewMessage);
 					Producer.flush();
+					MessagesProduced.Inc();
+					ProduceTime.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+										   std::chrono::steady_clock::now() - Start)
+										   .count());
 				}
 			} catch (const cppkafka::HandleException &E) {
+				ProduceErrors.Inc();
 				poco_warning(Logger_,
 							 fmt::format("Caught a Kafka exception (producer): {}", E.what()));
 			} catch (const Poco::Exception &E) {
+				ProduceErrors.Inc();
 				Logger_.log(E);
 			} catch (...) {
+				ProduceErrors.Inc();
 				poco_error(Logger_, "std::exception");
 			}
 			Note = Queue_.waitDequeueNotification();
@@ -179,6 +199,7 @@ namespace OpenWifi {
 			// Callback executed whenever a new message is consumed
 			[&](cppkafka::Message msg) {
 				// Print the key (if any)
+				MessagesConsumed.Inc();
 				std::lock_guard G(ConsumerMutex_);
 				auto It = Notifiers_.find(msg.get_topic());
 				if (It != Notifiers_.end()) {
@@ -197,6 +218,7 @@ namespace OpenWifi {
 			},
 			// Whenever there's an error (other than the EOF soft error)
 			[&Logger_](cppkafka::Error error) {
+				ConsumeErrors.Inc();
 				poco_warning(Logger_,fmt::format("Error: {}", error.to_string()));
 			},
 			// Whenever EOF is reached on a partition, print this
@@ -278,6 +300,9 @@ namespace OpenWifi {
 		if (!KafkaEnabled_)
 			return 0;
 		MaxPayloadSize_ = MicroServiceConfigGetInt("openwifi.kafka.max.payload", 250000);
+		MetricsRegistry()->GaugeFunction("owgw_kafka_produce_queue_depth",
+										 "Messages waiting for the Kafka producer.", {},
+										 [this] { return (double)ProducerThr_.QueueDepth(); });
 		ConsumerThr_.Start();
 		ProducerThr_.Start();
 		return 0;
@@ -37,6 +37,7 @@ namespace OpenWifi {
 		void Start();
 		void Stop();
 		void Produce(const char *Topic, const std::string &Key, const std::string & Payload);
+		[[nodiscard]] inline std::size_t QueueDepth() { return Queue_.size(); }
 
 	  private:
 		std::mutex Mutex_;
@@ -0,0 +1,283 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace OpenWifi {
+
+	using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+	class MetricCounter {
+	  public:
+		inline void Inc(std::uint64_t N = 1) { Value_.fetch_add(N, std::memory_order_relaxed); }
+		[[nodiscard]] inline std::uint64_t Value() const {
+			return Value_.load(std::memory_order_relaxed);
+		}
+
+	  private:
+		std::atomic_uint64_t Value_ = 0;
+	};
+
+	class MetricGauge {
+	  public:
+		inline void Set(std::int64_t V) { Value_.store(V, std::memory_order_relaxed); }
+		inline void Inc(std::int64_t N = 1) { Value_.fetch_add(N, std::memory_order_relaxed); }
+		inline void Dec(std::int64_t N = 1) { Value_.fetch_sub(N, std::memory_order_relaxed); }
+		[[nodiscard]] inline std::int64_t Value() const {
+			return Value_.load(std::memory_order_relaxed);
+		}
+
+	  private:
+		std::atomic_int64_t Value_ = 0;
+	};
+
+	//	Durations in microseconds, exported in seconds. Buckets are log-linear: two per power
+	//	of two (1, 2, 3, 4, 6, 8, 12, 16, ...) up to about 3 minutes, so any value lands in a
+	//	bucket at most 50% wider than itself.
+	class MetricHistogram {
+	  public:
+		static constexpr std::size_t BucketCount = 55;
+		static constexpr std::array<std::uint64_t, BucketCount> Bounds = [] {
+			std::array<std::uint64_t, BucketCount> B{};
+			B[0] = 1;
+			for (std::size_t i = 1; i < BucketCount; ++i) {
+				auto Octave = (i + 1) / 2;
+				B[i] = (i % 2) ? (1ULL << Octave) : (3ULL << (Octave - 1));
+			}
+			return B;
+		}();
+
+		inline void Record(std::uint64_t Us) {
+			auto i = std::lower_bound(Bounds.begin(), Bounds.end(), Us) - Bounds.begin();
+			Buckets_[i].fetch_add(1, std::memory_order_relaxed);
+			Sum_.fetch_add(Us, std::memory_order_relaxed);
+			auto Max = Max_.load(std::memory_order_relaxed);
+			while (Us > Max && !Max_.compare_exchange_weak(Max, Us, std::memory_order_relaxed))
+				;
+			if (auto M = Export_.load(std::memory_order_relaxed))
+				M->Record(Us);
+		}
+
+		//	Also feed every value to another histogram, usually a series several owners share.
+		inline void Export(MetricHistogram &M) { Export_ = &M; }
+
+		//	Cumulative counts, the last one is +Inf.
+		inline void Snapshot(std::array<std::uint64_t, BucketCount + 1> &Cumulative,
+							 std::uint64_t &Sum) const {
+			std::uint64_t Total = 0;
+			for (std::size_t i = 0; i < Buckets_.size(); ++i) {
+				Total += Buckets_[i].load(std::memory_order_relaxed);
+				Cumulative[i] = Total;
+			}
+			Sum = Sum_.load(std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] inline std::uint64_t Count() const {
+			std::uint64_t Total = 0;
+			for (const auto &Bucket : Buckets_)
+				Total += Bucket.load(std::memory_order_relaxed);
+			return Total;
+		}
+
+		//	Upper bound of the bucket holding quantile Q, the maximum for the last bucket.
+		[[nodiscard]] static inline std::uint64_t
+		Quantile(const std::array<std::uint64_t, BucketCount + 1> &Cumulative, double Q,
+				 std::uint64_t Max) {
+			auto Rank = (std::uint64_t)(Q * (double)Cumulative.back());
+			for (std::size_t i = 0; i < BucketCount; ++i)
+				if (Cumulative[i] > Rank)
+					return std::min(Bounds[i], Max);
+			return Max;
+		}
+
+		//	Summary for the statistics command, Obj is a Poco::JSON::Object.
+		template <typename Object> inline void ToJSON(Object &Obj) const {
+			std::array<std::uint64_t, BucketCount + 1> Cumulative{};
+			std::uint64_t Sum = 0;
+			Snapshot(Cumulative, Sum);
+			auto Count = Cumulative.back();
+			auto Max = Max_.load(std::memory_order_relaxed);
+			Obj.set("count", Count);
+			Obj.set("averageUs", Count ? Sum / Count : 0);
+			Obj.set("p50Us", Quantile(Cumulative, 0.50, Max));
+			Obj.set("p90Us", Quantile(Cumulative, 0.90, Max));
+			Obj.set("p99Us", Quantile(Cumulative, 0.99, Max));
+			Obj.set("maxUs", Max);
+		}
+
+	  private:
+		std::array<std::atomic_uint64_t, BucketCount + 1> Buckets_{};
+		std::atomic_uint64_t Sum_ = 0, Max_ = 0;
+		std::atomic<MetricHistogram *> Export_ = nullptr;
+	};
+
+	//	Named series in the Prometheus text format. Looking a series up takes a lock, updating
+	//	one does not: callers keep the reference they got, it stays valid for the life of the
+	//	process.
+	class MetricsRegistry {
+	  public:
+		static auto instance() {
+			static auto instance_ = new MetricsRegistry;
+			return instance_;
+		}
+
+		inline MetricCounter &Counter(const std::string &Name, const std::string &Help,
+									  const MetricLabels &Labels = {}) {
+			return Series(Counters_, Name, Help, "counter", Labels);
+		}
+
+		inline MetricGauge &Gauge(const std::string &Name, const std::string &Help,
+								  const MetricLabels &Labels = {}) {
+			return Series(Gauges_, Name, Help, "gauge", Labels);
+		}
+
+		inline MetricHistogram &Histogram(const std::string &Name, const std::string &Help,
+										  const MetricLabels &Labels = {}) {
+			return Series(Histograms_, Name, Help, "histogram", Labels);
+		}
+
+		//	For values that already exist elsewhere, read when scraped. F runs with the registry
+		//	locked and must not register series.
+		inline void GaugeFunction(const std::string &Name, const std::string &Help,
+								  const MetricLabels &Labels, std::function<double()> F) {
+			Series(Functions_, Name, Help, "gauge", Labels).F = std::move(F);
+		}
+
+		inline void CounterFunction(const std::string &Name, const std::string &Help,
+									const MetricLabels &Labels, std::function<double()> F) {
+			Series(Functions_, Name, Help, "counter", Labels).F = std::move(F);
+		}
+
+		inline void Render(std::ostream &os) {
+			std::lock_guard G(Mutex_);
+			for (const auto &[Name, Family] : Families_) {
+				os << "# HELP " << Name << " " << Family.Help << "\n";
+				os << "# TYPE " << Name << " " << Family.Type << "\n";
+				RenderFamily(os, Name);
+			}
+		}
+
+	  private:
+		struct Family {
+			std::string Help;
+			std::string Type;
+		};
+		struct Function {
+			std::function<double()> F;
+		};
+		template <typename T>
+		using SeriesMap = std::map<std::string, std::map<std::string, std::unique_ptr<T>>>;
+
+		std::mutex Mutex_;
+		std::map<std::string, Family> Families_;
+		SeriesMap<MetricCounter> Counters_;
+		SeriesMap<MetricGauge> Gauges_;
+		SeriesMap<MetricHistogram> Histograms_;
+		SeriesMap<Function> Functions_;
+
+		MetricsRegistry() = default;
+
+		template <typename T>
+		inline T &Series(SeriesMap<T> &Map, const std::string &Name, const std::string &Help,
+						 const char *Type, const MetricLabels &Labels) {
+			std::lock_guard G(Mutex_);
+			auto &F = Families_[Name];
+			if (F.Type.empty()) {
+				F.Help = Help;
+				F.Type = Type;
+			}
+			auto &Entry = Map[Name][FormatLabels(Labels)];
+			if (!Entry)
+				Entry = std::make_unique<T>();
+			return *Entry;
+		}
+
+		static inline std::string FormatLabels(const MetricLabels &Labels) {
+			if (Labels.empty())
+				return "";
+			std::string R = "{";
+			for (const auto &[Key, Value] : Labels) {
+				if (R.size() > 1)
+					R += ",";
+				R += Key + "=\"";
+				for (auto c : Value) {
+					if (c == '\\' || c == '"')
+						R += '\\';
+					if (c == '\n') {
+						R += "\\n";
+						continue;
+					}
+					R += c;
+				}
+				R += "\"";
+			}
+			return R + "}";
+		}
+
+		//	Labels are stored formatted, the bucket label goes inside the braces.
+		static inline std::string WithLabel(const std::string &Labels, const std::string &Extra) {
+			if (Labels.empty())
+				return "{" + Extra + "}";
+			return Labels.substr(0, Labels.size() - 1) + "," + Extra + "}";
+		}
+
+		//	Called with Mutex_ held.
+		inline void RenderFamily(std::ostream &os, const std::string &Name) {
+			if (auto C = Counters_.find(Name); C != Counters_.end()) {
+				for (const auto &[Labels, Counter] : C->second)
+					os << Name << Labels << " " << Counter->Value() << "\n";
+			}
+			if (auto Gs = Gauges_.find(Name); Gs != Gauges_.end()) {
+				for (const auto &[Labels, Gauge] : Gs->second)
+					os << Name << Labels << " " << Gauge->Value() << "\n";
+			}
+			if (auto Fs = Functions_.find(Name); Fs != Functions_.end()) {
+				for (const auto &[Labels, Function] : Fs->second) {
+					try {
+						if (Function->F)
+							os << Name << Labels << " " << fmt::format("{}", Function->F()) << "\n";
+					} catch (...) {
+						//	the owner is shutting down, leave the series out.
+					}
+				}
+			}
+			if (auto Hs = Histograms_.find(Name); Hs != Histograms_.end()) {
+				std::array<std::uint64_t, MetricHistogram::BucketCount + 1> Cumulative{};
+				std::uint64_t Sum = 0;
+				for (const auto &[Labels, Histogram] : Hs->second) {
+					Histogram->Snapshot(Cumulative, Sum);
+					for (std::size_t i = 0; i < MetricHistogram::BucketCount; ++i) {
+						os << Name << "_bucket"
+						   << WithLabel(Labels, fmt::format("le=\"{}\"",
+															MetricHistogram::Bounds[i] / 1e6))
+						   << " " << Cumulative[i] << "\n";
+					}
+					os << Name << "_bucket" << WithLabel(Labels, "le=\"+Inf\"") << " "
+					   << Cumulative.back() << "\n";
+					os << Name << "_sum" << Labels << " " << fmt::format("{}", Sum / 1e6) << "\n";
+					os << Name << "_count" << Labels << " " << Cumulative.back() << "\n";
+				}
+			}
+		}
+	};
+
+	inline auto MetricsRegistry() { return MetricsRegistry::instance(); }
+
+} // namespace OpenWifi
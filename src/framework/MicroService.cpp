@@ -26,6 +26,7 @@
 #include "framework/RESTAPI_ExtServer.h"
 #include "framework/RESTAPI_GenericServerAccounting.h"
 #include "framework/RESTAPI_IntServer.h"
+#include "framework/RESTAPI_RateLimiter.h"
 #include "framework/UI_WebSocketClientServer.h"
 #include "framework/WebSocketLogger.h"
 #include "framework/utils.h"
@@ -441,6 +442,7 @@ namespace OpenWifi {
             InitializedBaseService = true;
             SubSystems_.push_back(KafkaManager());
             SubSystems_.push_back(ALBHealthCheckServer());
+            SubSystems_.push_back(RESTAPI_RateLimiter());
             SubSystems_.push_back(RESTAPI_ExtServer());
             SubSystems_.push_back(RESTAPI_IntServer());
 #ifndef TIP_SECURITY_SERVICE
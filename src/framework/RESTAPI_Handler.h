@@ -5,6 +5,8 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -20,6 +22,7 @@
 
 #include "RESTObjects/RESTAPI_SecurityObjects.h"
 #include "framework/AuthClient.h"
+#include "framework/JSONListWriter.h"
 #include "framework/RESTAPI_GenericServerAccounting.h"
 #include "framework/RESTAPI_RateLimiter.h"
 #include "framework/RESTAPI_utils.h"
@@ -38,10 +41,10 @@ namespace OpenWifi {
 	  public:
 		struct QueryBlock {
 			uint64_t StartDate = 0, EndDate = 0, Offset = 0, Limit = 0, LogType = 0;
-			std::string SerialNumber, Filter;
+			std::string SerialNumber, Filter, Cursor;
 			std::vector<std::string> Select;
 			bool Lifetime = false, LastOnly = false, Newest = false, CountOnly = false,
-				 AdditionalInfo = false;
+				 AdditionalInfo = false, UseCursor = false;
 		};
 		typedef std::map<std::string, std::string> BindingMap;
 
@@ -492,6 +495,22 @@ namespace OpenWifi {
 			Response->sendFile(TempAvatar.path(), MT.ContentType);
 		}
 
+		//	Streams a file from disk under the given download name.
+		inline void SendNamedFile(Poco::File &File, const std::string &Name) {
+			Response->setStatus(Poco::Net::HTTPResponse::HTTPStatus::HTTP_OK);
+			SetCommonHeaders();
+			auto MT = Utils::FindMediaType(Name);
+			if (MT.Encoding == Utils::BINARY) {
+				Response->set("Content-Transfer-Encoding", "binary");
+				Response->set("Accept-Ranges", "bytes");
+			}
+			Response->set("Access-Control-Expose-Headers", "Content-Disposition");
+			Response->set("Content-Disposition", "attachment; filename=" + Name);
+			Response->set("Cache-Control", "no-store");
+			Response->set("Expires", "Mon, 26 Jul 2027 05:00:00 GMT");
+			Response->sendFile(File.path(), MT.ContentType);
+		}
+
 		inline void SendFileContent(const std::string &Content, [[maybe_unused]] const std::string &Type,
 									const std::string &Name) {
 			Response->setStatus(Poco::Net::HTTPResponse::HTTPStatus::HTTP_OK);
@@ -626,6 +645,52 @@ namespace OpenWifi {
 			Answer << json_doc;
 		}
 
+		//	Sends a listing while Fill(JSONListWriter &) produces its rows, so a large page is never
+		//	built as one JSON document. Trailer fields follow the array. Fill returns false when the
+		//	database failed: before the first rows went out that is a 500, after it the status is
+		//	already sent and the document ends with an "error" field instead of the trailer.
+		template <typename F>
+		inline void StreamList(const std::string &Name, F Fill,
+							   const Poco::JSON::Object &Trailer = Poco::JSON::Object()) {
+			std::ostream *Answer = nullptr;
+			std::unique_ptr<Poco::DeflatingOutputStream> Deflater;
+			JSONListWriter Writer(Name, [&](const std::string &Text) {
+				if (Answer == nullptr) {
+					PrepareResponse();
+					bool Compress = false;
+					if (Request != nullptr) {
+						auto AcceptedEncoding = Request->find("Accept-Encoding");
+						Compress = AcceptedEncoding != Request->end() &&
+								   (AcceptedEncoding->second.find("gzip") != std::string::npos ||
+									AcceptedEncoding->second.find("compress") != std::string::npos);
+					}
+					if (Compress)
+						Response->set("Content-Encoding", "gzip");
+					Answer = &Response->send();
+					if (Compress) {
+						Deflater = std::make_unique<Poco::DeflatingOutputStream>(
+							*Answer, Poco::DeflatingStreamBuf::STREAM_GZIP);
+						Answer = Deflater.get();
+					}
+				}
+				*Answer << Text;
+			});
+			if (Fill(Writer)) {
+				Writer.Close(Trailer);
+			} else if (!Writer.Flushed()) {
+				return InternalError(RESTAPI::Errors::InternalError);
+			} else {
+				const auto &E = RESTAPI::Errors::InternalError;
+				Poco::JSON::Object Error, Failed;
+				Error.set("ErrorCode", 500);
+				Error.set("ErrorDescription", fmt::format("{}: {}", E.err_num, E.err_txt));
+				Failed.set("error", Error);
+				Writer.Close(Failed);
+			}
+			if (Deflater)
+				Deflater->close();
+		}
+
 		inline void ReturnCountOnly(uint64_t Count) {
 			Poco::JSON::Object Answer;
 			Answer.set("count", Count);
@@ -648,6 +713,8 @@ namespace OpenWifi {
 			QB_.Newest = GetBoolParameter(RESTAPI::Protocol::NEWEST, false);
 			QB_.CountOnly = GetBoolParameter(RESTAPI::Protocol::COUNTONLY, false);
 			QB_.AdditionalInfo = GetBoolParameter(RESTAPI::Protocol::WITHEXTENDEDINFO, false);
+			//	an empty cursor asks for the first page of a keyset listing.
+			QB_.UseCursor = HasParameter(RESTAPI::Protocol::CURSOR, QB_.Cursor);
 
 			auto RawSelect = GetParameter(RESTAPI::Protocol::SELECT, "");
 
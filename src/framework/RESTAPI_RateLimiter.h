@@ -4,9 +4,10 @@
 
 #pragma once
 
+#include "framework/MicroServiceFuncs.h"
 #include "framework/SubSystemServer.h"
+#include "framework/TokenBuckets.h"
 
-#include "Poco/ExpireLRUCache.h"
 #include "Poco/Net/HTTPServerRequest.h"
 #include "Poco/URI.h"
 
@@ -14,53 +15,54 @@
 
 namespace OpenWifi {
 
+	//	Token bucket per (path, client address), see TokenBuckets.
 	class RESTAPI_RateLimiter : public SubSystemServer {
 	  public:
-		struct ClientCacheEntry {
-			int64_t Start = 0;
-			int Count = 0;
-		};
-
 		static auto instance() {
 			static auto instance_ = new RESTAPI_RateLimiter;
 			return instance_;
 		}
 
-		inline int Start() final { return 0; };
+		//	Before the REST servers start, nothing checks yet.
+		inline int Start() final {
+			auto Capacity = MicroServiceConfigGetInt("openwifi.restapi.ratelimiter.capacity",
+													 TokenBuckets::DefaultCapacity);
+			auto Shards = MicroServiceConfigGetInt("openwifi.restapi.ratelimiter.shards",
+												   TokenBuckets::DefaultShards);
+			Buckets_.Resize(Capacity, Shards);
+			return 0;
+		};
 		inline void Stop() final{};
 
 		inline bool IsRateLimited(const Poco::Net::HTTPServerRequest &R, int64_t Period,
 								  int64_t MaxCalls) {
 			Poco::URI uri(R.getURI());
 			auto H = str_hash(uri.getPath() + R.clientAddress().host().toString());
-			auto E = Cache_.get(H);
-			auto Now = std::chrono::duration_cast<std::chrono::milliseconds>(
-						   std::chrono::system_clock::now().time_since_epoch())
-						   .count();
-			if (E.isNull()) {
-				Cache_.add(H, ClientCacheEntry{.Start = Now, .Count = 1});
-				return false;
-			}
-			if ((Now - E->Start) < Period) {
-				E->Count++;
-				Cache_.update(H, E);
-				if (E->Count > MaxCalls) {
-					poco_warning(Logger(), fmt::format("RATE-LIMIT-EXCEEDED: from '{}'",
-													   R.clientAddress().toString()));
-					return true;
-				}
-				return false;
+			if (Buckets_.IsRateLimited(H, Period, MaxCalls)) {
+				poco_warning(Logger(), fmt::format("RATE-LIMIT-EXCEEDED: from '{}'",
+												   R.clientAddress().toString()));
+				return true;
 			}
-			E->Start = Now;
-			E->Count = 1;
-			Cache_.update(H, E);
 			return false;
 		}
 
-		inline void Clear() { Cache_.clear(); }
+		inline bool IsRateLimited(std::uint64_t Key, int64_t Period, int64_t MaxCalls) {
+			return Buckets_.IsRateLimited(Key, Period, MaxCalls);
+		}
+
+		inline void Clear() { Buckets_.Clear(); }
+
+		inline void GetStatistics(Poco::JSON::Object &Stats) final {
+			Stats.set("checks", Buckets_.Checks());
+			Stats.set("limited", Buckets_.Limited());
+			Stats.set("evictions", Buckets_.Evictions());
+			Stats.set("evictionRaces", Buckets_.EvictionRaces());
+			Stats.set("shards", Buckets_.Shards());
+			Stats.set("capacity", Buckets_.Capacity());
+		}
 
 	  private:
-		Poco::ExpireLRUCache<uint64_t, ClientCacheEntry> Cache_{2048};
+		TokenBuckets Buckets_;
 		std::hash<std::string> str_hash;
 
 		RESTAPI_RateLimiter() noexcept
@@ -69,4 +71,4 @@ namespace OpenWifi {
 
 	inline auto RESTAPI_RateLimiter() { return RESTAPI_RateLimiter::instance(); }
 
-} // namespace OpenWifi
\ No newline at end of file
+} // namespace OpenWifi
@@ -81,6 +81,16 @@ namespace OpenWifi {
 					Answer.set("peakVirtMem", peakVirtMem);
 					return ReturnObject(Answer);
 				}
+				if (Arg == RESTAPI::Protocol::STATS) {
+					Poco::JSON::Object Answer;
+					for (const auto &i : MicroServiceGetFullSubSystems()) {
+						Poco::JSON::Object SubSystemStats;
+						i->GetStatistics(SubSystemStats);
+						if (SubSystemStats.size() > 0)
+							Answer.set(i->Name(), SubSystemStats);
+					}
+					return ReturnObject(Answer);
+				}
 			}
 			BadRequest(RESTAPI::Errors::InvalidCommand);
 		}
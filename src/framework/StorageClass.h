@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "Poco/Data/SQLite/Connector.h"
 #include "Poco/Data/Session.h"
 #include "Poco/Data/SessionPool.h"
@@ -16,6 +18,7 @@
 
 #include "framework/MicroServiceFuncs.h"
 #include "framework/SubSystemServer.h"
+#include "framework/StorageSessionPool.h"
 
 namespace OpenWifi {
 	enum DBType { sqlite, pgsql, mysql };
@@ -36,10 +39,18 @@ namespace OpenWifi {
 			} else if (DBType == "mysql") {
 				Setup_MySQL();
 			}
+			Setup_Replica();
+			Pool_->ExportMetrics("primary");
+			if (ReplicaPool_)
+				ReplicaPool_->ExportMetrics("replica");
 			return 0;
 		}
 
-		inline void Stop() override { Pool_->shutdown(); }
+		inline void Stop() override {
+			if (ReplicaPool_)
+				ReplicaPool_->shutdown();
+			Pool_->shutdown();
+		}
 
 		DBType Type() const { return dbType_; };
 
@@ -49,37 +60,46 @@ namespace OpenWifi {
 
 		Poco::Data::SessionPool &Pool() { return *Pool_; }
 
+		inline void GetPoolStatistics(Poco::JSON::Object &Stats) {
+			Poco::JSON::Object Primary;
+			Pool_->GetStatistics(Primary);
+			Stats.set("primary", Primary);
+			if (ReplicaPool_) {
+				Poco::JSON::Object Replica;
+				ReplicaPool_->GetStatistics(Replica);
+				Stats.set("replica", Replica);
+			}
+		}
+
 	  private:
 		inline int Setup_SQLite();
 		inline int Setup_MySQL();
 		inline int Setup_PostgreSQL();
+		inline int Setup_Replica();
 
+		//	Sessions a pool keeps open when idle, at least one and at most its maximum.
+		static inline int MinPoolSessions(const std::string &Key, int Default, int MaxSessions) {
+			auto Min = (int)MicroServiceConfigGetInt(Key, (std::uint64_t)Default);
+			return std::clamp(Min, 1, std::max(1, MaxSessions));
+		}
 
     protected:
-		std::shared_ptr<Poco::Data::SessionPool> Pool_;
+		std::shared_ptr<StorageSessionPool> Pool_;
+		//	Optional read replica of the same type as the primary, null when not configured.
+		std::shared_ptr<StorageSessionPool> ReplicaPool_;
 		Poco::Data::SQLite::Connector SQLiteConn_;
 		Poco::Data::PostgreSQL::Connector PostgresConn_;
 		Poco::Data::MySQL::Connector MySQLConn_;
 		DBType dbType_ = sqlite;
 	};
 
-#ifdef SMALL_BUILD
-	int Service::Setup_MySQL() {
-		Daemon()->exit(Poco::Util::Application::EXIT_CONFIG);
-		return 0;
-	}
-	int Service::Setup_PostgreSQL() {
-		Daemon()->exit(Poco::Util::Application::EXIT_CONFIG);
-		return 0;
-	}
-#else
-
 	inline int StorageClass::Setup_SQLite() {
 		Logger().notice("SQLite StorageClass enabled.");
 		dbType_ = sqlite;
 		auto DBName = MicroServiceDataDirectory() + "/" +
 					  MicroServiceConfigGetString("storage.type.sqlite.db", "");
 		int NumSessions = (int)MicroServiceConfigGetInt("storage.type.sqlite.maxsessions", 64);
+		int MinSessions = MinPoolSessions("storage.type.sqlite.minsessions", 8, NumSessions);
 		int IdleTime = (int)MicroServiceConfigGetInt("storage.type.sqlite.idletime", 60);
 
 		Poco::Data::SQLite::Connector::registerConnector();
@@ -87,15 +107,29 @@ namespace OpenWifi {
 		//        Poco::Data::SessionPool(SQLiteConn_.name(), DBName, 8,
 		//                                                                                     (int)NumSessions,
 		//                                                                                     (int)IdleTime));
-		Pool_ = std::make_shared<Poco::Data::SessionPool>(SQLiteConn_.name(), DBName, 8,
+		Pool_ = std::make_shared<StorageSessionPool>(SQLiteConn_.name(), DBName, MinSessions,
 														  (int)NumSessions, (int)IdleTime);
 		return 0;
 	}
 
+#ifdef SMALL_BUILD
+	inline int StorageClass::Setup_MySQL() {
+		Daemon()->exit(Poco::Util::Application::EXIT_CONFIG);
+		return 0;
+	}
+	inline int StorageClass::Setup_PostgreSQL() {
+		Daemon()->exit(Poco::Util::Application::EXIT_CONFIG);
+		return 0;
+	}
+	//	no replica without MySQL or PostgreSQL, reads use the primary.
+	inline int StorageClass::Setup_Replica() { return 0; }
+#else
+
 	inline int StorageClass::Setup_MySQL() {
 		Logger().notice("MySQL StorageClass enabled.");
 		dbType_ = mysql;
 		int NumSessions = (int)MicroServiceConfigGetInt("storage.type.mysql.maxsessions", 64);
+		int MinSessions = MinPoolSessions("storage.type.mysql.minsessions", 8, NumSessions);
 		int IdleTime = (int)MicroServiceConfigGetInt("storage.type.mysql.idletime", 60);
 		auto Host = MicroServiceConfigGetString("storage.type.mysql.host", "");
 		auto Username = MicroServiceConfigGetString("storage.type.mysql.username", "");
@@ -108,7 +142,7 @@ namespace OpenWifi {
 									";compress=true;auto-reconnect=true";
 
 		Poco::Data::MySQL::Connector::registerConnector();
-		Pool_ = std::make_shared<Poco::Data::SessionPool>(MySQLConn_.name(), ConnectionStr, 8,
+		Pool_ = std::make_shared<StorageSessionPool>(MySQLConn_.name(), ConnectionStr, MinSessions,
 														  NumSessions, IdleTime);
 
 		return 0;
@@ -118,6 +152,7 @@ namespace OpenWifi {
 		Logger().notice("PostgreSQL StorageClass enabled.");
 		dbType_ = pgsql;
 		int NumSessions = (int)MicroServiceConfigGetInt("storage.type.postgresql.maxsessions", 64);
+		int MinSessions = MinPoolSessions("storage.type.postgresql.minsessions", 8, NumSessions);
 		int IdleTime = (int)MicroServiceConfigGetInt("storage.type.postgresql.idletime", 60);
 		auto Host = MicroServiceConfigGetString("storage.type.postgresql.host", "");
 		auto Username = MicroServiceConfigGetString("storage.type.postgresql.username", "");
@@ -132,9 +167,45 @@ namespace OpenWifi {
 									" connect_timeout=" + ConnectionTimeout;
 
 		Poco::Data::PostgreSQL::Connector::registerConnector();
-		Pool_ = std::make_shared<Poco::Data::SessionPool>(PostgresConn_.name(), ConnectionStr, 8,
-														  NumSessions, IdleTime);
+		Pool_ = std::make_shared<StorageSessionPool>(PostgresConn_.name(), ConnectionStr,
+														  MinSessions, NumSessions, IdleTime);
+
+		return 0;
+	}
 
+	inline int StorageClass::Setup_Replica() {
+		if (!MicroServiceConfigGetBool("storage.replica", false))
+			return 0;
+		int NumSessions = (int)MicroServiceConfigGetInt("storage.replica.maxsessions", 32);
+		int MinSessions = MinPoolSessions("storage.replica.minsessions", 4, NumSessions);
+		int IdleTime = (int)MicroServiceConfigGetInt("storage.replica.idletime", 60);
+		auto Host = MicroServiceConfigGetString("storage.replica.host", "");
+		auto Username = MicroServiceConfigGetString("storage.replica.username", "");
+		auto Password = MicroServiceConfigGetString("storage.replica.password", "");
+		auto Database = MicroServiceConfigGetString("storage.replica.database", "");
+		auto Port = MicroServiceConfigGetString("storage.replica.port", "");
+
+		if (dbType_ == sqlite) {
+			auto DBName = MicroServiceDataDirectory() + "/" +
+						  MicroServiceConfigGetString("storage.replica.db", "");
+			ReplicaPool_ = std::make_shared<StorageSessionPool>(SQLiteConn_.name(), DBName,
+																	 MinSessions, NumSessions, IdleTime);
+		} else if (dbType_ == mysql) {
+			std::string ConnectionStr = "host=" + Host + ";user=" + Username +
+										";password=" + Password + ";db=" + Database +
+										";port=" + Port + ";compress=true;auto-reconnect=true";
+			ReplicaPool_ = std::make_shared<StorageSessionPool>(
+				MySQLConn_.name(), ConnectionStr, MinSessions, NumSessions, IdleTime);
+		} else {
+			auto ConnectionTimeout =
+				MicroServiceConfigGetString("storage.replica.connectiontimeout", "10");
+			std::string ConnectionStr = "host=" + Host + " user=" + Username +
+										" password=" + Password + " dbname=" + Database +
+										" port=" + Port + " connect_timeout=" + ConnectionTimeout;
+			ReplicaPool_ = std::make_shared<StorageSessionPool>(
+				PostgresConn_.name(), ConnectionStr, MinSessions, NumSessions, IdleTime);
+		}
+		Logger().notice("Read replica enabled.");
 		return 0;
 	}
 #endif
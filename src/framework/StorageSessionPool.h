@@ -0,0 +1,135 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <source_location>
+#include <string>
+
+#include "Poco/Data/DataException.h"
+#include "Poco/Data/SessionPool.h"
+#include "Poco/JSON/Array.h"
+#include "Poco/JSON/Object.h"
+
+#include "framework/MetricsRegistry.h"
+
+namespace OpenWifi {
+
+	//	Session pool that measures how long callers take to get a session, and who they are.
+	//	Sessions are handed out as Poco::Data::SessionPool does it: an exhausted pool throws
+	//	SessionPoolExhaustedException at once, the caller is counted and nothing waits. The pool
+	//	opens sessions on demand up to its maximum and closes those idle for its idle time, down
+	//	to its minimum. It does not resize on observed waits: SessionPool does not say when a
+	//	session comes back, which a limit in front of it would need.
+	class StorageSessionPool : public Poco::Data::SessionPool {
+	  public:
+		StorageSessionPool(const std::string &Connector, const std::string &ConnectionString,
+						   int MinSessions, int MaxSessions, int IdleTime)
+			: Poco::Data::SessionPool(Connector, ConnectionString, MinSessions, MaxSessions,
+									  IdleTime) {}
+
+		//	Hides SessionPool::get(). Calls made through a SessionPool reference, like the ORM's,
+		//	are not counted.
+		inline Poco::Data::Session
+		get(const std::source_location &Caller = std::source_location::current()) {
+			auto Start = std::chrono::steady_clock::now();
+			try {
+				auto Session = Poco::Data::SessionPool::get();
+				Acquired(Start, Caller, false);
+				return Session;
+			} catch (const Poco::Data::SessionPoolExhaustedException &) {
+				Exhausted_++;
+				Acquired(Start, Caller, true);
+				throw;
+			}
+		}
+
+		inline void ExportMetrics(const std::string &Name) {
+			Wait_.Export(MetricsRegistry()->Histogram("owgw_db_session_wait_seconds",
+													  "Time spent getting a database session.",
+													  {{"pool", Name}}));
+			MetricsRegistry()->GaugeFunction("owgw_db_sessions_used",
+											 "Database sessions checked out.", {{"pool", Name}},
+											 [this] { return (double)used(); });
+			MetricsRegistry()->GaugeFunction("owgw_db_session_capacity",
+											 "Database sessions the pool may open.",
+											 {{"pool", Name}}, [this] { return (double)capacity(); });
+			MetricsRegistry()->CounterFunction(
+				"owgw_db_session_exhausted_total",
+				"Session requests refused because the pool was exhausted.", {{"pool", Name}},
+				[this] { return (double)Exhausted_.load(); });
+		}
+
+		inline void GetStatistics(Poco::JSON::Object &Obj) {
+			Obj.set("capacity", capacity());
+			Obj.set("used", used());
+			Obj.set("idle", idle());
+			Obj.set("dead", dead());
+			Obj.set("allocated", allocated());
+			Obj.set("exhausted", Exhausted_.load());
+			Poco::JSON::Object Wait;
+			Wait_.ToJSON(Wait);
+			Obj.set("wait", Wait);
+			Poco::JSON::Array Callers;
+			std::shared_lock Lock(CallersMutex_);
+			for (const auto &[_, Stats] : Callers_) {
+				Poco::JSON::Object Caller;
+				Stats->Wait.ToJSON(Caller);
+				Caller.set("caller", Stats->Name);
+				Caller.set("exhausted", Stats->Exhausted.load());
+				Callers.add(Caller);
+			}
+			Obj.set("callers", Callers);
+		}
+
+	  private:
+		struct CallerStatistics {
+			std::string Name;
+			MetricHistogram Wait;
+			std::atomic_uint64_t Exhausted = 0;
+		};
+
+		MetricHistogram Wait_;
+		std::atomic_uint64_t Exhausted_ = 0;
+
+		//	function_name() points to static storage, one entry per calling function.
+		std::shared_mutex CallersMutex_;
+		std::map<const char *, std::unique_ptr<CallerStatistics>> Callers_;
+
+		inline CallerStatistics &ForCaller(const std::source_location &Caller) {
+			{
+				std::shared_lock Lock(CallersMutex_);
+				auto It = Callers_.find(Caller.function_name());
+				if (It != Callers_.end())
+					return *It->second;
+			}
+			std::unique_lock Lock(CallersMutex_);
+			auto &Entry = Callers_[Caller.function_name()];
+			if (!Entry) {
+				Entry = std::make_unique<CallerStatistics>();
+				Entry->Name = Caller.function_name();
+			}
+			return *Entry;
+		}
+
+		inline void Acquired(std::chrono::steady_clock::time_point Start,
+							 const std::source_location &Caller, bool Failed) {
+			auto Us = std::chrono::duration_cast<std::chrono::microseconds>(
+						  std::chrono::steady_clock::now() - Start)
+						  .count();
+			Wait_.Record(Us);
+			auto &Stats = ForCaller(Caller);
+			Stats.Wait.Record(Us);
+			if (Failed)
+				Stats.Exhausted++;
+		}
+	};
+
+} // namespace OpenWifi
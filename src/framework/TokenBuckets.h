@@ -0,0 +1,191 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace OpenWifi {
+
+	//	Token bucket per key. Buckets live in a fixed size table split in shards. Each bucket is a
+	//	key and a packed state updated with compare-and-swap, so a check never takes a lock. When
+	//	all the slots probed for a new key are taken, the bucket that was refilled the longest time
+	//	ago is recycled.
+	class TokenBuckets {
+	  public:
+		static constexpr std::uint64_t DefaultCapacity = 65536;
+		static constexpr std::uint64_t DefaultShards = 64;
+
+		TokenBuckets() { Resize(DefaultCapacity, DefaultShards); }
+
+		//	Not safe while checks are running.
+		inline void Resize(std::uint64_t Capacity, std::uint64_t Shards) {
+			Shards = std::clamp(Shards, (std::uint64_t)1, (std::uint64_t)1024);
+			Capacity = std::max(Capacity, Shards * MaxProbes);
+			auto NewTable = std::make_unique<BucketTable>();
+			NewTable->SlotsPerShard = (Capacity + Shards - 1) / Shards;
+			for (std::uint64_t i = 0; i < Shards; ++i)
+				NewTable->Shards.emplace_back(std::make_unique<Bucket[]>(NewTable->SlotsPerShard));
+			Table_ = std::move(NewTable);
+		}
+
+		//	Period is in milliseconds. A key may burst up to MaxCalls and is then refilled at
+		//	MaxCalls per Period.
+		inline bool IsRateLimited(std::uint64_t Key, int64_t Period, int64_t MaxCalls) {
+			return IsRateLimited(Key, Period, MaxCalls, NowMs());
+		}
+
+		//	Now in milliseconds, never 0.
+		inline bool IsRateLimited(std::uint64_t Key, int64_t Period, int64_t MaxCalls,
+								  std::uint64_t Now) {
+			Checks_++;
+			if (Period <= 0 || MaxCalls <= 0)
+				return false;
+			Key = std::clamp(Key, (std::uint64_t)1, ClaimedKey - 1);
+			auto &Slot = FindSlot(*Table_, Key);
+			auto Capacity = std::min((std::uint64_t)MaxCalls, TokenMask);
+			auto Current = Slot.State.load(std::memory_order_relaxed);
+			while (true) {
+				auto Stamp = Current >> TokenBits;
+				auto Tokens = Current & TokenMask;
+				if (Stamp == 0) {
+					//	new bucket, full minus this call.
+					Stamp = Now;
+					Tokens = Capacity;
+				} else if (Now > Stamp) {
+					auto Refill = ((Now - Stamp) * Capacity) / (std::uint64_t)Period;
+					if (Refill > 0) {
+						if (Tokens + Refill >= Capacity) {
+							Tokens = Capacity;
+							Stamp = Now;
+						} else {
+							Tokens += Refill;
+							//	only advance by the time that was converted into tokens.
+							Stamp += (Refill * (std::uint64_t)Period) / Capacity;
+						}
+					}
+				}
+				bool Limited = Tokens == 0;
+				if (!Limited)
+					Tokens--;
+				auto Next = (Stamp << TokenBits) | Tokens;
+				if (Slot.State.compare_exchange_weak(Current, Next, std::memory_order_acq_rel,
+													 std::memory_order_relaxed)) {
+					if (Limited)
+						Limited_++;
+					return Limited;
+				}
+			}
+		}
+
+		inline void Clear() {
+			for (auto &Shard : Table_->Shards) {
+				for (std::size_t i = 0; i < Table_->SlotsPerShard; ++i) {
+					Shard[i].Key.store(0);
+					Shard[i].State.store(0);
+				}
+			}
+		}
+
+		//	Never 0, so a stamp of 0 means an unused bucket.
+		inline std::uint64_t NowMs() const {
+			return 1 + std::chrono::duration_cast<std::chrono::milliseconds>(
+						   std::chrono::steady_clock::now() - Epoch_)
+						   .count();
+		}
+
+		[[nodiscard]] inline std::uint64_t Checks() const { return Checks_.load(); }
+		[[nodiscard]] inline std::uint64_t Limited() const { return Limited_.load(); }
+		[[nodiscard]] inline std::uint64_t Evictions() const { return Evictions_.load(); }
+		[[nodiscard]] inline std::uint64_t EvictionRaces() const { return EvictionRaces_.load(); }
+		[[nodiscard]] inline std::size_t Shards() const { return Table_->Shards.size(); }
+		[[nodiscard]] inline std::size_t Capacity() const {
+			return Table_->Shards.size() * Table_->SlotsPerShard;
+		}
+
+	  private:
+		static constexpr std::size_t MaxProbes = 8;
+		static constexpr std::size_t MaxEvictionAttempts = 4;
+		static constexpr std::uint64_t ClaimedKey = ~0ULL; //	a bucket being recycled
+		static constexpr std::uint64_t TokenBits = 20;
+		static constexpr std::uint64_t TokenMask = (1ULL << TokenBits) - 1;
+
+		struct alignas(16) Bucket {
+			std::atomic_uint64_t Key = 0;
+			std::atomic_uint64_t State = 0; //	refill time in ms << TokenBits | tokens
+		};
+
+		struct BucketTable {
+			std::size_t SlotsPerShard = 0;
+			std::vector<std::unique_ptr<Bucket[]>> Shards;
+		};
+
+		std::unique_ptr<BucketTable> Table_;
+		std::chrono::steady_clock::time_point Epoch_ = std::chrono::steady_clock::now();
+		std::atomic_uint64_t Checks_ = 0, Limited_ = 0, Evictions_ = 0, EvictionRaces_ = 0;
+
+		inline Bucket &FindSlot(BucketTable &Table, std::uint64_t Key) {
+			auto &Shard = Table.Shards[Key % Table.Shards.size()];
+			auto Mixed = Key * 0x9E3779B97F4A7C15ULL;
+			auto Start = (Mixed >> 17) % Table.SlotsPerShard;
+			Bucket *Oldest = nullptr;
+			for (std::size_t Attempt = 0; Attempt < MaxEvictionAttempts; ++Attempt) {
+				Oldest = nullptr;
+				bool Claimed = false;
+				std::uint64_t OldestKey = 0, OldestStamp = ~0ULL;
+				for (std::size_t Probe = 0; Probe < MaxProbes; ++Probe) {
+					auto &Slot = Shard[(Start + Probe) % Table.SlotsPerShard];
+					auto SlotKey = Slot.Key.load(std::memory_order_acquire);
+					if (SlotKey == Key)
+						return Slot;
+					if (SlotKey == 0) {
+						std::uint64_t Empty = 0;
+						if (Slot.Key.compare_exchange_strong(Empty, Key))
+							return Slot;
+						if (Empty == Key)
+							return Slot;
+						continue;
+					}
+					if (SlotKey == ClaimedKey) {
+						//	may be becoming ours, look again before recycling another one.
+						Claimed = true;
+						continue;
+					}
+					auto Stamp = Slot.State.load(std::memory_order_relaxed) >> TokenBits;
+					if (Stamp < OldestStamp) {
+						OldestStamp = Stamp;
+						OldestKey = SlotKey;
+						Oldest = &Slot;
+					}
+				}
+				if (Claimed || Oldest == nullptr) {
+					std::this_thread::yield();
+					continue;
+				}
+				//	Table is full around this key: recycle the least recently refilled bucket. It is
+				//	claimed first, so only one thread recycles it and nobody sees the new key with
+				//	the old state. A check still running for the old key may take one token from
+				//	the new bucket.
+				if (Oldest->Key.compare_exchange_strong(OldestKey, ClaimedKey,
+														std::memory_order_acq_rel)) {
+					Oldest->State.store(0, std::memory_order_relaxed);
+					Oldest->Key.store(Key, std::memory_order_release);
+					Evictions_++;
+					return *Oldest;
+				}
+			}
+			//	Lost every race: share a bucket rather than spin.
+			EvictionRaces_++;
+			return Oldest != nullptr ? *Oldest : Shard[Start];
+		}
+	};
+
+} // namespace OpenWifi
@@ -46,24 +46,43 @@ namespace OpenWifi {
 			*Client->WS_, Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ErrorNotification>(
 							  *this, &UI_WebSocketClientServer::OnSocketError));
 		Client->SocketRegistered_ = true;
+		Client->Batch_ = DefaultBatch_;
+		IndexUser(UserName, ClientSocket);
 		Clients_[ClientSocket] = std::move(Client);
 		UsersConnected_ = Clients_.size();
 	}
 
+	void UI_WebSocketClientServer::IndexUser(const std::string &UserName, int ClientSocket) {
+		Users_[UserName].insert(ClientSocket);
+	}
+
+	void UI_WebSocketClientServer::UnIndexUser(const std::string &UserName, int ClientSocket) {
+		auto User = Users_.find(UserName);
+		if (User == end(Users_))
+			return;
+		User->second.erase(ClientSocket);
+		if (User->second.empty())
+			Users_.erase(User);
+	}
+
 	void UI_WebSocketClientServer::SetProcessor(UI_WebSocketClientProcessor *F) { Processor_ = F; }
 
 	UI_WebSocketClientServer::UI_WebSocketClientServer() noexcept
 		: SubSystemServer("WebSocketClientServer", "UI-WSCLNT-SVR", "websocketclients") {}
 
+	//	Notifications are written and clients are erased only from this thread, so a client cannot
+	//	go away while its pending frames are being sent.
 	void UI_WebSocketClientServer::run() {
 		Running_ = true;
 		while (Running_) {
-			if(!Poco::Thread::trySleep(2000)) {
+			if(!Poco::Thread::trySleep((long)DispatchWindow_)) {
                 break;
             }
+			DispatchPending();
 			std::lock_guard G(LocalMutex_);
 			for (const auto i : ToBeRemoved_) {
 				// std::cout << "Erasing old WS UI connection..." << std::endl;
+				UnIndexUser(i->second->UserName_, i->first);
 				Clients_.erase(i);
 			}
 			ToBeRemoved_.clear();
@@ -71,6 +90,110 @@ namespace OpenWifi {
 		}
 	}
 
+	//	Notifications over the per type limit of a window, or pushed out of a full queue, are not
+	//	sent. The client is told with a {"notificationsDropped": {"total": n, "types": [...]}}
+	//	frame after the ones that were kept, and the counts are in the statistics.
+	void UI_WebSocketClientServer::DispatchPending() {
+		using PendingList = std::deque<std::pair<std::uint64_t, std::shared_ptr<const std::string>>>;
+		struct ClientWork {
+			UI_WebSocketClientInfo *Client = nullptr;
+			PendingList Pending;
+			std::uint64_t Overflowed = 0;
+		};
+		std::vector<ClientWork> Work;
+		{
+			std::lock_guard G(LocalMutex_);
+			for (auto &[Socket, Client] : Clients_) {
+				if ((!Client->Pending_.empty() || Client->Overflowed_ > 0) &&
+					Client->SocketRegistered_) {
+					Work.emplace_back();
+					Work.back().Client = Client.get();
+					std::swap(Work.back().Pending, Client->Pending_);
+					std::swap(Work.back().Overflowed, Client->Overflowed_);
+				}
+			}
+		}
+
+		for (auto &[Client, Pending, Overflowed] : Work) {
+			//	Per type rate limiting: only the first notifications of each type in a window are kept.
+			std::map<std::uint64_t, std::uint64_t> PerType, Limited;
+			std::vector<std::shared_ptr<const std::string>> Frames;
+			Frames.reserve(Pending.size() + 1);
+			for (const auto &[Id, Payload] : Pending) {
+				if (++PerType[Id] > MaxPerTypePerWindow_) {
+					Limited[Id]++;
+					continue;
+				}
+				Frames.push_back(Payload);
+			}
+
+			if (!Limited.empty() || Overflowed > 0) {
+				std::uint64_t Total = Overflowed;
+				Poco::JSON::Array Types;
+				{
+					std::lock_guard SG(StatsMutex_);
+					for (const auto &[Id, Count] : Limited) {
+						RateLimitedByType_[Id] += Count;
+						RateLimited_ += Count;
+						Total += Count;
+						Poco::JSON::Object Type;
+						Type.set("id", Id);
+						Type.set("count", Count);
+						Types.add(Type);
+					}
+				}
+				Poco::JSON::Object Dropped, Marker;
+				Dropped.set("total", Total);
+				Dropped.set("types", Types);
+				Marker.set("notificationsDropped", Dropped);
+				std::ostringstream OS;
+				Marker.stringify(OS);
+				Frames.push_back(std::make_shared<const std::string>(OS.str()));
+			}
+
+			std::lock_guard SG(Client->SendMutex_);
+			try {
+				if (Client->Batch_ && Frames.size() > 1) {
+					std::string Batch{"{\"notifications\":["};
+					for (std::size_t i = 0; i < Frames.size(); ++i) {
+						if (i)
+							Batch += ',';
+						Batch += *Frames[i];
+					}
+					Batch += "]}";
+					Client->WS_->sendFrame(Batch.c_str(), (int)Batch.size());
+					FramesSent_++;
+					Coalesced_ += Frames.size() - 1;
+				} else {
+					for (const auto &Frame : Frames) {
+						Client->WS_->sendFrame(Frame->c_str(), (int)Frame->size());
+						FramesSent_++;
+					}
+				}
+			} catch (...) {
+				Dropped_ += Frames.size();
+			}
+		}
+	}
+
+	void UI_WebSocketClientServer::GetStatistics(Poco::JSON::Object &Stats) {
+		Stats.set("clients", UsersConnected_.load());
+		Stats.set("queued", Queued_.load());
+		Stats.set("framesSent", FramesSent_.load());
+		Stats.set("coalesced", Coalesced_.load());
+		Stats.set("dropped", Dropped_.load());
+		Stats.set("rateLimited", RateLimited_.load());
+		Poco::JSON::Array ByType;
+		std::lock_guard G(StatsMutex_);
+		for (const auto &[Id, Count] : RateLimitedByType_) {
+			Poco::JSON::Object Type;
+			Type.set("id", Id);
+			Type.set("count", Count);
+			ByType.add(Type);
+		}
+		Stats.set("rateLimitedByType", ByType);
+	}
+
 	void UI_WebSocketClientServer::EndConnection(ClientList::iterator Client) {
 		if (Client->second->SocketRegistered_) {
 			Client->second->SocketRegistered_ = false;
@@ -86,14 +209,21 @@ namespace OpenWifi {
 				*Client->second->WS_,
 				Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ErrorNotification>(
 					*this, &UI_WebSocketClientServer::OnSocketError));
+			ToBeRemoved_.push_back(Client);
 		}
-		ToBeRemoved_.push_back(Client);
 	}
 
 	int UI_WebSocketClientServer::Start() {
 		poco_information(Logger(), "Starting...");
 		GoogleApiKey_ = MicroServiceConfigGetString("google.apikey", "");
 		GeoCodeEnabled_ = !GoogleApiKey_.empty();
+		DispatchWindow_ = std::max(
+			MicroServiceConfigGetInt("websocketclients.notifications.window", 250), (std::uint64_t)10);
+		MaxQueueSize_ = std::max(
+			MicroServiceConfigGetInt("websocketclients.notifications.queuesize", 1000), (std::uint64_t)1);
+		MaxPerTypePerWindow_ = std::max(
+			MicroServiceConfigGetInt("websocketclients.notifications.maxpertype", 100), (std::uint64_t)1);
+		DefaultBatch_ = MicroServiceConfigGetBool("websocketclients.notifications.batch", false);
 		ReactorThread_.start(Reactor_);
 		ReactorThread_.setName("ws:ui-reactor");
 		CleanerThread_.start(*this);
@@ -104,12 +234,14 @@ namespace OpenWifi {
 	void UI_WebSocketClientServer::Stop() {
 		if (Running_) {
 			poco_information(Logger(), "Stopping...");
-			Clients_.clear();
-			Reactor_.stop();
-			ReactorThread_.join();
 			Running_ = false;
 			CleanerThread_.wakeUp();
 			CleanerThread_.join();
+			Reactor_.stop();
+			ReactorThread_.join();
+			std::lock_guard G(LocalMutex_);
+			Clients_.clear();
+			Users_.clear();
 			poco_information(Logger(), "Stopped...");
 		}
 	};
@@ -119,35 +251,50 @@ namespace OpenWifi {
 		return std::find(Client.Filter_.begin(), Client.Filter_.end(), id) != end(Client.Filter_);
 	}
 
+	//	Bounded per client queue. When a console cannot keep up, its oldest notifications go first.
+	void UI_WebSocketClientServer::Enqueue(UI_WebSocketClientInfo &Client, std::uint64_t id,
+										   const std::shared_ptr<const std::string> &Payload) {
+		while (Client.Pending_.size() >= MaxQueueSize_) {
+			Client.Pending_.pop_front();
+			Client.Overflowed_++;
+			Dropped_++;
+		}
+		Client.Pending_.emplace_back(id, Payload);
+		Queued_++;
+	}
+
 	bool UI_WebSocketClientServer::SendToUser(const std::string &UserName, std::uint64_t id,
 											  const std::string &Payload) {
 		std::lock_guard G(LocalMutex_);
 
-		for (const auto &Client : Clients_) {
-			if (Client.second->UserName_ == UserName) {
-				try {
-					if (!IsFiltered(id, *Client.second) && Client.second->Authenticated_) {
-						return Client.second->WS_->sendFrame(
-								   Payload.c_str(), (int)Payload.size()) == (int)Payload.size();
-					} else {
-						return false;
-					}
-				} catch (...) {
-					return false;
-				}
-			}
+		auto User = Users_.find(UserName);
+		if (User == end(Users_))
+			return false;
+
+		bool Queued = false;
+		std::shared_ptr<const std::string> SharedPayload;
+		for (const auto ClientSocket : User->second) {
+			auto Client = Clients_.find(ClientSocket);
+			if (Client == end(Clients_) || !Client->second->Authenticated_ ||
+				IsFiltered(id, *Client->second))
+				continue;
+			if (!SharedPayload)
+				SharedPayload = std::make_shared<const std::string>(Payload);
+			Enqueue(*Client->second, id, SharedPayload);
+			Queued = true;
 		}
-		return false;
+		return Queued;
 	}
 
 	void UI_WebSocketClientServer::SendToAll(std::uint64_t id, const std::string &Payload) {
 		std::lock_guard G(LocalMutex_);
 
+		std::shared_ptr<const std::string> SharedPayload;
 		for (const auto &Client : Clients_) {
-			try {
-				if (!IsFiltered(id, *Client.second) && Client.second->Authenticated_)
-					Client.second->WS_->sendFrame(Payload.c_str(), (int)Payload.size());
-			} catch (...) {
+			if (!IsFiltered(id, *Client.second) && Client.second->Authenticated_) {
+				if (!SharedPayload)
+					SharedPayload = std::make_shared<const std::string>(Payload);
+				Enqueue(*Client.second, id, SharedPayload);
 			}
 		}
 	}
@@ -204,6 +351,7 @@ namespace OpenWifi {
 			if (Client == end(Clients_))
 				return;
 
+			std::lock_guard SG(Client->second->SendMutex_);
 			Poco::Buffer<char> IncomingFrame(0);
 			int flags;
 			int n;
@@ -233,6 +381,7 @@ namespace OpenWifi {
 			} break;
 			case Poco::Net::WebSocket::FRAME_OP_TEXT: {
 				constexpr const char *DropMessagesCommand = "drop-notifications";
+				constexpr const char *BatchMessagesCommand = "batch-notifications";
 				IncomingFrame.append(0);
 				if (!Client->second->Authenticated_) {
 					std::string Frame{IncomingFrame.begin()};
@@ -250,7 +399,9 @@ namespace OpenWifi {
 												   Expired, Contacted)) {
 #endif
 						Client->second->Authenticated_ = true;
+						UnIndexUser(Client->second->UserName_, Client->first);
 						Client->second->UserName_ = Client->second->UserInfo_.userinfo.email;
+						IndexUser(Client->second->UserName_, Client->first);
 						poco_debug(Logger(),
 								   fmt::format("START({}): {} UI Client is starting WS connection.",
 											   Client->second->Id_, Client->second->UserName_));
@@ -282,6 +433,11 @@ namespace OpenWifi {
 						return;
 					}
 
+					if (Obj->has(BatchMessagesCommand)) {
+						Client->second->Batch_ = Obj->getValue<bool>(BatchMessagesCommand);
+						return;
+					}
+
 					std::string Answer;
 					bool CloseConnection = false;
 					if (Processor_ != nullptr) {
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 
 #include "Poco/JSON/Object.h"
@@ -33,8 +36,12 @@ namespace OpenWifi {
 		std::string UserName_;
 		bool Authenticated_ = false;
 		bool SocketRegistered_ = false;
+		bool Batch_ = false;
 		std::vector<std::uint64_t> Filter_;
 		SecurityObjects::UserInfoAndPolicy UserInfo_;
+		std::mutex SendMutex_;
+		std::deque<std::pair<std::uint64_t, std::shared_ptr<const std::string>>> Pending_;
+		std::uint64_t Overflowed_ = 0; //	dropped from Pending_ since the last dispatch
 
 		UI_WebSocketClientInfo(Poco::Net::WebSocket &WS, const std::string &Id,
 							   const std::string &username) {
@@ -88,9 +95,13 @@ namespace OpenWifi {
 			SendToAll(Notification.type_id, OO.str());
 		}
 
+		//	Queues the notification for every authenticated connection of the user. True means it
+		//	was queued for at least one of them, not that it was delivered: frames are written at
+		//	the end of the dispatch window and may still be dropped, see DispatchPending.
 		[[nodiscard]] bool SendToUser(const std::string &userName, std::uint64_t id,
 									  const std::string &Payload);
 		void SendToAll(std::uint64_t id, const std::string &Payload);
+		void GetStatistics(Poco::JSON::Object &Stats) override;
 
 		struct NotificationEntry {
 			std::uint64_t id = 0;
@@ -117,10 +128,26 @@ namespace OpenWifi {
 		NotificationTypeIdVec NotificationTypes_;
 		Poco::JSON::Object NotificationTypesJSON_;
 		std::vector<ClientList::iterator> ToBeRemoved_;
+		std::map<std::string, std::set<int>> Users_; //	user name -> sockets
 		std::uint64_t TID_ = 0;
 
+		std::uint64_t DispatchWindow_ = 250;	//	milliseconds
+		std::uint64_t MaxQueueSize_ = 1000;
+		std::uint64_t MaxPerTypePerWindow_ = 100;
+		bool DefaultBatch_ = false;
+
+		std::atomic_uint64_t Queued_ = 0, FramesSent_ = 0, Coalesced_ = 0, Dropped_ = 0,
+							 RateLimited_ = 0;
+		std::mutex StatsMutex_;
+		std::map<std::uint64_t, std::uint64_t> RateLimitedByType_;
+
 		UI_WebSocketClientServer() noexcept;
 		void EndConnection(ClientList::iterator Client);
+		void Enqueue(UI_WebSocketClientInfo &Client, std::uint64_t id,
+					 const std::shared_ptr<const std::string> &Payload);
+		void DispatchPending();
+		void IndexUser(const std::string &UserName, int ClientSocket);
+		void UnIndexUser(const std::string &UserName, int ClientSocket);
 
 		void OnSocketReadable(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf);
 		void OnSocketShutdown(const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf);
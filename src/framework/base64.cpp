@@ -0,0 +1,372 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OWGW_BASE64_X86
+#endif
+
+#include "framework/utils.h"
+
+//	Base64 and compressed device payloads. The vector kernels follow W. Muła and D. Lemire,
+//	"Faster Base64 Encoding and Decoding using AVX2 Instructions" (2018): characters are
+//	validated and translated with nibble lookups, and packed with multiply-adds. Each one is
+//	compiled for its instruction set and picked at startup, so the binary still runs anywhere.
+
+namespace OpenWifi::Utils {
+
+	static constexpr char kEncodeLookup[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	static constexpr char kPadCharacter = '=';
+
+	//	6-bit value of each character, 0xff for anything else.
+	static constexpr auto kDecodeLookup = [] {
+		std::array<std::uint8_t, 256> T{};
+		for (auto &V : T)
+			V = 0xff;
+		for (std::uint8_t i = 0; i < 64; ++i)
+			T[(std::uint8_t)kEncodeLookup[i]] = i;
+		return T;
+	}();
+
+	enum class Base64Kernel { Scalar, SSSE3, AVX2 };
+
+	static Base64Kernel DetectBase64Kernel() {
+#ifdef OWGW_BASE64_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return Base64Kernel::AVX2;
+		if (__builtin_cpu_supports("ssse3"))
+			return Base64Kernel::SSSE3;
+#endif
+		return Base64Kernel::Scalar;
+	}
+
+	static const Base64Kernel BestKernel = DetectBase64Kernel();
+	static std::atomic<Base64Kernel> Kernel = BestKernel;
+
+	//	The kernels advance i (input) and o (output) over whole blocks and leave the rest to the
+	//	next one. Decoders stop at the first block with anything but the 64 characters.
+
+	static void EncodeScalar(const byte *In, std::size_t Size, char *Out, std::size_t &i,
+							 std::size_t &o) {
+		for (; i + 3 <= Size; i += 3, o += 4) {
+			std::uint32_t T = (In[i] << 16) | (In[i + 1] << 8) | In[i + 2];
+			Out[o] = kEncodeLookup[T >> 18];
+			Out[o + 1] = kEncodeLookup[(T >> 12) & 0x3f];
+			Out[o + 2] = kEncodeLookup[(T >> 6) & 0x3f];
+			Out[o + 3] = kEncodeLookup[T & 0x3f];
+		}
+	}
+
+	static bool DecodeScalar(const char *In, std::size_t Size, byte *Out, std::size_t &i,
+							 std::size_t &o) {
+		for (; i + 4 <= Size; i += 4, o += 3) {
+			std::uint32_t A = kDecodeLookup[(std::uint8_t)In[i]],
+						  B = kDecodeLookup[(std::uint8_t)In[i + 1]],
+						  C = kDecodeLookup[(std::uint8_t)In[i + 2]],
+						  D = kDecodeLookup[(std::uint8_t)In[i + 3]];
+			if ((A | B | C | D) & 0x80)
+				return false;
+			std::uint32_t T = (A << 18) | (B << 12) | (C << 6) | D;
+			Out[o] = (byte)(T >> 16);
+			Out[o + 1] = (byte)(T >> 8);
+			Out[o + 2] = (byte)T;
+		}
+		return true;
+	}
+
+#ifdef OWGW_BASE64_X86
+	//	12 bytes in, 16 characters out. Reads 16 bytes.
+	__attribute__((target("ssse3"))) static void EncodeSSSE3(const byte *In, std::size_t Size,
+															 char *Out, std::size_t &i,
+															 std::size_t &o) {
+		const __m128i Reshuffle =
+			_mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m128i Offsets =
+			_mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+		for (; i + 16 <= Size; i += 12, o += 16) {
+			__m128i V = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(In + i)), Reshuffle);
+			__m128i Hi = _mm_mulhi_epu16(_mm_and_si128(V, _mm_set1_epi32(0x0fc0fc00)),
+										 _mm_set1_epi32(0x04000040));
+			__m128i Lo = _mm_mullo_epi16(_mm_and_si128(V, _mm_set1_epi32(0x003f03f0)),
+										 _mm_set1_epi32(0x01000010));
+			__m128i Indices = _mm_or_si128(Hi, Lo);
+			__m128i Range = _mm_subs_epu8(Indices, _mm_set1_epi8(51));
+			Range = _mm_sub_epi8(Range, _mm_cmpgt_epi8(Indices, _mm_set1_epi8(25)));
+			_mm_storeu_si128((__m128i *)(Out + o),
+							 _mm_add_epi8(Indices, _mm_shuffle_epi8(Offsets, Range)));
+		}
+	}
+
+	//	24 bytes in, 32 characters out. Reads 28 bytes.
+	__attribute__((target("avx2"))) static void EncodeAVX2(const byte *In, std::size_t Size,
+														   char *Out, std::size_t &i,
+														   std::size_t &o) {
+		const __m256i Reshuffle =
+			_mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3,
+							 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m256i Offsets =
+			_mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0, 65,
+							 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+		for (; i + 32 <= Size; i += 24, o += 32) {
+			__m256i V = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(In + i))),
+				_mm_loadu_si128((const __m128i *)(In + i + 12)), 1);
+			V = _mm256_shuffle_epi8(V, Reshuffle);
+			__m256i Hi = _mm256_mulhi_epu16(_mm256_and_si256(V, _mm256_set1_epi32(0x0fc0fc00)),
+											_mm256_set1_epi32(0x04000040));
+			__m256i Lo = _mm256_mullo_epi16(_mm256_and_si256(V, _mm256_set1_epi32(0x003f03f0)),
+											_mm256_set1_epi32(0x01000010));
+			__m256i Indices = _mm256_or_si256(Hi, Lo);
+			__m256i Range = _mm256_subs_epu8(Indices, _mm256_set1_epi8(51));
+			Range = _mm256_sub_epi8(Range, _mm256_cmpgt_epi8(Indices, _mm256_set1_epi8(25)));
+			_mm256_storeu_si256((__m256i *)(Out + o),
+								_mm256_add_epi8(Indices, _mm256_shuffle_epi8(Offsets, Range)));
+		}
+	}
+
+	//	16 characters in, 12 bytes out. Writes 16 bytes, so it stops while more input follows.
+	__attribute__((target("ssse3"))) static void DecodeSSSE3(const char *In, std::size_t Size,
+															 byte *Out, std::size_t &i,
+															 std::size_t &o) {
+		const __m128i LutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+											0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+		const __m128i LutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+											0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m128i LutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0,
+											  0, 0);
+		const __m128i Pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		const __m128i Mask2F = _mm_set1_epi8(0x2f);
+		for (; i + 24 <= Size; i += 16, o += 12) {
+			__m128i V = _mm_loadu_si128((const __m128i *)(In + i));
+			__m128i HiNibbles = _mm_and_si128(_mm_srli_epi32(V, 4), Mask2F);
+			__m128i Lo = _mm_shuffle_epi8(LutLo, _mm_and_si128(V, Mask2F));
+			__m128i Hi = _mm_shuffle_epi8(LutHi, HiNibbles);
+			if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(Lo, Hi), _mm_setzero_si128())))
+				return;
+			__m128i Roll = _mm_shuffle_epi8(
+				LutRoll, _mm_add_epi8(_mm_cmpeq_epi8(V, Mask2F), HiNibbles));
+			V = _mm_add_epi8(V, Roll);
+			V = _mm_madd_epi16(_mm_maddubs_epi16(V, _mm_set1_epi32(0x01400140)),
+							   _mm_set1_epi32(0x00011000));
+			_mm_storeu_si128((__m128i *)(Out + o), _mm_shuffle_epi8(V, Pack));
+		}
+	}
+
+	//	32 characters in, 24 bytes out. Writes 32 bytes, so it stops while more input follows.
+	__attribute__((target("avx2"))) static void DecodeAVX2(const char *In, std::size_t Size,
+														   byte *Out, std::size_t &i,
+														   std::size_t &o) {
+		const __m256i LutLo = _mm256_setr_epi8(
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b,
+			0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+			0x1b, 0x1b, 0x1b, 0x1a);
+		const __m256i LutHi = _mm256_setr_epi8(
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+			0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+			0x10, 0x10, 0x10, 0x10);
+		const __m256i LutRoll =
+			_mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19,
+							 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m256i Pack =
+			_mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6,
+							 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		const __m256i Mask2F = _mm256_set1_epi8(0x2f);
+		for (; i + 44 <= Size; i += 32, o += 24) {
+			__m256i V = _mm256_loadu_si256((const __m256i *)(In + i));
+			__m256i HiNibbles = _mm256_and_si256(_mm256_srli_epi32(V, 4), Mask2F);
+			__m256i Lo = _mm256_shuffle_epi8(LutLo, _mm256_and_si256(V, Mask2F));
+			__m256i Hi = _mm256_shuffle_epi8(LutHi, HiNibbles);
+			if (!_mm256_testz_si256(Lo, Hi))
+				return;
+			__m256i Roll = _mm256_shuffle_epi8(
+				LutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(V, Mask2F), HiNibbles));
+			V = _mm256_add_epi8(V, Roll);
+			V = _mm256_madd_epi16(_mm256_maddubs_epi16(V, _mm256_set1_epi32(0x01400140)),
+								  _mm256_set1_epi32(0x00011000));
+			V = _mm256_shuffle_epi8(V, Pack);
+			V = _mm256_permutevar8x32_epi32(V, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+			_mm256_storeu_si256((__m256i *)(Out + o), V);
+		}
+	}
+#endif
+
+	std::size_t base64encode(const byte *input, std::size_t size, char *output) {
+		std::size_t i = 0, o = 0;
+#ifdef OWGW_BASE64_X86
+		auto K = Kernel.load(std::memory_order_relaxed);
+		if (K == Base64Kernel::AVX2)
+			EncodeAVX2(input, size, output, i, o);
+		if (K != Base64Kernel::Scalar)
+			EncodeSSSE3(input, size, output, i, o);
+#endif
+		EncodeScalar(input, size, output, i, o);
+
+		switch (size - i) {
+		case 1:
+			output[o++] = kEncodeLookup[input[i] >> 2];
+			output[o++] = kEncodeLookup[(input[i] & 0x03) << 4];
+			output[o++] = kPadCharacter;
+			output[o++] = kPadCharacter;
+			break;
+		case 2:
+			output[o++] = kEncodeLookup[input[i] >> 2];
+			output[o++] = kEncodeLookup[((input[i] & 0x03) << 4) | (input[i + 1] >> 4)];
+			output[o++] = kEncodeLookup[(input[i + 1] & 0x0f) << 2];
+			output[o++] = kPadCharacter;
+			break;
+		}
+		return o;
+	}
+
+	bool base64decode(const char *input, std::size_t size, byte *output, std::size_t &decoded) {
+		decoded = 0;
+		if (size % 4)
+			return false;
+		if (size == 0)
+			return true;
+
+		//	the last group may be padded, it is done on its own.
+		auto Body = size - 4;
+		std::size_t i = 0, o = 0;
+#ifdef OWGW_BASE64_X86
+		auto K = Kernel.load(std::memory_order_relaxed);
+		if (K == Base64Kernel::AVX2)
+			DecodeAVX2(input, Body, output, i, o);
+		if (K != Base64Kernel::Scalar)
+			DecodeSSSE3(input, Body, output, i, o);
+#endif
+		if (!DecodeScalar(input, Body, output, i, o))
+			return false;
+
+		if (input[size - 1] != kPadCharacter) {
+			if (!DecodeScalar(input, size, output, i, o))
+				return false;
+		} else {
+			std::uint32_t A = kDecodeLookup[(std::uint8_t)input[i]],
+						  B = kDecodeLookup[(std::uint8_t)input[i + 1]];
+			if ((A | B) & 0x80)
+				return false;
+			output[o++] = (byte)((A << 2) | (B >> 4));
+			if (input[size - 2] != kPadCharacter) {
+				std::uint32_t C = kDecodeLookup[(std::uint8_t)input[i + 2]];
+				if (C & 0x80)
+					return false;
+				output[o++] = (byte)((B << 4) | (C >> 2));
+			}
+		}
+		decoded = o;
+		return true;
+	}
+
+	[[nodiscard]] std::string base64encode(const byte *input, uint32_t size) {
+		std::string encoded(base64encodedsize(size), '\0');
+		base64encode(input, size, encoded.data());
+		return encoded;
+	}
+
+	[[nodiscard]] std::vector<byte> base64decode(const std::string &input) {
+		std::vector<byte> decoded(base64decodedsize(input.size()));
+		std::size_t Size = 0;
+		if (!base64decode(input.data(), input.size(), decoded.data(), Size))
+			throw std::runtime_error("Invalid base64!");
+		decoded.resize(Size);
+		return decoded;
+	}
+
+	bool base64decode(const std::string &input, std::string &output) {
+		output.resize(base64decodedsize(input.size()));
+		std::size_t Size = 0;
+		if (!base64decode(input.data(), input.size(), (byte *)output.data(), Size)) {
+			std::string Stripped;
+			Stripped.reserve(input.size());
+			std::copy_if(input.begin(), input.end(), std::back_inserter(Stripped), [](char c) {
+				return c != ' ' && c != '\t' && c != '\r' && c != '\n';
+			});
+			if (Stripped.size() == input.size() ||
+				!base64decode(Stripped.data(), Stripped.size(), (byte *)output.data(), Size)) {
+				output.clear();
+				return false;
+			}
+		}
+		output.resize(Size);
+		return true;
+	}
+
+	const char *base64implementation() {
+		switch (Kernel.load()) {
+		case Base64Kernel::AVX2:
+			return "avx2";
+		case Base64Kernel::SSSE3:
+			return "ssse3";
+		default:
+			return "scalar";
+		}
+	}
+
+	bool base64implementation(const std::string &Name) {
+		Base64Kernel K;
+		if (Name == "avx2")
+			K = Base64Kernel::AVX2;
+		else if (Name == "ssse3")
+			K = Base64Kernel::SSSE3;
+		else if (Name == "scalar")
+			K = Base64Kernel::Scalar;
+		else
+			return false;
+		if (K > BestKernel)
+			return false;
+		Kernel = K;
+		return true;
+	}
+
+	bool ExtractBase64CompressedData(const std::string &CompressedData,
+									 std::string &UnCompressedData, uint64_t compress_sz) {
+		std::string Compressed;
+		if (!base64decode(CompressedData, Compressed) || Compressed.empty())
+			return false;
+
+		//	deflate never expands more than 1032:1, so a larger compress_sz cannot be right.
+		std::size_t MaxSize = Compressed.size() * 1032 + 64;
+		std::size_t Size = compress_sz ? std::min((std::size_t)compress_sz, MaxSize)
+									   : std::min(Compressed.size() * 8, MaxSize);
+		z_stream Z{};
+		if (inflateInit(&Z) != Z_OK)
+			return false;
+		Z.next_in = (Bytef *)Compressed.data();
+		Z.avail_in = (uInt)Compressed.size();
+
+		//	one pass over the input: the buffer only grows when compress_sz was missing or wrong.
+		UnCompressedData.resize(std::max(Size, (std::size_t)1));
+		std::size_t Produced = 0;
+		while (true) {
+			Z.next_out = (Bytef *)UnCompressedData.data() + Produced;
+			Z.avail_out = (uInt)(UnCompressedData.size() - Produced);
+			auto Status = inflate(&Z, Z_FINISH);
+			Produced = UnCompressedData.size() - Z.avail_out;
+			if (Status == Z_STREAM_END)
+				break;
+			if ((Status == Z_OK || Status == Z_BUF_ERROR) && Z.avail_out == 0 &&
+				UnCompressedData.size() < MaxSize) {
+				UnCompressedData.resize(std::min(UnCompressedData.size() * 2, MaxSize));
+				continue;
+			}
+			inflateEnd(&Z);
+			UnCompressedData.clear();
+			return false;
+		}
+		inflateEnd(&Z);
+		//	as before, the text ends at the first NUL, some devices compress the terminator.
+		UnCompressedData.resize(strnlen(UnCompressedData.data(), Produced));
+		return true;
+	}
+
+} // namespace OpenWifi::Utils
@@ -432,6 +432,7 @@ namespace OpenWifi::RESTAPI::Errors {
     static const struct msg InvalidRadiusServer { 1191, "Invalid Radius Server." };
 
 	static const struct msg InvalidRRMAction { 1192, "Invalid RRM Action." };
+	static const struct msg InvalidCursor { 1193, "Invalid or expired cursor." };
 
     static const struct msg SimulationDoesNotExist {
         7000, "Simulation Instance ID does not exist."
@@ -467,6 +468,8 @@ namespace OpenWifi::RESTAPI::Protocol {
 	static const char *ENDDATE = "endDate";
 	static const char *OFFSET = "offset";
 	static const char *LIMIT = "limit";
+	static const char *CURSOR = "cursor";
+	static const char *NEXTCURSOR = "nextCursor";
 	static const char *LIFETIME = "lifetime";
 	static const char *UUID = "UUID";
 	static const char *DATA = "data";
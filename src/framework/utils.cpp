@@ -164,107 +164,6 @@ namespace OpenWifi::Utils {
 		return R;
 	}
 
-	inline static const char kEncodeLookup[] =
-		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-	inline static const char kPadCharacter = '=';
-
-	using byte = std::uint8_t;
-
-	[[nodiscard]] std::string base64encode(const byte *input, uint32_t size) {
-		std::string encoded;
-		encoded.reserve(((size / 3) + (size % 3 > 0)) * 4);
-
-		std::uint32_t temp, i, ee;
-		ee = (size / 3);
-
-		for (i = 0; i < 3 * ee; ++i) {
-			temp = input[i++] << 16;
-			temp += input[i++] << 8;
-			temp += input[i];
-			encoded.append(1, kEncodeLookup[(temp & 0x00FC0000) >> 18]);
-			encoded.append(1, kEncodeLookup[(temp & 0x0003F000) >> 12]);
-			encoded.append(1, kEncodeLookup[(temp & 0x00000FC0) >> 6]);
-			encoded.append(1, kEncodeLookup[(temp & 0x0000003F)]);
-		}
-
-		switch (size % 3) {
-		case 1:
-			temp = input[i] << 16;
-			encoded.append(1, kEncodeLookup[(temp & 0x00FC0000) >> 18]);
-			encoded.append(1, kEncodeLookup[(temp & 0x0003F000) >> 12]);
-			encoded.append(2, kPadCharacter);
-			break;
-		case 2:
-			temp = input[i++] << 16;
-			temp += input[i] << 8;
-			encoded.append(1, kEncodeLookup[(temp & 0x00FC0000) >> 18]);
-			encoded.append(1, kEncodeLookup[(temp & 0x0003F000) >> 12]);
-			encoded.append(1, kEncodeLookup[(temp & 0x00000FC0) >> 6]);
-			encoded.append(1, kPadCharacter);
-			break;
-		}
-
-		return encoded;
-	}
-
-	[[nodiscard]] std::vector<byte> base64decode(const std::string &input) {
-		if (input.length() % 4)
-			throw std::runtime_error("Invalid base64 length!");
-
-		std::size_t padding = 0;
-
-		if (input.length()) {
-			if (input[input.length() - 1] == kPadCharacter)
-				padding++;
-			if (input[input.length() - 2] == kPadCharacter)
-				padding++;
-		}
-
-		std::vector<byte> decoded;
-		decoded.reserve(((input.length() / 4) * 3) - padding);
-
-		std::uint32_t temp = 0;
-		auto it = input.begin();
-
-		while (it < input.end()) {
-			for (std::size_t i = 0; i < 4; ++i) {
-				temp <<= 6;
-				if (*it >= 0x41 && *it <= 0x5A)
-					temp |= *it - 0x41;
-				else if (*it >= 0x61 && *it <= 0x7A)
-					temp |= *it - 0x47;
-				else if (*it >= 0x30 && *it <= 0x39)
-					temp |= *it + 0x04;
-				else if (*it == 0x2B)
-					temp |= 0x3E;
-				else if (*it == 0x2F)
-					temp |= 0x3F;
-				else if (*it == kPadCharacter) {
-					switch (input.end() - it) {
-					case 1:
-						decoded.push_back((temp >> 16) & 0x000000FF);
-						decoded.push_back((temp >> 8) & 0x000000FF);
-						return decoded;
-					case 2:
-						decoded.push_back((temp >> 10) & 0x000000FF);
-						return decoded;
-					default:
-						throw std::runtime_error("Invalid padding in base64!");
-					}
-				} else
-					throw std::runtime_error("Invalid character in base64!");
-
-				++it;
-			}
-
-			decoded.push_back((temp >> 16) & 0x000000FF);
-			decoded.push_back((temp >> 8) & 0x000000FF);
-			decoded.push_back((temp)&0x000000FF);
-		}
-
-		return decoded;
-	}
-
 	bool ParseTime(const std::string &Time, int &Hours, int &Minutes, int &Seconds) {
 		Poco::StringTokenizer TimeTokens(Time, ":", Poco::StringTokenizer::TOK_TRIM);
 
@@ -556,36 +455,30 @@ namespace OpenWifi::Utils {
 		return false;
 	}
 
-	bool ExtractBase64CompressedData(const std::string &CompressedData,
-									 std::string &UnCompressedData, uint64_t compress_sz) {
-		std::istringstream ifs(CompressedData);
-		Poco::Base64Decoder b64in(ifs);
-		std::ostringstream ofs;
-		Poco::StreamCopier::copyStream(b64in, ofs);
-
-		int factor = 20;
-		unsigned long MaxSize = compress_sz ? (unsigned long)(compress_sz + 5000)
-											: (unsigned long)(ofs.str().size() * factor);
-		while (true) {
-			std::vector<uint8_t> UncompressedBuffer(MaxSize);
-			unsigned long FinalSize = MaxSize;
-			auto status = uncompress((uint8_t *)&UncompressedBuffer[0], &FinalSize,
-									 (uint8_t *)ofs.str().c_str(), ofs.str().size());
-			if (status == Z_OK) {
-				UncompressedBuffer[FinalSize] = 0;
-				UnCompressedData = (char *)&UncompressedBuffer[0];
-				return true;
-			}
-			if (status == Z_BUF_ERROR) {
-				if (factor < 300) {
-					factor += 10;
-					MaxSize = ofs.str().size() * factor;
-					continue;
-				} else {
-					return false;
-				}
+	//	Copies the body straight to os, nothing is kept in memory or on disk. Only a 200 counts.
+	[[nodiscard]] bool wgetstream(const Poco::URI &uri, std::ostream &os) {
+		try {
+			std::unique_ptr<Poco::Net::HTTPClientSession> session;
+			if (uri.getScheme() == "http") {
+				session = std::make_unique<Poco::Net::HTTPClientSession>(uri.getHost(), uri.getPort());
+			} else {
+				session = std::make_unique<Poco::Net::HTTPSClientSession>(uri.getHost(), uri.getPort());
 			}
-			return false;
+
+			Poco::Net::HTTPRequest req(Poco::Net::HTTPRequest::HTTP_GET, uri.getPathAndQuery(),
+									   Poco::Net::HTTPMessage::HTTP_1_1);
+			session->sendRequest(req);
+
+			Poco::Net::HTTPResponse res;
+			std::istream &is = session->receiveResponse(res);
+			if (res.getStatus() != Poco::Net::HTTPResponse::HTTP_OK)
+				return false;
+			auto Copied = Poco::StreamCopier::copyStream(is, os);
+			//	a connection that drops early must not look like a complete file.
+			if (res.hasContentLength() && (std::int64_t)Copied != res.getContentLength64())
+				return false;
+			return os.good();
+		} catch (...) {
 		}
 		return false;
 	}
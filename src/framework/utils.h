@@ -99,6 +99,18 @@ namespace OpenWifi::Utils {
 
 	[[nodiscard]] std::string base64encode(const byte *input, uint32_t size);
 	[[nodiscard]] std::vector<byte> base64decode(const std::string &input);
+	//	Buffer versions, vectorised when the CPU allows it. The output must hold
+	//	base64encodedsize(size) or base64decodedsize(size) bytes.
+	constexpr std::size_t base64encodedsize(std::size_t size) { return (size + 2) / 3 * 4; }
+	constexpr std::size_t base64decodedsize(std::size_t size) { return size / 4 * 3; }
+	std::size_t base64encode(const byte *input, std::size_t size, char *output);
+	[[nodiscard]] bool base64decode(const char *input, std::size_t size, byte *output,
+									std::size_t &decoded);
+	//	Skips spaces and line breaks like Poco::Base64Decoder, false when the input is invalid.
+	[[nodiscard]] bool base64decode(const std::string &input, std::string &output);
+	//	"avx2", "ssse3" or "scalar". Setting it is for benchmarks, false if the CPU cannot.
+	[[nodiscard]] const char *base64implementation();
+	bool base64implementation(const std::string &Name);
 	;
 	bool ParseTime(const std::string &Time, int &Hours, int &Minutes, int &Seconds);
 	bool ParseDate(const std::string &Time, int &Year, int &Month, int &Day);
@@ -120,6 +132,7 @@ namespace OpenWifi::Utils {
 	[[nodiscard]] std::string SecondsToNiceText(uint64_t Seconds);
 	[[nodiscard]] bool wgets(const std::string &URL, std::string &Response);
 	[[nodiscard]] bool wgetfile(const Poco::URI &uri, const std::string &FileName);
+	[[nodiscard]] bool wgetstream(const Poco::URI &uri, std::ostream &os);
 	[[nodiscard]] bool IsAlphaNumeric(const std::string &s);
 	[[nodiscard]] std::string SanitizeToken(const std::string &Token);
 	[[nodiscard]] bool ValidateURI(const std::string &uri);
@@ -0,0 +1,45 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Linked into owgw_replay only: counts every operator new, in the process and per thread, for
+//	the replay report. The sized and array forms all end up here.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+static std::atomic_uint64_t Allocations{0};
+static thread_local std::uint64_t ThreadAllocations = 0;
+
+extern "C" std::uint64_t owgw_replay_allocations() { return Allocations.load(); }
+extern "C" std::uint64_t owgw_replay_thread_allocations() { return ThreadAllocations; }
+
+void *operator new(std::size_t Size) {
+	Allocations.fetch_add(1, std::memory_order_relaxed);
+	++ThreadAllocations;
+	if (auto P = std::malloc(Size ? Size : 1))
+		return P;
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t Size) { return operator new(Size); }
+
+void *operator new(std::size_t Size, const std::nothrow_t &) noexcept {
+	try {
+		return operator new(Size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void *operator new[](std::size_t Size, const std::nothrow_t &) noexcept {
+	return operator new(Size, std::nothrow);
+}
+
+void operator delete(void *P) noexcept { std::free(P); }
+void operator delete[](void *P) noexcept { std::free(P); }
+void operator delete(void *P, std::size_t) noexcept { std::free(P); }
+void operator delete[](void *P, std::size_t) noexcept { std::free(P); }
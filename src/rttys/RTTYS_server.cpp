@@ -8,6 +8,7 @@
 #include "AP_WS_Server.h"
 
 #include "fmt/format.h"
+#include "framework/MetricsRegistry.h"
 #include "framework/MicroServiceFuncs.h"
 
 #include "Poco/Net/SecureStreamSocketImpl.h"
@@ -36,6 +37,21 @@
 
 namespace OpenWifi {
 
+	static auto &DeviceAccepts = MetricsRegistry()->Counter(
+		"owgw_rtty_device_connections_total", "Secure device connections accepted by the RTTY server.");
+	static auto &ClientBytes = MetricsRegistry()->Counter(
+		"owgw_rtty_client_sent_bytes_total", "Terminal bytes sent to RTTY clients.");
+	static auto &KeystrokeBytes = MetricsRegistry()->Counter(
+		"owgw_rtty_keystroke_bytes_total", "Keystroke bytes sent to devices.");
+	static MetricGauge &RTTYGauge(const char *Kind) {
+		return MetricsRegistry()->Gauge("owgw_rtty_sessions", "Open RTTY endpoints and sockets.",
+										{{"kind", Kind}});
+	}
+	static auto &EndPointsGauge = RTTYGauge("endpoints");
+	static auto &ConnectedGauge = RTTYGauge("connected");
+	static auto &SocketsGauge = RTTYGauge("sockets");
+	static auto &ClientsGauge = RTTYGauge("clients");
+
 	int RTTYS_server::Start() {
 
 		poco_information(Logger(),"Starting...");
@@ -198,6 +214,7 @@ namespace OpenWifi {
 			Poco::Net::SocketAddress Client;
 			Poco::Net::StreamSocket NewSocket(pNf->socket().impl()->acceptConnection(Client));
 			if (NewSocket.secure()) {
+				DeviceAccepts.Inc();
 				auto SS = dynamic_cast<Poco::Net::SecureStreamSocketImpl *>(NewSocket.impl());
 				auto PeerAddress_ = SS->peerAddress().host();
 				auto CId_ = Utils::FormatIPv6(SS->peerAddress().toString());
@@ -684,6 +701,7 @@ namespace OpenWifi {
 				Connection->WSSocket_->sendFrame(Buf, len,
 												 Poco::Net::WebSocket::FRAME_FLAG_FIN |
 													 Poco::Net::WebSocket::FRAME_OP_BINARY);
+				ClientBytes.Inc(len);
 				return;
 			} catch (...) {
 				poco_error(Logger(), "SendData shutdown.");
@@ -696,6 +714,7 @@ namespace OpenWifi {
 		if (Connection->WSSocket_ != nullptr && Connection->WSSocket_->impl()!= nullptr) {
 			try {
 				Connection->WSSocket_->sendFrame(s.c_str(), s.length());
+				ClientBytes.Inc(s.length());
 				return;
 			} catch (...) {
 				poco_error(Logger(), "SendData shutdown.");
@@ -773,6 +792,10 @@ namespace OpenWifi {
 		poco_information(Logger(),fmt::format("EndPoints:{} Connected:{} Sockets:{} Clients:{}",
 											   EndPoints_.size(),Connected_.size(),
 											   Sockets_.size(), Clients_.size()));
+		EndPointsGauge.Set((std::int64_t)EndPoints_.size());
+		ConnectedGauge.Set((std::int64_t)Connected_.size());
+		SocketsGauge.Set((std::int64_t)Sockets_.size());
+		ClientsGauge.Set((std::int64_t)Clients_.size());
 
 		if (Utils::Now() - LastStats > (60 * 1)) {
 			LastStats = Utils::Now();
@@ -858,6 +881,7 @@ namespace OpenWifi {
 	}
 
 	bool RTTYS_server::KeyStrokes(std::shared_ptr<RTTYS_EndPoint> Conn, const u_char *buf, size_t len) {
+		KeystrokeBytes.Inc(len);
 
 		if (len <= (sizeof(Conn->small_buf_) - RTTY_HDR_SIZE - 1)) {
 			Conn->small_buf_[0] = RTTYS_EndPoint::msgTypeTermData;
@@ -0,0 +1,276 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <ctime>
+#include <random>
+
+#include "Poco/JSON/Parser.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/NumberParser.h"
+
+#include "fmt/format.h"
+
+#include "simulator/SimDevice.h"
+
+namespace OpenWifi::Simulator {
+
+	static std::uint64_t Micros(Clock::duration D) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(D).count();
+	}
+
+	//	Spreads the first message of each kind over its interval so devices that connected
+	//	together do not report together.
+	static Clock::time_point FirstDue(Clock::time_point Now, std::uint64_t Interval) {
+		if (Interval == 0)
+			return Clock::time_point::max();
+		thread_local std::mt19937_64 Random{std::random_device{}()};
+		std::uniform_int_distribution<std::uint64_t> Spread(0, Interval * 1000);
+		return Now + std::chrono::milliseconds(Spread(Random));
+	}
+
+	static Clock::time_point NextDue(Clock::time_point Due, std::uint64_t Interval) {
+		return Due + std::chrono::seconds(Interval);
+	}
+
+	bool SimDevice::Connect(Poco::Net::Context::Ptr Context) {
+		auto Start = Clock::now();
+		Poco::Net::HTTPResponse Response;
+		try {
+			Session_ =
+				std::make_unique<Poco::Net::HTTPSClientSession>(Config_.Host, Config_.Port, Context);
+			Poco::Net::HTTPRequest Request(Poco::Net::HTTPRequest::HTTP_GET, "/",
+										   Poco::Net::HTTPMessage::HTTP_1_1);
+			WS_ = std::make_unique<Poco::Net::WebSocket>(*Session_, Request, Response);
+			WS_->setReceiveTimeout(Poco::Timespan(5, 0));
+			WS_->setNoDelay(true);
+			ConnectLatency_.Add(Micros(Clock::now() - Start));
+			Started_ = std::time(nullptr);
+			ProbeOutstanding_ = false;
+			if (!SendConnect()) {
+				Disconnect();
+				return false;
+			}
+			Counters_.Connects++;
+			Schedule(Clock::now());
+			return true;
+		} catch (const Poco::Exception &) {
+		} catch (const std::exception &) {
+		}
+		WS_.reset();
+		Session_.reset();
+		auto Delay = Config_.ReconnectDelay;
+		//	a gateway shedding load answers the upgrade with a 503: come back when it says.
+		if (Response.getStatus() == Poco::Net::HTTPResponse::HTTP_SERVICE_UNAVAILABLE) {
+			Counters_.Shed++;
+			Poco::UInt64 RetryAfter = 0;
+			if (Poco::NumberParser::tryParseUnsigned64(Response.get("Retry-After", ""), RetryAfter))
+				Delay = RetryAfter;
+		} else {
+			Counters_.ConnectFailures++;
+		}
+		ReconnectAt_ = Clock::now() + std::chrono::seconds(Delay);
+		return false;
+	}
+
+	void SimDevice::Disconnect() {
+		try {
+			if (WS_)
+				WS_->close();
+		} catch (...) {
+		}
+		WS_.reset();
+		Session_.reset();
+		ReconnectAt_ = Clock::now() + std::chrono::seconds(Config_.ReconnectDelay);
+	}
+
+	void SimDevice::Schedule(Clock::time_point Now) {
+		NextState_ = FirstDue(Now, Config_.StateInterval);
+		NextHealthcheck_ = FirstDue(Now, Config_.HealthcheckInterval);
+		NextPing_ = FirstDue(Now, Config_.PingInterval);
+		NextLog_ = FirstDue(Now, Config_.LogInterval);
+		NextProbe_ = FirstDue(Now, Config_.ProbeInterval);
+	}
+
+	bool SimDevice::Tick(Clock::time_point Now) {
+		if (Now >= NextState_) {
+			NextState_ = NextDue(NextState_, Config_.StateInterval);
+			if (!SendState())
+				return false;
+		}
+		if (Now >= NextHealthcheck_) {
+			NextHealthcheck_ = NextDue(NextHealthcheck_, Config_.HealthcheckInterval);
+			if (!SendHealthcheck())
+				return false;
+		}
+		if (Now >= NextPing_) {
+			NextPing_ = NextDue(NextPing_, Config_.PingInterval);
+			if (!SendPing())
+				return false;
+		}
+		if (Now >= NextLog_) {
+			NextLog_ = NextDue(NextLog_, Config_.LogInterval);
+			if (!SendLog())
+				return false;
+		}
+		if (Now >= NextProbe_) {
+			NextProbe_ = NextDue(NextProbe_, Config_.ProbeInterval);
+			//	a probe that never came back is not counted, the gateway dropped it.
+			if (!SendProbe(Now))
+				return false;
+		}
+		return true;
+	}
+
+	bool SimDevice::OnReadable(Clock::time_point Now) {
+		try {
+			do {
+				Poco::Buffer<char> Frame(0);
+				int Flags = 0;
+				auto Size = WS_->receiveFrame(Frame, Flags);
+				if (Size == 0 && Flags == 0)
+					return false;
+				Counters_.FramesReceived++;
+				Counters_.BytesReceived += Size;
+				switch (Flags & Poco::Net::WebSocket::FRAME_OP_BITMASK) {
+				case Poco::Net::WebSocket::FRAME_OP_PING: {
+					WS_->sendFrame(Frame.begin(), Size,
+								   (int)Poco::Net::WebSocket::FRAME_OP_PONG |
+									   (int)Poco::Net::WebSocket::FRAME_FLAG_FIN);
+				} break;
+
+				case Poco::Net::WebSocket::FRAME_OP_PONG: {
+					if (ProbeOutstanding_) {
+						ProbeLatency_.Add(Micros(Now - ProbeSent_));
+						ProbeOutstanding_ = false;
+					}
+				} break;
+
+				case Poco::Net::WebSocket::FRAME_OP_TEXT: {
+					Frame.append(0);
+					Poco::JSON::Parser Parser;
+					auto Message =
+						Parser.parse(Frame.begin()).extract<Poco::JSON::Object::Ptr>();
+					if (Message->has("method") && Message->has("id") && !AnswerCommand(Message))
+						return false;
+				} break;
+
+				case Poco::Net::WebSocket::FRAME_OP_CLOSE:
+					return false;
+
+				default:
+					break;
+				}
+			} while (WS_->available() > 0);
+			return true;
+		} catch (const Poco::Exception &) {
+		} catch (const std::exception &) {
+		}
+		return false;
+	}
+
+	bool SimDevice::SendText(const std::string &Text) {
+		try {
+			auto Sent = WS_->sendFrame(Text.c_str(), (int)Text.size());
+			if (Sent == (int)Text.size()) {
+				Counters_.FramesSent++;
+				Counters_.BytesSent += Sent;
+				return true;
+			}
+		} catch (const Poco::Exception &) {
+		}
+		Counters_.SendFailures++;
+		return false;
+	}
+
+	bool SimDevice::SendConnect() {
+		return SendText(fmt::format(
+			R"lit({{"jsonrpc":"2.0","method":"connect","params":{{"serial":"{}","uuid":{},"firmware":"{}","wanip":["127.0.0.1:0"],"capabilities":{}}}}})lit",
+			Serial_, UUID_, Config_.Firmware, Config_.Capabilities));
+	}
+
+	static std::string RequestUUIDField(const std::string &RequestUUID) {
+		return RequestUUID.empty() ? "" : fmt::format(R"lit("request_uuid":"{}",)lit", RequestUUID);
+	}
+
+	bool SimDevice::SendState(const std::string &RequestUUID) {
+		auto Now = std::time(nullptr);
+		return SendText(fmt::format(
+			R"lit({{"jsonrpc":"2.0","method":"state","params":{{"serial":"{0}","uuid":{1},{2})lit"
+			R"lit("state":{{"unit":{{"load":[0.12,0.08,0.05],"memory":{{"total":512000000,"free":256000000}},"localtime":{3},"uptime":{4}}},)lit"
+			R"lit("radios":[{{"band":"2G","channel":6,"phy":"platform/soc/a000000.wifi"}},{{"band":"5G","channel":36,"phy":"platform/soc/a800000.wifi"}}],)lit"
+			R"lit("interfaces":[{{"name":"up0v0","counters":{{"rx_bytes":{5},"tx_bytes":{5}}},"ssids":[)lit"
+			R"lit({{"band":"2G","phy":"platform/soc/a000000.wifi","ssid":"simulator","associations":[{{"station":"0aabbccddee1","rssi":-61}}]}},)lit"
+			R"lit({{"band":"5G","phy":"platform/soc/a800000.wifi","ssid":"simulator","associations":[{{"station":"0aabbccddee2","rssi":-55}},{{"station":"0aabbccddee3","rssi":-70}}]}}]}}]}}}}}})lit",
+			Serial_, UUID_, RequestUUIDField(RequestUUID), Now, Now - Started_,
+			(Now - Started_) * 1000));
+	}
+
+	bool SimDevice::SendHealthcheck(const std::string &RequestUUID) {
+		return SendText(fmt::format(
+			R"lit({{"jsonrpc":"2.0","method":"healthcheck","params":{{"serial":"{}","uuid":{},{}"sanity":100,"data":{{}}}}}})lit",
+			Serial_, UUID_, RequestUUIDField(RequestUUID)));
+	}
+
+	bool SimDevice::SendPing() {
+		return SendText(fmt::format(
+			R"lit({{"jsonrpc":"2.0","method":"ping","params":{{"serial":"{}","uuid":{}}}}})lit",
+			Serial_, UUID_));
+	}
+
+	bool SimDevice::SendLog() {
+		return SendText(fmt::format(
+			R"lit({{"jsonrpc":"2.0","method":"log","params":{{"serial":"{}","log":"simulated log entry","severity":6}}}})lit",
+			Serial_));
+	}
+
+	//	Events get no answer, so round trips are measured with WebSocket pings. They queue
+	//	behind the events on the same connection and the same gateway reactor.
+	bool SimDevice::SendProbe(Clock::time_point Now) {
+		if (ProbeOutstanding_)
+			return true;
+		try {
+			WS_->sendFrame("", 0,
+						   (int)Poco::Net::WebSocket::FRAME_OP_PING |
+							   (int)Poco::Net::WebSocket::FRAME_FLAG_FIN);
+			Counters_.FramesSent++;
+			ProbeSent_ = Now;
+			ProbeOutstanding_ = true;
+			return true;
+		} catch (const Poco::Exception &) {
+		}
+		Counters_.SendFailures++;
+		return false;
+	}
+
+	bool SimDevice::AnswerCommand(const Poco::JSON::Object::Ptr &Command) {
+		auto Method = Command->get("method").toString();
+		auto Id = Command->get("id").toString();
+		Poco::JSON::Object::Ptr Params = Command->isObject("params")
+											 ? Command->getObject("params")
+											 : Poco::JSON::Object::Ptr(new Poco::JSON::Object);
+
+		if (Method == "configure" && Params->has("uuid"))
+			UUID_ = Params->get("uuid");
+
+		if (!SendText(fmt::format(
+				R"lit({{"jsonrpc":"2.0","id":{},"result":{{"serial":"{}","uuid":{},"status":{{"error":0,"text":"Success","when":0}}}}}})lit",
+				Id, Serial_, UUID_)))
+			return false;
+		Counters_.CommandsAnswered++;
+
+		if (Method == "request" && Params->has("message")) {
+			auto Message = Params->get("message").toString();
+			auto RequestUUID = Params->has("request_uuid") ? Params->get("request_uuid").toString() : "";
+			if (Message == "state")
+				return SendState(RequestUUID);
+			if (Message == "healthcheck")
+				return SendHealthcheck(RequestUUID);
+		}
+		return true;
+	}
+
+} // namespace OpenWifi::Simulator
@@ -0,0 +1,89 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Poco/Buffer.h"
+#include "Poco/JSON/Object.h"
+#include "Poco/Net/Context.h"
+#include "Poco/Net/HTTPSClientSession.h"
+#include "Poco/Net/WebSocket.h"
+
+#include "simulator/SimStats.h"
+
+namespace OpenWifi::Simulator {
+
+	using Clock = std::chrono::steady_clock;
+
+	struct SimConfig {
+		std::string Host{"localhost"};
+		std::uint16_t Port = 15002;
+		std::string CertFile, KeyFile, KeyPassword, CaFile;
+		std::string Prefix{"53494d"};
+		std::string Firmware{"owgw-simulator"};
+		std::string Capabilities;
+		std::uint64_t Devices = 100;
+		std::uint64_t ConnectRate = 50;		//	per second, for all devices
+		std::uint64_t Threads = 4;
+		std::uint64_t Connectors = 4;
+		std::uint64_t Duration = 60;		//	seconds, 0 runs until stopped
+		std::uint64_t Report = 10;			//	seconds
+		std::uint64_t ReconnectDelay = 5;	//	seconds
+		//	seconds between messages of each kind, 0 turns it off.
+		std::uint64_t StateInterval = 60, HealthcheckInterval = 60, PingInterval = 60,
+					  LogInterval = 300, ProbeInterval = 10;
+	};
+
+	//	One access point. Connect() runs on a connector thread, everything else on the worker
+	//	that owns the device once it is connected.
+	class SimDevice {
+	  public:
+		SimDevice(const SimConfig &Config, std::string Serial, SimCounters &Counters,
+				  SimLatency &ConnectLatency, SimLatency &ProbeLatency)
+			: Config_(Config), Serial_(std::move(Serial)), Counters_(Counters),
+			  ConnectLatency_(ConnectLatency), ProbeLatency_(ProbeLatency) {}
+
+		bool Connect(Poco::Net::Context::Ptr Context);
+		void Disconnect();
+
+		//	False means the connection is gone.
+		bool OnReadable(Clock::time_point Now);
+		bool Tick(Clock::time_point Now);
+
+		[[nodiscard]] inline Poco::Net::WebSocket &Socket() { return *WS_; }
+		[[nodiscard]] inline const std::string &Serial() const { return Serial_; }
+		[[nodiscard]] inline Clock::time_point ReconnectAt() const { return ReconnectAt_; }
+
+	  private:
+		const SimConfig &Config_;
+		std::string Serial_;
+		SimCounters &Counters_;
+		SimLatency &ConnectLatency_, &ProbeLatency_;
+
+		std::unique_ptr<Poco::Net::HTTPSClientSession> Session_;
+		std::unique_ptr<Poco::Net::WebSocket> WS_;
+		std::uint64_t UUID_ = 1;
+		std::uint64_t Started_ = 0;
+		Clock::time_point NextState_, NextHealthcheck_, NextPing_, NextLog_, NextProbe_,
+			ProbeSent_, ReconnectAt_;
+		bool ProbeOutstanding_ = false;
+
+		bool SendText(const std::string &Text);
+		bool SendConnect();
+		bool SendState(const std::string &RequestUUID = "");
+		bool SendHealthcheck(const std::string &RequestUUID = "");
+		bool SendPing();
+		bool SendLog();
+		bool SendProbe(Clock::time_point Now);
+		bool AnswerCommand(const Poco::JSON::Object::Ptr &Command);
+		void Schedule(Clock::time_point Now);
+	};
+
+} // namespace OpenWifi::Simulator
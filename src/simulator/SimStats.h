@@ -0,0 +1,59 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace OpenWifi::Simulator {
+
+	struct SimCounters {
+		std::atomic_uint64_t Connects = 0, ConnectFailures = 0, Shed = 0, Disconnects = 0,
+							 FramesSent = 0, FramesReceived = 0, BytesSent = 0, BytesReceived = 0,
+							 CommandsAnswered = 0, SendFailures = 0;
+	};
+
+	//	Latency samples in microseconds. Workers add, the reporter takes what came in since the
+	//	last report.
+	class SimLatency {
+	  public:
+		inline void Add(std::uint64_t Us) {
+			std::lock_guard G(Mutex_);
+			Samples_.push_back(Us);
+		}
+
+		inline void Take(std::vector<std::uint64_t> &Into) {
+			std::lock_guard G(Mutex_);
+			Into.insert(Into.end(), Samples_.begin(), Samples_.end());
+			Samples_.clear();
+		}
+
+	  private:
+		std::mutex Mutex_;
+		std::vector<std::uint64_t> Samples_;
+	};
+
+	//	Sorts Samples. Returns "n=0" when there are none.
+	inline std::string Percentiles(std::vector<std::uint64_t> &Samples) {
+		if (Samples.empty())
+			return "n=0";
+		std::sort(Samples.begin(), Samples.end());
+		auto At = [&](double P) {
+			auto i = (std::size_t)(P * (double)(Samples.size() - 1) + 0.5);
+			return Samples[std::min(i, Samples.size() - 1)] / 1000.0;
+		};
+		return fmt::format("n={} p50={:.2f}ms p90={:.2f}ms p99={:.2f}ms p99.9={:.2f}ms max={:.2f}ms",
+						   Samples.size(), At(0.5), At(0.9), At(0.99), At(0.999),
+						   Samples.back() / 1000.0);
+	}
+
+} // namespace OpenWifi::Simulator
@@ -0,0 +1,258 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <algorithm>
+#include <iostream>
+
+#include "Poco/Crypto/RSAKey.h"
+#include "Poco/Crypto/X509Certificate.h"
+
+#include "fmt/format.h"
+
+#include "simulator/Simulator.h"
+
+namespace OpenWifi::Simulator {
+
+	void SimWorker::Start() {
+		Running_ = true;
+		Thread_ = std::thread([this] { run(); });
+	}
+
+	void SimWorker::Stop() {
+		Running_ = false;
+		if (Thread_.joinable())
+			Thread_.join();
+		for (auto &[Socket, Device] : Devices_)
+			Device->Disconnect();
+		Devices_.clear();
+	}
+
+	void SimWorker::Adopt(SimDevice *Device) {
+		std::lock_guard G(Mutex_);
+		Adopted_.push_back(Device);
+	}
+
+	void SimWorker::run() {
+		auto NextTick = Clock::now();
+		std::vector<SimDevice *> Gone;
+		while (Running_) {
+			{
+				std::lock_guard G(Mutex_);
+				for (auto Device : Adopted_) {
+					Poll_.add(Device->Socket(), Poco::Net::PollSet::POLL_READ);
+					Devices_[Device->Socket()] = Device;
+				}
+				Adopted_.clear();
+			}
+
+			if (Devices_.empty()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				continue;
+			}
+
+			auto Ready = Poll_.poll(Poco::Timespan(0, 10000));
+			auto Now = Clock::now();
+			for (const auto &[Socket, Mode] : Ready) {
+				auto Hit = Devices_.find(Socket);
+				if (Hit != Devices_.end() && !Hit->second->OnReadable(Now))
+					Gone.push_back(Hit->second);
+			}
+
+			if (Now >= NextTick) {
+				NextTick = Now + std::chrono::milliseconds(100);
+				for (const auto &[Socket, Device] : Devices_) {
+					if (!Device->Tick(Now))
+						Gone.push_back(Device);
+				}
+			}
+
+			//	a device can fail a read and a send in the same pass.
+			std::sort(Gone.begin(), Gone.end());
+			Gone.erase(std::unique(Gone.begin(), Gone.end()), Gone.end());
+			for (auto Device : Gone)
+				Lost(Device);
+			Gone.clear();
+		}
+	}
+
+	void SimWorker::Lost(SimDevice *Device) {
+		Poll_.remove(Device->Socket());
+		Devices_.erase(Device->Socket());
+		Device->Disconnect();
+		Owner_.Counters().Disconnects++;
+		Owner_.Reconnect(Device);
+	}
+
+	Simulator::Simulator(const SimConfig &Config) : Config_(Config) {
+		Poco::Net::Context::Params P;
+		P.caLocation = Config_.CaFile;
+		P.verificationMode = Config_.CaFile.empty() ? Poco::Net::Context::VERIFY_NONE
+													: Poco::Net::Context::VERIFY_RELAXED;
+		P.loadDefaultCAs = false;
+		Context_ = new Poco::Net::Context(Poco::Net::Context::TLS_CLIENT_USE, P);
+		Context_->useCertificate(Poco::Crypto::X509Certificate(Config_.CertFile));
+		Context_->usePrivateKey(Poco::Crypto::RSAKey("", Config_.KeyFile, Config_.KeyPassword));
+		//	the gateway certificate is not issued for localhost.
+		Context_->enableExtendedCertificateVerification(false);
+
+		auto Threads = std::max((std::uint64_t)1, Config_.Threads);
+		for (std::uint64_t i = 0; i < Threads; ++i)
+			Workers_.emplace_back(std::make_unique<SimWorker>(*this));
+
+		auto Digits = 12 - Config_.Prefix.size();
+		for (std::uint64_t i = 0; i < Config_.Devices; ++i) {
+			Devices_.emplace_back(std::make_unique<SimDevice>(
+				Config_, fmt::format("{}{:0{}x}", Config_.Prefix, i + 1, Digits), Counters_,
+				ConnectLatency_, ProbeLatency_));
+			Owners_[Devices_.back().get()] = Workers_[i % Threads].get();
+		}
+	}
+
+	Simulator::~Simulator() { Stop(); }
+
+	int Simulator::Run(const std::atomic_bool &Interrupted) {
+		Running_ = true;
+		for (auto &Worker : Workers_)
+			Worker->Start();
+		{
+			std::lock_guard G(Mutex_);
+			NextConnect_ = Clock::now();
+			for (auto &Device : Devices_)
+				Pending_.emplace(Device->ReconnectAt(), Device.get());
+		}
+		for (std::uint64_t i = 0; i < std::max((std::uint64_t)1, Config_.Connectors); ++i)
+			Connectors_.emplace_back([this] { Connector(); });
+
+		auto Start = Clock::now();
+		auto Last = Start;
+		auto End = Config_.Duration ? Start + std::chrono::seconds(Config_.Duration)
+									: Clock::time_point::max();
+		auto Every = std::chrono::seconds(std::max((std::uint64_t)1, Config_.Report));
+		while (!Interrupted) {
+			auto Now = Clock::now();
+			if (Now >= End)
+				break;
+			if (Now >= Last + Every)
+				Report(Start, Last, false);
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		}
+
+		Stop();
+		Report(Start, Last, true);
+		return Counters_.Connects ? 0 : 1;
+	}
+
+	void Simulator::Stop() {
+		{
+			std::lock_guard G(Mutex_);
+			if (!Running_)
+				return;
+			Running_ = false;
+		}
+		Wakeup_.notify_all();
+		for (auto &Connector : Connectors_)
+			Connector.join();
+		Connectors_.clear();
+		for (auto &Worker : Workers_)
+			Worker->Stop();
+	}
+
+	void Simulator::Reconnect(SimDevice *Device) {
+		{
+			std::lock_guard G(Mutex_);
+			Pending_.emplace(Device->ReconnectAt(), Device);
+		}
+		Wakeup_.notify_all();
+	}
+
+	void Simulator::Connector() {
+		SimDevice *Device = nullptr;
+		while (NextToConnect(Device)) {
+			if (Device->Connect(Context_))
+				Owners_.at(Device)->Adopt(Device);
+			else
+				Reconnect(Device);
+		}
+	}
+
+	//	Devices are connected in reconnect time order, then in the order they were queued, no
+	//	sooner than their reconnect time and no faster than the connect rate.
+	bool Simulator::NextToConnect(SimDevice *&Device) {
+		auto Spacing = Config_.ConnectRate ? std::chrono::microseconds(1000000 / Config_.ConnectRate)
+										   : std::chrono::microseconds(0);
+		std::unique_lock L(Mutex_);
+		while (Running_) {
+			if (Pending_.empty()) {
+				Wakeup_.wait(L);
+				continue;
+			}
+			auto Now = Clock::now();
+			auto Due = std::max(Pending_.begin()->first, NextConnect_);
+			if (Now < Due) {
+				Wakeup_.wait_until(L, Due);
+				continue;
+			}
+			Device = Pending_.begin()->second;
+			Pending_.erase(Pending_.begin());
+			NextConnect_ = std::max(NextConnect_, Now) + Spacing;
+			return true;
+		}
+		return false;
+	}
+
+	void Simulator::Report(Clock::time_point Start, Clock::time_point &Last, bool Final) {
+		auto Now = Clock::now();
+		auto Seconds = [](Clock::duration D) { return std::chrono::duration<double>(D).count(); };
+		auto Interval = std::max(Seconds(Now - Last), 0.001);
+		Last = Now;
+
+		std::vector<std::uint64_t> Connects, Probes;
+		ConnectLatency_.Take(Connects);
+		ProbeLatency_.Take(Probes);
+		AllConnects_.insert(AllConnects_.end(), Connects.begin(), Connects.end());
+		AllProbes_.insert(AllProbes_.end(), Probes.begin(), Probes.end());
+
+		std::uint64_t TotalConnects = Counters_.Connects, Disconnects = Counters_.Disconnects,
+					  Failures = Counters_.ConnectFailures, Shed = Counters_.Shed,
+					  SendFailures = Counters_.SendFailures,
+					  Commands = Counters_.CommandsAnswered, FramesSent = Counters_.FramesSent,
+					  FramesReceived = Counters_.FramesReceived, BytesSent = Counters_.BytesSent;
+
+		if (!Final) {
+			std::cout << fmt::format(
+							 "[{:6.0f}s] connected={} connects/s={:.1f} failures={} shed={} disconnects={} "
+							 "frames/s out={:.0f} in={:.0f} MB/s out={:.2f} commands={}",
+							 Seconds(Now - Start), TotalConnects - Disconnects,
+							 (TotalConnects - LastConnects_) / Interval, Failures, Shed, Disconnects,
+							 (FramesSent - LastFramesSent_) / Interval,
+							 (FramesReceived - LastFramesReceived_) / Interval,
+							 (BytesSent - LastBytesSent_) / Interval / 1e6, Commands)
+					  << std::endl;
+			std::cout << "          connect " << Percentiles(Connects) << std::endl;
+			std::cout << "          rtt     " << Percentiles(Probes) << std::endl;
+		} else {
+			auto Elapsed = std::max(Seconds(Now - Start), 0.001);
+			std::cout << fmt::format("Ran {:.0f}s with {} devices: {} connects ({:.1f}/s), {} "
+									 "failures, {} shed, {} disconnects, {} send failures",
+									 Elapsed, Config_.Devices, TotalConnects,
+									 TotalConnects / Elapsed, Failures, Shed, Disconnects,
+									 SendFailures)
+					  << std::endl;
+			std::cout << fmt::format("Frames out {} ({:.0f}/s, {:.2f} MB/s), in {} ({:.0f}/s), "
+									 "commands answered {}",
+									 FramesSent, FramesSent / Elapsed, BytesSent / Elapsed / 1e6,
+									 FramesReceived, FramesReceived / Elapsed, Commands)
+					  << std::endl;
+			std::cout << "Connect " << Percentiles(AllConnects_) << std::endl;
+			std::cout << "RTT     " << Percentiles(AllProbes_) << std::endl;
+		}
+
+		LastConnects_ = TotalConnects;
+		LastFramesSent_ = FramesSent;
+		LastFramesReceived_ = FramesReceived;
+		LastBytesSent_ = BytesSent;
+	}
+
+} // namespace OpenWifi::Simulator
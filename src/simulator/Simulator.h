@@ -0,0 +1,91 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Poco/Net/Context.h"
+#include "Poco/Net/PollSet.h"
+
+#include "simulator/SimDevice.h"
+#include "simulator/SimStats.h"
+
+namespace OpenWifi::Simulator {
+
+	class Simulator;
+
+	//	Owns the connected devices given to it: reads their frames and sends what is due.
+	class SimWorker {
+	  public:
+		explicit SimWorker(Simulator &Owner) : Owner_(Owner) {}
+
+		void Start();
+		void Stop();
+		void Adopt(SimDevice *Device);
+
+	  private:
+		Simulator &Owner_;
+		std::thread Thread_;
+		std::atomic_bool Running_ = false;
+		std::mutex Mutex_;
+		std::vector<SimDevice *> Adopted_;
+		Poco::Net::PollSet Poll_;
+		std::map<Poco::Net::Socket, SimDevice *> Devices_;
+
+		void run();
+		void Lost(SimDevice *Device);
+	};
+
+	//	Connects the devices at the configured rate, hands them to the workers, reconnects the
+	//	ones that drop, and prints what happened every report interval.
+	class Simulator {
+	  public:
+		explicit Simulator(const SimConfig &Config);
+		~Simulator();
+
+		//	Runs for the configured duration, or until Interrupted is set.
+		int Run(const std::atomic_bool &Interrupted);
+
+		//	A worker lost Device, it will be connected again after the reconnect delay.
+		void Reconnect(SimDevice *Device);
+
+		[[nodiscard]] inline SimCounters &Counters() { return Counters_; }
+
+	  private:
+		const SimConfig &Config_;
+		Poco::Net::Context::Ptr Context_;
+		std::vector<std::unique_ptr<SimDevice>> Devices_;
+		std::vector<std::unique_ptr<SimWorker>> Workers_;
+		std::vector<std::thread> Connectors_;
+		std::map<SimDevice *, SimWorker *> Owners_;
+
+		std::atomic_bool Running_ = false;
+		std::mutex Mutex_;
+		std::condition_variable Wakeup_;
+		//	by reconnect time, then in the order they were queued.
+		std::multimap<Clock::time_point, SimDevice *> Pending_;
+		Clock::time_point NextConnect_;
+
+		SimCounters Counters_;
+		SimLatency ConnectLatency_, ProbeLatency_;
+		//	for the final report
+		std::vector<std::uint64_t> AllConnects_, AllProbes_;
+		std::uint64_t LastFramesSent_ = 0, LastFramesReceived_ = 0, LastBytesSent_ = 0,
+					  LastConnects_ = 0;
+
+		void Stop();
+		void Connector();
+		bool NextToConnect(SimDevice *&Device);
+		void Report(Clock::time_point Start, Clock::time_point &Last, bool Final);
+	};
+
+} // namespace OpenWifi::Simulator
@@ -0,0 +1,182 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "Poco/JSON/Parser.h"
+#include "Poco/Net/SSLManager.h"
+#include "Poco/String.h"
+#include "Poco/Util/Application.h"
+#include "Poco/Util/HelpFormatter.h"
+#include "Poco/Util/Option.h"
+#include "Poco/Util/OptionSet.h"
+
+#include "simulator/Simulator.h"
+
+namespace OpenWifi::Simulator {
+
+	static std::atomic_bool Interrupted = false;
+
+	//	Opens many device connections to a gateway and reports how it keeps up. See
+	//	SIMULATOR.md.
+	class SimulatorApp : public Poco::Util::Application {
+	  public:
+		void defineOptions(Poco::Util::OptionSet &options) override {
+			Poco::Util::Application::defineOptions(options);
+			options.addOption(
+				Poco::Util::Option("help", "", "display help information on command line arguments")
+					.required(false)
+					.repeatable(false)
+					.callback(Poco::Util::OptionCallback<SimulatorApp>(this,
+																	   &SimulatorApp::handleHelp)));
+			Value(options, "host", "gateway websocket address", "localhost");
+			Value(options, "port", "gateway websocket port", "15002");
+			Value(options, "cert", "device certificate (PEM)", "");
+			Value(options, "key", "device private key (PEM)", "");
+			Value(options, "keypassword", "device private key password", "");
+			Value(options, "cacert", "verify the gateway against this CA, not verified if absent",
+				  "");
+			Value(options, "capabilities", "capabilities JSON file sent with connect", "");
+			Value(options, "prefix", "hex serial number prefix, 53494d marks simulated devices",
+				  "53494d");
+			Value(options, "devices", "number of devices", "100");
+			Value(options, "connectrate", "new connections per second, 0 for no limit", "50");
+			Value(options, "threads", "worker threads for connected devices", "4");
+			Value(options, "connectors", "threads making connections", "4");
+			Value(options, "duration", "seconds to run, 0 until interrupted", "60");
+			Value(options, "report", "seconds between reports", "10");
+			Value(options, "reconnect", "seconds before a dropped device reconnects", "5");
+			Value(options, "state", "seconds between state messages, 0 for none", "60");
+			Value(options, "healthcheck", "seconds between healthchecks, 0 for none", "60");
+			Value(options, "ping", "seconds between ping messages, 0 for none", "60");
+			Value(options, "log", "seconds between log messages, 0 for none", "300");
+			Value(options, "probe", "seconds between websocket ping round trips, 0 for none",
+				  "10");
+		}
+
+	  protected:
+		int main([[maybe_unused]] const std::vector<std::string> &args) override {
+			if (HelpRequested_)
+				return Poco::Util::Application::EXIT_OK;
+
+			SimConfig Config;
+			try {
+				Config.Host = Get("host");
+				Config.Port = (std::uint16_t)GetInt("port");
+				Config.CertFile = Get("cert");
+				Config.KeyFile = Get("key");
+				Config.KeyPassword = Get("keypassword");
+				Config.CaFile = Get("cacert");
+				Config.Prefix = Poco::toLower(Get("prefix"));
+				Config.Devices = GetInt("devices");
+				Config.ConnectRate = GetInt("connectrate");
+				Config.Threads = GetInt("threads");
+				Config.Connectors = GetInt("connectors");
+				Config.Duration = GetInt("duration");
+				Config.Report = GetInt("report");
+				Config.ReconnectDelay = GetInt("reconnect");
+				Config.StateInterval = GetInt("state");
+				Config.HealthcheckInterval = GetInt("healthcheck");
+				Config.PingInterval = GetInt("ping");
+				Config.LogInterval = GetInt("log");
+				Config.ProbeInterval = GetInt("probe");
+				Config.Capabilities = Capabilities(Get("capabilities"));
+			} catch (const Poco::Exception &E) {
+				std::cerr << "Invalid option: " << E.displayText() << std::endl;
+				return Poco::Util::Application::EXIT_USAGE;
+			}
+
+			if (Config.CertFile.empty() || Config.KeyFile.empty()) {
+				std::cerr << "A device certificate and key are required (--cert, --key)."
+						  << std::endl;
+				return Poco::Util::Application::EXIT_USAGE;
+			}
+			if (Config.Prefix.size() > 6 ||
+				!std::all_of(Config.Prefix.begin(), Config.Prefix.end(),
+							 [](unsigned char c) { return std::isxdigit(c) != 0; })) {
+				std::cerr << "The prefix must be at most 6 hex digits." << std::endl;
+				return Poco::Util::Application::EXIT_USAGE;
+			}
+
+			std::signal(SIGINT, [](int) { Interrupted = true; });
+			std::signal(SIGTERM, [](int) { Interrupted = true; });
+			std::signal(SIGPIPE, SIG_IGN);
+
+			Poco::Net::initializeSSL();
+			int Result;
+			try {
+				Simulator Sim(Config);
+				Result = Sim.Run(Interrupted);
+			} catch (const Poco::Exception &E) {
+				std::cerr << "Simulator: " << E.displayText() << std::endl;
+				Result = Poco::Util::Application::EXIT_SOFTWARE;
+			}
+			Poco::Net::uninitializeSSL();
+			return Result;
+		}
+
+	  private:
+		bool HelpRequested_ = false;
+
+		void Value(Poco::Util::OptionSet &options, const std::string &Name,
+				   const std::string &Description, const std::string &Default) {
+			options.addOption(Poco::Util::Option(Name, "",
+												 Default.empty()
+													 ? Description
+													 : Description + " (" + Default + ")")
+								  .required(false)
+								  .repeatable(false)
+								  .argument("value")
+								  .binding("simulator." + Name));
+			Defaults_[Name] = Default;
+		}
+
+		std::string Get(const std::string &Name) {
+			return config().getString("simulator." + Name, Defaults_[Name]);
+		}
+
+		std::uint64_t GetInt(const std::string &Name) {
+			return config().getUInt64("simulator." + Name, std::stoull(Defaults_[Name]));
+		}
+
+		//	Compact, so it can go in the connect message as is.
+		static std::string Capabilities(const std::string &FileName) {
+			if (FileName.empty())
+				return R"lit({"compatible":"owgw_simulator","model":"OWGW Simulator","platform":"ap"})lit";
+			std::ifstream In(FileName);
+			if (!In)
+				throw Poco::FileNotFoundException(FileName);
+			std::stringstream Contents;
+			Contents << In.rdbuf();
+			Poco::JSON::Parser Parser;
+			std::ostringstream Compact;
+			Parser.parse(Contents.str()).extract<Poco::JSON::Object::Ptr>()->stringify(Compact);
+			return Compact.str();
+		}
+
+		void handleHelp([[maybe_unused]] const std::string &name,
+						[[maybe_unused]] const std::string &value) {
+			HelpRequested_ = true;
+			Poco::Util::HelpFormatter Help(options());
+			Help.setCommand(commandName());
+			Help.setUsage("--cert=FILE --key=FILE [OPTIONS]");
+			Help.setHeader("Simulated access points for load testing an OpenWiFi gateway.");
+			Help.format(std::cout);
+			stopOptionsProcessing();
+		}
+
+		std::map<std::string, std::string> Defaults_;
+	};
+
+} // namespace OpenWifi::Simulator
+
+POCO_APP_MAIN(OpenWifi::Simulator::SimulatorApp)
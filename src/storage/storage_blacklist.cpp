@@ -10,6 +10,7 @@
 #include "RESTObjects/RESTAPI_GWobjects.h"
 #include "StorageService.h"
 #include "fmt/format.h"
+#include "storage/storage_blacklist.h"
 
 namespace OpenWifi {
 
@@ -53,14 +54,14 @@ namespace OpenWifi {
 		R.set<3>(D.author);
 	}
 
-	struct DeviceDetails {
-		std::string reason;
-		std::string author;
-		std::uint64_t created=Utils::Now();
-	};
-
-	static std::map<std::uint64_t , DeviceDetails> BlackListDevices;
-	static std::recursive_mutex BlackListMutex;
+	//	Writers copy the current snapshot, apply their change and publish the copy. A replaced
+	//	snapshot is freed when its last reader lets go of it.
+	template <typename F> void Storage::UpdateBlackList(F Change) {
+		std::lock_guard G(BlackListUpdateMutex_);
+		auto Devices = BlackList_.Load()->Devices();
+		Change(Devices);
+		BlackList_.Store(std::make_shared<const BlackListSnapshot>(Devices));
+	}
 
 	bool Storage::InitializeBlackListCache() {
 		try {
@@ -72,16 +73,18 @@ namespace OpenWifi {
 
 			Poco::Data::RecordSet RSet(Select);
 
+			BlackListMap Loaded;
 			bool More = RSet.moveFirst();
 			while (More) {
 				auto SerialNumber = RSet[0].convert<std::string>();
 				auto Reason = RSet[1].convert<std::string>();
 				auto Author = RSet[2].convert<std::string>();
 				auto Created = RSet[3].convert<std::uint64_t>();
-				BlackListDevices[Utils::MACToInt(SerialNumber)] =
-					DeviceDetails{.reason = Reason, .author = Author, .created = Created};
+				Loaded[Utils::MACToInt(SerialNumber)] =
+					BlackListDetails{.reason = Reason, .author = Author, .created = Created};
 				More = RSet.moveNext();
 			}
+			UpdateBlackList([&Loaded](BlackListMap &Devices) { Devices = std::move(Loaded); });
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -91,6 +94,16 @@ namespace OpenWifi {
 	}
 
 	bool Storage::AddBlackListDevice(GWObjects::BlackListedDevice &Device) {
+		if (!InsertBlackListDevice(Device))
+			return false;
+		UpdateBlackList([&Device](BlackListMap &Devices) {
+			Devices[Utils::MACToInt(Device.serialNumber)] = BlackListDetails{
+				.reason = Device.reason, .author = Device.author, .created = Device.created};
+		});
+		return true;
+	}
+
+	bool Storage::InsertBlackListDevice(GWObjects::BlackListedDevice &Device) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
 			Sess.begin();
@@ -104,9 +117,6 @@ namespace OpenWifi {
 			Insert << ConvertParams(St), Poco::Data::Keywords::use(T);
 			Insert.execute();
 			Sess.commit();
-			std::lock_guard G(BlackListMutex);
-			BlackListDevices[Utils::MACToInt(Device.serialNumber)] = DeviceDetails{
-				.reason = Device.reason, .author = Device.author, .created = Device.created};
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -117,9 +127,19 @@ namespace OpenWifi {
 
 	bool Storage::AddBlackListDevices(std::vector<GWObjects::BlackListedDevice> &Devices) {
 		try {
+			//	one snapshot for the whole list.
+			std::vector<GWObjects::BlackListedDevice *> Added;
 			for (auto &i : Devices) {
-				AddBlackListDevice(i);
+				if (InsertBlackListDevice(i))
+					Added.push_back(&i);
 			}
+			UpdateBlackList([&Added](BlackListMap &BlackListed) {
+				for (const auto &Device : Added)
+					BlackListed[Utils::MACToInt(Device->serialNumber)] =
+						BlackListDetails{.reason = Device->reason,
+									  .author = Device->author,
+									  .created = Device->created};
+			});
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -140,8 +160,9 @@ namespace OpenWifi {
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(SerialNumber);
 			Delete.execute();
 			Sess.commit();
-			std::lock_guard G(BlackListMutex);
-			BlackListDevices.erase(Utils::MACToInt(SerialNumber));
+			UpdateBlackList([&SerialNumber](BlackListMap &Devices) {
+				Devices.erase(Utils::MACToInt(SerialNumber));
+			});
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -191,10 +212,10 @@ namespace OpenWifi {
 				Poco::Data::Keywords::use(SerialNumber);
 			Update.execute();
 			Sess.commit();
-			std::lock_guard G(BlackListMutex);
-			BlackListDevices[Utils::MACToInt(Device.serialNumber)] = DeviceDetails{
-				.reason = Device.reason, .author = Device.author, .created = Device.created};
-
+			UpdateBlackList([&Device](BlackListMap &Devices) {
+				Devices[Utils::MACToInt(Device.serialNumber)] = BlackListDetails{
+					.reason = Device.reason, .author = Device.author, .created = Device.created};
+			});
 			return true;
 
 		} catch (const Poco::Exception &E) {
@@ -231,26 +252,55 @@ namespace OpenWifi {
 		return false;
 	}
 
-	uint64_t Storage::GetBlackListDeviceCount() {
-		std::lock_guard G(BlackListMutex);
-		return BlackListDevices.size();
+	bool Storage::GetBlackListDevices(StorageCursor &Cursor, uint64_t HowMany,
+									  std::vector<GWObjects::BlackListedDevice> &Devices) {
+		try {
+			BlackListDeviceRecordList Records;
+
+			Poco::Data::Session Sess = Pool_->get();
+			Poco::Data::Statement Select(Sess);
+
+			if (Cursor.Started) {
+				std::string St{"SELECT " + DB_BlackListDeviceSelectFields +
+							   " FROM BlackList WHERE SerialNumber>? ORDER BY SerialNumber ASC "};
+				Select << ConvertParams(St) + ComputeRange(0, HowMany),
+					Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(Cursor.Key);
+			} else {
+				Select << "SELECT " + DB_BlackListDeviceSelectFields +
+							  " FROM BlackList ORDER BY SerialNumber ASC " + ComputeRange(0, HowMany),
+					Poco::Data::Keywords::into(Records);
+			}
+			Select.execute();
+
+			Cursor.AdvanceOnKey(Records, HowMany,
+								[](const BlackListDeviceRecordTuple &R) { return R.get<0>(); });
+			for (const auto &i : Records) {
+				GWObjects::BlackListedDevice R;
+				ConvertBlackListDeviceRecord(i, R);
+				Devices.push_back(R);
+			}
+			return true;
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
 	}
 
+	uint64_t Storage::GetBlackListDeviceCount() { return BlackList_.Lookup().size(); }
+
 	bool Storage::IsBlackListed(std::uint64_t SerialNumber, std::string &reason,
 								std::string &author, std::uint64_t &created) {
-		std::lock_guard G(BlackListMutex);
-		auto DeviceHint = BlackListDevices.find(SerialNumber);
-		if (DeviceHint == end(BlackListDevices))
+		auto Device = BlackList_.Lookup().Find(SerialNumber);
+		if (Device == nullptr)
 			return false;
-		reason = DeviceHint->second.reason;
-		author = DeviceHint->second.author;
-		created = DeviceHint->second.created;
+		reason = Device->reason;
+		author = Device->author;
+		created = Device->created;
 		return true;
 	}
 
 	bool Storage::IsBlackListed(std::uint64_t SerialNumber) {
-		std::lock_guard G(BlackListMutex);
-		auto DeviceHint = BlackListDevices.find(SerialNumber);
-		return DeviceHint != end(BlackListDevices);
+		return BlackList_.Lookup().Find(SerialNumber) != nullptr;
 	}
 } // namespace OpenWifi
\ No newline at end of file
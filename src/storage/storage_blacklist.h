@@ -0,0 +1,134 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	struct BlackListDetails {
+		std::string reason;
+		std::string author;
+		std::uint64_t created = Utils::Now();
+	};
+
+	using BlackListMap = std::map<std::uint64_t, BlackListDetails>;
+
+	//	Connections check the blacklist on every TLS handshake and connect message, while it only
+	//	changes through the REST API. A snapshot is immutable: sorted serial numbers, their details
+	//	and a small bloom filter so the common case, a device that is not listed, rarely touches
+	//	the arrays.
+	class BlackListSnapshot {
+	  public:
+		explicit BlackListSnapshot(const BlackListMap &Devices) {
+			Serials_.reserve(Devices.size());
+			Details_.reserve(Devices.size());
+			std::size_t Words = 1;
+			while (Words * 64 < Devices.size() * BitsPerEntry)
+				Words <<= 1;
+			Bloom_.resize(Words, 0);
+			for (const auto &[Serial, Details] : Devices) {
+				Serials_.push_back(Serial);
+				Details_.push_back(Details);
+				auto [B1, B2] = Bits(Serial);
+				Bloom_[B1 >> 6] |= 1ULL << (B1 & 63);
+				Bloom_[B2 >> 6] |= 1ULL << (B2 & 63);
+			}
+		}
+
+		[[nodiscard]] inline const BlackListDetails *Find(std::uint64_t Serial) const {
+			auto [B1, B2] = Bits(Serial);
+			if (!(Bloom_[B1 >> 6] & (1ULL << (B1 & 63))) || !(Bloom_[B2 >> 6] & (1ULL << (B2 & 63))))
+				return nullptr;
+			auto Hint = std::lower_bound(Serials_.begin(), Serials_.end(), Serial);
+			if (Hint == Serials_.end() || *Hint != Serial)
+				return nullptr;
+			return &Details_[Hint - Serials_.begin()];
+		}
+
+		[[nodiscard]] inline BlackListMap Devices() const {
+			BlackListMap Devices;
+			for (std::size_t i = 0; i < Serials_.size(); ++i)
+				Devices.emplace_hint(Devices.end(), Serials_[i], Details_[i]);
+			return Devices;
+		}
+
+		[[nodiscard]] inline std::size_t size() const { return Serials_.size(); }
+
+	  private:
+		static constexpr std::size_t BitsPerEntry = 16;
+		std::vector<std::uint64_t> Serials_;
+		std::vector<BlackListDetails> Details_;
+		std::vector<std::uint64_t> Bloom_;
+
+		[[nodiscard]] inline std::pair<std::uint64_t, std::uint64_t> Bits(std::uint64_t Serial) const {
+			//	splitmix64 finalizer, serial numbers share long prefixes.
+			Serial ^= Serial >> 30;
+			Serial *= 0xbf58476d1ce4e5b9ULL;
+			Serial ^= Serial >> 27;
+			Serial *= 0x94d049bb133111ebULL;
+			Serial ^= Serial >> 31;
+			auto Mask = Bloom_.size() * 64 - 1;
+			return {Serial & Mask, (Serial >> 32) & Mask};
+		}
+	};
+
+	//	The published snapshot. Lookup() keeps a reference per thread and only goes back to the
+	//	shared one when the generation moved, so a lookup reads one counter that changes when the
+	//	list does and writes nothing shared. Taking a shared_ptr copy on every lookup, behind a
+	//	lock or as a std::atomic<std::shared_ptr> (libstdc++ 12 releases its lock bit relaxed after
+	//	a load, a race TSan reports), bounces its reference count between cores. A thread holds on
+	//	to a replaced snapshot until its next lookup.
+	class SharedBlackList {
+	  public:
+		SharedBlackList() : Current_(std::make_shared<const BlackListSnapshot>(BlackListMap{})) {}
+
+		[[nodiscard]] inline std::shared_ptr<const BlackListSnapshot> Load() const {
+			std::lock_guard G(Mutex_);
+			return Current_;
+		}
+
+		//	Valid until the calling thread's next Lookup().
+		[[nodiscard]] inline const BlackListSnapshot &Lookup() const {
+			thread_local struct {
+				const SharedBlackList *Owner = nullptr;
+				std::uint64_t Generation = 0;
+				std::shared_ptr<const BlackListSnapshot> Snapshot;
+			} Cached;
+			auto Generation = Generation_.load(std::memory_order_acquire);
+			if (Cached.Owner != this || Cached.Generation != Generation) {
+				Cached.Snapshot = Load();
+				Cached.Generation = Generation;
+				Cached.Owner = this;
+			}
+			return *Cached.Snapshot;
+		}
+
+		inline void Store(std::shared_ptr<const BlackListSnapshot> Next) {
+			{
+				std::lock_guard G(Mutex_);
+				Current_ = std::move(Next);
+			}
+			Generation_.fetch_add(1, std::memory_order_release);
+		}
+
+	  private:
+		mutable std::mutex Mutex_;
+		std::shared_ptr<const BlackListSnapshot> Current_;
+		//	starts at 1 so a thread that never looked always loads.
+		std::atomic_uint64_t Generation_ = 1;
+	};
+
+} // namespace OpenWifi
@@ -0,0 +1,369 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include <algorithm>
+
+#include "StorageService.h"
+
+#include "Poco/NumberParser.h"
+#include "Poco/zlib.h"
+
+#include "fmt/format.h"
+#include "framework/MicroServiceFuncs.h"
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	void PayloadCodec::Configure(bool Enabled, std::uint64_t Samples, int Level, SaveFunction Save,
+								 FetchFunction Fetch) {
+		Enabled_ = Enabled;
+		SampleCount_ = std::max((std::uint64_t)1, Samples);
+		Level_ = std::clamp(Level, 1, 9);
+		Save_ = std::move(Save);
+		Fetch_ = std::move(Fetch);
+	}
+
+	void PayloadCodec::AddDictionary(const Dictionary &D) {
+		Insert(std::make_shared<const Dictionary>(D));
+	}
+
+	void PayloadCodec::Insert(const std::shared_ptr<const Dictionary> &D) {
+		std::unique_lock Lock(Mutex_);
+		ById_[D->Id] = D;
+		auto Current = ByModel_.find(D->Model);
+		if (Current == ByModel_.end() || Current->second->Created <= D->Created)
+			ByModel_[D->Model] = D;
+	}
+
+	std::shared_ptr<const PayloadCodec::Dictionary> PayloadCodec::ForModel(const std::string &Model) {
+		std::shared_lock Lock(Mutex_);
+		auto Hint = ByModel_.find(Model);
+		return Hint == ByModel_.end() ? nullptr : Hint->second;
+	}
+
+	std::shared_ptr<const PayloadCodec::Dictionary> PayloadCodec::ForId(std::uint32_t Id) {
+		{
+			std::shared_lock Lock(Mutex_);
+			auto Hint = ById_.find(Id);
+			if (Hint != ById_.end())
+				return Hint->second;
+		}
+		//	written by another gateway sharing this database.
+		auto D = std::make_shared<Dictionary>();
+		if (!Fetch_ || !Fetch_(Id, *D))
+			return nullptr;
+		Insert(D);
+		return D;
+	}
+
+	//	Keeps the first payloads of a model. Once enough are seen, they are joined, newest last so
+	//	the most typical content sits closest to the data, and cut to the deflate window.
+	std::shared_ptr<const PayloadCodec::Dictionary> PayloadCodec::Train(const std::string &Model,
+																		const std::string &Payload) {
+		std::lock_guard Guard(TrainingMutex_);
+		if (auto Existing = ForModel(Model))
+			return Existing;
+
+		auto &Samples = Samples_[Model];
+		Samples.emplace_back(Payload);
+		if (Samples.size() < SampleCount_)
+			return nullptr;
+
+		std::string Content;
+		for (const auto &Sample : Samples)
+			Content += Sample;
+		if (Content.size() > MaxDictionarySize)
+			Content.erase(0, Content.size() - MaxDictionarySize);
+		Samples_.erase(Model);
+
+		auto D = std::make_shared<Dictionary>();
+		D->Model = Model;
+		D->Created = Utils::Now();
+		D->Content = std::move(Content);
+		D->Id = adler32(adler32(0L, Z_NULL, 0), (const Bytef *)D->Content.data(),
+						D->Content.size());
+		//	rows must never point to a dictionary nobody can find again.
+		if (Save_ && !Save_(*D))
+			return nullptr;
+		Insert(D);
+		return D;
+	}
+
+	std::string PayloadCodec::Encode(const std::string &Model, const std::string &Payload) {
+		if (!Enabled_ || Payload.size() < MinPayloadSize)
+			return Payload;
+
+		auto D = ForModel(Model);
+		if (D == nullptr && !Model.empty())
+			D = Train(Model, Payload);
+
+		z_stream Stream{};
+		if (deflateInit(&Stream, Level_) != Z_OK)
+			return Payload;
+		if (D != nullptr && deflateSetDictionary(&Stream, (const Bytef *)D->Content.data(),
+												 D->Content.size()) != Z_OK) {
+			deflateEnd(&Stream);
+			return Payload;
+		}
+		std::vector<Utils::byte> Out(deflateBound(&Stream, Payload.size()));
+		Stream.next_in = (Bytef *)Payload.data();
+		Stream.avail_in = Payload.size();
+		Stream.next_out = Out.data();
+		Stream.avail_out = Out.size();
+		auto Result = deflate(&Stream, Z_FINISH);
+		auto OutSize = Stream.total_out;
+		deflateEnd(&Stream);
+		if (Result != Z_STREAM_END)
+			return Payload;
+
+		auto Encoded = std::string(Prefix) + std::to_string(Payload.size()) + ":" +
+					   Utils::base64encode(Out.data(), OutSize);
+		if (Encoded.size() >= Payload.size())
+			return Payload;
+		Encoded_++;
+		BytesIn_ += Payload.size();
+		BytesOut_ += Encoded.size();
+		return Encoded;
+	}
+
+	bool PayloadCodec::Decode(const std::string &Stored, std::string &Payload) {
+		if (!IsEncoded(Stored)) {
+			Payload = Stored;
+			return true;
+		}
+		auto Sep = Stored.find(':', 4);
+		std::uint64_t Size = 0;
+		std::string In;
+		if (Sep == std::string::npos ||
+			!Poco::NumberParser::tryParseUnsigned64(Stored.substr(4, Sep - 4), Size) ||
+			Size > MaxPayloadSize || !Utils::base64decode(Stored.substr(Sep + 1), In)) {
+			Failures_++;
+			return false;
+		}
+
+		std::string Out(Size, '\0');
+		z_stream Stream{};
+		if (inflateInit(&Stream) != Z_OK) {
+			Failures_++;
+			return false;
+		}
+		Stream.next_in = (Bytef *)In.data();
+		Stream.avail_in = In.size();
+		Stream.next_out = (Bytef *)Out.data();
+		Stream.avail_out = Out.size();
+		auto Result = inflate(&Stream, Z_FINISH);
+		if (Result == Z_NEED_DICT) {
+			//	a dictionary that cannot be found now may be found on the next read.
+			auto D = ForId(Stream.adler);
+			if (D != nullptr && inflateSetDictionary(&Stream, (const Bytef *)D->Content.data(),
+													 D->Content.size()) == Z_OK)
+				Result = inflate(&Stream, Z_FINISH);
+		}
+		auto OutSize = Stream.total_out;
+		inflateEnd(&Stream);
+		if (Result != Z_STREAM_END || OutSize != Size) {
+			Failures_++;
+			return false;
+		}
+		Decoded_++;
+		Payload = std::move(Out);
+		return true;
+	}
+
+	void PayloadCodec::GetStatistics(Poco::JSON::Object &Obj) const {
+		Obj.set("enabled", Enabled_);
+		{
+			std::shared_lock Lock(Mutex_);
+			Obj.set("dictionaries", ById_.size());
+			Obj.set("models", ByModel_.size());
+		}
+		Obj.set("encoded", Encoded_.load());
+		Obj.set("decoded", Decoded_.load());
+		Obj.set("failures", Failures_.load());
+		Obj.set("bytesIn", BytesIn_.load());
+		Obj.set("bytesOut", BytesOut_.load());
+	}
+
+	void PayloadMigrator::Start() {
+		Running_ = true;
+		Worker_.start(*this);
+	}
+
+	void PayloadMigrator::Stop() {
+		if (Running_) {
+			Running_ = false;
+			Worker_.wakeUp();
+			Worker_.join();
+		}
+	}
+
+	void PayloadMigrator::run() {
+		Utils::SetThreadName("payload-migr");
+		//	let the gateway settle before adding load on the database.
+		Poco::Thread::trySleep(60000);
+		for (const auto &Table : {"Statistics", "HealthChecks"}) {
+			if (!Running_)
+				break;
+			StorageService()->CompressStoredPayloads(Table, Running_);
+		}
+	}
+
+	const static std::string DB_PayloadDictionarySelectFields{"Id, Model, Created, Dictionary"};
+
+	typedef Poco::Tuple<std::uint64_t, std::string, std::uint64_t, std::string>
+		PayloadDictionaryTuple;
+
+	static void ConvertPayloadDictionary(const PayloadDictionaryTuple &R,
+										 PayloadCodec::Dictionary &D) {
+		D.Id = (std::uint32_t)R.get<0>();
+		D.Model = R.get<1>();
+		D.Created = R.get<2>();
+		auto Content = Utils::base64decode(R.get<3>());
+		D.Content.assign(Content.begin(), Content.end());
+	}
+
+	bool Storage::SavePayloadDictionary(const PayloadCodec::Dictionary &D) {
+		try {
+			Poco::Data::Session Sess(Pool_->get());
+			Poco::Data::Statement Insert(Sess);
+			PayloadDictionaryTuple R{
+				D.Id, D.Model, D.Created,
+				Utils::base64encode((const Utils::byte *)D.Content.data(), D.Content.size())};
+			std::string St{"INSERT INTO PayloadDictionaries ( " + DB_PayloadDictionarySelectFields +
+						   " ) VALUES( ?,?,?,? )"};
+			Insert << ConvertParams(St), Poco::Data::Keywords::use(R);
+			Insert.execute();
+			poco_information(Logger(), fmt::format("Payload dictionary {} created for {}. Size={}",
+												   D.Id, D.Model, D.Content.size()));
+			return true;
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
+	}
+
+	bool Storage::FetchPayloadDictionary(std::uint32_t Id, PayloadCodec::Dictionary &D) {
+		try {
+			Poco::Data::Session Sess(Pool_->get());
+			Poco::Data::Statement Select(Sess);
+			std::vector<PayloadDictionaryTuple> Records;
+			std::uint64_t Key = Id;
+			std::string St{"SELECT " + DB_PayloadDictionarySelectFields +
+						   " FROM PayloadDictionaries WHERE Id=?"};
+			Select << ConvertParams(St), Poco::Data::Keywords::into(Records),
+				Poco::Data::Keywords::use(Key);
+			Select.execute();
+			if (Records.empty())
+				return false;
+			ConvertPayloadDictionary(Records.front(), D);
+			return true;
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
+	}
+
+	void Storage::InitializePayloadCodec() {
+		auto Enabled = MicroServiceConfigGetBool("storage.compression", false);
+		auto Samples = MicroServiceConfigGetInt("storage.compression.samples", 16);
+		auto Level = MicroServiceConfigGetInt("storage.compression.level", 6);
+
+		//	dictionaries are loaded even when compression is off: older rows may need them.
+		Codec_.Configure(
+			Enabled, Samples, (int)Level,
+			[this](const PayloadCodec::Dictionary &D) { return SavePayloadDictionary(D); },
+			[this](std::uint32_t Id, PayloadCodec::Dictionary &D) {
+				return FetchPayloadDictionary(Id, D);
+			});
+
+		try {
+			Poco::Data::Session Sess(Pool_->get());
+			Poco::Data::Statement Select(Sess);
+			std::vector<PayloadDictionaryTuple> Records;
+			Select << "SELECT " + DB_PayloadDictionarySelectFields + " FROM PayloadDictionaries",
+				Poco::Data::Keywords::into(Records);
+			Select.execute();
+			for (const auto &i : Records) {
+				PayloadCodec::Dictionary D;
+				ConvertPayloadDictionary(i, D);
+				Codec_.AddDictionary(D);
+			}
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+
+		if (Enabled && MicroServiceConfigGetBool("storage.compression.migrate", false))
+			Migrator_.Start();
+	}
+
+	//	Walks the table on Recorded and rewrites plain payloads. The UPDATE matches on the old
+	//	value, so a row deleted or changed meanwhile is left alone.
+	bool Storage::CompressStoredPayloads(const std::string &Table,
+										 const std::atomic_bool &Running) {
+		constexpr std::uint64_t BatchSize = 500;
+		typedef Poco::Tuple<std::string, std::uint64_t, std::string, std::string> PayloadRowTuple;
+
+		StorageCursor Cursor;
+		std::uint64_t Rows = 0, Compressed = 0;
+		poco_information(Logger(), fmt::format("Compressing stored payloads in {}.", Table));
+		try {
+			while (Running && !Cursor.Done) {
+				Poco::Data::Session Sess(Pool_->get());
+				std::vector<PayloadRowTuple> Records;
+				std::vector<std::uint64_t> RowIds;
+				{
+					Poco::Data::Statement Select(Sess);
+					auto Seek = Cursor.Seeks(HasRowId(Table));
+					std::string St{"SELECT T.SerialNumber, T.Recorded, T.Data, "
+								   "COALESCE(D.Compatible,''), " +
+								   std::string(Seek ? "T.rowid" : "0") + " FROM " + Table +
+								   " T LEFT JOIN Devices D ON T.SerialNumber=D.SerialNumber "};
+					if (Seek && Cursor.Started)
+						St += " WHERE " + Cursor.AfterRecorded(false, "T.");
+					Select << St +
+								  (Seek ? " ORDER BY T.Recorded ASC, T.rowid ASC " +
+											  ComputeRange(0, BatchSize)
+										: " ORDER BY T.Recorded ASC " +
+											  ComputeRange(Cursor.Offset, BatchSize)),
+						Poco::Data::Keywords::into(Records), Poco::Data::Keywords::into(RowIds);
+					Select.execute();
+				}
+				Cursor.AdvanceOnRecorded(Records, RowIds, BatchSize,
+										 [](const PayloadRowTuple &R) { return R.get<1>(); });
+
+				Sess.begin();
+				for (auto &i : Records) {
+					Rows++;
+					if (PayloadCodec::IsEncoded(i.get<2>()))
+						continue;
+					auto Encoded = Codec_.Encode(i.get<3>(), i.get<2>());
+					if (Encoded == i.get<2>())
+						continue;
+					Poco::Data::Statement Update(Sess);
+					std::string St{"UPDATE " + Table +
+								   " SET Data=? WHERE SerialNumber=? AND Recorded=? AND Data=?"};
+					Update << ConvertParams(St), Poco::Data::Keywords::use(Encoded),
+						Poco::Data::Keywords::use(i.get<0>()), Poco::Data::Keywords::use(i.get<1>()),
+						Poco::Data::Keywords::use(i.get<2>());
+					Update.execute();
+					Compressed++;
+				}
+				Sess.commit();
+				Poco::Thread::trySleep(100);
+			}
+			poco_information(Logger(),
+							 fmt::format("Compressed {} of {} stored payloads in {}.{}", Compressed,
+										 Rows, Table, Cursor.Done ? "" : " Interrupted."));
+			return Cursor.Done;
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,98 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "Poco/JSON/Object.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+
+namespace OpenWifi {
+
+	//	Compresses the JSON payloads kept in the Statistics and HealthChecks tables. Payloads of
+	//	one device model share most of their keys and layout, so each model gets a deflate preset
+	//	dictionary built from its first payloads. Stored values look like "~z1:<size>:<base64>".
+	//	Anything else is a plain payload and is returned as is, so old rows keep working.
+	class PayloadCodec {
+	  public:
+		static constexpr const char *Prefix = "~z1:";
+		static constexpr std::size_t MaxDictionarySize = 32768; //	deflate window
+		static constexpr std::size_t MinPayloadSize = 128;
+		static constexpr std::size_t MaxPayloadSize = 64 * 1024 * 1024;
+
+		struct Dictionary {
+			std::uint32_t Id = 0; //	adler32 of Content, also written in the deflate header
+			std::string Model;
+			std::uint64_t Created = 0;
+			std::string Content;
+		};
+
+		using SaveFunction = std::function<bool(const Dictionary &)>;
+		using FetchFunction = std::function<bool(std::uint32_t, Dictionary &)>;
+
+		void Configure(bool Enabled, std::uint64_t Samples, int Level, SaveFunction Save,
+					   FetchFunction Fetch);
+		//	Dictionaries loaded at startup. The newest one of a model is used to encode.
+		void AddDictionary(const Dictionary &D);
+
+		[[nodiscard]] inline bool Enabled() const { return Enabled_; }
+		[[nodiscard]] static inline bool IsEncoded(const std::string &S) {
+			return S.compare(0, 4, Prefix) == 0;
+		}
+
+		//	Returns Payload untouched when compression is off or does not pay.
+		[[nodiscard]] std::string Encode(const std::string &Model, const std::string &Payload);
+		//	False when the payload is corrupt or its dictionary cannot be found: the caller must
+		//	not hand out a made up payload.
+		[[nodiscard]] bool Decode(const std::string &Stored, std::string &Payload);
+
+		void GetStatistics(Poco::JSON::Object &Obj) const;
+
+	  private:
+		bool Enabled_ = false;
+		std::uint64_t SampleCount_ = 16;
+		int Level_ = 6;
+		SaveFunction Save_;
+		FetchFunction Fetch_;
+
+		mutable std::shared_mutex Mutex_;
+		std::map<std::string, std::shared_ptr<const Dictionary>> ByModel_;
+		std::map<std::uint32_t, std::shared_ptr<const Dictionary>> ById_;
+
+		std::mutex TrainingMutex_;
+		std::map<std::string, std::vector<std::string>> Samples_;
+
+		std::atomic_uint64_t Encoded_ = 0, Decoded_ = 0, Failures_ = 0, BytesIn_ = 0,
+							 BytesOut_ = 0;
+
+		std::shared_ptr<const Dictionary> ForModel(const std::string &Model);
+		std::shared_ptr<const Dictionary> ForId(std::uint32_t Id);
+		std::shared_ptr<const Dictionary> Train(const std::string &Model,
+												const std::string &Payload);
+		void Insert(const std::shared_ptr<const Dictionary> &D);
+	};
+
+	//	Rewrites the rows stored before compression was turned on, oldest first.
+	class PayloadMigrator : public Poco::Runnable {
+	  public:
+		void Start();
+		void Stop();
+		void run() final;
+
+	  private:
+		Poco::Thread Worker_;
+		std::atomic_bool Running_ = false;
+	};
+
+} // namespace OpenWifi
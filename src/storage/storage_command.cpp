@@ -102,9 +102,65 @@ namespace OpenWifi {
 		R.set<20>(Command.deferred);
 	}
 
+	class PreparedRemoveOldCommands : public PreparedStatement {
+	  public:
+		explicit PreparedRemoveOldCommands(Poco::Data::Session &Session) : Delete(Session) {
+			Delete << StorageService()->ConvertParams(
+						  "delete from CommandList where SerialNumber=? and command=? and completed=0"),
+				Poco::Data::Keywords::use(SerialNumber), Poco::Data::Keywords::use(Command);
+		}
+		std::string SerialNumber, Command;
+		Poco::Data::Statement Delete;
+	};
+
+	class PreparedAddCommand : public PreparedStatement {
+	  public:
+		explicit PreparedAddCommand(Poco::Data::Session &Session) : Insert(Session) {
+			Insert << StorageService()->ConvertParams("INSERT INTO CommandList ( " +
+													  DB_Command_SelectFields + " ) VALUES( " +
+													  DB_Command_InsertValues + " )"),
+				Poco::Data::Keywords::use(R);
+		}
+		CommandDetailsRecordTuple R;
+		Poco::Data::Statement Insert;
+	};
+
+	class PreparedSetCommandResult : public PreparedStatement {
+	  public:
+		explicit PreparedSetCommandResult(Poco::Data::Session &Session) : Update(Session) {
+			Update << StorageService()->ConvertParams(
+						  "UPDATE CommandList SET Completed=?, Results=?, Status=? WHERE UUID=?"),
+				Poco::Data::Keywords::use(Completed), Poco::Data::Keywords::use(Results),
+				Poco::Data::Keywords::use(Status), Poco::Data::Keywords::use(UUID);
+		}
+		std::uint64_t Completed = 0;
+		std::string Results, Status, UUID;
+		Poco::Data::Statement Update;
+	};
+
 	bool Storage::RemoveOldCommands(std::string &SerialNumber, std::string &Command) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
+			return RemoveOldCommands(Sess, SerialNumber, Command, nullptr);
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+		return false;
+	}
+
+	bool Storage::RemoveOldCommands(Poco::Data::Session &Sess, std::string &SerialNumber,
+									std::string &Command, PreparedStatementCache *Prepared) {
+		auto Cached =
+			GetPrepared<PreparedRemoveOldCommands>(Prepared, PreparedQuery::RemoveOldCommands, Sess);
+		QueryTimer Timer(QueryStats(PreparedQuery::RemoveOldCommands), Cached != nullptr);
+		try {
+			if (Cached != nullptr) {
+				Cached->SerialNumber = SerialNumber;
+				Cached->Command = Command;
+				Cached->Delete.execute();
+				return true;
+			}
+
 			Sess.begin();
 			Poco::Data::Statement Delete(Sess);
 
@@ -116,6 +172,9 @@ namespace OpenWifi {
 			Sess.commit();
 			return true;
 		} catch (const Poco::Exception &E) {
+			Timer.Failed();
+			if (Cached != nullptr)
+				Prepared->Invalidate(PreparedQuery::RemoveOldCommands);
 			Logger().log(E);
 		}
 		return false;
@@ -123,6 +182,9 @@ namespace OpenWifi {
 
 	bool Storage::AddCommand(std::string &SerialNumber, GWObjects::CommandDetails &Command,
 							 CommandExecutionType Type) {
+		auto Prepared = PreparedSession();
+		QueryTimer Timer(QueryStats(PreparedQuery::AddCommand), Prepared != nullptr);
+		PreparedStatementCache *Cache = nullptr;
 		try {
 			auto Now = Utils::Now();
 
@@ -143,6 +205,17 @@ namespace OpenWifi {
 				Command.Completed = Now;
 			}
 
+			if (Prepared != nullptr) {
+				std::lock_guard Lock(Prepared->Mutex());
+				auto &Sess = Prepared->Session();
+				Cache = &Prepared->Prepared();
+				RemoveOldCommands(Sess, SerialNumber, Command.Command, Cache);
+				auto &Insert = Cache->Get<PreparedAddCommand>(PreparedQuery::AddCommand, Sess);
+				ConvertCommandRecord(Command, Insert.R);
+				Insert.Insert.execute();
+				return true;
+			}
+
 			RemoveOldCommands(SerialNumber, Command.Command);
 
 			Poco::Data::Session Sess = Pool_->get();
@@ -161,6 +234,9 @@ namespace OpenWifi {
 			return true;
 
 		} catch (const Poco::Exception &E) {
+			Timer.Failed();
+			if (Cache != nullptr)
+				Cache->Invalidate(PreparedQuery::AddCommand);
 			Logger().log(E);
 		}
 		return false;
@@ -169,48 +245,62 @@ namespace OpenWifi {
 	bool Storage::GetCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 							  uint64_t Offset, uint64_t HowMany,
 							  std::vector<GWObjects::CommandDetails> &Commands) {
-		try {
-			CommandDetailsRecordList Records;
-			Poco::Data::Session Sess = Pool_->get();
-
-			bool DatesIncluded = (FromDate != 0 || ToDate != 0);
-
-			std::string Fields{"SELECT " + DB_Command_SelectFields + " FROM CommandList "};
-
-			std::string IntroStatement = SerialNumber.empty()
-											 ? Fields + std::string(DatesIncluded ? "WHERE " : "")
-											 : Fields + "WHERE SerialNumber='" + SerialNumber +
-												   "'" + std::string(DatesIncluded ? " AND " : "");
-
-			std::string DateSelector;
-			if (FromDate && ToDate) {
-				DateSelector = " Submitted>=" + std::to_string(FromDate) +
-							   " AND Submitted<=" + std::to_string(ToDate);
-			} else if (FromDate) {
-				DateSelector = " Submitted>=" + std::to_string(FromDate);
-			} else if (ToDate) {
-				DateSelector = " Submitted<=" + std::to_string(ToDate);
-			}
-
-			Poco::Data::Statement Select(Sess);
+		return StreamCommands(SerialNumber, FromDate, ToDate, Offset, HowMany,
+							  [&Commands](const GWObjects::CommandDetails &C) {
+								  Commands.push_back(C);
+								  return true;
+							  });
+	}
 
-			std::string FullQuery = IntroStatement + DateSelector + " ORDER BY Submitted ASC " +
-									ComputeRange(Offset, HowMany);
+	bool Storage::StreamCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+								 uint64_t Offset, uint64_t HowMany,
+								 const RowFunction<GWObjects::CommandDetails> &Row) {
+		bool DatesIncluded = (FromDate != 0 || ToDate != 0);
+
+		std::string Fields{"SELECT " + DB_Command_SelectFields + " FROM CommandList "};
+
+		std::string IntroStatement = SerialNumber.empty()
+										 ? Fields + std::string(DatesIncluded ? "WHERE " : "")
+										 : Fields + "WHERE SerialNumber='" + SerialNumber + "'" +
+											   std::string(DatesIncluded ? " AND " : "");
+
+		std::string DateSelector;
+		if (FromDate && ToDate) {
+			DateSelector = " Submitted>=" + std::to_string(FromDate) +
+						   " AND Submitted<=" + std::to_string(ToDate);
+		} else if (FromDate) {
+			DateSelector = " Submitted>=" + std::to_string(FromDate);
+		} else if (ToDate) {
+			DateSelector = " Submitted<=" + std::to_string(ToDate);
+		}
 
-			Select << FullQuery, Poco::Data::Keywords::into(Records);
-			Select.execute();
-			for (const auto &i : Records) {
-				GWObjects::CommandDetails R;
-				ConvertCommandRecord(i, R);
-				Commands.push_back(R);
+		return StreamPages(Offset, HowMany, Row,
+						   [&](std::uint64_t From, std::uint64_t Count,
+							   std::vector<GWObjects::CommandDetails> &Page, std::uint64_t &Read) {
+			try {
+				return ReadQuery([&](PooledSession &Sess) {
+					CommandDetailsRecordList Records;
+					Poco::Data::Statement Select(Sess);
+					Select << IntroStatement + DateSelector + " ORDER BY Submitted ASC " +
+								  ComputeRange(From, Count),
+						Poco::Data::Keywords::into(Records);
+					Select.execute();
+
+					std::vector<GWObjects::CommandDetails> Batch;
+					for (const auto &i : Records) {
+						GWObjects::CommandDetails R;
+						ConvertCommandRecord(i, R);
+						Batch.emplace_back(std::move(R));
+					}
+					Page = std::move(Batch);
+					Read = Records.size();
+					return true;
+				});
+			} catch (const Poco::Exception &E) {
+				Logger().log(E);
 			}
-			Select.reset(Sess);
-
-			return true;
-		} catch (const Poco::Exception &E) {
-			Logger().log(E);
-		}
-		return false;
+			return false;
+		});
 	}
 
 	bool Storage::DeleteCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate) {
@@ -438,14 +528,10 @@ namespace OpenWifi {
 
 			std::string St{"DELETE FROM CommandList WHERE UUID=?"};
 
-			Delete << ConvertParams(St), Poco::Data::Keywords::use(UUID);
-			Delete.execute();
-			Delete.reset(Sess);
-			St = "DELETE FROM FileUploads WHERE UUID=?";
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(UUID);
 			Delete.execute();
 			Sess.commit();
-			return true;
+			return RemoveAttachedFile(UUID);
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
@@ -455,24 +541,60 @@ namespace OpenWifi {
 	bool Storage::GetNewestCommands(std::string &SerialNumber, uint64_t HowMany,
 									std::vector<GWObjects::CommandDetails> &Commands) {
 		try {
-			CommandDetailsRecordList Records;
+			return ReadQuery([&](PooledSession &Sess) {
+				CommandDetailsRecordList Records;
+
+				Poco::Data::Statement Select(Sess);
+
+				std::string st{"SELECT " + DB_Command_SelectFields +
+							   " FROM CommandList WHERE SerialNumber=? ORDER BY Submitted DESC " +
+							   ComputeRange(0, HowMany)};
+				Select << ConvertParams(st), Poco::Data::Keywords::into(Records),
+					Poco::Data::Keywords::use(SerialNumber);
+				Select.execute();
+
+				std::vector<GWObjects::CommandDetails> Newest;
+				for (const auto &record : Records) {
+					GWObjects::CommandDetails R;
+					ConvertCommandRecord(record, R);
+					Newest.push_back(R);
+				}
+				Select.reset(Sess);
+				Commands.insert(Commands.end(), Newest.begin(), Newest.end());
+				return true;
+			});
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+		return false;
+	}
+
+	bool Storage::GetReadyToExecuteCommands(uint64_t Offset, uint64_t HowMany,
+											std::vector<GWObjects::CommandDetails> &Commands) {
 
+		try {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select(Sess);
 
-			std::string st{"SELECT " + DB_Command_SelectFields +
-						   " FROM CommandList WHERE SerialNumber=? ORDER BY Submitted DESC " +
-						   ComputeRange(0, HowMany)};
-			Select << ConvertParams(st), Poco::Data::Keywords::into(Records),
-				Poco::Data::Keywords::use(SerialNumber);
+			auto Now = Utils::Now();
+			std::string St{"SELECT " + DB_Command_SelectFields +
+						   " FROM CommandList "
+						   " WHERE ((RunAt<=?) And (Executed=0) And (LastTry=0 or (" +
+						   std::to_string(Now) + "-LastTry)>" +
+						   std::to_string(CommandManager()->CommandRetry()) +
+						   ")) ORDER BY Submitted ASC "};
+			CommandDetailsRecordList Records;
+
+			std::string SS = ConvertParams(St) + ComputeRange(Offset, HowMany);
+			Select << SS, Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(Now);
 			Select.execute();
 
 			for (const auto &record : Records) {
 				GWObjects::CommandDetails R;
 				ConvertCommandRecord(record, R);
-				Commands.push_back(R);
+				if (AP_WS_Server()->Connected(Utils::SerialNumberToInt(R.SerialNumber)))
+					Commands.push_back(R);
 			}
-			Select.reset(Sess);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -480,7 +602,9 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::GetReadyToExecuteCommands(uint64_t Offset, uint64_t HowMany,
+	//	Commands leave this listing as soon as they are executed, so an offset would skip the ones
+	//	that slid into the pages already read. Seek on (Submitted, UUID) instead.
+	bool Storage::GetReadyToExecuteCommands(StorageCursor &Cursor, uint64_t HowMany,
 											std::vector<GWObjects::CommandDetails> &Commands) {
 
 		try {
@@ -492,14 +616,26 @@ namespace OpenWifi {
 						   " FROM CommandList "
 						   " WHERE ((RunAt<=?) And (Executed=0) And (LastTry=0 or (" +
 						   std::to_string(Now) + "-LastTry)>" +
-						   std::to_string(CommandManager()->CommandRetry()) +
-						   ")) ORDER BY Submitted ASC "};
+						   std::to_string(CommandManager()->CommandRetry()) + "))" +
+						   (Cursor.Started ? " And (Submitted>? or (Submitted=? And UUID>?))" : "") +
+						   " ORDER BY Submitted ASC, UUID ASC "};
 			CommandDetailsRecordList Records;
 
-			std::string SS = ConvertParams(St) + ComputeRange(Offset, HowMany);
-			Select << SS, Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(Now);
+			std::string SS = ConvertParams(St) + ComputeRange(0, HowMany);
+			if (Cursor.Started) {
+				Select << SS, Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(Now),
+					Poco::Data::Keywords::use(Cursor.Recorded),
+					Poco::Data::Keywords::use(Cursor.Recorded), Poco::Data::Keywords::use(Cursor.Key);
+			} else {
+				Select << SS, Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(Now);
+			}
 			Select.execute();
 
+			Cursor.AdvanceOnKey(Records, HowMany,
+								[](const CommandDetailsRecordTuple &R) { return R.get<0>(); });
+			if (!Cursor.Done)
+				Cursor.Recorded = Records.back().get<8>();
+
 			for (const auto &record : Records) {
 				GWObjects::CommandDetails R;
 				ConvertCommandRecord(record, R);
@@ -636,12 +772,11 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::AttachFileDataToCommand(std::string &UUID, const std::stringstream &FileContent,
-										  const std::string &Type) {
+	bool Storage::AttachFileDataToCommand(std::string &UUID, const std::string &FileHash,
+										  std::uint64_t Size, const std::string &Type) {
 		try {
 			auto Now = Utils::Now();
 			uint64_t WaitForFile = 0;
-			uint64_t Size = FileContent.str().size();
 
 			Poco::Data::Session Sess = Pool_->get();
 			Sess.begin();
@@ -657,46 +792,47 @@ namespace OpenWifi {
 			Statement << ConvertParams(StatementStr), Poco::Data::Keywords::use(WaitForFile),
 				Poco::Data::Keywords::use(Now), Poco::Data::Keywords::use(Size),
 				Poco::Data::Keywords::use(UUID);
-			Statement.execute();
-			Sess.commit();
-			if (Size < FileUploader()->MaxSize()) {
-
-				Poco::Data::BLOB TheBlob;
+			try {
+				Statement.execute();
 
-				TheBlob.appendRaw((const unsigned char *)FileContent.str().c_str(),
-								  FileContent.str().size());
-				Sess.begin();
 				Poco::Data::Statement Insert(Sess);
-				std::string FileType{Type};
+				std::string FileType{Type}, Hash{FileHash};
 
-				std::string St2{
-					"INSERT INTO FileUploads (UUID,Type,Created,FileContent) VALUES(?,?,?,?)"};
+				std::string St2{"INSERT INTO FileUploads (UUID,Type,Created,FileHash,FileSize) "
+								"VALUES(?,?,?,?,?)"};
 
 				Insert << ConvertParams(St2), Poco::Data::Keywords::use(UUID),
 					Poco::Data::Keywords::use(FileType), Poco::Data::Keywords::use(Now),
-					Poco::Data::Keywords::use(TheBlob);
+					Poco::Data::Keywords::use(Hash), Poco::Data::Keywords::use(Size);
 				Insert.execute();
 				Sess.commit();
-			} else {
-				poco_warning(Logger(), fmt::format("File {} is too large.", UUID));
+				return true;
+			} catch (...) {
+				//	neither row is kept unless both are written.
+				try {
+					Sess.rollback();
+				} catch (...) {
+				}
+				throw;
 			}
-			Sess.commit();
-			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
 		return false;
 	}
 
-	bool Storage::GetAttachedFileContent(std::string &UUID, const std::string &SerialNumber,
-										 std::string &FileContent, std::string &Type) {
+	bool Storage::GetAttachedFile(std::string &UUID, const std::string &SerialNumber,
+								  std::string &FileHash, std::string &FileContent,
+								  std::string &Type) {
 		try {
 			Poco::Data::BLOB L;
 			/*
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	BYTEA"
+						"FileContent	BYTEA, "
+						"FileHash		VARCHAR(64), "
+						"FileSize		BIGINT"
 			*/
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select1(Sess);
@@ -712,11 +848,22 @@ namespace OpenWifi {
 				return false;
 			}
 
-			std::string St2{"SELECT FileContent, Type FROM FileUploads WHERE UUID=?"};
+			std::string St2{"SELECT FileHash, Type FROM FileUploads WHERE UUID=?"};
 			Poco::Data::Statement Select2(Sess);
-			Select2 << ConvertParams(St2), Poco::Data::Keywords::into(L),
+			Select2 << ConvertParams(St2), Poco::Data::Keywords::into(FileHash),
 				Poco::Data::Keywords::into(Type), Poco::Data::Keywords::use(UUID);
 			Select2.execute();
+			if (Select2.rowsExtracted() == 0)
+				return false;
+			if (!FileHash.empty())
+				return true;
+
+			//	uploaded before the file store existed.
+			std::string St3{"SELECT FileContent FROM FileUploads WHERE UUID=?"};
+			Poco::Data::Statement Select3(Sess);
+			Select3 << ConvertParams(St3), Poco::Data::Keywords::into(L),
+				Poco::Data::Keywords::use(UUID);
+			Select3.execute();
 			FileContent.assign(L.content().begin(), L.content().end());
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -725,14 +872,54 @@ namespace OpenWifi {
 		return false;
 	}
 
+	void Storage::ReleaseStoredFiles(Poco::Data::Session &Sess,
+									 const std::vector<std::string> &Hashes) {
+		if (Hashes.empty())
+			return;
+		std::lock_guard G(FileUploader()->StoreMutex());
+		for (const auto &Hash : Hashes) {
+			try {
+				std::uint64_t Count = 0;
+				std::string H{Hash};
+				Poco::Data::Statement Select(Sess);
+				std::string St{"SELECT COUNT(*) FROM FileUploads WHERE FileHash=?"};
+				Select << ConvertParams(St), Poco::Data::Keywords::into(Count),
+					Poco::Data::Keywords::use(H);
+				Select.execute();
+				if (Count == 0)
+					FileUploader()->RemoveStoredFile(Hash);
+			} catch (const Poco::Exception &E) {
+				Logger().log(E);
+			}
+		}
+	}
+
 	bool Storage::SetCommandResult(std::string &UUID, std::string &Result) {
+		auto Prepared = PreparedSession();
+		QueryTimer Timer(QueryStats(PreparedQuery::SetCommandResult), Prepared != nullptr);
+		PreparedStatementCache *Cache = nullptr;
 		try {
+			auto Now = Utils::Now();
+			auto Status = to_string(Storage::CommandExecutionType::COMMAND_COMPLETED);
+
+			if (Prepared != nullptr) {
+				std::lock_guard Lock(Prepared->Mutex());
+				auto &Sess = Prepared->Session();
+				Cache = &Prepared->Prepared();
+				auto &Update =
+					Cache->Get<PreparedSetCommandResult>(PreparedQuery::SetCommandResult, Sess);
+				Update.Completed = Now;
+				Update.Results = Result;
+				Update.Status = Status;
+				Update.UUID = UUID;
+				Update.Update.execute();
+				return true;
+			}
+
 			Poco::Data::Session Sess = Pool_->get();
 			Sess.begin();
 			Poco::Data::Statement Update(Sess);
 
-			auto Now = Utils::Now();
-			auto Status = to_string(Storage::CommandExecutionType::COMMAND_COMPLETED);
 			std::string St{"UPDATE CommandList SET Completed=?, Results=?, Status=? WHERE UUID=?"};
 
 			Update << ConvertParams(St), Poco::Data::Keywords::use(Now),
@@ -743,6 +930,9 @@ namespace OpenWifi {
 			return true;
 
 		} catch (const Poco::Exception &E) {
+			Timer.Failed();
+			if (Cache != nullptr)
+				Cache->Invalidate(PreparedQuery::SetCommandResult);
 			Logger().log(E);
 		}
 		return false;
@@ -751,6 +941,14 @@ namespace OpenWifi {
 	bool Storage::RemoveAttachedFile(std::string &UUID) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
+
+			std::vector<std::string> Hashes;
+			Poco::Data::Statement Select(Sess);
+			std::string St1{"SELECT FileHash FROM FileUploads WHERE UUID=? AND FileHash IS NOT NULL"};
+			Select << ConvertParams(St1), Poco::Data::Keywords::into(Hashes),
+				Poco::Data::Keywords::use(UUID);
+			Select.execute();
+
 			Sess.begin();
 			Poco::Data::Statement Delete(Sess);
 
@@ -759,6 +957,7 @@ namespace OpenWifi {
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(UUID);
 			Delete.execute();
 			Sess.commit();
+			ReleaseStoredFiles(Sess, Hashes);
 			return true;
 
 		} catch (const Poco::Exception &E) {
@@ -770,6 +969,15 @@ namespace OpenWifi {
 	bool Storage::RemoveUploadedFilesRecordsOlderThan(uint64_t Date) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
+
+			std::vector<std::string> Hashes;
+			Poco::Data::Statement Select(Sess);
+			std::string St0{
+				"SELECT DISTINCT FileHash FROM FileUploads WHERE Created<? AND FileHash IS NOT NULL"};
+			Select << ConvertParams(St0), Poco::Data::Keywords::into(Hashes),
+				Poco::Data::Keywords::use(Date);
+			Select.execute();
+
 			Sess.begin();
 			Poco::Data::Statement Delete(Sess);
 
@@ -777,6 +985,7 @@ namespace OpenWifi {
 			Delete << ConvertParams(St1), Poco::Data::Keywords::use(Date);
 			Delete.execute();
 			Sess.commit();
+			ReleaseStoredFiles(Sess, Hashes);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -803,22 +1012,26 @@ namespace OpenWifi {
 
 	bool Storage::AnalyzeCommands(Types::CountedMap &R) {
 		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
+			return ReadQuery([&](PooledSession &Sess) {
+				//	counted on a copy: a query retried on the primary must not count twice.
+				auto Counts = R;
+				Poco::Data::Statement Select(Sess);
 
-			Select << "SELECT Command from CommandList";
-			Select.execute();
+				Select << "SELECT Command from CommandList";
+				Select.execute();
 
-			Poco::Data::RecordSet RSet(Select);
+				Poco::Data::RecordSet RSet(Select);
 
-			bool More = RSet.moveFirst();
-			while (More) {
-				auto Command = RSet[0].convert<std::string>();
-				if (!Command.empty())
-					UpdateCountedMap(R, Command);
-				More = RSet.moveNext();
-			}
-			return true;
+				bool More = RSet.moveFirst();
+				while (More) {
+					auto Command = RSet[0].convert<std::string>();
+					if (!Command.empty())
+						UpdateCountedMap(Counts, Command);
+					More = RSet.moveNext();
+				}
+				R = std::move(Counts);
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
@@ -0,0 +1,139 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Poco/Exception.h"
+#include "Poco/NumberParser.h"
+#include "Poco/StringTokenizer.h"
+
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	//	Position right after the last row of a page, for keyset (seek) pagination. Listings keyed
+	//	on a unique column only use Key. Listings ordered on Recorded, which is not unique, break
+	//	ties on the row id and keep it in Key: the next page starts right after (Recorded, Key).
+	//	On a table without a rowid column, listings on Recorded skip Offset rows instead.
+	struct StorageCursor {
+		std::string Key;
+		std::uint64_t Recorded = 0;
+		std::uint64_t Offset = 0;
+		bool ByOffset = false;
+		bool Started = false; //	false for the first page
+		bool Done = false;	  //	set when the last page was returned
+
+		//	Opaque token handed to REST clients. URL safe base64, no padding.
+		[[nodiscard]] inline std::string Encode() const {
+			if (Done)
+				return "";
+			auto Raw = ByOffset ? "3:" + std::to_string(Offset)
+								: "2:" + std::to_string(Recorded) + ":" + Key;
+			auto Token = Utils::base64encode((const Utils::byte *)Raw.c_str(), Raw.size());
+			while (!Token.empty() && Token.back() == '=')
+				Token.pop_back();
+			for (auto &c : Token) {
+				if (c == '+')
+					c = '-';
+				else if (c == '/')
+					c = '_';
+			}
+			return Token;
+		}
+
+		//	An empty token is the first page.
+		inline bool Decode(const std::string &Token) {
+			*this = StorageCursor{};
+			if (Token.empty())
+				return true;
+			try {
+				auto B64 = Token;
+				for (auto &c : B64) {
+					if (c == '-')
+						c = '+';
+					else if (c == '_')
+						c = '/';
+				}
+				while (B64.size() % 4)
+					B64 += '=';
+				auto Bytes = Utils::base64decode(B64);
+				std::string Raw(Bytes.begin(), Bytes.end());
+				auto P1 = Raw.find(':');
+				if (P1 != std::string::npos && Raw.substr(0, P1) == "3") {
+					ByOffset = Started = true;
+					return Poco::NumberParser::tryParseUnsigned64(Raw.substr(P1 + 1), Offset);
+				}
+				auto P2 = Raw.find(':', P1 + 1);
+				if (P1 == std::string::npos || P2 == std::string::npos || Raw.substr(0, P1) != "2")
+					return false;
+				if (!Poco::NumberParser::tryParseUnsigned64(Raw.substr(P1 + 1, P2 - P1 - 1),
+															 Recorded))
+					return false;
+				Key = Raw.substr(P2 + 1);
+				Started = true;
+				return true;
+			} catch (...) {
+			}
+			return false;
+		}
+
+		//	For listings on Recorded: true to seek on (Recorded, rowid), false to page with OFFSET.
+		//	A first page follows the table, a continuation token keeps the way it was made.
+		inline bool Seeks(bool TableHasRowId) {
+			if (!Started)
+				ByOffset = !TableHasRowId;
+			else if (!ByOffset && !TableHasRowId)
+				throw Poco::DataFormatException("Invalid cursor");
+			return !ByOffset;
+		}
+
+		//	Rows ordered on "Recorded, rowid" (both ASC or both DESC): the condition selecting the
+		//	rows after this cursor. Prefix qualifies the columns, as in "T.".
+		[[nodiscard]] inline std::string AfterRecorded(bool Descending,
+													   const std::string &Prefix = "") const {
+			std::uint64_t RowId = 0;
+			if (!Poco::NumberParser::tryParseUnsigned64(Key, RowId))
+				throw Poco::DataFormatException("Invalid cursor");
+			auto Op = Descending ? "<" : ">";
+			auto At = std::to_string(Recorded);
+			return "(" + Prefix + "Recorded" + Op + At + " OR (" + Prefix + "Recorded=" + At +
+				   " AND " + Prefix + "rowid" + Op + std::to_string(RowId) + "))";
+		}
+
+		//	For listings ordered on Recorded then rowid. RowIds holds the rowid of each record.
+		template <typename T, typename F>
+		inline void AdvanceOnRecorded(const std::vector<T> &Records,
+									  const std::vector<std::uint64_t> &RowIds,
+									  std::uint64_t HowMany, F GetRecorded) {
+			if (Records.size() < HowMany || Records.empty() || RowIds.size() != Records.size()) {
+				Done = true;
+				return;
+			}
+			if (ByOffset) {
+				Offset += Records.size();
+				Started = true;
+				return;
+			}
+			Recorded = GetRecorded(Records.back());
+			Key = std::to_string(RowIds.back());
+			Started = true;
+		}
+
+		//	For listings ordered on a unique key.
+		template <typename T, typename F>
+		inline void AdvanceOnKey(const std::vector<T> &Records, std::uint64_t HowMany, F GetKey) {
+			if (Records.size() < HowMany || Records.empty()) {
+				Done = true;
+				return;
+			}
+			Key = GetKey(Records.back());
+			Started = true;
+		}
+	};
+
+} // namespace OpenWifi
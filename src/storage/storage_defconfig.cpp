@@ -54,6 +54,41 @@ namespace OpenWifi {
 		T.set<6>(R.platform);
 	}
 
+	//	Serialized so an index published later never comes from an older read of the table.
+	bool Storage::RefreshDefaultConfigurationIndex() {
+		std::lock_guard G(DefaultConfigsRefreshMutex_);
+		try {
+			DefConfigRecordList Records;
+
+			Poco::Data::Session Sess = Pool_->get();
+			Poco::Data::Statement Select(Sess);
+
+			Select << "SELECT " + DB_DefConfig_SelectFields + " FROM DefaultConfigs",
+				Poco::Data::Keywords::into(Records);
+			Select.execute();
+
+			auto Index = std::make_shared<DefaultConfigIndex>();
+			for (const auto &Record : Records) {
+				auto C = std::make_shared<GWObjects::DefaultConfiguration>();
+				Convert(Record, *C);
+				Index->Add(C);
+			}
+
+			std::unique_lock Lock(DefaultConfigsMutex_);
+			DefaultConfigs_ = std::move(Index);
+			return true;
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
+	}
+
+	void Storage::RefreshDefaultConfigurationIndex([[maybe_unused]] Poco::Timer &timer) {
+		Utils::SetThreadName("defcfg-refresh");
+		RefreshDefaultConfigurationIndex();
+	}
+
 	bool Storage::CreateDefaultConfiguration(std::string &Name,
 											 GWObjects::DefaultConfiguration &DefConfig) {
 		try {
@@ -87,6 +122,7 @@ namespace OpenWifi {
 				Insert << ConvertParams(St), Poco::Data::Keywords::use(R);
 				Insert.execute();
 				Sess.commit();
+				RefreshDefaultConfigurationIndex();
 				return true;
 			} else {
 				poco_warning(Logger(), "Cannot create device: invalid configuration.");
@@ -111,6 +147,7 @@ namespace OpenWifi {
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(Name);
 			Delete.execute();
 			Sess.commit();
+			RefreshDefaultConfigurationIndex();
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -138,6 +175,7 @@ namespace OpenWifi {
 				Poco::Data::Keywords::use(Name);
 			Update.execute();
 			Sess.commit();
+			RefreshDefaultConfigurationIndex();
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -223,32 +261,20 @@ namespace OpenWifi {
 
 	bool Storage::FindDefaultConfigurationForModel(const std::string &DeviceModel, const std::string &Platform,
 												   GWObjects::DefaultConfiguration &Config) {
-		try {
-			DefConfigRecordList DefConfigs;
-
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
-
-			Select << "SELECT " + DB_DefConfig_SelectFields + " FROM DefaultConfigs",
-				Poco::Data::Keywords::into(DefConfigs);
-			Select.execute();
-
-			for (const auto &DefConfig : DefConfigs) {
-				GWObjects::DefaultConfiguration C;
-				Convert(DefConfig, C);
-				for (const auto &Model : C.models) {
-					if ((Model == "*" || Model == DeviceModel) && (Config.platform == Platform)){
-						Config = C;
-						return true;
-					}
-				}
+		//	refreshed by DefaultConfigsTimer_, never on the connect path.
+		std::shared_ptr<const DefaultConfigIndex> Index;
+		{
+			std::shared_lock Lock(DefaultConfigsMutex_);
+			Index = DefaultConfigs_;
+		}
+		if (Index != nullptr) {
+			if (auto C = Index->Find(Platform, DeviceModel); C != nullptr) {
+				Config = *C;
+				return true;
 			}
-			Logger().information(
-				fmt::format("AUTO-PROVISIONING: no default configuration for model:{}", DeviceModel));
-		} catch (const Poco::Exception &E) {
-			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
-											   E.displayText()));
 		}
+		Logger().information(
+			fmt::format("AUTO-PROVISIONING: no default configuration for model:{}", DeviceModel));
 		return false;
 	}
 
@@ -0,0 +1,62 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "RESTObjects/RESTAPI_GWobjects.h"
+#include "framework/ow_constants.h"
+
+namespace OpenWifi {
+
+	//	Auto-provisioning looks up the default configuration of every new device. The table is
+	//	kept in memory as (platform, model) -> configuration plus one "*" entry per platform. A
+	//	configuration listing the model wins over a wildcard, and within a key the lowest name
+	//	wins. An empty platform is an AP.
+	class DefaultConfigIndex {
+	  public:
+		using ConfigPtr = std::shared_ptr<const GWObjects::DefaultConfiguration>;
+
+		inline void Add(const ConfigPtr &C) {
+			const auto &Platform = PlatformOf(C->platform);
+			for (const auto &Model : C->models) {
+				if (Model == "*")
+					Keep(Wildcards_[Platform], C);
+				else
+					Keep(Models_[std::make_pair(Platform, Model)], C);
+			}
+		}
+
+		[[nodiscard]] inline ConfigPtr Find(const std::string &Platform,
+											const std::string &Model) const {
+			const auto &DevicePlatform = PlatformOf(Platform);
+			auto Hint = Models_.find(std::make_pair(DevicePlatform, Model));
+			if (Hint != Models_.end())
+				return Hint->second;
+			auto Wildcard = Wildcards_.find(DevicePlatform);
+			if (Wildcard != Wildcards_.end())
+				return Wildcard->second;
+			return nullptr;
+		}
+
+	  private:
+		std::map<std::pair<std::string, std::string>, ConfigPtr> Models_;
+		std::map<std::string, ConfigPtr> Wildcards_;
+
+		static inline const std::string &PlatformOf(const std::string &Platform) {
+			return Platform.empty() ? Platforms::AP : Platform;
+		}
+
+		static inline void Keep(ConfigPtr &Slot, const ConfigPtr &C) {
+			if (Slot == nullptr || C->name < Slot->name)
+				Slot = C;
+		}
+	};
+
+} // namespace OpenWifi
@@ -6,6 +6,9 @@
 //	Arilia Wireless Inc.
 //
 
+#include <array>
+#include <utility>
+
 #include "AP_WS_Server.h"
 #include "CapabilitiesCache.h"
 #include "CentralConfig.h"
@@ -174,18 +177,21 @@ namespace OpenWifi {
 
 	bool Storage::GetDeviceCount(uint64_t &Count, const std::string &platform) {
 		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
+			return ReadQuery([&](PooledSession &Sess) {
+				Poco::Data::Statement Select(Sess);
 
-			if(!platform.empty()) {
-				std::string st{"SELECT COUNT(*) FROM Devices WHERE DeviceType='" + platform + "'"};
-				Select << st, Poco::Data::Keywords::into(Count);
-			} else {
-				std::string st{"SELECT COUNT(*) FROM Devices"};
-				Select << st, Poco::Data::Keywords::into(Count);
-			}
-			Select.execute();
-			return true;
+				uint64_t Devices = 0;
+				if(!platform.empty()) {
+					std::string st{"SELECT COUNT(*) FROM Devices WHERE DeviceType='" + platform + "'"};
+					Select << st, Poco::Data::Keywords::into(Devices);
+				} else {
+					std::string st{"SELECT COUNT(*) FROM Devices"};
+					Select << st, Poco::Data::Keywords::into(Devices);
+				}
+				Select.execute();
+				Count = Devices;
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
@@ -197,38 +203,89 @@ namespace OpenWifi {
 										 const std::string &orderBy,
 										 const std::string &platform, bool includeProvisioned) {
 		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
+			return ReadQuery([&](PooledSession &Sess) {
+				Poco::Data::Statement Select(Sess);
 
-			std::string st;
-			std::string whereClause = "";
-			if(!platform.empty()) {
-				if (includeProvisioned == false) {
+				std::string st;
+				std::string whereClause = "";
+				if(!platform.empty()) {
+					if (includeProvisioned == false) {
+
+						whereClause = fmt::format("WHERE entity='' and venue='' and DeviceType='" + platform + "'");
+					} else {
+						whereClause = fmt::format("WHERE DeviceType='" + platform + "'");
+					}
 
-					whereClause = fmt::format("WHERE entity='' and venue='' and DeviceType='" + platform + "'");
+
+					//st = "SELECT SerialNumber From Devices WHERE DeviceType='" + platform + "' ";
 				} else {
-					whereClause = fmt::format("WHERE DeviceType='" + platform + "'");
+					if (includeProvisioned == false) {
+						whereClause = fmt::format("WHERE entity='' and venue=''");
+					}
+					//st = "SELECT SerialNumber From Devices ";
 				}
-			
 
-				//st = "SELECT SerialNumber From Devices WHERE DeviceType='" + platform + "' ";
-			} else {
-				if (includeProvisioned == false) {
-					whereClause = fmt::format("WHERE entity='' and venue=''");
-				}
-				//st = "SELECT SerialNumber From Devices ";
-			}
-			
-			st = fmt::format("SELECT SerialNumber From Devices {}", whereClause);
+				st = fmt::format("SELECT SerialNumber From Devices {}", whereClause);
 
-			if (orderBy.empty())
-				st += " ORDER BY SerialNumber ASC ";
-			else
-				st += orderBy;
+				if (orderBy.empty())
+					st += " ORDER BY SerialNumber ASC ";
+				else
+					st += orderBy;
 
-			Select << st + ComputeRange(From, HowMany), Poco::Data::Keywords::into(SerialNumbers);
-			Select.execute();
-			return true;
+				//	into a local list, a query retried on the primary must not append twice.
+				std::vector<std::string> Records;
+				Select << st + ComputeRange(From, HowMany), Poco::Data::Keywords::into(Records);
+				Select.execute();
+				SerialNumbers.insert(SerialNumbers.end(), Records.begin(), Records.end());
+				return true;
+			});
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+		return false;
+	}
+
+	//	Filter shared by the keyset device listings.
+	static std::string DeviceListConditions(const std::string &platform, bool includeProvisioned,
+											bool After) {
+		std::vector<std::string> Conditions;
+		if (!platform.empty())
+			Conditions.emplace_back("DeviceType='" + platform + "'");
+		if (!includeProvisioned)
+			Conditions.emplace_back("entity='' and venue=''");
+		if (After)
+			Conditions.emplace_back("SerialNumber>?");
+		std::string Where;
+		for (std::size_t i = 0; i < Conditions.size(); ++i)
+			Where += (i == 0 ? " WHERE " : " AND ") + Conditions[i];
+		return Where;
+	}
+
+	bool Storage::GetDeviceSerialNumbers(StorageCursor &Cursor, uint64_t HowMany,
+										 std::vector<std::string> &SerialNumbers,
+										 const std::string &platform, bool includeProvisioned) {
+		try {
+			return ReadQuery([&](PooledSession &Sess) {
+				Poco::Data::Statement Select(Sess);
+
+				std::vector<std::string> Records;
+				auto st = ConvertParams("SELECT SerialNumber From Devices " +
+										DeviceListConditions(platform, includeProvisioned,
+															 Cursor.Started) +
+										" ORDER BY SerialNumber ASC ") +
+						  ComputeRange(0, HowMany);
+				if (Cursor.Started) {
+					Select << st, Poco::Data::Keywords::into(Records),
+						Poco::Data::Keywords::use(Cursor.Key);
+				} else {
+					Select << st, Poco::Data::Keywords::into(Records);
+				}
+				Select.execute();
+
+				Cursor.AdvanceOnKey(Records, HowMany, [](const std::string &S) { return S; });
+				SerialNumbers.insert(SerialNumbers.end(), Records.begin(), Records.end());
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
@@ -454,6 +511,47 @@ namespace OpenWifi {
 		return false;
 	}
 
+	void Storage::QueueDeviceLastRecordedContact(const std::string &SerialNumber,
+												 std::uint64_t lastRecordedContact) {
+		PendingLastContacts_.Queue(SerialNumber, lastRecordedContact);
+	}
+
+	void Storage::FlushLastContacts([[maybe_unused]] Poco::Timer &timer) { FlushLastContacts(); }
+
+	//	See LastContactBatch for the statement.
+	void Storage::FlushLastContacts() {
+		std::lock_guard FlushGuard(LastContactsFlushMutex_);
+		auto Contacts = PendingLastContacts_.Take();
+		if (Contacts.empty())
+			return;
+
+		QueryTimer Timer(LastContactFlushes_, false);
+		LastContactBatch Batch;
+		LastContactQueue::Contacts::const_iterator Next = Contacts.begin(), Unwritten = Next;
+		try {
+			Poco::Data::Session Sess = Pool_->get();
+			while (Next != Contacts.end()) {
+				Unwritten = Next;
+				Batch.Fill(Next, Contacts.end());
+				Sess.begin();
+				Poco::Data::Statement Update(Sess);
+				Update << ConvertParams(Batch.Query());
+				Batch.Bind(Update);
+				Update.execute();
+				Sess.commit();
+				LastContactsWritten_ += Batch.Serials.size();
+			}
+			return;
+		} catch (const Poco::Exception &E) {
+			Timer.Failed();
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+
+		//	keep what was not written for the next flush.
+		PendingLastContacts_.Restore(Unwritten, Contacts.cend());
+	}
+
 	bool Storage::CreateDevice(Poco::Data::Session &Sess, GWObjects::Device &DeviceDetails) {
 		std::string SerialNumber;
 		try {
@@ -752,19 +850,62 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::GetDevice(Poco::Data::Session &Session, const std::string &SerialNumber, GWObjects::Device &DeviceDetails) {
+	//	SELECT one device by serial number, bound to its own key and record.
+	class PreparedGetDevice : public PreparedStatement {
+	  public:
+		explicit PreparedGetDevice(Poco::Data::Session &Session) : Select(Session) {
+			Select << StorageService()->ConvertParams("SELECT " + DB_DeviceSelectFields +
+													  " FROM Devices WHERE SerialNumber=?"),
+				Poco::Data::Keywords::into(R), Poco::Data::Keywords::use(SerialNumber);
+		}
+		std::string SerialNumber;
+		DeviceRecordTuple R;
+		Poco::Data::Statement Select;
+	};
+
+	class PreparedUpdateDevice : public PreparedStatement {
+	  public:
+		explicit PreparedUpdateDevice(Poco::Data::Session &Session) : Update(Session) {
+			Update << StorageService()->ConvertParams("UPDATE Devices SET " +
+													  DB_DeviceUpdateFields +
+													  " WHERE SerialNumber=?"),
+				Poco::Data::Keywords::use(R), Poco::Data::Keywords::use(SerialNumber);
+		}
+		DeviceRecordTuple R;
+		std::string SerialNumber;
+		Poco::Data::Statement Update;
+	};
+
+	bool Storage::GetDevice(Poco::Data::Session &Session, const std::string &SerialNumber, GWObjects::Device &DeviceDetails,
+							PreparedStatementCache *Prepared) {
+		auto Cached = GetPrepared<PreparedGetDevice>(Prepared, PreparedQuery::GetDevice, Session);
+		QueryTimer Timer(QueryStats(PreparedQuery::GetDevice), Cached != nullptr);
 		try {
+			if (Cached != nullptr) {
+				Cached->SerialNumber = SerialNumber;
+				Cached->Select.execute();
+				if (Cached->Select.rowsExtracted() == 0)
+					return false;
+				ConvertDeviceRecord(Cached->R, DeviceDetails);
+				return true;
+			}
+
 			Poco::Data::Statement Select(Session);
-			std::string St = fmt::format("SELECT {} FROM Devices WHERE SerialNumber='{}'", DB_DeviceSelectFields, SerialNumber);
+			std::string St{"SELECT " + DB_DeviceSelectFields + " FROM Devices WHERE SerialNumber=?"};
 
 			DeviceRecordTuple R;
-			Select << St, Poco::Data::Keywords::into(R);
+			std::string Serial{SerialNumber};
+			Select << ConvertParams(St), Poco::Data::Keywords::into(R),
+				Poco::Data::Keywords::use(Serial);
 			Select.execute();
 			if (Select.rowsExtracted() == 0)
 				return false;
 			ConvertDeviceRecord(R, DeviceDetails);
 			return true;
 		} catch (const Poco::Exception &E) {
+			Timer.Failed();
+			if (Cached != nullptr)
+				Prepared->Invalidate(PreparedQuery::GetDevice);
 			Logger().log(E);
 		}
 		return false;
@@ -772,6 +913,9 @@ namespace OpenWifi {
 
 	bool Storage::GetDevice(const std::string &SerialNumber, GWObjects::Device &DeviceDetails) {
 		try {
+			auto Prepared = PreparedSession();
+			if (Prepared != nullptr)
+				return GetDevice(*Prepared, SerialNumber, DeviceDetails);
 			auto Sess = Pool_->get();
 			return GetDevice(Sess, SerialNumber, DeviceDetails);
 		} catch (const Poco::Exception &E) {
@@ -783,7 +927,7 @@ namespace OpenWifi {
 	bool Storage::GetDevice(LockedDbSession &Session, const std::string &SerialNumber, GWObjects::Device &DeviceDetails) {
 		try {
 			std::lock_guard		Lock(Session.Mutex());
-			return GetDevice(Session.Session(), SerialNumber, DeviceDetails);
+			return GetDevice(Session.Session(), SerialNumber, DeviceDetails, &Session.Prepared());
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
@@ -815,6 +959,9 @@ namespace OpenWifi {
 
 	bool Storage::UpdateDevice(GWObjects::Device &NewDeviceDetails) {
 		try {
+			auto Prepared = PreparedSession();
+			if (Prepared != nullptr)
+				return UpdateDevice(*Prepared, NewDeviceDetails);
 			Poco::Data::Session Sess = Pool_->get();
 			return UpdateDevice(Sess, NewDeviceDetails);
 		} catch (const Poco::Exception &E) {
@@ -826,23 +973,32 @@ namespace OpenWifi {
 	bool Storage::UpdateDevice(LockedDbSession &Session, GWObjects::Device &NewDeviceDetails) {
 		try {
 			std::lock_guard Lock(Session.Mutex());
-			return UpdateDevice(Session.Session(), NewDeviceDetails);
+			return UpdateDevice(Session.Session(), NewDeviceDetails, &Session.Prepared());
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
 		return false;
 	}
 
-	bool Storage::UpdateDevice(Poco::Data::Session &Sess, GWObjects::Device &NewDeviceDetails) {
+	bool Storage::UpdateDevice(Poco::Data::Session &Sess, GWObjects::Device &NewDeviceDetails,
+							   PreparedStatementCache *Prepared) {
+		auto Cached = GetPrepared<PreparedUpdateDevice>(Prepared, PreparedQuery::UpdateDevice, Sess);
+		QueryTimer Timer(QueryStats(PreparedQuery::UpdateDevice), Cached != nullptr);
 		try {
+			NewDeviceDetails.modified = Utils::Now();
+			// NewDeviceDetails.LastConfigurationChange = Utils::Now();
+			if (Cached != nullptr) {
+				ConvertDeviceRecord(NewDeviceDetails, Cached->R);
+				Cached->SerialNumber = NewDeviceDetails.SerialNumber;
+				Cached->Update.execute();
+				return true;
+			}
+
 			Sess.begin();
 			Poco::Data::Statement Update(Sess);
 
 			DeviceRecordTuple R;
-
-			NewDeviceDetails.modified = Utils::Now();
 			ConvertDeviceRecord(NewDeviceDetails, R);
-			// NewDeviceDetails.LastConfigurationChange = Utils::Now();
 			std::string St2{"UPDATE Devices SET " + DB_DeviceUpdateFields +
 							" WHERE SerialNumber=?"};
 			Update << ConvertParams(St2), Poco::Data::Keywords::use(R),
@@ -852,6 +1008,78 @@ namespace OpenWifi {
 			// GetDevice(NewDeviceDetails.SerialNumber,NewDeviceDetails);
 			return true;
 		} catch (const Poco::Exception &E) {
+			Timer.Failed();
+			if (Cached != nullptr)
+				Prepared->Invalidate(PreparedQuery::UpdateDevice);
+			Logger().log(E);
+		}
+		return false;
+	}
+
+	//	Column of each DeviceRecordTuple element, in the same order.
+	const static std::array<const char *, 31> DB_DeviceColumns{
+		"SerialNumber", "DeviceType", "MACAddress", "Manufacturer", "Configuration", "Notes",
+		"Owner", "Location", "Firmware", "Compatible", "FWUpdatePolicy", "UUID",
+		"CreationTimestamp", "LastConfigurationChange", "LastConfigurationDownload",
+		"LastFWUpdate", "Venue", "DevicePassword", "subscriber", "entity", "modified", "locale",
+		"restrictedDevice", "pendingConfiguration", "pendingConfigurationCmd",
+		"restrictionDetails", "pendingUUID", "simulated", "lastRecordedContact",
+		"certificateExpiryDate", "connectReason"};
+	constexpr static std::size_t DB_DeviceModifiedColumn = 20;
+
+	template <std::size_t... I>
+	static void ChangedDeviceColumns(const DeviceRecordTuple &Before, DeviceRecordTuple &After,
+									 std::string &Fields,
+									 std::vector<Poco::Data::AbstractBinding::Ptr> &Bindings,
+									 std::index_sequence<I...>) {
+		(
+			[&] {
+				if (I != DB_DeviceModifiedColumn && Before.get<I>() != After.get<I>()) {
+					Fields += std::string(DB_DeviceColumns[I]) + "=?, ";
+					Bindings.emplace_back(Poco::Data::Keywords::use(After.get<I>()));
+				}
+			}(),
+			...);
+	}
+
+	bool Storage::UpdateDevice(Poco::Data::Session &Sess, const GWObjects::Device &Original,
+							   GWObjects::Device &NewDeviceDetails, std::uint64_t &RowsWritten) {
+		QueryTimer Timer(QueryStats(PreparedQuery::UpdateDevice), false);
+		try {
+			DeviceRecordTuple Before, After;
+			ConvertDeviceRecord(Original, Before);
+			ConvertDeviceRecord(NewDeviceDetails, After);
+
+			std::string Fields;
+			std::vector<Poco::Data::AbstractBinding::Ptr> Bindings;
+			ChangedDeviceColumns(Before, After, Fields, Bindings,
+								 std::make_index_sequence<DB_DeviceColumns.size()>{});
+			if (Bindings.empty()) {
+				DeviceUpdatesSkipped_++;
+				return true;
+			}
+
+			NewDeviceDetails.modified = Utils::Now();
+			std::uint64_t Modified = NewDeviceDetails.modified;
+			std::string SerialNumber{Original.SerialNumber};
+
+			Sess.begin();
+			Poco::Data::Statement Update(Sess);
+			Update << ConvertParams("UPDATE Devices SET " + Fields +
+									"modified=? WHERE SerialNumber=?");
+			for (auto &Binding : Bindings)
+				Update.addBind(Binding);
+			Update.addBind(Poco::Data::Keywords::use(Modified));
+			Update.addBind(Poco::Data::Keywords::use(SerialNumber));
+			Update.execute();
+			Sess.commit();
+
+			DeviceUpdatesNarrow_++;
+			DeviceColumnsWritten_ += Bindings.size() + 1;
+			RowsWritten++;
+			return true;
+		} catch (const Poco::Exception &E) {
+			Timer.Failed();
 			Logger().log(E);
 		}
 		return false;
@@ -860,45 +1088,100 @@ namespace OpenWifi {
 	bool Storage::GetDevices(uint64_t From, uint64_t HowMany,
 							 std::vector<GWObjects::Device> &Devices, const std::string &orderBy, const std::string &platform,
 							 bool includeProvisioned) {
-		DeviceRecordList Records;
-		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
+		return StreamDevices(
+			From, HowMany,
+			[&Devices](const GWObjects::Device &D) {
+				Devices.push_back(D);
+				return true;
+			},
+			orderBy, platform, includeProvisioned);
+	}
 
-			std::string st;
-			std::string whereClause = "";
-			if(platform.empty()) {
+	bool Storage::StreamDevices(uint64_t From, uint64_t HowMany,
+								const RowFunction<GWObjects::Device> &Row,
+								const std::string &orderBy, const std::string &platform,
+								bool includeProvisioned) {
+		std::string whereClause = "";
+		if(platform.empty()) {
 
-				if (includeProvisioned == false) {
-					whereClause = fmt::format("WHERE entity='' and venue=''");
-				}
+			if (includeProvisioned == false) {
+				whereClause = fmt::format("WHERE entity='' and venue=''");
+			}
 
-			} else {
+		} else {
 
-				if (includeProvisioned == false) {
-					whereClause = fmt::format("WHERE DeviceType='{}' and entity='' and venue=''",platform);
-				} else {
-					whereClause = fmt::format("WHERE DeviceType='{}'", platform);				
-				}
-		
+			if (includeProvisioned == false) {
+				whereClause = fmt::format("WHERE DeviceType='{}' and entity='' and venue=''",platform);
+			} else {
+				whereClause = fmt::format("WHERE DeviceType='{}'", platform);
 			}
 
-			st =
-				fmt::format("SELECT {} FROM Devices {} {} {}", DB_DeviceSelectFields, whereClause,
-							orderBy.empty() ? " ORDER BY SerialNumber ASC " : orderBy,
-							ComputeRange(From, HowMany));
-
-			//Logger().information(fmt::format(" GetDevices st is {} ", st));
-			
-			Select << ConvertParams(st), Poco::Data::Keywords::into(Records);
-			Select.execute();
+		}
 
-			for (auto &i : Records) {
-				GWObjects::Device D;
-				ConvertDeviceRecord(i, D);
-				Devices.push_back(D);
+		return StreamPages(From, HowMany, Row,
+						   [&](std::uint64_t Start, std::uint64_t Count,
+							   std::vector<GWObjects::Device> &Page, std::uint64_t &Read) {
+			try {
+				return ReadQuery([&](PooledSession &Sess) {
+					DeviceRecordList Records;
+					Poco::Data::Statement Select(Sess);
+
+					std::string st = fmt::format(
+						"SELECT {} FROM Devices {} {} {}", DB_DeviceSelectFields, whereClause,
+						orderBy.empty() ? " ORDER BY SerialNumber ASC " : orderBy,
+						ComputeRange(Start, Count));
+					Select << ConvertParams(st), Poco::Data::Keywords::into(Records);
+					Select.execute();
+
+					std::vector<GWObjects::Device> Batch;
+					for (const auto &i : Records) {
+						GWObjects::Device D;
+						ConvertDeviceRecord(i, D);
+						Batch.emplace_back(std::move(D));
+					}
+					Page = std::move(Batch);
+					Read = Records.size();
+					return true;
+				});
+			} catch (const Poco::Exception &E) {
+				Logger().log(E);
 			}
-			return true;
+			return false;
+		});
+	}
+
+	bool Storage::GetDevices(StorageCursor &Cursor, uint64_t HowMany,
+							 std::vector<GWObjects::Device> &Devices, const std::string &platform,
+							 bool includeProvisioned) {
+		try {
+			return ReadQuery([&](PooledSession &Sess) {
+				DeviceRecordList Records;
+				Poco::Data::Statement Select(Sess);
+
+				auto st = ConvertParams("SELECT " + DB_DeviceSelectFields + " FROM Devices " +
+										DeviceListConditions(platform, includeProvisioned,
+															 Cursor.Started) +
+										" ORDER BY SerialNumber ASC ") +
+						  ComputeRange(0, HowMany);
+				if (Cursor.Started) {
+					Select << st, Poco::Data::Keywords::into(Records),
+						Poco::Data::Keywords::use(Cursor.Key);
+				} else {
+					Select << st, Poco::Data::Keywords::into(Records);
+				}
+				Select.execute();
+
+				std::vector<GWObjects::Device> Page;
+				for (const auto &i : Records) {
+					GWObjects::Device D;
+					ConvertDeviceRecord(i, D);
+					Page.push_back(D);
+				}
+				Cursor.AdvanceOnKey(Records, HowMany,
+									[](const DeviceRecordTuple &R) { return R.get<0>(); });
+				Devices.insert(Devices.end(), Page.begin(), Page.end());
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
@@ -943,27 +1226,32 @@ namespace OpenWifi {
 	}
 
 	bool Storage::UpdateSerialNumberCache() {
+		std::vector<uint64_t> SerialNumbers;
+		if (!GetSerialNumbers(SerialNumbers))
+			return false;
+		Logger().information(fmt::format("Added {} serial numbers to cache.", SerialNumbers.size()));
+		SerialNumberCache()->Assign(std::move(SerialNumbers));
+		return true;
+	}
+
+	bool Storage::GetSerialNumbers(std::vector<uint64_t> &SerialNumbers, uint64_t CreatedSince) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select(Sess);
 
-			Select << "SELECT SerialNumber FROM Devices";
+			std::vector<std::string> Rows;
+			if (CreatedSince) {
+				Select << "SELECT SerialNumber FROM Devices WHERE CreationTimestamp>=?",
+					Poco::Data::Keywords::into(Rows), Poco::Data::Keywords::use(CreatedSince);
+			} else {
+				Select << "SELECT SerialNumber FROM Devices", Poco::Data::Keywords::into(Rows);
+			}
 			Select.execute();
 
-			Poco::Data::RecordSet RSet(Select);
-
-			uint64_t NumberOfDevices = 0;
-
-			bool More = RSet.moveFirst();
-			while (More) {
-				auto SerialNumber = RSet[0].convert<std::string>();
-				SerialNumberCache()->AddSerialNumber(SerialNumber);
-				NumberOfDevices++;
-				More = RSet.moveNext();
-			}
-			Logger().information(fmt::format("Added {} serial numbers to cache.", NumberOfDevices));
+			SerialNumbers.reserve(SerialNumbers.size() + Rows.size());
+			for (const auto &SerialNumber : Rows)
+				SerialNumbers.push_back(Utils::SerialNumberToInt(SerialNumber));
 			return true;
-
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
@@ -1056,80 +1344,84 @@ namespace OpenWifi {
 
 	bool Storage::AnalyzeDevices(GWObjects::Dashboard &Dashboard) {
 		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
-
-			Select << "SELECT SerialNumber, Compatible, Firmware FROM Devices";
-			Select.execute();
-
-			Poco::Data::RecordSet RSet(Select);
-
-			bool More = RSet.moveFirst();
-			while (More) {
-				Dashboard.numberOfDevices++;
-				auto SerialNumber = RSet[0].convert<std::string>();
-				auto DeviceType = RSet[1].convert<std::string>();
-				auto Revision = RSet[2].convert<std::string>();
-				UpdateCountedMap(Dashboard.vendors, OUIServer()->GetManufacturer(SerialNumber));
-				UpdateCountedMap(Dashboard.deviceType, DeviceType);
-
-				GWObjects::ConnectionState ConnState;
-				if (AP_WS_Server()->GetState(SerialNumber, ConnState)) {
-					UpdateCountedMap(Dashboard.status,
-									 ConnState.Connected ? "connected" : "not connected");
-					UpdateCountedMap(Dashboard.certificates,
-									 ComputeCertificateTag(ConnState.VerifiedCertificate));
-					UpdateCountedMap(Dashboard.lastContact,
-									 ComputeUpLastContactTag(ConnState.LastContact));
-					GWObjects::HealthCheck HC;
-					if (AP_WS_Server()->GetHealthcheck(SerialNumber, HC))
-						UpdateCountedMap(Dashboard.healths, ComputeSanityTag(HC.Sanity));
-					else
-						UpdateCountedMap(Dashboard.healths, ComputeSanityTag(100));
-					std::string LastStats;
-					if (AP_WS_Server()->GetStatistics(SerialNumber, LastStats) &&
-						!LastStats.empty()) {
-						Poco::JSON::Parser P;
-
-						auto RawObject = P.parse(LastStats).extract<Poco::JSON::Object::Ptr>();
-
-						if (RawObject->has("unit")) {
-							auto Unit = RawObject->getObject("unit");
-							if (Unit->has("uptime")) {
-								UpdateCountedMap(Dashboard.upTimes,
-												 ComputeUpTimeTag(Unit->get("uptime")));
+			return ReadQuery([&](PooledSession &Sess) {
+				//	counted on a copy: a query retried on the primary must not count twice.
+				auto Counts = Dashboard;
+				Poco::Data::Statement Select(Sess);
+
+				Select << "SELECT SerialNumber, Compatible, Firmware FROM Devices";
+				Select.execute();
+
+				Poco::Data::RecordSet RSet(Select);
+
+				bool More = RSet.moveFirst();
+				while (More) {
+					Counts.numberOfDevices++;
+					auto SerialNumber = RSet[0].convert<std::string>();
+					auto DeviceType = RSet[1].convert<std::string>();
+					auto Revision = RSet[2].convert<std::string>();
+					UpdateCountedMap(Counts.vendors, OUIServer()->GetManufacturer(SerialNumber));
+					UpdateCountedMap(Counts.deviceType, DeviceType);
+
+					GWObjects::ConnectionState ConnState;
+					if (AP_WS_Server()->GetState(SerialNumber, ConnState)) {
+						UpdateCountedMap(Counts.status,
+										 ConnState.Connected ? "connected" : "not connected");
+						UpdateCountedMap(Counts.certificates,
+										 ComputeCertificateTag(ConnState.VerifiedCertificate));
+						UpdateCountedMap(Counts.lastContact,
+										 ComputeUpLastContactTag(ConnState.LastContact));
+						GWObjects::HealthCheck HC;
+						if (AP_WS_Server()->GetHealthcheck(SerialNumber, HC))
+							UpdateCountedMap(Counts.healths, ComputeSanityTag(HC.Sanity));
+						else
+							UpdateCountedMap(Counts.healths, ComputeSanityTag(100));
+						std::string LastStats;
+						if (AP_WS_Server()->GetStatistics(SerialNumber, LastStats) &&
+							!LastStats.empty()) {
+							Poco::JSON::Parser P;
+
+							auto RawObject = P.parse(LastStats).extract<Poco::JSON::Object::Ptr>();
+
+							if (RawObject->has("unit")) {
+								auto Unit = RawObject->getObject("unit");
+								if (Unit->has("uptime")) {
+									UpdateCountedMap(Counts.upTimes,
+													 ComputeUpTimeTag(Unit->get("uptime")));
+								}
+								if (Unit->has("memory")) {
+									auto Memory = Unit->getObject("memory");
+									uint64_t Free = Memory->get("free");
+									uint64_t Total = Memory->get("total");
+									UpdateCountedMap(Counts.memoryUsed,
+													 ComputeUsedMemoryTag(Free, Total));
+								}
+								if (Unit->has("load")) {
+									auto Load = Unit->getArray("load");
+									UpdateCountedMap(Counts.load1,
+													 ComputeLoadTag(Load->getElement<uint64_t>(0)));
+									UpdateCountedMap(Counts.load5,
+													 ComputeLoadTag(Load->getElement<uint64_t>(1)));
+									UpdateCountedMap(Counts.load15,
+													 ComputeLoadTag(Load->getElement<uint64_t>(2)));
+								}
 							}
-							if (Unit->has("memory")) {
-								auto Memory = Unit->getObject("memory");
-								uint64_t Free = Memory->get("free");
-								uint64_t Total = Memory->get("total");
-								UpdateCountedMap(Dashboard.memoryUsed,
-												 ComputeUsedMemoryTag(Free, Total));
-							}
-							if (Unit->has("load")) {
-								auto Load = Unit->getArray("load");
-								UpdateCountedMap(Dashboard.load1,
-												 ComputeLoadTag(Load->getElement<uint64_t>(0)));
-								UpdateCountedMap(Dashboard.load5,
-												 ComputeLoadTag(Load->getElement<uint64_t>(1)));
-								UpdateCountedMap(Dashboard.load15,
-												 ComputeLoadTag(Load->getElement<uint64_t>(2)));
-							}
-						}
 
-						uint64_t Associations_2G, Associations_5G, Associations_6G, uptime;
-						StateUtils::ComputeAssociations(RawObject, Associations_2G, Associations_5G,
-														Associations_6G, uptime);
-						UpdateCountedMap(Dashboard.associations, "2G", Associations_2G);
-						UpdateCountedMap(Dashboard.associations, "5G", Associations_5G);
-						UpdateCountedMap(Dashboard.associations, "6G", Associations_6G);
+							uint64_t Associations_2G, Associations_5G, Associations_6G, uptime;
+							StateUtils::ComputeAssociations(RawObject, Associations_2G, Associations_5G,
+															Associations_6G, uptime);
+							UpdateCountedMap(Counts.associations, "2G", Associations_2G);
+							UpdateCountedMap(Counts.associations, "5G", Associations_5G);
+							UpdateCountedMap(Counts.associations, "6G", Associations_6G);
+						}
+					} else {
+						UpdateCountedMap(Counts.status, "not connected");
 					}
-				} else {
-					UpdateCountedMap(Dashboard.status, "not connected");
+					More = RSet.moveNext();
 				}
-				More = RSet.moveNext();
-			}
-			return true;
+				Dashboard = std::move(Counts);
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
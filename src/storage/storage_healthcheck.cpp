@@ -19,12 +19,18 @@ namespace OpenWifi {
 		HealthCheckRecordTuple;
 	typedef std::vector<HealthCheckRecordTuple> HealthCheckRecordList;
 
-	void ConvertHealthCheckRecord(const HealthCheckRecordTuple &R, GWObjects::HealthCheck &H) {
+	//	False when the stored payload cannot be decoded: the record is left out of the listing.
+	bool ConvertHealthCheckRecord(const HealthCheckRecordTuple &R, GWObjects::HealthCheck &H) {
 		H.SerialNumber = R.get<0>();
 		H.UUID = R.get<1>();
-		H.Data = R.get<2>();
 		H.Sanity = R.get<3>();
 		H.Recorded = R.get<4>();
+		if (StorageService()->Codec().Decode(R.get<2>(), H.Data))
+			return true;
+		poco_warning(StorageService()->Logger(),
+					 fmt::format("Healthcheck record {} of {} at {} cannot be decoded, skipped.",
+								 H.UUID, H.SerialNumber, H.Recorded));
+		return false;
 	}
 
 	void ConvertHealthCheckRecord(const GWObjects::HealthCheck &H, HealthCheckRecordTuple &R) {
@@ -35,7 +41,8 @@ namespace OpenWifi {
 		R.set<4>(H.Recorded);
 	}
 
-	bool Storage::AddHealthCheckData(LockedDbSession &Session, const GWObjects::HealthCheck &Check) {
+	bool Storage::AddHealthCheckData(LockedDbSession &Session, const GWObjects::HealthCheck &Check,
+									 const std::string &Model) {
 		try {
 			std::lock_guard Guard(Session.Mutex());
 			Session.Session().begin();
@@ -46,6 +53,7 @@ namespace OpenWifi {
 
 			HealthCheckRecordTuple R;
 			ConvertHealthCheckRecord(Check, R);
+			R.set<2>(Codec_.Encode(Model, Check.Data));
 			Insert << ConvertParams(St), Poco::Data::Keywords::use(R);
 			Insert.execute();
 			Session.Session().commit();
@@ -61,41 +69,97 @@ namespace OpenWifi {
 									 uint64_t Offset, uint64_t HowMany,
 									 std::vector<GWObjects::HealthCheck> &Checks) {
 		try {
-			HealthCheckRecordList Records;
-			Poco::Data::Session Sess = Pool_->get();
+			return ReadQuery([&](PooledSession &Sess) {
+				HealthCheckRecordList Records;
 
-			bool DatesIncluded = (FromDate != 0 || ToDate != 0);
+				bool DatesIncluded = (FromDate != 0 || ToDate != 0);
 
-			std::string Prefix{"SELECT " + DB_HealthCheckSelectFields + " FROM HealthChecks "};
-			std::string Statement = SerialNumber.empty()
-										? Prefix + std::string(DatesIncluded ? "WHERE " : "")
-										: Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
-											  std::string(DatesIncluded ? " AND " : "");
+				std::string Prefix{"SELECT " + DB_HealthCheckSelectFields + " FROM HealthChecks "};
+				std::string Statement = SerialNumber.empty()
+											? Prefix + std::string(DatesIncluded ? "WHERE " : "")
+											: Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
+												  std::string(DatesIncluded ? " AND " : "");
 
-			std::string DateSelector;
-			if (FromDate && ToDate) {
-				DateSelector = " Recorded>=" + std::to_string(FromDate) +
-							   " AND Recorded<=" + std::to_string(ToDate);
-			} else if (FromDate) {
-				DateSelector = " Recorded>=" + std::to_string(FromDate);
-			} else if (ToDate) {
-				DateSelector = " Recorded<=" + std::to_string(ToDate);
-			}
+				std::string DateSelector;
+				if (FromDate && ToDate) {
+					DateSelector = " Recorded>=" + std::to_string(FromDate) +
+								   " AND Recorded<=" + std::to_string(ToDate);
+				} else if (FromDate) {
+					DateSelector = " Recorded>=" + std::to_string(FromDate);
+				} else if (ToDate) {
+					DateSelector = " Recorded<=" + std::to_string(ToDate);
+				}
 
-			Poco::Data::Statement Select(Sess);
+				Poco::Data::Statement Select(Sess);
 
-			Select << Statement + DateSelector + " ORDER BY Recorded ASC " +
-						  ComputeRange(Offset, HowMany),
-				Poco::Data::Keywords::into(Records);
-			Select.execute();
+				Select << Statement + DateSelector + " ORDER BY Recorded ASC " +
+							  ComputeRange(Offset, HowMany),
+					Poco::Data::Keywords::into(Records);
+				Select.execute();
 
-			for (const auto &i : Records) {
-				GWObjects::HealthCheck R;
-				ConvertHealthCheckRecord(i, R);
-				Checks.push_back(R);
-			}
-			Select.reset(Sess);
-			return true;
+				std::vector<GWObjects::HealthCheck> Page;
+				for (const auto &i : Records) {
+					GWObjects::HealthCheck R;
+					if (!ConvertHealthCheckRecord(i, R))
+						continue;
+					Page.push_back(R);
+				}
+				Select.reset(Sess);
+				Checks.insert(Checks.end(), Page.begin(), Page.end());
+				return true;
+			});
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
+	}
+
+	bool Storage::GetHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+									 StorageCursor &Cursor, uint64_t HowMany,
+									 std::vector<GWObjects::HealthCheck> &Checks) {
+		try {
+			return ReadQuery([&](PooledSession &Sess) {
+				HealthCheckRecordList Records;
+
+				std::vector<std::string> Conditions;
+				if (!SerialNumber.empty())
+					Conditions.emplace_back("SerialNumber='" + SerialNumber + "'");
+				if (FromDate)
+					Conditions.emplace_back("Recorded>=" + std::to_string(FromDate));
+				if (ToDate)
+					Conditions.emplace_back("Recorded<=" + std::to_string(ToDate));
+				auto Seek = Cursor.Seeks(HasRowId("HealthChecks"));
+				if (Seek && Cursor.Started)
+					Conditions.emplace_back(Cursor.AfterRecorded(false));
+
+				std::vector<std::uint64_t> RowIds;
+				std::string Statement{"SELECT " + DB_HealthCheckSelectFields +
+									  (Seek ? ", rowid" : ", 0") + " FROM HealthChecks "};
+				for (std::size_t i = 0; i < Conditions.size(); ++i)
+					Statement += (i == 0 ? " WHERE " : " AND ") + Conditions[i];
+
+				Poco::Data::Statement Select(Sess);
+
+				Select << Statement +
+							  (Seek ? " ORDER BY Recorded ASC, rowid ASC " + ComputeRange(0, HowMany)
+									: " ORDER BY Recorded ASC " +
+										  ComputeRange(Cursor.Offset, HowMany)),
+					Poco::Data::Keywords::into(Records), Poco::Data::Keywords::into(RowIds);
+				Select.execute();
+
+				std::vector<GWObjects::HealthCheck> Page;
+				for (const auto &i : Records) {
+					GWObjects::HealthCheck R;
+					if (!ConvertHealthCheckRecord(i, R))
+						continue;
+					Page.push_back(R);
+				}
+				Cursor.AdvanceOnRecorded(Records, RowIds, HowMany,
+										 [](const HealthCheckRecordTuple &R) { return R.get<4>(); });
+				Checks.insert(Checks.end(), Page.begin(), Page.end());
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
 											   E.displayText()));
@@ -107,24 +171,28 @@ namespace OpenWifi {
 										   std::vector<GWObjects::HealthCheck> &Checks) {
 
 		try {
-			HealthCheckRecordList Records;
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
+			return ReadQuery([&](PooledSession &Sess) {
+				HealthCheckRecordList Records;
+				Poco::Data::Statement Select(Sess);
 
-			std::string st{"SELECT " + DB_HealthCheckSelectFields +
-						   " FROM HealthChecks WHERE SerialNumber=? ORDER BY Recorded DESC "};
+				std::string st{"SELECT " + DB_HealthCheckSelectFields +
+							   " FROM HealthChecks WHERE SerialNumber=? ORDER BY Recorded DESC "};
 
-			Select << ConvertParams(st) + ComputeRange(0, HowMany),
-				Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(SerialNumber);
-			Select.execute();
+				Select << ConvertParams(st) + ComputeRange(0, HowMany),
+					Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(SerialNumber);
+				Select.execute();
 
-			for (const auto &i : Records) {
-				GWObjects::HealthCheck R;
-				ConvertHealthCheckRecord(i, R);
-				Checks.push_back(R);
-			}
-			Select.reset(Sess);
-			return true;
+				std::vector<GWObjects::HealthCheck> Page;
+				for (const auto &i : Records) {
+					GWObjects::HealthCheck R;
+					if (!ConvertHealthCheckRecord(i, R))
+						continue;
+					Page.push_back(R);
+				}
+				Select.reset(Sess);
+				Checks.insert(Checks.end(), Page.begin(), Page.end());
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
 											   E.displayText()));
@@ -0,0 +1,98 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Poco/Data/Statement.h"
+
+namespace OpenWifi {
+
+	//	Last contact times of disconnected devices, newest per device, until they are written.
+	class LastContactQueue {
+	  public:
+		using Contacts = std::map<std::string, std::uint64_t>;
+
+		inline void Queue(const std::string &SerialNumber, std::uint64_t LastContact) {
+			std::lock_guard Guard(Mutex_);
+			auto &Pending = Pending_[SerialNumber];
+			Pending = std::max(Pending, LastContact);
+		}
+
+		inline Contacts Take() {
+			Contacts Taken;
+			std::lock_guard Guard(Mutex_);
+			Taken.swap(Pending_);
+			return Taken;
+		}
+
+		//	Puts back what could not be written, unless newer values came in meanwhile.
+		inline void Restore(Contacts::const_iterator From, Contacts::const_iterator To) {
+			std::lock_guard Guard(Mutex_);
+			for (; From != To; ++From) {
+				auto &Pending = Pending_[From->first];
+				Pending = std::max(Pending, From->second);
+			}
+		}
+
+		[[nodiscard]] inline std::size_t size() {
+			std::lock_guard Guard(Mutex_);
+			return Pending_.size();
+		}
+
+	  private:
+		std::mutex Mutex_;
+		Contacts Pending_;
+	};
+
+	//	One statement per batch:
+	//		UPDATE Devices SET lastRecordedContact=CASE SerialNumber WHEN ? THEN ? ... ELSE
+	//		lastRecordedContact END WHERE SerialNumber IN (?,...)
+	//	which all three databases accept. Batches stay under the sqlite limit on bound values.
+	struct LastContactBatch {
+		static constexpr std::size_t Size = 250;
+
+		std::vector<std::string> Serials;
+		std::vector<std::uint64_t> Stamps;
+
+		//	Takes up to Size contacts from Next on, and moves Next past them.
+		inline void Fill(LastContactQueue::Contacts::const_iterator &Next,
+						 LastContactQueue::Contacts::const_iterator End) {
+			Serials.clear();
+			Stamps.clear();
+			for (; Next != End && Serials.size() < Size; ++Next) {
+				Serials.push_back(Next->first);
+				Stamps.push_back(Next->second);
+			}
+		}
+
+		//	With ? placeholders, for ConvertParams.
+		[[nodiscard]] inline std::string Query() const {
+			std::string Cases, Keys;
+			for (std::size_t i = 0; i < Serials.size(); ++i) {
+				Cases += " WHEN ? THEN ?";
+				Keys += i ? ",?" : "?";
+			}
+			return "UPDATE Devices SET lastRecordedContact=CASE SerialNumber" + Cases +
+				   " ELSE lastRecordedContact END WHERE SerialNumber IN (" + Keys + ")";
+		}
+
+		inline void Bind(Poco::Data::Statement &Update) {
+			for (std::size_t i = 0; i < Serials.size(); ++i) {
+				Update.addBind(Poco::Data::Keywords::use(Serials[i]));
+				Update.addBind(Poco::Data::Keywords::use(Stamps[i]));
+			}
+			for (auto &Serial : Serials)
+				Update.addBind(Poco::Data::Keywords::use(Serial));
+		}
+	};
+
+} // namespace OpenWifi
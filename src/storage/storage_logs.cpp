@@ -65,45 +65,115 @@ namespace OpenWifi {
 	bool Storage::GetLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 							 uint64_t Offset, uint64_t HowMany,
 							 std::vector<GWObjects::DeviceLog> &Stats, uint64_t Type) {
-		try {
-			DeviceLogsRecordList Records;
-			Poco::Data::Session Sess = Pool_->get();
+		return StreamLogData(SerialNumber, FromDate, ToDate, Offset, HowMany,
+							 [&Stats](const GWObjects::DeviceLog &L) {
+								 Stats.push_back(L);
+								 return true;
+							 },
+							 Type);
+	}
 
-			bool DatesIncluded = (FromDate != 0 || ToDate != 0);
-			bool HasWhere = DatesIncluded || !SerialNumber.empty();
+	bool Storage::StreamLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+								uint64_t Offset, uint64_t HowMany,
+								const RowFunction<GWObjects::DeviceLog> &Row, uint64_t Type) {
+		bool DatesIncluded = (FromDate != 0 || ToDate != 0);
+		bool HasWhere = DatesIncluded || !SerialNumber.empty();
 
-			std::string Prefix{"SELECT " + DB_LogsSelectFields + " FROM DeviceLogs  "};
-			std::string Statement = SerialNumber.empty()
-										? Prefix + std::string(DatesIncluded ? "WHERE " : "")
-										: Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
-											  std::string(DatesIncluded ? " AND " : "");
+		std::string Prefix{"SELECT " + DB_LogsSelectFields + " FROM DeviceLogs  "};
+		std::string Statement = SerialNumber.empty()
+									? Prefix + std::string(DatesIncluded ? "WHERE " : "")
+									: Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
+										  std::string(DatesIncluded ? " AND " : "");
 
-			std::string DateSelector;
-			if (FromDate && ToDate) {
-				DateSelector = " Recorded>=" + std::to_string(FromDate) +
-							   " AND Recorded<=" + std::to_string(ToDate);
-			} else if (FromDate) {
-				DateSelector = " Recorded>=" + std::to_string(FromDate);
-			} else if (ToDate) {
-				DateSelector = " Recorded<=" + std::to_string(ToDate);
-			}
+		std::string DateSelector;
+		if (FromDate && ToDate) {
+			DateSelector = " Recorded>=" + std::to_string(FromDate) +
+						   " AND Recorded<=" + std::to_string(ToDate);
+		} else if (FromDate) {
+			DateSelector = " Recorded>=" + std::to_string(FromDate);
+		} else if (ToDate) {
+			DateSelector = " Recorded<=" + std::to_string(ToDate);
+		}
 
-			std::string TypeSelector;
-			TypeSelector = (HasWhere ? " AND LogType=" : " WHERE LogType=") + std::to_string(Type);
-			Poco::Data::Statement Select(Sess);
+		std::string TypeSelector;
+		TypeSelector = (HasWhere ? " AND LogType=" : " WHERE LogType=") + std::to_string(Type);
 
-			Select << Statement + DateSelector + TypeSelector + " ORDER BY Recorded DESC " +
-						  ComputeRange(Offset, HowMany),
-				Poco::Data::Keywords::into(Records);
-			Select.execute();
+		return StreamPages(Offset, HowMany, Row,
+						   [&](std::uint64_t From, std::uint64_t Count,
+							   std::vector<GWObjects::DeviceLog> &Page, std::uint64_t &Read) {
+			try {
+				return ReadQuery([&](PooledSession &Sess) {
+					DeviceLogsRecordList Records;
+					Poco::Data::Statement Select(Sess);
+					Select << Statement + DateSelector + TypeSelector + " ORDER BY Recorded DESC " +
+								  ComputeRange(From, Count),
+						Poco::Data::Keywords::into(Records);
+					Select.execute();
 
-			for (const auto &i : Records) {
-				GWObjects::DeviceLog R;
-				ConvertLogsRecord(i, R);
-				Stats.push_back(R);
+					std::vector<GWObjects::DeviceLog> Batch;
+					for (const auto &i : Records) {
+						GWObjects::DeviceLog R;
+						ConvertLogsRecord(i, R);
+						Batch.emplace_back(std::move(R));
+					}
+					Page = std::move(Batch);
+					Read = Records.size();
+					return true;
+				});
+			} catch (const Poco::Exception &E) {
+				poco_warning(Logger(),
+							 fmt::format("StreamLogData: Failed with: {}", E.displayText()));
 			}
-			Select.reset(Sess);
-			return true;
+			return false;
+		});
+	}
+
+	bool Storage::GetLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+							 StorageCursor &Cursor, uint64_t HowMany,
+							 std::vector<GWObjects::DeviceLog> &Stats, uint64_t Type) {
+		try {
+			return ReadQuery([&](PooledSession &Sess) {
+				DeviceLogsRecordList Records;
+
+				std::vector<std::string> Conditions;
+				if (!SerialNumber.empty())
+					Conditions.emplace_back("SerialNumber='" + SerialNumber + "'");
+				if (FromDate)
+					Conditions.emplace_back("Recorded>=" + std::to_string(FromDate));
+				if (ToDate)
+					Conditions.emplace_back("Recorded<=" + std::to_string(ToDate));
+				Conditions.emplace_back("LogType=" + std::to_string(Type));
+				//	newest first, so the next page starts below the last row.
+				auto Seek = Cursor.Seeks(HasRowId("DeviceLogs"));
+				if (Seek && Cursor.Started)
+					Conditions.emplace_back(Cursor.AfterRecorded(true));
+
+				std::vector<std::uint64_t> RowIds;
+				std::string Statement{"SELECT " + DB_LogsSelectFields +
+									  (Seek ? ", rowid" : ", 0") + " FROM DeviceLogs "};
+				for (std::size_t i = 0; i < Conditions.size(); ++i)
+					Statement += (i == 0 ? " WHERE " : " AND ") + Conditions[i];
+
+				Poco::Data::Statement Select(Sess);
+
+				Select << Statement +
+							  (Seek ? " ORDER BY Recorded DESC, rowid DESC " + ComputeRange(0, HowMany)
+									: " ORDER BY Recorded DESC " +
+										  ComputeRange(Cursor.Offset, HowMany)),
+					Poco::Data::Keywords::into(Records), Poco::Data::Keywords::into(RowIds);
+				Select.execute();
+
+				std::vector<GWObjects::DeviceLog> Page;
+				for (const auto &i : Records) {
+					GWObjects::DeviceLog R;
+					ConvertLogsRecord(i, R);
+					Page.push_back(R);
+				}
+				Cursor.AdvanceOnRecorded(Records, RowIds, HowMany,
+										 [](const DeviceLogsRecordTuple &R) { return R.get<4>(); });
+				Stats.insert(Stats.end(), Page.begin(), Page.end());
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
 											   E.displayText()));
@@ -155,25 +225,28 @@ namespace OpenWifi {
 	bool Storage::GetNewestLogData(std::string &SerialNumber, uint64_t HowMany,
 								   std::vector<GWObjects::DeviceLog> &Stats, uint64_t Type) {
 		try {
-			DeviceLogsRecordList Records;
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
-
-			std::string st{
-				"SELECT " + DB_LogsSelectFields +
-				" FROM DeviceLogs WHERE SerialNumber=? AND LogType=? ORDER BY Recorded DESC " +
-				ComputeRange(0, HowMany)};
-			Select << ConvertParams(st), Poco::Data::Keywords::into(Records),
-				Poco::Data::Keywords::use(SerialNumber), Poco::Data::Keywords::use(Type);
-			Select.execute();
-
-			for (const auto &i : Records) {
-				GWObjects::DeviceLog R;
-				ConvertLogsRecord(i, R);
-				Stats.push_back(R);
-			}
-			Select.reset(Sess);
-			return true;
+			return ReadQuery([&](PooledSession &Sess) {
+				DeviceLogsRecordList Records;
+				Poco::Data::Statement Select(Sess);
+
+				std::string st{
+					"SELECT " + DB_LogsSelectFields +
+					" FROM DeviceLogs WHERE SerialNumber=? AND LogType=? ORDER BY Recorded DESC " +
+					ComputeRange(0, HowMany)};
+				Select << ConvertParams(st), Poco::Data::Keywords::into(Records),
+					Poco::Data::Keywords::use(SerialNumber), Poco::Data::Keywords::use(Type);
+				Select.execute();
+
+				std::vector<GWObjects::DeviceLog> Newest;
+				for (const auto &i : Records) {
+					GWObjects::DeviceLog R;
+					ConvertLogsRecord(i, R);
+					Newest.push_back(R);
+				}
+				Select.reset(Sess);
+				Stats.insert(Stats.end(), Newest.begin(), Newest.end());
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
 											   E.displayText()));
@@ -0,0 +1,126 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "Poco/Data/Session.h"
+#include "Poco/Data/Statement.h"
+#include "Poco/JSON/Object.h"
+
+#include "framework/MetricsRegistry.h"
+
+namespace OpenWifi {
+
+	//	Queries that run on every connect, state message or command and are worth keeping
+	//	prepared on long-lived sessions.
+	enum class PreparedQuery : std::uint8_t {
+		GetDevice = 0,
+		UpdateDevice,
+		AddCommand,
+		RemoveOldCommands,
+		AddStatisticsData,
+		SetCommandResult,
+		Count
+	};
+
+	inline const char *to_string(PreparedQuery Q) {
+		switch (Q) {
+		case PreparedQuery::GetDevice:
+			return "GetDevice";
+		case PreparedQuery::UpdateDevice:
+			return "UpdateDevice";
+		case PreparedQuery::AddCommand:
+			return "AddCommand";
+		case PreparedQuery::RemoveOldCommands:
+			return "RemoveOldCommands";
+		case PreparedQuery::AddStatisticsData:
+			return "AddStatisticsData";
+		case PreparedQuery::SetCommandResult:
+			return "SetCommandResult";
+		default:
+			return "unknown";
+		}
+	}
+
+	//	A statement bound once to the storage it owns. Callers fill the bound members and call
+	//	execute() again, so the backend only parses and plans the SQL the first time.
+	class PreparedStatement {
+	  public:
+		virtual ~PreparedStatement() = default;
+	};
+
+	//	Owned by a single session and used under that session's lock.
+	class PreparedStatementCache {
+	  public:
+		template <typename T> T &Get(PreparedQuery Q, Poco::Data::Session &Session) {
+			auto &Entry = Entries_[(std::size_t)Q];
+			if (!Entry)
+				Entry = std::make_unique<T>(Session);
+			return static_cast<T &>(*Entry);
+		}
+
+		//	Called when a statement failed: the next call prepares it again.
+		inline void Invalidate(PreparedQuery Q) { Entries_[(std::size_t)Q].reset(); }
+
+		//	Statements belong to a connection, they must go before it is reconnected.
+		inline void Clear() {
+			for (auto &Entry : Entries_)
+				Entry.reset();
+		}
+
+	  private:
+		std::array<std::unique_ptr<PreparedStatement>, (std::size_t)PreparedQuery::Count> Entries_;
+	};
+
+	//	Latency of a database query, and how many calls ran a prepared statement or failed.
+	class QueryStatistics {
+	  public:
+		inline void Record(std::uint64_t Us, bool Prepared, bool Failed) {
+			Latency_.Record(Us);
+			if (Prepared)
+				Prepared_++;
+			if (Failed)
+				Failed_++;
+		}
+
+		inline void Export(MetricHistogram &M) { Latency_.Export(M); }
+
+		inline void ToJSON(Poco::JSON::Object &Obj) const {
+			Latency_.ToJSON(Obj);
+			Obj.set("prepared", Prepared_.load());
+			Obj.set("failed", Failed_.load());
+		}
+
+	  private:
+		MetricHistogram Latency_;
+		std::atomic_uint64_t Prepared_ = 0, Failed_ = 0;
+	};
+
+	//	Records the time spent in a query when it goes out of scope.
+	class QueryTimer {
+	  public:
+		QueryTimer(QueryStatistics &H, bool Prepared)
+			: H_(H), Prepared_(Prepared), Start_(std::chrono::steady_clock::now()) {}
+		~QueryTimer() {
+			H_.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+						  std::chrono::steady_clock::now() - Start_)
+						  .count(),
+					  Prepared_, Failed_);
+		}
+		inline void Failed() { Failed_ = true; }
+
+	  private:
+		QueryStatistics &H_;
+		bool Prepared_;
+		bool Failed_ = false;
+		std::chrono::steady_clock::time_point Start_;
+	};
+
+} // namespace OpenWifi
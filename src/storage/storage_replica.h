@@ -0,0 +1,184 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <source_location>
+
+#include "Poco/Data/Session.h"
+#include "Poco/JSON/Object.h"
+#include "Poco/Logger.h"
+
+#include "fmt/format.h"
+
+#include "framework/MetricsRegistry.h"
+#include "framework/StorageSessionPool.h"
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	//	Time spent waiting for a session and holding it, for the queries using one pool.
+	struct SessionPoolStatistics {
+		MetricHistogram Wait, Held;
+
+		inline void ToJSON(Poco::JSON::Object &Obj) const {
+			Poco::JSON::Object W, H;
+			Wait.ToJSON(W);
+			Held.ToJSON(H);
+			Obj.set("wait", W);
+			Obj.set("held", H);
+		}
+	};
+
+	//	A pooled session that records how long the caller waited for it, and how long it was
+	//	held, against the pool it came from.
+	class PooledSession : public Poco::Data::Session {
+	  public:
+		PooledSession(Poco::Data::Session S, SessionPoolStatistics &Stats,
+					  std::chrono::steady_clock::time_point Requested, bool Replica)
+			: Poco::Data::Session(std::move(S)), Stats_(Stats), Replica_(Replica),
+			  Acquired_(std::chrono::steady_clock::now()) {
+			Stats_.Wait.Record(
+				std::chrono::duration_cast<std::chrono::microseconds>(Acquired_ - Requested)
+					.count());
+		}
+		PooledSession(const PooledSession &) = delete;
+		PooledSession &operator=(const PooledSession &) = delete;
+		~PooledSession() {
+			Stats_.Held.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+								   std::chrono::steady_clock::now() - Acquired_)
+								   .count());
+		}
+
+		[[nodiscard]] inline bool FromReplica() const { return Replica_; }
+
+	  private:
+		SessionPoolStatistics &Stats_;
+		bool Replica_;
+		std::chrono::steady_clock::time_point Acquired_;
+	};
+
+	//	Sends read-only queries to the read replica when one is configured and reachable, and to
+	//	the primary otherwise.
+	class ReadRouter {
+	  public:
+		inline void Configure(Poco::Logger &Logger, std::shared_ptr<StorageSessionPool> Primary,
+							  std::shared_ptr<StorageSessionPool> Replica,
+							  std::uint64_t RetrySeconds) {
+			Logger_ = &Logger;
+			Primary_ = std::move(Primary);
+			Replica_ = std::move(Replica);
+			Retry_ = RetrySeconds;
+			RetryAt_ = 0;
+		}
+
+		//	From the replica unless it failed less than RetrySeconds ago.
+		inline PooledSession
+		Session(const std::source_location &Caller = std::source_location::current()) {
+			if (Replica_ && Utils::Now() >= RetryAt_) {
+				auto Requested = std::chrono::steady_clock::now();
+				try {
+					return PooledSession(Replica_->get(Caller), ReplicaReads_, Requested, true);
+				} catch (const Poco::Exception &E) {
+					//	do not wait on a replica that is down for every query.
+					Fallbacks_++;
+					RetryAt_ = Utils::Now() + Retry_;
+					poco_warning(*Logger_,
+								 fmt::format("Read replica unavailable, using the primary for {}s: {}",
+											 Retry_, E.displayText()));
+				}
+			}
+			return Primary(Caller);
+		}
+
+		inline PooledSession
+		Primary(const std::source_location &Caller = std::source_location::current()) {
+			auto Requested = std::chrono::steady_clock::now();
+			return PooledSession(Primary_->get(Caller), PrimaryReads_, Requested, false);
+		}
+
+		//	Runs Query(PooledSession &) and returns its result. A query that throws on the replica,
+		//	a lagging schema or a dropped connection, runs again on the primary, unless Emitted
+		//	says it already handed rows to its caller. A replica session that lost its connection
+		//	also sends the next queries to the primary for RetrySeconds.
+		template <typename F>
+		inline bool Read(F Query, const bool *Emitted = nullptr,
+						 const std::source_location &Caller = std::source_location::current()) {
+			{
+				auto Sess = Session(Caller);
+				if (!Sess.FromReplica())
+					return Query(Sess);
+				try {
+					return Query(Sess);
+				} catch (const Poco::Exception &E) {
+					if (Emitted != nullptr && *Emitted)
+						throw;
+					Failed(Sess, E);
+				}
+			}
+			auto Sess = Primary(Caller);
+			return Query(Sess);
+		}
+
+		inline void ExportMetrics() {
+			PrimaryReads_.Held.Export(MetricsRegistry()->Histogram(
+				"owgw_db_read_session_held_seconds", "Time a read-only query held its session.",
+				{{"pool", "primary"}}));
+			ReplicaReads_.Held.Export(MetricsRegistry()->Histogram(
+				"owgw_db_read_session_held_seconds", "Time a read-only query held its session.",
+				{{"pool", "replica"}}));
+			MetricsRegistry()->CounterFunction(
+				"owgw_db_replica_fallbacks_total",
+				"Read-only queries sent to the primary because the replica could not be reached.",
+				{}, [this] { return (double)Fallbacks_.load(); });
+			MetricsRegistry()->CounterFunction(
+				"owgw_db_replica_retries_total",
+				"Read-only queries that failed on the replica and ran again on the primary.", {},
+				[this] { return (double)Retries_.load(); });
+		}
+
+		inline void ToJSON(Poco::JSON::Object &Obj) const {
+			Poco::JSON::Object Primary;
+			PrimaryReads_.ToJSON(Primary);
+			Obj.set("primary", Primary);
+			if (Replica_) {
+				Poco::JSON::Object Replica;
+				ReplicaReads_.ToJSON(Replica);
+				Obj.set("replica", Replica);
+			}
+			Obj.set("replicaFallbacks", Fallbacks_.load());
+			Obj.set("replicaRetries", Retries_.load());
+		}
+
+		[[nodiscard]] inline std::uint64_t Fallbacks() const { return Fallbacks_.load(); }
+		[[nodiscard]] inline std::uint64_t Retries() const { return Retries_.load(); }
+
+	  private:
+		Poco::Logger *Logger_ = nullptr;
+		std::shared_ptr<StorageSessionPool> Primary_, Replica_;
+		SessionPoolStatistics PrimaryReads_, ReplicaReads_;
+		std::atomic_uint64_t Fallbacks_ = 0, Retries_ = 0, RetryAt_ = 0;
+		std::uint64_t Retry_ = 30;
+
+		inline void Failed(Poco::Data::Session &Sess, const Poco::Exception &E) {
+			Retries_++;
+			bool Connected = false;
+			try {
+				Connected = Sess.isConnected();
+			} catch (...) {
+			}
+			if (!Connected)
+				RetryAt_ = Utils::Now() + Retry_;
+			poco_warning(*Logger_,
+						 fmt::format("Read replica query failed, running it on the primary{}: {}",
+									 Connected ? "" : fmt::format(" for {}s", Retry_),
+									 E.displayText()));
+		}
+	};
+
+} // namespace OpenWifi
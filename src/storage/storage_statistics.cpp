@@ -18,11 +18,17 @@ namespace OpenWifi {
 	typedef Poco::Tuple<std::string, uint64_t, std::string, uint64_t> StatsRecordTuple;
 	typedef std::vector<StatsRecordTuple> StatsRecordList;
 
-	void ConvertStatsRecord(const StatsRecordTuple &R, GWObjects::Statistics &Stats) {
+	//	False when the stored payload cannot be decoded: the record is left out of the listing.
+	bool ConvertStatsRecord(const StatsRecordTuple &R, GWObjects::Statistics &Stats) {
 		Stats.SerialNumber = R.get<0>();
 		Stats.UUID = R.get<1>();
-		Stats.Data = R.get<2>();
 		Stats.Recorded = R.get<3>();
+		if (StorageService()->Codec().Decode(R.get<2>(), Stats.Data))
+			return true;
+		poco_warning(StorageService()->Logger(),
+					 fmt::format("Statistics record {} of {} at {} cannot be decoded, skipped.",
+								 Stats.UUID, Stats.SerialNumber, Stats.Recorded));
+		return false;
 	}
 
 	void ConvertStatsRecord(const GWObjects::Statistics &Stats, StatsRecordTuple &R) {
@@ -32,22 +38,48 @@ namespace OpenWifi {
 		R.set<3>(Stats.Recorded);
 	}
 
-	bool Storage::AddStatisticsData(Poco::Data::Session &Session, const GWObjects::Statistics &Stats) {
+	class PreparedAddStatistics : public PreparedStatement {
+	  public:
+		explicit PreparedAddStatistics(Poco::Data::Session &Session) : Insert(Session) {
+			Insert << StorageService()->ConvertParams("INSERT INTO Statistics ( " +
+													  DB_StatsSelectFields + " ) VALUES ( " +
+													  DB_StatsInsertValues + " )"),
+				Poco::Data::Keywords::use(R);
+		}
+		StatsRecordTuple R;
+		Poco::Data::Statement Insert;
+	};
+
+	bool Storage::AddStatisticsData(Poco::Data::Session &Session, const GWObjects::Statistics &Stats,
+									const std::string &Model, PreparedStatementCache *Prepared) {
+		auto Cached =
+			GetPrepared<PreparedAddStatistics>(Prepared, PreparedQuery::AddStatisticsData, Session);
+		QueryTimer Timer(QueryStats(PreparedQuery::AddStatisticsData), Cached != nullptr);
 		try {
-			Session.begin();
-			Poco::Data::Statement Insert(Session);
-
 			poco_trace(Logger(), fmt::format("{}: Adding stats. Size={}", Stats.SerialNumber,
 											 std::to_string(Stats.Data.size())));
+			if (Cached != nullptr) {
+				ConvertStatsRecord(Stats, Cached->R);
+				Cached->R.set<2>(Codec_.Encode(Model, Stats.Data));
+				Cached->Insert.execute();
+				return true;
+			}
+
+			Session.begin();
+			Poco::Data::Statement Insert(Session);
 			std::string St{"INSERT INTO Statistics ( " + DB_StatsSelectFields + " ) VALUES ( " +
 						   DB_StatsInsertValues + " )"};
 			StatsRecordTuple R;
 			ConvertStatsRecord(Stats, R);
+			R.set<2>(Codec_.Encode(Model, Stats.Data));
 			Insert << ConvertParams(St), Poco::Data::Keywords::use(R);
 			Insert.execute();
 			Session.commit();
 			return true;
 		} catch (const Poco::Exception &E) {
+			Timer.Failed();
+			if (Cached != nullptr)
+				Prepared->Invalidate(PreparedQuery::AddStatisticsData);
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
 											   E.displayText()));
 		}
@@ -57,32 +89,35 @@ namespace OpenWifi {
 	bool Storage::GetNumberOfStatisticsDataRecords(std::string &SerialNumber, uint64_t FromDate,
 												   uint64_t ToDate, std::uint64_t &Count) {
 		try {
-			Poco::Data::Session Sess(Pool_->get());
-			Poco::Data::Statement Select(Sess);
-
-			StatsRecordList Records;
-
-			bool DatesIncluded = (FromDate != 0 || ToDate != 0);
-
-			std::string Prefix{"SELECT count(*) FROM Statistics "};
-			std::string StatementStr = SerialNumber.empty()
-										   ? Prefix + std::string(DatesIncluded ? "WHERE " : "")
-										   : Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
-												 std::string(DatesIncluded ? " AND " : "");
-
-			std::string DateSelector;
-			if (FromDate && ToDate) {
-				DateSelector = " Recorded>=" + std::to_string(FromDate) +
-							   " AND Recorded<=" + std::to_string(ToDate);
-			} else if (FromDate) {
-				DateSelector = " Recorded>=" + std::to_string(FromDate);
-			} else if (ToDate) {
-				DateSelector = " Recorded<=" + std::to_string(ToDate);
-			}
-
-			Select << StatementStr + DateSelector, Poco::Data::Keywords::into(Count);
-			Select.execute();
-			return true;
+			return ReadQuery([&](PooledSession &Sess) {
+				Poco::Data::Statement Select(Sess);
+
+				StatsRecordList Records;
+
+				bool DatesIncluded = (FromDate != 0 || ToDate != 0);
+
+				std::string Prefix{"SELECT count(*) FROM Statistics "};
+				std::string StatementStr = SerialNumber.empty()
+											   ? Prefix + std::string(DatesIncluded ? "WHERE " : "")
+											   : Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
+													 std::string(DatesIncluded ? " AND " : "");
+
+				std::string DateSelector;
+				if (FromDate && ToDate) {
+					DateSelector = " Recorded>=" + std::to_string(FromDate) +
+								   " AND Recorded<=" + std::to_string(ToDate);
+				} else if (FromDate) {
+					DateSelector = " Recorded>=" + std::to_string(FromDate);
+				} else if (ToDate) {
+					DateSelector = " Recorded<=" + std::to_string(ToDate);
+				}
+
+				std::uint64_t Rows = 0;
+				Select << StatementStr + DateSelector, Poco::Data::Keywords::into(Rows);
+				Select.execute();
+				Count = Rows;
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
 											   E.displayText()));
@@ -93,42 +128,111 @@ namespace OpenWifi {
 	bool Storage::GetStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 									uint64_t Offset, uint64_t HowMany,
 									std::vector<GWObjects::Statistics> &Stats) {
-		try {
-			Poco::Data::Session Sess(Pool_->get());
-			Poco::Data::Statement Select(Sess);
-
-			StatsRecordList Records;
-
-			bool DatesIncluded = (FromDate != 0 || ToDate != 0);
+		return StreamStatisticsData(SerialNumber, FromDate, ToDate, Offset, HowMany,
+									[&Stats](const GWObjects::Statistics &S) {
+										Stats.emplace_back(S);
+										return true;
+									});
+	}
 
-			std::string Prefix{"SELECT " + DB_StatsSelectFields + " FROM Statistics "};
-			std::string StatementStr = SerialNumber.empty()
-										   ? Prefix + std::string(DatesIncluded ? "WHERE " : "")
-										   : Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
-												 std::string(DatesIncluded ? " AND " : "");
+	bool Storage::StreamStatisticsData(std::string &SerialNumber, uint64_t FromDate,
+									   uint64_t ToDate, uint64_t Offset, uint64_t HowMany,
+									   const RowFunction<GWObjects::Statistics> &Row) {
+		bool DatesIncluded = (FromDate != 0 || ToDate != 0);
+
+		std::string Prefix{"SELECT " + DB_StatsSelectFields + " FROM Statistics "};
+		std::string StatementStr = SerialNumber.empty()
+									   ? Prefix + std::string(DatesIncluded ? "WHERE " : "")
+									   : Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
+											 std::string(DatesIncluded ? " AND " : "");
+
+		std::string DateSelector;
+		if (FromDate && ToDate) {
+			DateSelector = " Recorded>=" + std::to_string(FromDate) +
+						   " AND Recorded<=" + std::to_string(ToDate);
+		} else if (FromDate) {
+			DateSelector = " Recorded>=" + std::to_string(FromDate);
+		} else if (ToDate) {
+			DateSelector = " Recorded<=" + std::to_string(ToDate);
+		}
 
-			std::string DateSelector;
-			if (FromDate && ToDate) {
-				DateSelector = " Recorded>=" + std::to_string(FromDate) +
-							   " AND Recorded<=" + std::to_string(ToDate);
-			} else if (FromDate) {
-				DateSelector = " Recorded>=" + std::to_string(FromDate);
-			} else if (ToDate) {
-				DateSelector = " Recorded<=" + std::to_string(ToDate);
+		return StreamPages(Offset, HowMany, Row,
+						   [&](std::uint64_t From, std::uint64_t Count,
+							   std::vector<GWObjects::Statistics> &Page, std::uint64_t &Read) {
+			try {
+				return ReadQuery([&](PooledSession &Sess) {
+					Poco::Data::Statement Select(Sess);
+					StatsRecordList Records;
+					Select << StatementStr + DateSelector + " ORDER BY Recorded ASC " +
+								  ComputeRange(From, Count),
+						Poco::Data::Keywords::into(Records);
+					Select.execute();
+
+					std::vector<GWObjects::Statistics> Batch;
+					for (const auto &i : Records) {
+						GWObjects::Statistics R;
+						if (!ConvertStatsRecord(i, R))
+							continue;
+						Batch.emplace_back(std::move(R));
+					}
+					Page = std::move(Batch);
+					Read = Records.size();
+					return true;
+				});
+			} catch (const Poco::Exception &E) {
+				poco_warning(Logger(), fmt::format("StreamStatisticsData: Failed with: {}",
+												   E.displayText()));
 			}
+			return false;
+		});
+	}
 
-			Select << StatementStr + DateSelector + " ORDER BY Recorded ASC " +
-						  ComputeRange(Offset, HowMany),
-				Poco::Data::Keywords::into(Records);
-			Select.execute();
-
-			for (const auto &i : Records) {
-				GWObjects::Statistics R;
-				ConvertStatsRecord(i, R);
-				Stats.emplace_back(R);
-			}
-			Select.reset(Sess);
-			return true;
+	bool Storage::GetStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
+									StorageCursor &Cursor, uint64_t HowMany,
+									std::vector<GWObjects::Statistics> &Stats) {
+		try {
+			return ReadQuery([&](PooledSession &Sess) {
+				Poco::Data::Statement Select(Sess);
+
+				StatsRecordList Records;
+
+				std::vector<std::string> Conditions;
+				if (!SerialNumber.empty())
+					Conditions.emplace_back("SerialNumber='" + SerialNumber + "'");
+				if (FromDate)
+					Conditions.emplace_back("Recorded>=" + std::to_string(FromDate));
+				if (ToDate)
+					Conditions.emplace_back("Recorded<=" + std::to_string(ToDate));
+				//	seek on the StatsSerial index instead of skipping Offset rows.
+				auto Seek = Cursor.Seeks(HasRowId("Statistics"));
+				if (Seek && Cursor.Started)
+					Conditions.emplace_back(Cursor.AfterRecorded(false));
+
+				std::vector<std::uint64_t> RowIds;
+				std::string StatementStr{"SELECT " + DB_StatsSelectFields +
+										 (Seek ? ", rowid" : ", 0") + " FROM Statistics "};
+				for (std::size_t i = 0; i < Conditions.size(); ++i)
+					StatementStr += (i == 0 ? " WHERE " : " AND ") + Conditions[i];
+
+				Select << StatementStr +
+							  (Seek ? " ORDER BY Recorded ASC, rowid ASC " + ComputeRange(0, HowMany)
+									: " ORDER BY Recorded ASC " +
+										  ComputeRange(Cursor.Offset, HowMany)),
+					Poco::Data::Keywords::into(Records), Poco::Data::Keywords::into(RowIds);
+				Select.execute();
+
+				std::vector<GWObjects::Statistics> Page;
+				for (const auto &i : Records) {
+					GWObjects::Statistics R;
+					if (!ConvertStatsRecord(i, R))
+						continue;
+					Page.emplace_back(R);
+				}
+				Cursor.AdvanceOnRecorded(Records, RowIds, HowMany,
+										 [](const StatsRecordTuple &R) { return R.get<3>(); });
+				Stats.insert(Stats.end(), Page.begin(), Page.end());
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
 											   E.displayText()));
@@ -140,22 +244,26 @@ namespace OpenWifi {
 	bool Storage::GetNewestStatisticsData(std::string &SerialNumber, uint64_t HowMany,
 										  std::vector<GWObjects::Statistics> &Stats) {
 		try {
-			StatsRecordList Records;
-			Poco::Data::Session Sess(Pool_->get());
-			Poco::Data::Statement Select(Sess);
-
-			std::string St{"SELECT " + DB_StatsSelectFields +
-						   " FROM Statistics WHERE SerialNumber=? ORDER BY Recorded DESC "};
-			Select << ConvertParams(St) + ComputeRange(0, HowMany),
-				Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(SerialNumber);
-			Select.execute();
-
-			for (const auto &i : Records) {
-				GWObjects::Statistics R;
-				ConvertStatsRecord(i, R);
-				Stats.emplace_back(R);
-			}
-			return true;
+			return ReadQuery([&](PooledSession &Sess) {
+				StatsRecordList Records;
+				Poco::Data::Statement Select(Sess);
+
+				std::string St{"SELECT " + DB_StatsSelectFields +
+							   " FROM Statistics WHERE SerialNumber=? ORDER BY Recorded DESC "};
+				Select << ConvertParams(St) + ComputeRange(0, HowMany),
+					Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(SerialNumber);
+				Select.execute();
+
+				std::vector<GWObjects::Statistics> Newest;
+				for (const auto &i : Records) {
+					GWObjects::Statistics R;
+					if (!ConvertStatsRecord(i, R))
+						continue;
+					Newest.emplace_back(R);
+				}
+				Stats.insert(Stats.end(), Newest.begin(), Newest.end());
+				return true;
+			});
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
 											   E.displayText()));
@@ -7,6 +7,7 @@
 //
 
 #include "StorageService.h"
+#include "fmt/format.h"
 
 namespace OpenWifi {
 
@@ -22,10 +23,58 @@ namespace OpenWifi {
 		Create_BlackList();
 		Create_FileUploads();
 		Create_DefaultFirmwares();
+		Create_PayloadDictionaries();
 
 		return 0;
 	}
 
+	bool Storage::HasColumn(Poco::Data::Session &Sess, const std::string &Table,
+							const std::string &Column) {
+		std::string St{"SELECT COUNT(*) FROM information_schema.columns WHERE table_schema=" +
+					   std::string(dbType_ == mysql ? "DATABASE()" : "current_schema()") +
+					   " AND LOWER(table_name)=? AND LOWER(column_name)=?"};
+		auto TableName = Poco::toLower(Table), ColumnName = Poco::toLower(Column);
+		std::uint64_t Count = 0;
+		Sess << ConvertParams(St), Poco::Data::Keywords::into(Count),
+			Poco::Data::Keywords::use(TableName), Poco::Data::Keywords::use(ColumnName),
+			Poco::Data::Keywords::now;
+		return Count > 0;
+	}
+
+	//	Listings ordered on Recorded break ties on rowid. SQLite has one on every table. The other
+	//	databases need an auto-numbered column of that name, and adding it rewrites the whole
+	//	table, so it is only added when storage.rowid.migrate is set. Without it, listings on that
+	//	table page with OFFSET.
+	void Storage::AddRowId(Poco::Data::Session &Sess, const std::string &Table) {
+		if (dbType_ == sqlite) {
+			RowIdTables_.insert(Table);
+			return;
+		}
+		try {
+			if (!HasColumn(Sess, Table, "rowid") && MigrateRowIds_) {
+				poco_information(Logger(), fmt::format("Adding rowid to {}.", Table));
+				if (dbType_ == pgsql)
+					Sess << "ALTER TABLE " + Table + " ADD COLUMN IF NOT EXISTS rowid BIGSERIAL",
+						Poco::Data::Keywords::now;
+				else
+					Sess << "ALTER TABLE " + Table +
+								" ADD COLUMN rowid BIGINT NOT NULL AUTO_INCREMENT UNIQUE",
+						Poco::Data::Keywords::now;
+			}
+			if (HasColumn(Sess, Table, "rowid")) {
+				RowIdTables_.insert(Table);
+				return;
+			}
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: could not add rowid: {}", Table,
+											   E.displayText()));
+		}
+		poco_information(Logger(),
+						 fmt::format("{} has no rowid column: listings page with OFFSET. Set "
+									 "storage.rowid.migrate to add it.",
+									 Table));
+	}
+
 	int Storage::Create_Statistics() {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
@@ -52,6 +101,7 @@ namespace OpenWifi {
 						"INDEX StatSerial (SerialNumber ASC, Recorded ASC))",
 					Poco::Data::Keywords::now;
 			}
+			AddRowId(Sess, "Statistics");
 			return 0;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -218,6 +268,7 @@ namespace OpenWifi {
 						"ASC, Recorded ASC)",
 					Poco::Data::Keywords::now;
 			}
+			AddRowId(Sess, "HealthChecks");
 			return 0;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -256,6 +307,7 @@ namespace OpenWifi {
 						"Recorded ASC)",
 					Poco::Data::Keywords::now;
 			}
+			AddRowId(Sess, "DeviceLogs");
 
 			return 0;
 		} catch (const Poco::Exception &E) {
@@ -426,7 +478,9 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	BLOB"
+						"FileContent	BLOB, "
+						"FileHash		VARCHAR(64), "
+						"FileSize		BIGINT"
 						") ",
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == mysql) {
@@ -434,7 +488,9 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	LONGBLOB"
+						"FileContent	LONGBLOB, "
+						"FileHash		VARCHAR(64), "
+						"FileSize		BIGINT"
 						") ",
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == pgsql) {
@@ -442,11 +498,54 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	BYTEA"
+						"FileContent	BYTEA, "
+						"FileHash		VARCHAR(64), "
+						"FileSize		BIGINT"
 						") ",
 					Poco::Data::Keywords::now;
 			}
 
+			//	uploads now live in the file store, rows only keep the content hash.
+			std::vector<std::string> Script{
+				"alter table FileUploads add column FileHash varchar(64)",
+				"alter table FileUploads add column FileSize bigint"};
+
+			for (const auto &i : Script) {
+				try {
+					Sess << i, Poco::Data::Keywords::now;
+				} catch (...) {
+				}
+			}
+
+			try {
+				//	mysql has no IF NOT EXISTS here, it fails once the index exists.
+				Sess << (dbType_ == mysql
+							 ? "CREATE INDEX FileUploadsHash ON FileUploads (FileHash)"
+							 : "CREATE INDEX IF NOT EXISTS FileUploadsHash ON FileUploads (FileHash)"),
+					Poco::Data::Keywords::now;
+			} catch (...) {
+			}
+
+			return 0;
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+		return -1;
+	}
+
+	int Storage::Create_PayloadDictionaries() {
+		try {
+			Poco::Data::Session Sess = Pool_->get();
+
+			if (dbType_ == pgsql || dbType_ == sqlite || dbType_ == mysql) {
+				Sess << "CREATE TABLE IF NOT EXISTS PayloadDictionaries ("
+						"Id				BIGINT PRIMARY KEY, "
+						"Model			VARCHAR(128), "
+						"Created		BIGINT, "
+						"Dictionary		TEXT"
+						")",
+					Poco::Data::Keywords::now;
+			}
 			return 0;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
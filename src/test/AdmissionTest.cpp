@@ -0,0 +1,259 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Admission control under load. Threads standing in for the accept and HTTP threads admit and
+//	release devices: a thread must never wait for a slot, and the limit must hold. Slots taken at
+//	accept time are claimed by the upgrade request or expire. Then a reconnect storm of 20000
+//	devices is played in simulated time against a backend whose connect time grows with the
+//	number of devices in setup, with and without admission. A device gives up after 5 seconds in
+//	setup and comes back 5 seconds later; a device that is shed comes back after 30 to 60
+//	seconds. Admission must keep every device out of timeouts and setup under the target
+//	latency. The backend is a model, not the gateway: run owgw_simulator against a gateway for
+//	real numbers. Build and run:
+//		cmake --build . --target owgw_admission_test && ./owgw_admission_test
+
+#include <algorithm>
+#include <atomic>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "AP_WS_Admission.h"
+
+namespace OpenWifi::Test {
+
+	using Clock = AP_WS_Admission::Clock;
+	using namespace std::chrono_literals;
+
+	static int Failures = 0;
+
+	static void Check(bool Ok, const std::string &What) {
+		fmt::print("{} {}\n", Ok ? "ok  " : "FAIL", What);
+		if (!Ok)
+			Failures++;
+	}
+
+	//	Many more workers than slots, each holding its slot for a while.
+	static void Workers() {
+		AP_WS_Admission Admission;
+		AP_WS_Admission::Settings S;
+		S.Enabled = true;
+		S.Min = S.Max = S.Initial = 8;
+		Admission.Configure(S);
+
+		auto Threads = std::max(32u, std::thread::hardware_concurrency() * 4);
+		std::atomic_uint64_t Admitted = 0, Shed = 0, SlowestUs = 0, OverLimit = 0;
+		std::vector<std::thread> Pool;
+		for (unsigned t = 0; t < Threads; ++t) {
+			Pool.emplace_back([&] {
+				for (int i = 0; i < 2000; ++i) {
+					std::uint64_t Ticket = 0;
+					auto Start = Clock::now();
+					bool Ok = Admission.Admit(Ticket);
+					auto Us = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+								  Clock::now() - Start)
+								  .count();
+					auto Slowest = SlowestUs.load();
+					while (Us > Slowest && !SlowestUs.compare_exchange_weak(Slowest, Us))
+						;
+					if (!Ok) {
+						Shed++;
+						continue;
+					}
+					Admitted++;
+					if (Admission.InFlight() > 8)
+						OverLimit++;
+					std::this_thread::sleep_for(100us);
+					Admission.Release(Ticket, true);
+				}
+			});
+		}
+		for (auto &T : Pool)
+			T.join();
+
+		Check(OverLimit == 0, "never more devices in setup than the limit");
+		Check(Shed > 0 && Admitted > 0,
+			  fmt::format("{} workers on 8 slots: {} admitted, {} shed", Threads, Admitted.load(),
+						  Shed.load()));
+		//	a waiting Admit would take about as long as a slot is held, 100us or more, every time.
+		Check(SlowestUs < 50000,
+			  fmt::format("slowest admission decision took {}us", SlowestUs.load()));
+		Check(Admission.InFlight() == 0, "every slot was given back");
+	}
+
+	static void Adapts() {
+		AP_WS_Admission Admission;
+		AP_WS_Admission::Settings S;
+		S.Enabled = true;
+		S.Min = 10;
+		S.Initial = 100;
+		S.Max = 200;
+		auto Now = Clock::time_point{} + 1h;
+		Admission.Configure(S, Now);
+
+		//	fast connects while devices are shed: grow by an eighth.
+		std::uint64_t Ticket = 0;
+		for (int i = 0; i < 150; ++i)
+			if (Admission.Admit(Ticket, Now))
+				Admission.Release(Ticket, true, Now + 10ms);
+		std::vector<std::uint64_t> Held;
+		for (int i = 0; i < 101; ++i)
+			if (Admission.Admit(Ticket, Now))
+				Held.push_back(Ticket);
+		Check(Held.size() == 100, "admits up to the limit, sheds the rest");
+		for (auto T : Held)
+			Admission.Release(T, true, Now + 100ms);
+		Admission.Admit(Ticket, Now + 5s);
+		Check(Admission.Limit() == 112, fmt::format("grows while shedding ({})", Admission.Limit()));
+		Admission.Release(Ticket, false, Now + 5s);
+
+		//	slow connects: back off by a quarter.
+		Now += 5s;
+		Admission.Admit(Ticket, Now);
+		Admission.Release(Ticket, true, Now + 3s);
+		Admission.Admit(Ticket, Now + 10s);
+		Check(Admission.Limit() == 84, fmt::format("backs off when slow ({})", Admission.Limit()));
+
+		//	a device that never sends its connect gives its slot back after the hold timeout.
+		Check(Admission.InFlight() == 1, "the last device holds a slot");
+		Admission.Admit(Ticket, Now + 41s);
+		Check(Admission.InFlight() == 1, "an abandoned slot expires");
+	}
+
+	//	Slots taken at accept time, claimed by the upgrade request of the same peer.
+	static void Handshakes() {
+		AP_WS_Admission Admission;
+		AP_WS_Admission::Settings S;
+		auto Now = Clock::time_point{} + 1h;
+		Admission.Configure(S, Now);
+		Check(Admission.Admit("10.0.0.1:1000", Now) && Admission.InFlight() == 0,
+			  "off by default: every connection is let in, nothing is held");
+
+		S.Enabled = true;
+		S.Min = S.Max = S.Initial = 2;
+		Admission.Configure(S, Now);
+		Check(Admission.Admit("10.0.0.1:1000", Now) && Admission.Admit("10.0.0.2:1000", Now),
+			  "connections are admitted at accept time up to the limit");
+		Check(!Admission.Admit("10.0.0.3:1000", Now), "over the limit, the connection is shed");
+		auto Ticket = Admission.Claim("10.0.0.1:1000", Now + 1s);
+		Check(Ticket != 0, "the upgrade request claims the slot of its connection");
+		Check(Admission.Claim("10.0.0.1:1000", Now + 1s) == 0, "a slot is claimed once");
+		Check(Admission.Claim("10.0.0.9:1000", Now + 1s) == 0, "an unknown peer has no slot");
+		Check(Admission.InFlight() == 2, "handshaking and claimed slots both count");
+
+		//	10.0.0.2 never finishes its handshake.
+		Check(Admission.Admit("10.0.0.3:1000", Now + 11s),
+			  "a handshake that never finished gives its slot back");
+		Check(Admission.Claim("10.0.0.2:1000", Now + 11s) == 0, "and can no longer claim it");
+		Admission.Release(Ticket, true, Now + 12s);
+		Check(Admission.InFlight() == 1, "a released slot is free again");
+	}
+
+	struct StormResult {
+		double AllConnected = -1;
+		std::uint64_t Attempts = 0, Shed = 0, TimedOut = 0, PeakInSetup = 0;
+		double WorstConnect = 0;
+	};
+
+	//	Simulated time, in microseconds from the start of the storm.
+	static StormResult Storm(bool Admit, std::size_t Devices) {
+		const double Base = 0.05, Capacity = 100, Timeout = 5, Reconnect = 5, Horizon = 600;
+
+		AP_WS_Admission Admission;
+		AP_WS_Admission::Settings S;
+		S.Enabled = Admit;
+		Admission.Configure(S, Clock::time_point{});
+		auto At = [](double Seconds) {
+			return Clock::time_point{} + std::chrono::microseconds((std::int64_t)(Seconds * 1e6));
+		};
+
+		struct Event {
+			double When;
+			std::size_t Device;
+			std::uint64_t Ticket;
+			int Kind; //	0 attempt, 1 connected, 2 gave up
+			bool operator>(const Event &O) const { return When > O.When; }
+		};
+		std::priority_queue<Event, std::vector<Event>, std::greater<>> Events;
+		std::mt19937_64 Random(42);
+		std::uniform_real_distribution<double> Spread(0, 1);
+		for (std::size_t i = 0; i < Devices; ++i)
+			Events.push({Spread(Random), i, 0, 0});
+
+		StormResult R;
+		std::uint64_t InSetup = 0, Connected = 0;
+		while (!Events.empty() && Connected < Devices) {
+			auto E = Events.top();
+			Events.pop();
+			if (E.When > Horizon)
+				break;
+			if (E.Kind == 0) {
+				R.Attempts++;
+				std::uint64_t Ticket = 0;
+				if (!Admission.Admit(Ticket, At(E.When))) {
+					R.Shed++;
+					//	the device backs off for 30 to 60 seconds.
+					Events.push({E.When + 30 + 30 * Spread(Random), E.Device, 0, 0});
+					continue;
+				}
+				InSetup++;
+				R.PeakInSetup = std::max(R.PeakInSetup, InSetup);
+				auto Setup = Base * std::max(1.0, (double)InSetup / Capacity);
+				if (Setup > Timeout) {
+					Events.push({E.When + Timeout, E.Device, Ticket, 2});
+				} else {
+					Events.push({E.When + Setup, E.Device, Ticket, 1});
+					R.WorstConnect = std::max(R.WorstConnect, Setup);
+				}
+			} else {
+				InSetup--;
+				Admission.Release(E.Ticket, E.Kind == 1, At(E.When));
+				if (E.Kind == 1) {
+					if (++Connected == Devices)
+						R.AllConnected = E.When;
+				} else {
+					R.TimedOut++;
+					Events.push({E.When + Reconnect, E.Device, 0, 0});
+				}
+			}
+		}
+		return R;
+	}
+
+	static void Storms() {
+		const std::size_t Devices = 20000;
+		fmt::print("{:>10}{:>14}{:>10}{:>10}{:>10}{:>12}{:>14}\n", "admission", "all in (s)",
+				   "attempts", "shed", "timeouts", "peak setup", "worst setup s");
+		StormResult Results[2];
+		for (bool Admit : {false, true}) {
+			auto R = Results[Admit] = Storm(Admit, Devices);
+			fmt::print("{:>10}{:>14}{:>10}{:>10}{:>10}{:>12}{:>14.2f}\n", Admit ? "on" : "off",
+					   R.AllConnected < 0 ? std::string("never") : fmt::format("{:.1f}", R.AllConnected),
+					   R.Attempts, R.Shed, R.TimedOut, R.PeakInSetup, R.WorstConnect);
+		}
+		Check(Results[1].AllConnected > 0, "with admission, every device connects");
+		Check(Results[1].TimedOut == 0, "with admission, no device times out in setup");
+		Check(Results[1].PeakInSetup <= 1024, "with admission, setup stays within the maximum");
+		Check(Results[1].WorstConnect <= 2.0, "with admission, setup stays under the target latency");
+		//	the price: shed devices stay away for their backoff, so the storm takes longer to
+		//	clear than the backend alone would need.
+	}
+
+	static int Run() {
+		Workers();
+		Adapts();
+		Handshakes();
+		Storms();
+		fmt::print("{} failure(s)\n", Failures);
+		return Failures == 0 ? 0 : 1;
+	}
+
+} // namespace OpenWifi::Test
+
+int main() { return OpenWifi::Test::Run(); }
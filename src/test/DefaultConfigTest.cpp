@@ -0,0 +1,70 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Which default configuration auto-provisioning picks for a device. Build and run:
+//		cmake --build . --target owgw_defconfig_test && ./owgw_defconfig_test
+
+#include <string>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "storage/storage_defconfig.h"
+
+namespace OpenWifi::Test {
+
+	static int Failures = 0;
+
+	static void Check(const DefaultConfigIndex &Index, const std::string &Platform,
+					  const std::string &Model, const std::string &Expected,
+					  const std::string &What) {
+		auto C = Index.Find(Platform, Model);
+		auto Found = C == nullptr ? std::string{} : C->name;
+		bool Ok = Found == Expected;
+		fmt::print("{} {}{}\n", Ok ? "ok  " : "FAIL", What,
+				   Ok ? "" : fmt::format(": got '{}', expected '{}'", Found, Expected));
+		if (!Ok)
+			Failures++;
+	}
+
+	static void Add(DefaultConfigIndex &Index, const std::string &Name,
+					const std::string &Platform, std::vector<std::string> Models) {
+		auto C = std::make_shared<GWObjects::DefaultConfiguration>();
+		C->name = Name;
+		C->platform = Platform;
+		C->models = std::move(Models);
+		Index.Add(C);
+	}
+
+	static int Run() {
+		DefaultConfigIndex Index;
+		//	added out of name order, the index does not depend on the query order.
+		Add(Index, "z-ap-wildcard", "ap", {"*"});
+		Add(Index, "b-model", "ap", {"edgecore_eap101", "cig_wf188n"});
+		Add(Index, "a-wildcard", "", {"*"});
+		Add(Index, "a-model", "ap", {"edgecore_eap101"});
+		Add(Index, "switch-wildcard", "switch", {"*"});
+		Add(Index, "switch-model", "switch", {"edgecore_ecs4100"});
+
+		Check(Index, "ap", "edgecore_eap101", "a-model", "the lowest name wins for a model");
+		Check(Index, "ap", "cig_wf188n", "b-model", "a model beats a wildcard");
+		Check(Index, "ap", "unknown", "a-wildcard",
+			  "the lowest name wins among wildcards, an empty platform is an AP");
+		Check(Index, "", "cig_wf188n", "b-model", "a device without platform is an AP");
+		Check(Index, "switch", "edgecore_ecs4100", "switch-model", "platforms are kept apart");
+		Check(Index, "switch", "edgecore_eap101", "switch-wildcard",
+			  "an AP model does not match a switch");
+		Check(Index, "other", "edgecore_eap101", "", "an unknown platform matches nothing");
+
+		DefaultConfigIndex Empty;
+		Check(Empty, "ap", "edgecore_eap101", "", "an empty table matches nothing");
+
+		fmt::print("{} failure(s)\n", Failures);
+		return Failures == 0 ? 0 : 1;
+	}
+
+} // namespace OpenWifi::Test
+
+int main() { return OpenWifi::Test::Run(); }
@@ -0,0 +1,154 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	A mass disconnect against a local SQLite database: every device's last contact written with
+//	its own UPDATE, as EndConnection did before, then queued from several threads and written in
+//	batches as Storage::FlushLastContacts does. Build and run:
+//		cmake --build . --target owgw_lastcontact_test && ./owgw_lastcontact_test [devices]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Poco/Data/SQLite/Connector.h"
+#include "Poco/Data/Session.h"
+#include "Poco/TemporaryFile.h"
+
+#include "fmt/format.h"
+
+#include "storage/storage_lastcontact.h"
+
+namespace OpenWifi::Test {
+
+	using namespace Poco::Data::Keywords;
+
+	static int Failures = 0;
+
+	static void Check(bool Ok, const std::string &What) {
+		fmt::print("{} {}\n", Ok ? "ok  " : "FAIL", What);
+		if (!Ok)
+			Failures++;
+	}
+
+	static std::string Serial(std::size_t i) { return fmt::format("{:012x}", 0x1000000 + i); }
+
+	static void Reset(Poco::Data::Session &Sess) {
+		Sess << "UPDATE Devices SET lastRecordedContact=0", now;
+	}
+
+	static std::uint64_t Matching(Poco::Data::Session &Sess, std::uint64_t Base) {
+		std::uint64_t Count = 0;
+		Sess << "SELECT COUNT(*) FROM Devices WHERE lastRecordedContact=? + rowid - 1", use(Base),
+			into(Count), now;
+		return Count;
+	}
+
+	static double Seconds(std::chrono::steady_clock::time_point Start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	static int Run(std::size_t Devices) {
+		Poco::Data::SQLite::Connector::registerConnector();
+		Poco::TemporaryFile File;
+		Poco::Data::Session Sess(Poco::Data::SQLite::Connector::KEY, File.path());
+		Sess << "CREATE TABLE Devices (SerialNumber VARCHAR(30) PRIMARY KEY, "
+				"lastRecordedContact BIGINT)",
+			now;
+		Sess.begin();
+		for (std::size_t i = 0; i < Devices; ++i) {
+			auto S = Serial(i);
+			Sess << "INSERT INTO Devices VALUES (?, 0)", use(S), now;
+		}
+		Sess.commit();
+		const std::uint64_t Base = 1700000000;
+
+		fmt::print("{:>10}{:>12}{:>12}{:>14}\n", "path", "statements", "seconds", "devices/s");
+
+		//	one UPDATE and one commit per disconnect.
+		auto Start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < Devices; ++i) {
+			auto S = Serial(i);
+			std::uint64_t Stamp = Base + i;
+			Sess.begin();
+			Sess << "UPDATE Devices SET lastRecordedContact=?  WHERE SerialNumber=?", use(Stamp),
+				use(S), now;
+			Sess.commit();
+		}
+		auto Single = Seconds(Start);
+		fmt::print("{:>10}{:>12}{:>12.2f}{:>14.0f}\n", "single", Devices, Single,
+				   Devices / Single);
+		Check(Matching(Sess, Base) == Devices, "single-row updates wrote every device");
+		Reset(Sess);
+
+		//	every device disconnects twice, from several threads; the newer time must win.
+		LastContactQueue Queue;
+		auto Threads = std::max(2u, std::thread::hardware_concurrency());
+		Start = std::chrono::steady_clock::now();
+		{
+			std::vector<std::thread> Workers;
+			for (unsigned t = 0; t < Threads; ++t) {
+				Workers.emplace_back([&, t] {
+					for (std::size_t i = t; i < Devices; i += Threads) {
+						Queue.Queue(Serial(i), Base + i);
+						Queue.Queue(Serial(i), Base + i - 1);
+					}
+				});
+			}
+			for (auto &W : Workers)
+				W.join();
+		}
+		auto Queued = Seconds(Start);
+		Check(Queue.size() == Devices, "one pending contact per device");
+
+		Start = std::chrono::steady_clock::now();
+		auto Contacts = Queue.Take();
+		LastContactBatch Batch;
+		std::size_t Statements = 0;
+		LastContactQueue::Contacts::const_iterator Next = Contacts.begin();
+		while (Next != Contacts.end()) {
+			Batch.Fill(Next, Contacts.end());
+			Sess.begin();
+			Poco::Data::Statement Update(Sess);
+			Update << Batch.Query();
+			Batch.Bind(Update);
+			Update.execute();
+			Sess.commit();
+			Statements++;
+		}
+		auto Batched = Seconds(Start);
+		fmt::print("{:>10}{:>12}{:>12.2f}{:>14.0f}\n", "queue", 0, Queued, Devices / Queued);
+		fmt::print("{:>10}{:>12}{:>12.2f}{:>14.0f}\n", "batched", Statements, Batched,
+				   Devices / Batched);
+		Check(Matching(Sess, Base) == Devices, "batched updates wrote the newest time of every device");
+		Check(Statements == (Devices + LastContactBatch::Size - 1) / LastContactBatch::Size,
+			  "one statement per batch");
+		fmt::print("batched writes are {:.0f}x faster\n", Single / Batched);
+
+		//	a failed flush puts its contacts back without overwriting newer ones.
+		Queue.Queue(Serial(0), Base + 10);
+		Contacts = {{Serial(0), Base}, {Serial(1), Base + 1}};
+		Queue.Restore(Contacts.cbegin(), Contacts.cend());
+		auto Restored = Queue.Take();
+		Check(Restored.size() == 2 && Restored[Serial(0)] == Base + 10 &&
+				  Restored[Serial(1)] == Base + 1,
+			  "a failed batch is queued again, newer times win");
+
+		fmt::print("{} failure(s)\n", Failures);
+		return Failures == 0 ? 0 : 1;
+	}
+
+} // namespace OpenWifi::Test
+
+int main(int argc, char **argv) {
+	try {
+		return OpenWifi::Test::Run(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000);
+	} catch (const Poco::Exception &E) {
+		fmt::print(stderr, "{}\n", E.displayText());
+	}
+	return 1;
+}
@@ -0,0 +1,142 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	REST rate limiter buckets: refill, one client hammering from many threads, threads racing to
+//	recycle a bucket, and floods of client addresses smaller and larger than the table. Build and run:
+//		cmake --build . --target owgw_ratelimiter_test && ./owgw_ratelimiter_test
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "framework/TokenBuckets.h"
+
+namespace OpenWifi::Test {
+
+	static int Failures = 0;
+
+	static void Check(bool Ok, const std::string &What) {
+		fmt::print("{} {}\n", Ok ? "ok  " : "FAIL", What);
+		if (!Ok)
+			Failures++;
+	}
+
+	//	Calls allowed out of Calls for Key at Now.
+	static std::uint64_t Allowed(TokenBuckets &B, std::uint64_t Key, std::uint64_t Calls,
+								 std::uint64_t Now, int64_t Period = 1000, int64_t MaxCalls = 10) {
+		std::uint64_t Passed = 0;
+		for (std::uint64_t i = 0; i < Calls; ++i)
+			Passed += !B.IsRateLimited(Key, Period, MaxCalls, Now);
+		return Passed;
+	}
+
+	//	Keys as the limiter makes them, a hash of path and client address.
+	static std::uint64_t Client(std::uint64_t i) {
+		return std::hash<std::string>{}(
+			fmt::format("/api/v1/devices10.{}.{}.{}", (i >> 16) & 255, (i >> 8) & 255, i & 255));
+	}
+
+	static void Refill() {
+		TokenBuckets B;
+		auto Key = Client(1);
+		Check(Allowed(B, Key, 15, 1000) == 10, "a client bursts up to MaxCalls");
+		Check(Allowed(B, Key, 5, 1099) == 0, "no token before Period / MaxCalls");
+		Check(Allowed(B, Key, 5, 1100) == 1, "one token every Period / MaxCalls");
+		Check(Allowed(B, Key, 5, 1350) == 2, "partial refills keep the remainder");
+		Check(Allowed(B, Key, 15, 5000) == 10, "an idle client is back to MaxCalls, not more");
+		Check(Allowed(B, Client(2), 15, 5000) == 10, "clients are limited apart");
+	}
+
+	//	One address hammering from every core: the compare-and-swap must hand out exactly
+	//	MaxCalls tokens.
+	static void OneClient() {
+		TokenBuckets B;
+		auto Threads = std::max(4u, std::thread::hardware_concurrency());
+		std::atomic_uint64_t Passed = 0;
+		std::vector<std::thread> Workers;
+		for (unsigned t = 0; t < Threads; ++t)
+			Workers.emplace_back(
+				[&] { Passed += Allowed(B, Client(7), 20000, 1000, 1000000, 1000); });
+		for (auto &W : Workers)
+			W.join();
+		Check(Passed == 1000,
+			  fmt::format("{} threads on one client get exactly MaxCalls ({})", Threads,
+						  Passed.load()));
+	}
+
+	//	Every flooding address sends MaxCalls + 5 requests, with the legitimate client in the
+	//	middle of the flood.
+	static void Flood(std::uint64_t Addresses, bool FitsTable) {
+		TokenBuckets B;
+		auto Legit = std::hash<std::string>{}("/api/v1/devices192.168.1.1");
+		auto Before = Allowed(B, Legit, 5, 1000);
+		std::uint64_t FloodPassed = 0;
+		for (std::uint64_t i = 0; i < Addresses; ++i)
+			FloodPassed += Allowed(B, Client(i), 15, 1000);
+		auto After = Allowed(B, Legit, 15, 1000);
+		Check(FloodPassed == Addresses * 10,
+			  fmt::format("{} flooding addresses are each limited to MaxCalls", Addresses));
+		Check(B.Capacity() == TokenBuckets::DefaultCapacity, "the table does not grow");
+		if (FitsTable) {
+			//	8 probes per key: a few crowded neighbourhoods recycle a bucket already.
+			Check(B.Evictions() < Addresses / 1000,
+				  fmt::format("{} addresses fit: {} evictions", Addresses, B.Evictions()));
+			Check(Before + After == 10, "the legitimate client keeps its bucket");
+		} else {
+			//	a recycled bucket starts full again, the limiter fails open for that client.
+			Check(B.Evictions() > 0 && Before + After <= 15,
+				  fmt::format("{} addresses overflow: {} evictions, the legitimate client got "
+							  "{} calls, at most MaxCalls extra",
+							  Addresses, B.Evictions(), Before + After));
+		}
+	}
+
+	//	A full table and every thread asking for the same new key at once: only one bucket may be
+	//	recycled for it, or the key would get MaxCalls per bucket.
+	static void EvictionRace() {
+		auto Threads = std::max(4u, std::thread::hardware_concurrency());
+		std::uint64_t Worst = 0, Evictions = 0;
+		for (int Round = 0; Round < 500; ++Round) {
+			TokenBuckets B;
+			B.Resize(8, 1);
+			for (std::uint64_t i = 0; i < 8; ++i)
+				Allowed(B, Client(1000 + i), 1, 1000 + i);
+			std::atomic_uint64_t Passed = 0;
+			std::atomic_bool Go = false;
+			std::vector<std::thread> Workers;
+			for (unsigned t = 0; t < Threads; ++t)
+				Workers.emplace_back([&] {
+					while (!Go)
+						std::this_thread::yield();
+					Passed += Allowed(B, Client(7), 50, 2000, 1000000, 10);
+				});
+			Go = true;
+			for (auto &W : Workers)
+				W.join();
+			Worst = std::max(Worst, Passed.load());
+			Evictions += B.Evictions();
+		}
+		Check(Worst == 10 && Evictions == 500,
+			  fmt::format("{} threads recycling a bucket for one key: one eviction per round, at "
+						  "most MaxCalls ({})",
+						  Threads, Worst));
+	}
+
+	static int Run() {
+		Refill();
+		OneClient();
+		EvictionRace();
+		Flood(20000, true);
+		Flood(1000000, false);
+		fmt::print("{} failure(s)\n", Failures);
+		return Failures == 0 ? 0 : 1;
+	}
+
+} // namespace OpenWifi::Test
+
+int main() { return OpenWifi::Test::Run(); }
@@ -0,0 +1,131 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Read replica routing against two local SQLite databases, one standing in for the replica.
+//	Build and run:
+//		cmake --build . --target owgw_replica_test && ./owgw_replica_test
+
+#include <cstdio>
+#include <string>
+
+#include "Poco/ConsoleChannel.h"
+#include "Poco/Data/SQLite/Connector.h"
+#include "Poco/File.h"
+#include "Poco/Logger.h"
+#include "Poco/TemporaryFile.h"
+
+#include "fmt/format.h"
+
+#include "storage/storage_replica.h"
+
+namespace OpenWifi::Test {
+
+	static int Failures = 0;
+
+	static void Check(bool Ok, const std::string &What) {
+		fmt::print("{} {}\n", Ok ? "ok  " : "FAIL", What);
+		if (!Ok)
+			Failures++;
+	}
+
+	static std::shared_ptr<StorageSessionPool> Pool(const std::string &File) {
+		return std::make_shared<StorageSessionPool>(Poco::Data::SQLite::Connector::KEY, File, 1, 4,
+													60);
+	}
+
+	static void Create(const std::string &File, const std::string &Name, bool WithLogs) {
+		Poco::Data::Session Sess(Poco::Data::SQLite::Connector::KEY, File);
+		Sess << "CREATE TABLE Devices (SerialNumber VARCHAR(30))", Poco::Data::Keywords::now;
+		Sess << "INSERT INTO Devices VALUES ('" + Name + "')", Poco::Data::Keywords::now;
+		//	a table the replica has not caught up with yet.
+		if (WithLogs) {
+			Sess << "CREATE TABLE DeviceLogs (Log TEXT)", Poco::Data::Keywords::now;
+			Sess << "INSERT INTO DeviceLogs VALUES ('" + Name + "')", Poco::Data::Keywords::now;
+		}
+	}
+
+	static std::string Query(ReadRouter &Reads, const std::string &Table,
+							 const bool *Emitted = nullptr) {
+		std::string Value;
+		Reads.Read(
+			[&](PooledSession &Sess) {
+				Value.clear();
+				Poco::Data::Statement Select(Sess);
+				Select << "SELECT * FROM " + Table, Poco::Data::Keywords::into(Value);
+				Select.execute();
+				return true;
+			},
+			Emitted);
+		return Value;
+	}
+
+	static int Run() {
+		Poco::Data::SQLite::Connector::registerConnector();
+		auto &Logger = Poco::Logger::get("replica-test");
+		Logger.setChannel(new Poco::ConsoleChannel);
+
+		Poco::TemporaryFile Dir;
+		Dir.createDirectories();
+		auto PrimaryFile = Dir.path() + "/primary.db", ReplicaFile = Dir.path() + "/replica.db";
+		Create(PrimaryFile, "primary", true);
+		Create(ReplicaFile, "replica", false);
+
+		{
+			ReadRouter Reads;
+			Reads.Configure(Logger, Pool(PrimaryFile), nullptr, 30);
+			Check(Query(Reads, "Devices") == "primary", "no replica: reads go to the primary");
+		}
+
+		{
+			ReadRouter Reads;
+			Reads.Configure(Logger, Pool(PrimaryFile), Pool(ReplicaFile), 30);
+			Check(Query(Reads, "Devices") == "replica", "reads go to the replica");
+			Check(Query(Reads, "DeviceLogs") == "primary",
+				  "a query failing on the replica runs again on the primary");
+			Check(Reads.Retries() == 1 && Reads.Fallbacks() == 0, "the retry is counted");
+			Check(Query(Reads, "Devices") == "replica",
+				  "a replica that is still connected keeps serving reads");
+
+			bool Emitted = true, Thrown = false;
+			try {
+				Query(Reads, "DeviceLogs", &Emitted);
+			} catch (const Poco::Exception &) {
+				Thrown = true;
+			}
+			Check(Thrown && Reads.Retries() == 1,
+				  "a query that already handed rows out is not run twice");
+
+			try {
+				Query(Reads, "NoSuchTable");
+				Check(false, "a query failing on both databases throws");
+			} catch (const Poco::Exception &) {
+				Check(Reads.Retries() == 2, "a query failing on both databases throws");
+			}
+		}
+
+		{
+			ReadRouter Reads;
+			Reads.Configure(Logger, Pool(PrimaryFile), Pool(Dir.path() + "/missing/replica.db"),
+							30);
+			Check(Query(Reads, "Devices") == "primary",
+				  "an unreachable replica falls back to the primary");
+			Check(Query(Reads, "Devices") == "primary" && Reads.Fallbacks() == 1,
+				  "the replica is not tried again before the retry delay");
+		}
+
+		fmt::print("{} failure(s)\n", Failures);
+		return Failures == 0 ? 0 : 1;
+	}
+
+} // namespace OpenWifi::Test
+
+int main() {
+	try {
+		return OpenWifi::Test::Run();
+	} catch (const Poco::Exception &E) {
+		fmt::print(stderr, "{}\n", E.displayText());
+	}
+	return 1;
+}
@@ -0,0 +1,157 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+//	Concurrent signing requests for one firmware image, served by a local HTTP server: the
+//	image must be fetched once. Build and run:
+//		cmake --build . --target owgw_signature_test && ./owgw_signature_test
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/StreamCopier.h"
+
+#include "fmt/format.h"
+
+#include "SignatureCache.h"
+
+namespace OpenWifi::Test {
+
+	static int Failures = 0;
+	static std::atomic_uint64_t Requests = 0;
+	static constexpr auto FetchTime = std::chrono::milliseconds(300);
+
+	static void Check(bool Ok, const std::string &What) {
+		fmt::print("{} {}\n", Ok ? "ok  " : "FAIL", What);
+		if (!Ok)
+			Failures++;
+	}
+
+	//	A slow firmware server: /missing is a 404, any other path returns its own name.
+	class ImageHandler : public Poco::Net::HTTPRequestHandler {
+	  public:
+		void handleRequest(Poco::Net::HTTPServerRequest &Request,
+						   Poco::Net::HTTPServerResponse &Response) override {
+			Requests++;
+			std::this_thread::sleep_for(FetchTime);
+			if (Request.getURI() == "/missing") {
+				Response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+				Response.send();
+				return;
+			}
+			auto Body = "image:" + Request.getURI();
+			Response.setContentLength((std::streamsize)Body.size());
+			Response.send() << Body;
+		}
+	};
+
+	class ImageHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory {
+	  public:
+		Poco::Net::HTTPRequestHandler *
+		createRequestHandler(const Poco::Net::HTTPServerRequest &) override {
+			return new ImageHandler;
+		}
+	};
+
+	//	Stands in for SignatureManager::SignFile, the body is the signature.
+	static std::string Fetch(std::uint16_t Port, const std::string &Path) {
+		Poco::Net::HTTPClientSession Session("127.0.0.1", Port);
+		Poco::Net::HTTPRequest Request(Poco::Net::HTTPRequest::HTTP_GET, Path,
+									   Poco::Net::HTTPMessage::HTTP_1_1);
+		Session.sendRequest(Request);
+		Poco::Net::HTTPResponse Response;
+		auto &Body = Session.receiveResponse(Response);
+		std::ostringstream OS;
+		Poco::StreamCopier::copyStream(Body, OS);
+		return Response.getStatus() == Poco::Net::HTTPResponse::HTTP_OK ? OS.str() : "";
+	}
+
+	//	Callers threads asking for Path at once, returns how many got Expected.
+	static unsigned Concurrent(SignatureCache &Cache, std::uint16_t Port, unsigned Callers,
+							   const std::string &Path, const std::string &Expected) {
+		std::atomic_uint Matching = 0, Added = 0;
+		std::vector<std::thread> Threads;
+		for (unsigned i = 0; i < Callers; ++i) {
+			Threads.emplace_back([&] {
+				bool New = false;
+				if (Cache.Get(
+						Path, [&] { return Fetch(Port, Path); }, New) == Expected)
+					Matching++;
+				Added += New;
+			});
+		}
+		for (auto &T : Threads)
+			T.join();
+		Check(Added == (Expected.empty() ? 0 : 1),
+			  fmt::format("{}: one caller is told to persist the result", Path));
+		return Matching;
+	}
+
+	static int Run() {
+		Poco::Net::ServerSocket Socket(Poco::Net::SocketAddress("127.0.0.1", 0));
+		auto Params = new Poco::Net::HTTPServerParams;
+		Params->setMaxThreads(64);
+		Params->setMaxQueued(256);
+		Poco::Net::HTTPServer Server(new ImageHandlerFactory, Socket, Params);
+		Server.start();
+		auto Port = Socket.address().port();
+
+		constexpr unsigned Callers = 32;
+		SignatureCache Cache;
+
+		Check(Concurrent(Cache, Port, Callers, "/image1", "image:/image1") == Callers,
+			  "every caller gets the signature");
+		Check(Requests == 1, fmt::format("the image is fetched once ({} fetches)", Requests.load()));
+		Check(Cache.Signed() == 1 && Cache.Joined() + Cache.Hits() == Callers - 1,
+			  "the other callers wait for that fetch");
+
+		Check(Concurrent(Cache, Port, Callers, "/image1", "image:/image1") == Callers &&
+				  Requests == 1 && Cache.Hits() >= Callers,
+			  "a signed image is not fetched again");
+
+		Requests = 0;
+		Check(Concurrent(Cache, Port, Callers, "/missing", "") == Callers && Requests == 1,
+			  "a failed fetch is shared too");
+		Concurrent(Cache, Port, 1, "/missing", "");
+		Check(Requests == 2 && Cache.Failures() == 2, "a failure is not cached");
+
+		//	different images do not wait for each other.
+		Requests = 0;
+		auto Start = std::chrono::steady_clock::now();
+		std::thread Other([&] { Concurrent(Cache, Port, Callers / 2, "/image2", "image:/image2"); });
+		Concurrent(Cache, Port, Callers / 2, "/image3", "image:/image3");
+		Other.join();
+		auto Elapsed = std::chrono::steady_clock::now() - Start;
+		Check(Requests == 2 && Elapsed < FetchTime * 19 / 10,
+			  fmt::format("two images are fetched in parallel ({} ms)",
+						  std::chrono::duration_cast<std::chrono::milliseconds>(Elapsed).count()));
+
+		Server.stop();
+		fmt::print("{} failure(s)\n", Failures);
+		return Failures == 0 ? 0 : 1;
+	}
+
+} // namespace OpenWifi::Test
+
+int main() {
+	try {
+		return OpenWifi::Test::Run();
+	} catch (const Poco::Exception &E) {
+		fmt::print(stderr, "{}\n", E.displayText());
+	}
+	return 1;
+}